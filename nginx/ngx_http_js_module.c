@@ -16,6 +16,11 @@ typedef struct {
     njs_vm_t            *vm;
     const njs_extern_t  *req_proto;
     const njs_extern_t  *res_proto;
+    ngx_flag_t           preinit;
+    ngx_str_t            cache_path;
+    ngx_uint_t           vm_pool;
+    ngx_uint_t           nfree;
+    njs_vm_t           **free;
 } ngx_http_js_main_conf_t;
 
 
@@ -25,13 +30,14 @@ typedef struct {
 
 
 typedef struct {
-    njs_vm_t            *vm;
-    ngx_log_t           *log;
-    njs_opaque_value_t   args[2];
-    ngx_uint_t           done;
-    ngx_int_t            status;
-    njs_opaque_value_t   request_body;
-    ngx_str_t            redirect_uri;
+    njs_vm_t                 *vm;
+    ngx_log_t                *log;
+    ngx_http_js_main_conf_t  *main_conf;
+    njs_opaque_value_t        args[2];
+    ngx_uint_t                done;
+    ngx_int_t                 status;
+    njs_opaque_value_t        request_body;
+    ngx_str_t                 redirect_uri;
 } ngx_http_js_ctx_t;
 
 
@@ -150,10 +156,19 @@ static void ngx_http_js_handle_event(ngx_http_request_t *r,
 
 static char *ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
+static char *ngx_http_js_cache_path(ngx_conf_t *cf, ngx_command_t *cmd,
+    void *conf);
+static ngx_int_t ngx_http_js_cache_name(ngx_conf_t *cf,
+    ngx_http_js_main_conf_t *jmcf, nxt_str_t *script, ngx_str_t *name);
+static ngx_int_t ngx_http_js_cache_load(ngx_conf_t *cf,
+    ngx_http_js_main_conf_t *jmcf, nxt_str_t *script, ngx_str_t *name);
+static void ngx_http_js_cache_save(ngx_conf_t *cf,
+    ngx_http_js_main_conf_t *jmcf, nxt_str_t *script, ngx_str_t *name);
 static char *ngx_http_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf);
 static char *ngx_http_js_content(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
 static void *ngx_http_js_create_main_conf(ngx_conf_t *cf);
+static char *ngx_http_js_init_main_conf(ngx_conf_t *cf, void *conf);
 static void *ngx_http_js_create_loc_conf(ngx_conf_t *cf);
 static char *ngx_http_js_merge_loc_conf(ngx_conf_t *cf, void *parent,
     void *child);
@@ -168,6 +183,27 @@ static ngx_command_t  ngx_http_js_commands[] = {
       0,
       NULL },
 
+    { ngx_string("js_cache_path"),
+      NGX_HTTP_MAIN_CONF|NGX_CONF_TAKE1,
+      ngx_http_js_cache_path,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      0,
+      NULL },
+
+    { ngx_string("js_preinit"),
+      NGX_HTTP_MAIN_CONF|NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      offsetof(ngx_http_js_main_conf_t, preinit),
+      NULL },
+
+    { ngx_string("js_vm_pool"),
+      NGX_HTTP_MAIN_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_num_slot,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      offsetof(ngx_http_js_main_conf_t, vm_pool),
+      NULL },
+
     { ngx_string("js_set"),
       NGX_HTTP_MAIN_CONF|NGX_CONF_TAKE2,
       ngx_http_js_set,
@@ -191,7 +227,7 @@ static ngx_http_module_t  ngx_http_js_module_ctx = {
     NULL,                          /* postconfiguration */
 
     ngx_http_js_create_main_conf,  /* create main configuration */
-    NULL,                          /* init main configuration */
+    ngx_http_js_init_main_conf,    /* init main configuration */
 
     NULL,                          /* create server configuration */
     NULL,                          /* merge server configuration */
@@ -898,11 +934,19 @@ ngx_http_js_init_vm(ngx_http_request_t *r)
         return NGX_OK;
     }
 
-    ctx->vm = njs_vm_clone(jmcf->vm, r);
-    if (ctx->vm == NULL) {
-        return NGX_ERROR;
+    if (jmcf->nfree) {
+        ctx->vm = jmcf->free[--jmcf->nfree];
+        njs_vm_external_set(ctx->vm, r);
+
+    } else {
+        ctx->vm = njs_vm_clone(jmcf->vm, r);
+        if (ctx->vm == NULL) {
+            return NGX_ERROR;
+        }
     }
 
+    ctx->main_conf = jmcf;
+
     cln = ngx_pool_cleanup_add(r->pool, 0);
     if (cln == NULL) {
         return NGX_ERROR;
@@ -943,10 +987,28 @@ ngx_http_js_cleanup_ctx(void *data)
 {
     ngx_http_js_ctx_t *ctx = data;
 
+    njs_vm_t                 *vm;
+    ngx_http_js_main_conf_t  *jmcf;
+
     if (njs_vm_pending(ctx->vm)) {
         ngx_log_error(NGX_LOG_ERR, ctx->log, 0, "pending events");
     }
 
+    jmcf = ctx->main_conf;
+
+    if (jmcf->nfree < jmcf->vm_pool) {
+
+        /* The VM is reset while its pending events can still be released. */
+
+        vm = njs_vm_reset(jmcf->vm, ctx->vm);
+
+        if (vm != NULL) {
+            jmcf->free[jmcf->nfree++] = vm;
+        }
+
+        return;
+    }
+
     njs_vm_destroy(ctx->vm);
 }
 
@@ -954,9 +1016,13 @@ ngx_http_js_cleanup_ctx(void *data)
 static void
 ngx_http_js_cleanup_vm(void *data)
 {
-    njs_vm_t *vm = data;
+    ngx_http_js_main_conf_t *jmcf = data;
 
-    njs_vm_destroy(vm);
+    while (jmcf->nfree) {
+        njs_vm_destroy(jmcf->free[--jmcf->nfree]);
+    }
+
+    njs_vm_destroy(jmcf->vm);
 }
 
 
@@ -2293,9 +2359,9 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     u_char                *start, *end;
     ssize_t                n;
     ngx_fd_t               fd;
-    ngx_str_t             *value, file;
+    ngx_str_t             *value, file, cache;
     nxt_int_t              rc;
-    nxt_str_t              text;
+    nxt_str_t              text, script;
     njs_vm_opt_t           options;
     ngx_file_info_t        fi;
     ngx_pool_cleanup_t    *cln;
@@ -2376,7 +2442,7 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     }
 
     cln->handler = ngx_http_js_cleanup_vm;
-    cln->data = jmcf->vm;
+    cln->data = jmcf;
 
     jmcf->req_proto = njs_vm_external_prototype(jmcf->vm,
                                                 &ngx_http_js_externals[0]);
@@ -2393,6 +2459,25 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    script.start = start;
+    script.length = size;
+
+    if (jmcf->cache_path.data) {
+        if (ngx_http_js_cache_name(cf, jmcf, &script, &cache) != NGX_OK) {
+            return NGX_CONF_ERROR;
+        }
+
+        rc = ngx_http_js_cache_load(cf, jmcf, &script, &cache);
+
+        if (rc == NGX_OK) {
+            return NGX_CONF_OK;
+        }
+
+        if (rc == NGX_ERROR) {
+            return NGX_CONF_ERROR;
+        }
+    }
+
     rc = njs_vm_compile(jmcf->vm, &start, end);
 
     if (rc != NJS_OK) {
@@ -2411,10 +2496,217 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    if (jmcf->cache_path.data) {
+        ngx_http_js_cache_save(cf, jmcf, &script, &cache);
+    }
+
+    return NGX_CONF_OK;
+}
+
+
+static char *
+ngx_http_js_cache_path(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_http_js_main_conf_t *jmcf = conf;
+
+    ngx_str_t  *value;
+
+    if (jmcf->cache_path.data) {
+        return "is duplicate";
+    }
+
+    if (jmcf->vm) {
+        return "must be specified before \"js_include\"";
+    }
+
+    value = cf->args->elts;
+    jmcf->cache_path = value[1];
+
+    if (ngx_conf_full_name(cf->cycle, &jmcf->cache_path, 0) != NGX_OK) {
+        return NGX_CONF_ERROR;
+    }
+
     return NGX_CONF_OK;
 }
 
 
+static ngx_int_t
+ngx_http_js_cache_name(ngx_conf_t *cf, ngx_http_js_main_conf_t *jmcf,
+    nxt_str_t *script, ngx_str_t *name)
+{
+    u_char     *p;
+    u_char      hash[16];
+    ngx_md5_t   md5;
+
+    ngx_md5_init(&md5);
+    ngx_md5_update(&md5, script->start, script->length);
+    ngx_md5_final(hash, &md5);
+
+    name->len = jmcf->cache_path.len + 1 + 2 * sizeof(hash)
+                + sizeof(".njsc") - 1;
+
+    name->data = ngx_pnalloc(cf->pool, name->len + 1);
+    if (name->data == NULL) {
+        return NGX_ERROR;
+    }
+
+    p = ngx_cpymem(name->data, jmcf->cache_path.data, jmcf->cache_path.len);
+    *p++ = '/';
+    p = ngx_hex_dump(p, hash, sizeof(hash));
+    p = ngx_cpymem(p, ".njsc", sizeof(".njsc") - 1);
+    *p = '\0';
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_js_cache_load(ngx_conf_t *cf, ngx_http_js_main_conf_t *jmcf,
+    nxt_str_t *script, ngx_str_t *name)
+{
+    ssize_t           n;
+    ngx_fd_t          fd;
+    nxt_int_t         rc;
+    nxt_str_t         image;
+    ngx_file_info_t   fi;
+
+    fd = ngx_open_file(name->data, NGX_FILE_RDONLY, NGX_FILE_OPEN, 0);
+    if (fd == NGX_INVALID_FILE) {
+        if (ngx_errno != NGX_ENOENT) {
+            ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                               ngx_open_file_n " \"%s\" failed", name->data);
+        }
+
+        return NGX_DECLINED;
+    }
+
+    if (ngx_fd_info(fd, &fi) == NGX_FILE_ERROR) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_fd_info_n " \"%s\" failed", name->data);
+        (void) ngx_close_file(fd);
+        return NGX_DECLINED;
+    }
+
+    image.length = ngx_file_size(&fi);
+
+    image.start = ngx_alloc(image.length, cf->log);
+    if (image.start == NULL) {
+        (void) ngx_close_file(fd);
+        return NGX_ERROR;
+    }
+
+    n = ngx_read_fd(fd, image.start, image.length);
+
+    if (ngx_close_file(fd) == NGX_FILE_ERROR) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_close_file_n " \"%s\" failed", name->data);
+    }
+
+    if (n == -1 || (size_t) n != image.length) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_read_fd_n " \"%s\" failed", name->data);
+        ngx_free(image.start);
+        return NGX_DECLINED;
+    }
+
+    rc = njs_vm_cache_load(jmcf->vm, script, &image);
+
+    ngx_free(image.start);
+
+    if (rc == NJS_DECLINED) {
+        ngx_conf_log_error(NGX_LOG_NOTICE, cf, 0,
+                           "js cache \"%s\" is stale", name->data);
+        return NGX_DECLINED;
+    }
+
+    if (rc != NJS_OK) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "failed to load js cache \"%s\"", name->data);
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_js_cache_save(ngx_conf_t *cf, ngx_http_js_main_conf_t *jmcf,
+    nxt_str_t *script, ngx_str_t *name)
+{
+    u_char     *p;
+    ssize_t     n;
+    ngx_fd_t    fd;
+    ngx_str_t   temp;
+    nxt_int_t   rc;
+    nxt_str_t   image;
+
+    rc = njs_vm_cache_save(jmcf->vm, script, &image);
+
+    if (rc == NJS_DECLINED) {
+        ngx_conf_log_error(NGX_LOG_NOTICE, cf, 0,
+                           "js script cannot be cached");
+        return;
+    }
+
+    if (rc != NJS_OK) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                           "failed to save js cache \"%s\"", name->data);
+        return;
+    }
+
+    /* The cache file is replaced atomically. */
+
+    temp.len = name->len + 1 + NGX_INT64_LEN;
+
+    temp.data = ngx_pnalloc(cf->pool, temp.len + 1);
+    if (temp.data == NULL) {
+        return;
+    }
+
+    p = ngx_sprintf(temp.data, "%V.%P", name, ngx_pid);
+    *p = '\0';
+
+    fd = ngx_open_file(temp.data, NGX_FILE_WRONLY, NGX_FILE_TRUNCATE,
+                       NGX_FILE_DEFAULT_ACCESS);
+    if (fd == NGX_INVALID_FILE) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_open_file_n " \"%s\" failed", temp.data);
+        return;
+    }
+
+    n = ngx_write_fd(fd, image.start, image.length);
+
+    if (n == -1 || (size_t) n != image.length) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_write_fd_n " \"%s\" failed", temp.data);
+        (void) ngx_close_file(fd);
+        goto failed;
+    }
+
+    if (ngx_close_file(fd) == NGX_FILE_ERROR) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_close_file_n " \"%s\" failed", temp.data);
+        goto failed;
+    }
+
+    if (ngx_rename_file(temp.data, name->data) == NGX_FILE_ERROR) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_rename_file_n " \"%s\" to \"%s\" failed",
+                           temp.data, name->data);
+        goto failed;
+    }
+
+    return;
+
+failed:
+
+    if (ngx_delete_file(temp.data) == NGX_FILE_ERROR) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_delete_file_n " \"%s\" failed", temp.data);
+    }
+}
+
+
 static char *
 ngx_http_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
@@ -2489,12 +2781,65 @@ ngx_http_js_create_main_conf(ngx_conf_t *cf)
      *     conf->vm = NULL;
      *     conf->req_proto = NULL;
      *     conf->res_proto = NULL;
+     *     conf->cache_path = { 0, NULL };
+     *     conf->nfree = 0;
+     *     conf->free = NULL;
      */
 
+    conf->preinit = NGX_CONF_UNSET;
+    conf->vm_pool = NGX_CONF_UNSET_UINT;
+
     return conf;
 }
 
 
+static char *
+ngx_http_js_init_main_conf(ngx_conf_t *cf, void *conf)
+{
+    ngx_http_js_main_conf_t *jmcf = conf;
+
+    nxt_int_t  rc;
+    nxt_str_t  text;
+
+    ngx_conf_init_value(jmcf->preinit, 0);
+    ngx_conf_init_uint_value(jmcf->vm_pool, 0);
+
+    if (jmcf->vm == NULL) {
+        return NGX_CONF_OK;
+    }
+
+    if (jmcf->vm_pool) {
+        jmcf->free = ngx_palloc(cf->pool, jmcf->vm_pool * sizeof(njs_vm_t *));
+        if (jmcf->free == NULL) {
+            return NGX_CONF_ERROR;
+        }
+    }
+
+    if (!jmcf->preinit) {
+        return NGX_CONF_OK;
+    }
+
+    rc = njs_vm_preinit(jmcf->vm);
+
+    if (rc == NJS_DECLINED) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                           "js global scope cannot be preinitialized, "
+                           "it will be run for each request");
+        return NGX_CONF_OK;
+    }
+
+    if (rc != NJS_OK) {
+        njs_vm_retval_to_ext_string(jmcf->vm, &text);
+
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0, "%*s, preinitialized",
+                           text.length, text.start);
+        return NGX_CONF_ERROR;
+    }
+
+    return NGX_CONF_OK;
+}
+
+
 static void *
 ngx_http_js_create_loc_conf(ngx_conf_t *cf)
 {
@@ -15,6 +15,12 @@
 typedef struct {
     njs_vm_t              *vm;
     const njs_extern_t    *proto;
+    ngx_flag_t             preinit;
+    ngx_str_t              cache_path;
+    size_t                 gc_threshold;
+    ngx_uint_t             vm_pool;
+    ngx_uint_t             nfree;
+    njs_vm_t             **free;
 } ngx_stream_js_main_conf_t;
 
 
@@ -26,15 +32,16 @@ typedef struct {
 
 
 typedef struct {
-    njs_vm_t              *vm;
-    ngx_log_t             *log;
-    njs_opaque_value_t     arg;
-    ngx_buf_t             *buf;
-    ngx_chain_t           *free;
-    ngx_chain_t           *busy;
-    ngx_stream_session_t  *session;
-    unsigned               from_upstream:1;
-    unsigned               filter:1;
+    njs_vm_t                   *vm;
+    ngx_log_t                  *log;
+    ngx_stream_js_main_conf_t  *main_conf;
+    njs_opaque_value_t          arg;
+    ngx_buf_t                  *buf;
+    ngx_chain_t                *free;
+    ngx_chain_t                *busy;
+    ngx_stream_session_t       *session;
+    unsigned                    from_upstream:1;
+    unsigned                    filter:1;
 } ngx_stream_js_ctx_t;
 
 
@@ -47,6 +54,8 @@ static ngx_int_t ngx_stream_js_body_filter(ngx_stream_session_t *s,
 static ngx_int_t ngx_stream_js_variable(ngx_stream_session_t *s,
     ngx_stream_variable_value_t *v, uintptr_t data);
 static ngx_int_t ngx_stream_js_init_vm(ngx_stream_session_t *s);
+static nxt_int_t ngx_stream_js_call(ngx_stream_js_ctx_t *ctx,
+    njs_function_t *func);
 static void ngx_stream_js_cleanup_ctx(void *data);
 static void ngx_stream_js_cleanup_vm(void *data);
 
@@ -60,6 +69,8 @@ static njs_ret_t ngx_stream_js_ext_get_buffer(njs_vm_t *vm, njs_value_t *value,
     void *obj, uintptr_t data);
 static njs_ret_t ngx_stream_js_ext_set_buffer(njs_vm_t *vm, void *obj,
     uintptr_t data, nxt_str_t *value);
+static njs_ret_t ngx_stream_js_ext_get_array_buffer(njs_vm_t *vm,
+    njs_value_t *value, void *obj, uintptr_t data);
 
 static njs_ret_t ngx_stream_js_ext_log(njs_vm_t *vm, njs_value_t *args,
      nxt_uint_t nargs, njs_index_t unused);
@@ -77,9 +88,18 @@ static njs_ret_t ngx_stream_js_ext_get_code(njs_vm_t *vm,
 
 static char *ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
+static char *ngx_stream_js_cache_path(ngx_conf_t *cf, ngx_command_t *cmd,
+    void *conf);
+static ngx_int_t ngx_stream_js_cache_name(ngx_conf_t *cf,
+    ngx_stream_js_main_conf_t *jmcf, nxt_str_t *script, ngx_str_t *name);
+static ngx_int_t ngx_stream_js_cache_load(ngx_conf_t *cf,
+    ngx_stream_js_main_conf_t *jmcf, nxt_str_t *script, ngx_str_t *name);
+static void ngx_stream_js_cache_save(ngx_conf_t *cf,
+    ngx_stream_js_main_conf_t *jmcf, nxt_str_t *script, ngx_str_t *name);
 static char *ngx_stream_js_set(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
 static void *ngx_stream_js_create_main_conf(ngx_conf_t *cf);
+static char *ngx_stream_js_init_main_conf(ngx_conf_t *cf, void *conf);
 static void *ngx_stream_js_create_srv_conf(ngx_conf_t *cf);
 static char *ngx_stream_js_merge_srv_conf(ngx_conf_t *cf, void *parent,
     void *child);
@@ -95,6 +115,34 @@ static ngx_command_t  ngx_stream_js_commands[] = {
       0,
       NULL },
 
+    { ngx_string("js_cache_path"),
+      NGX_STREAM_MAIN_CONF|NGX_CONF_TAKE1,
+      ngx_stream_js_cache_path,
+      NGX_STREAM_MAIN_CONF_OFFSET,
+      0,
+      NULL },
+
+    { ngx_string("js_preinit"),
+      NGX_STREAM_MAIN_CONF|NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      NGX_STREAM_MAIN_CONF_OFFSET,
+      offsetof(ngx_stream_js_main_conf_t, preinit),
+      NULL },
+
+    { ngx_string("js_gc_threshold"),
+      NGX_STREAM_MAIN_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_size_slot,
+      NGX_STREAM_MAIN_CONF_OFFSET,
+      offsetof(ngx_stream_js_main_conf_t, gc_threshold),
+      NULL },
+
+    { ngx_string("js_vm_pool"),
+      NGX_STREAM_MAIN_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_num_slot,
+      NGX_STREAM_MAIN_CONF_OFFSET,
+      offsetof(ngx_stream_js_main_conf_t, vm_pool),
+      NULL },
+
     { ngx_string("js_set"),
       NGX_STREAM_MAIN_CONF|NGX_CONF_TAKE2,
       ngx_stream_js_set,
@@ -132,7 +180,7 @@ static ngx_stream_module_t  ngx_stream_js_module_ctx = {
     ngx_stream_js_init,             /* postconfiguration */
 
     ngx_stream_js_create_main_conf, /* create main configuration */
-    NULL,                           /* init main configuration */
+    ngx_stream_js_init_main_conf,   /* init main configuration */
 
     ngx_stream_js_create_srv_conf,  /* create server configuration */
     ngx_stream_js_merge_srv_conf,   /* merge server configuration */
@@ -205,6 +253,18 @@ static njs_external_t  ngx_stream_js_ext_session[] = {
       NULL,
       0 },
 
+    { nxt_string("arrayBuffer"),
+      NJS_EXTERN_PROPERTY,
+      NULL,
+      0,
+      ngx_stream_js_ext_get_array_buffer,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      0 },
+
 
     { nxt_string("variables"),
       NJS_EXTERN_OBJECT,
@@ -405,7 +465,7 @@ ngx_stream_js_phase_handler(ngx_stream_session_t *s, ngx_str_t *name)
         return NGX_ERROR;
     }
 
-    if (njs_vm_call(ctx->vm, func, njs_value_arg(&ctx->arg), 1) != NJS_OK) {
+    if (ngx_stream_js_call(ctx, func) != NJS_OK) {
         njs_vm_retval_to_ext_string(ctx->vm, &exception);
 
         ngx_log_error(NGX_LOG_ERR, c->log, 0, "js exception: %*s",
@@ -492,7 +552,7 @@ ngx_stream_js_body_filter(ngx_stream_session_t *s, ngx_chain_t *in,
     while (in) {
         ctx->buf = in->buf;
 
-        if (njs_vm_call(ctx->vm, func, njs_value_arg(&ctx->arg), 1) != NJS_OK) {
+        if (ngx_stream_js_call(ctx, func) != NJS_OK) {
             njs_vm_retval_to_ext_string(ctx->vm, &exception);
 
             ngx_log_error(NGX_LOG_ERR, c->log, 0, "js exception: %*s",
@@ -558,11 +618,12 @@ ngx_stream_js_variable(ngx_stream_session_t *s, ngx_stream_variable_value_t *v,
 {
     ngx_str_t *fname = (ngx_str_t *) data;
 
-    ngx_int_t             rc;
-    nxt_int_t             pending;
-    nxt_str_t             name, value, exception;
-    njs_function_t       *func;
-    ngx_stream_js_ctx_t  *ctx;
+    ngx_int_t                   rc;
+    nxt_int_t                   pending;
+    nxt_str_t                   name, value, exception;
+    njs_function_t             *func;
+    ngx_stream_js_ctx_t        *ctx;
+    ngx_stream_js_main_conf_t  *jmcf;
 
     rc = ngx_stream_js_init_vm(s);
 
@@ -593,7 +654,7 @@ ngx_stream_js_variable(ngx_stream_session_t *s, ngx_stream_variable_value_t *v,
 
     pending = njs_vm_pending(ctx->vm);
 
-    if (njs_vm_call(ctx->vm, func, njs_value_arg(&ctx->arg), 1) != NJS_OK) {
+    if (ngx_stream_js_call(ctx, func) != NJS_OK) {
         njs_vm_retval_to_ext_string(ctx->vm, &exception);
 
         ngx_log_error(NGX_LOG_ERR, s->connection->log, 0,
@@ -619,6 +680,19 @@ ngx_stream_js_variable(ngx_stream_session_t *s, ngx_stream_variable_value_t *v,
     v->not_found = 0;
     v->data = value.start;
 
+    jmcf = ngx_stream_get_module_main_conf(s, ngx_stream_js_module);
+
+    if (jmcf->gc_threshold) {
+        /* The collector may free the value during the next call. */
+
+        v->data = ngx_pnalloc(s->connection->pool, value.length);
+        if (v->data == NULL) {
+            return NGX_ERROR;
+        }
+
+        ngx_memcpy(v->data, value.start, value.length);
+    }
+
     return NGX_OK;
 }
 
@@ -652,11 +726,19 @@ ngx_stream_js_init_vm(ngx_stream_session_t *s)
         return NGX_OK;
     }
 
-    ctx->vm = njs_vm_clone(jmcf->vm, s);
-    if (ctx->vm == NULL) {
-        return NGX_ERROR;
+    if (jmcf->nfree) {
+        ctx->vm = jmcf->free[--jmcf->nfree];
+        njs_vm_external_set(ctx->vm, s);
+
+    } else {
+        ctx->vm = njs_vm_clone(jmcf->vm, s);
+        if (ctx->vm == NULL) {
+            return NGX_ERROR;
+        }
     }
 
+    ctx->main_conf = jmcf;
+
     cln = ngx_pool_cleanup_add(s->connection->pool, 0);
     if (cln == NULL) {
         return NGX_ERROR;
@@ -686,15 +768,51 @@ ngx_stream_js_init_vm(ngx_stream_session_t *s)
 }
 
 
+/*
+ * The ArrayBuffers wrapping the connection buffers are detached after
+ * each call since the buffers may be reused by nginx.
+ */
+
+static nxt_int_t
+ngx_stream_js_call(ngx_stream_js_ctx_t *ctx, njs_function_t *func)
+{
+    nxt_int_t  ret;
+
+    ret = njs_vm_call(ctx->vm, func, njs_value_arg(&ctx->arg), 1);
+
+    njs_vm_array_buffers_detach(ctx->vm);
+
+    return ret;
+}
+
+
 static void
 ngx_stream_js_cleanup_ctx(void *data)
 {
     ngx_stream_js_ctx_t *ctx = data;
 
+    njs_vm_t                   *vm;
+    ngx_stream_js_main_conf_t  *jmcf;
+
     if (njs_vm_pending(ctx->vm)) {
         ngx_log_error(NGX_LOG_ERR, ctx->log, 0, "pending events");
     }
 
+    jmcf = ctx->main_conf;
+
+    if (jmcf->nfree < jmcf->vm_pool) {
+
+        /* The VM is reset while its pending events can still be released. */
+
+        vm = njs_vm_reset(jmcf->vm, ctx->vm);
+
+        if (vm != NULL) {
+            jmcf->free[jmcf->nfree++] = vm;
+        }
+
+        return;
+    }
+
     njs_vm_destroy(ctx->vm);
 }
 
@@ -702,9 +820,13 @@ ngx_stream_js_cleanup_ctx(void *data)
 static void
 ngx_stream_js_cleanup_vm(void *data)
 {
-    njs_vm_t *vm = data;
+    ngx_stream_js_main_conf_t *jmcf = data;
+
+    while (jmcf->nfree) {
+        njs_vm_destroy(jmcf->free[--jmcf->nfree]);
+    }
 
-    njs_vm_destroy(vm);
+    njs_vm_destroy(jmcf->vm);
 }
 
 
@@ -791,12 +913,16 @@ ngx_stream_js_ext_get_buffer(njs_vm_t *vm, njs_value_t *value, void *obj,
 }
 
 
+/*
+ * The ArrayBuffer refers to the data of the current buffer without copying,
+ * it is detached after the handler returns.
+ */
+
 static njs_ret_t
-ngx_stream_js_ext_set_buffer(njs_vm_t *vm, void *obj, uintptr_t data,
-    nxt_str_t *value)
+ngx_stream_js_ext_get_array_buffer(njs_vm_t *vm, njs_value_t *value,
+    void *obj, uintptr_t data)
 {
     ngx_buf_t             *b;
-    ngx_chain_t           *cl;
     ngx_connection_t      *c;
     ngx_stream_js_ctx_t   *ctx;
     ngx_stream_session_t  *s;
@@ -805,6 +931,31 @@ ngx_stream_js_ext_set_buffer(njs_vm_t *vm, void *obj, uintptr_t data,
     c = s->connection;
     ctx = ngx_stream_get_module_ctx(s, ngx_stream_js_module);
 
+    b = ctx->filter ? ctx->buf : c->buffer;
+
+    if (b == NULL) {
+        return njs_vm_array_buffer_wrap(vm, value, NULL, 0);
+    }
+
+    return njs_vm_array_buffer_wrap(vm, value, b->pos, b->last - b->pos);
+}
+
+
+static njs_ret_t
+ngx_stream_js_ext_set_buffer(njs_vm_t *vm, void *obj, uintptr_t data,
+    nxt_str_t *value)
+{
+    ngx_buf_t                  *b;
+    ngx_chain_t                *cl;
+    ngx_connection_t           *c;
+    ngx_stream_js_ctx_t        *ctx;
+    ngx_stream_session_t       *s;
+    ngx_stream_js_main_conf_t  *jmcf;
+
+    s = (ngx_stream_session_t *) obj;
+    c = s->connection;
+    ctx = ngx_stream_get_module_ctx(s, ngx_stream_js_module);
+
     ngx_log_debug2(NGX_LOG_DEBUG_STREAM, c->log, 0,
                    "stream js set buffer \"%*s\"", value->length, value->start);
 
@@ -830,6 +981,21 @@ ngx_stream_js_ext_set_buffer(njs_vm_t *vm, void *obj, uintptr_t data,
 
     b->start = value->start;
     b->end = value->start + value->length;
+
+    jmcf = ngx_stream_get_module_main_conf(s, ngx_stream_js_module);
+
+    if (jmcf->gc_threshold && value->length) {
+        /* The collector may free the value before the buffer is sent. */
+
+        b->start = ngx_pnalloc(c->pool, value->length);
+        if (b->start == NULL) {
+            return NJS_ERROR;
+        }
+
+        ngx_memcpy(b->start, value->start, value->length);
+        b->end = b->start + value->length;
+    }
+
     b->pos = b->start;
     b->last = b->end;
 
@@ -952,9 +1118,9 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     u_char                *start, *end;
     ssize_t                n;
     ngx_fd_t               fd;
-    ngx_str_t             *value, file;
+    ngx_str_t             *value, file, cache;
     nxt_int_t              rc;
-    nxt_str_t              text;
+    nxt_str_t              text, script;
     njs_vm_opt_t           options;
     ngx_file_info_t        fi;
     ngx_pool_cleanup_t    *cln;
@@ -1034,7 +1200,7 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     }
 
     cln->handler = ngx_stream_js_cleanup_vm;
-    cln->data = jmcf->vm;
+    cln->data = jmcf;
 
     jmcf->proto = njs_vm_external_prototype(jmcf->vm,
                                             &ngx_stream_js_externals[0]);
@@ -1044,6 +1210,25 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    script.start = start;
+    script.length = size;
+
+    if (jmcf->cache_path.data) {
+        if (ngx_stream_js_cache_name(cf, jmcf, &script, &cache) != NGX_OK) {
+            return NGX_CONF_ERROR;
+        }
+
+        rc = ngx_stream_js_cache_load(cf, jmcf, &script, &cache);
+
+        if (rc == NGX_OK) {
+            return NGX_CONF_OK;
+        }
+
+        if (rc == NGX_ERROR) {
+            return NGX_CONF_ERROR;
+        }
+    }
+
     rc = njs_vm_compile(jmcf->vm, &start, end);
 
     if (rc != NJS_OK) {
@@ -1062,10 +1247,217 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    if (jmcf->cache_path.data) {
+        ngx_stream_js_cache_save(cf, jmcf, &script, &cache);
+    }
+
+    return NGX_CONF_OK;
+}
+
+
+static char *
+ngx_stream_js_cache_path(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_stream_js_main_conf_t *jmcf = conf;
+
+    ngx_str_t  *value;
+
+    if (jmcf->cache_path.data) {
+        return "is duplicate";
+    }
+
+    if (jmcf->vm) {
+        return "must be specified before \"js_include\"";
+    }
+
+    value = cf->args->elts;
+    jmcf->cache_path = value[1];
+
+    if (ngx_conf_full_name(cf->cycle, &jmcf->cache_path, 0) != NGX_OK) {
+        return NGX_CONF_ERROR;
+    }
+
     return NGX_CONF_OK;
 }
 
 
+static ngx_int_t
+ngx_stream_js_cache_name(ngx_conf_t *cf, ngx_stream_js_main_conf_t *jmcf,
+    nxt_str_t *script, ngx_str_t *name)
+{
+    u_char     *p;
+    u_char      hash[16];
+    ngx_md5_t   md5;
+
+    ngx_md5_init(&md5);
+    ngx_md5_update(&md5, script->start, script->length);
+    ngx_md5_final(hash, &md5);
+
+    name->len = jmcf->cache_path.len + 1 + 2 * sizeof(hash)
+                + sizeof(".njsc") - 1;
+
+    name->data = ngx_pnalloc(cf->pool, name->len + 1);
+    if (name->data == NULL) {
+        return NGX_ERROR;
+    }
+
+    p = ngx_cpymem(name->data, jmcf->cache_path.data, jmcf->cache_path.len);
+    *p++ = '/';
+    p = ngx_hex_dump(p, hash, sizeof(hash));
+    p = ngx_cpymem(p, ".njsc", sizeof(".njsc") - 1);
+    *p = '\0';
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_stream_js_cache_load(ngx_conf_t *cf, ngx_stream_js_main_conf_t *jmcf,
+    nxt_str_t *script, ngx_str_t *name)
+{
+    ssize_t           n;
+    ngx_fd_t          fd;
+    nxt_int_t         rc;
+    nxt_str_t         image;
+    ngx_file_info_t   fi;
+
+    fd = ngx_open_file(name->data, NGX_FILE_RDONLY, NGX_FILE_OPEN, 0);
+    if (fd == NGX_INVALID_FILE) {
+        if (ngx_errno != NGX_ENOENT) {
+            ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                               ngx_open_file_n " \"%s\" failed", name->data);
+        }
+
+        return NGX_DECLINED;
+    }
+
+    if (ngx_fd_info(fd, &fi) == NGX_FILE_ERROR) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_fd_info_n " \"%s\" failed", name->data);
+        (void) ngx_close_file(fd);
+        return NGX_DECLINED;
+    }
+
+    image.length = ngx_file_size(&fi);
+
+    image.start = ngx_alloc(image.length, cf->log);
+    if (image.start == NULL) {
+        (void) ngx_close_file(fd);
+        return NGX_ERROR;
+    }
+
+    n = ngx_read_fd(fd, image.start, image.length);
+
+    if (ngx_close_file(fd) == NGX_FILE_ERROR) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_close_file_n " \"%s\" failed", name->data);
+    }
+
+    if (n == -1 || (size_t) n != image.length) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_read_fd_n " \"%s\" failed", name->data);
+        ngx_free(image.start);
+        return NGX_DECLINED;
+    }
+
+    rc = njs_vm_cache_load(jmcf->vm, script, &image);
+
+    ngx_free(image.start);
+
+    if (rc == NJS_DECLINED) {
+        ngx_conf_log_error(NGX_LOG_NOTICE, cf, 0,
+                           "js cache \"%s\" is stale", name->data);
+        return NGX_DECLINED;
+    }
+
+    if (rc != NJS_OK) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "failed to load js cache \"%s\"", name->data);
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_stream_js_cache_save(ngx_conf_t *cf, ngx_stream_js_main_conf_t *jmcf,
+    nxt_str_t *script, ngx_str_t *name)
+{
+    u_char     *p;
+    ssize_t     n;
+    ngx_fd_t    fd;
+    ngx_str_t   temp;
+    nxt_int_t   rc;
+    nxt_str_t   image;
+
+    rc = njs_vm_cache_save(jmcf->vm, script, &image);
+
+    if (rc == NJS_DECLINED) {
+        ngx_conf_log_error(NGX_LOG_NOTICE, cf, 0,
+                           "js script cannot be cached");
+        return;
+    }
+
+    if (rc != NJS_OK) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                           "failed to save js cache \"%s\"", name->data);
+        return;
+    }
+
+    /* The cache file is replaced atomically. */
+
+    temp.len = name->len + 1 + NGX_INT64_LEN;
+
+    temp.data = ngx_pnalloc(cf->pool, temp.len + 1);
+    if (temp.data == NULL) {
+        return;
+    }
+
+    p = ngx_sprintf(temp.data, "%V.%P", name, ngx_pid);
+    *p = '\0';
+
+    fd = ngx_open_file(temp.data, NGX_FILE_WRONLY, NGX_FILE_TRUNCATE,
+                       NGX_FILE_DEFAULT_ACCESS);
+    if (fd == NGX_INVALID_FILE) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_open_file_n " \"%s\" failed", temp.data);
+        return;
+    }
+
+    n = ngx_write_fd(fd, image.start, image.length);
+
+    if (n == -1 || (size_t) n != image.length) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_write_fd_n " \"%s\" failed", temp.data);
+        (void) ngx_close_file(fd);
+        goto failed;
+    }
+
+    if (ngx_close_file(fd) == NGX_FILE_ERROR) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_close_file_n " \"%s\" failed", temp.data);
+        goto failed;
+    }
+
+    if (ngx_rename_file(temp.data, name->data) == NGX_FILE_ERROR) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_rename_file_n " \"%s\" to \"%s\" failed",
+                           temp.data, name->data);
+        goto failed;
+    }
+
+    return;
+
+failed:
+
+    if (ngx_delete_file(temp.data) == NGX_FILE_ERROR) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, ngx_errno,
+                           ngx_delete_file_n " \"%s\" failed", temp.data);
+    }
+}
+
+
 static char *
 ngx_stream_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
@@ -1105,7 +1497,7 @@ ngx_stream_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 static void *
 ngx_stream_js_create_main_conf(ngx_conf_t *cf)
 {
-    ngx_stream_js_srv_conf_t  *conf;
+    ngx_stream_js_main_conf_t  *conf;
 
     conf = ngx_pcalloc(cf->pool, sizeof(ngx_stream_js_main_conf_t));
     if (conf == NULL) {
@@ -1117,12 +1509,71 @@ ngx_stream_js_create_main_conf(ngx_conf_t *cf)
      *
      *     conf->vm = NULL;
      *     conf->proto = NULL;
+     *     conf->cache_path = { 0, NULL };
+     *     conf->nfree = 0;
+     *     conf->free = NULL;
      */
 
+    conf->preinit = NGX_CONF_UNSET;
+    conf->gc_threshold = NGX_CONF_UNSET_SIZE;
+    conf->vm_pool = NGX_CONF_UNSET_UINT;
+
     return conf;
 }
 
 
+static char *
+ngx_stream_js_init_main_conf(ngx_conf_t *cf, void *conf)
+{
+    ngx_stream_js_main_conf_t *jmcf = conf;
+
+    nxt_int_t  rc;
+    nxt_str_t  text;
+
+    ngx_conf_init_value(jmcf->preinit, 0);
+    ngx_conf_init_size_value(jmcf->gc_threshold, 0);
+    ngx_conf_init_uint_value(jmcf->vm_pool, 0);
+
+    if (jmcf->vm == NULL) {
+        return NGX_CONF_OK;
+    }
+
+    if (jmcf->vm_pool) {
+        jmcf->free = ngx_palloc(cf->pool, jmcf->vm_pool * sizeof(njs_vm_t *));
+        if (jmcf->free == NULL) {
+            return NGX_CONF_ERROR;
+        }
+    }
+
+    /* The sessions inherit the threshold from the main VM. */
+
+    njs_vm_gc_threshold_set(jmcf->vm, jmcf->gc_threshold);
+
+    if (!jmcf->preinit) {
+        return NGX_CONF_OK;
+    }
+
+    rc = njs_vm_preinit(jmcf->vm);
+
+    if (rc == NJS_DECLINED) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                           "js global scope cannot be preinitialized, "
+                           "it will be run for each session");
+        return NGX_CONF_OK;
+    }
+
+    if (rc != NJS_OK) {
+        njs_vm_retval_to_ext_string(jmcf->vm, &text);
+
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0, "%*s, preinitialized",
+                           text.length, text.start);
+        return NGX_CONF_ERROR;
+    }
+
+    return NGX_CONF_OK;
+}
+
+
 static void *
 ngx_stream_js_create_srv_conf(ngx_conf_t *cf)
 {
@@ -5,14 +5,29 @@
  */
 
 #include <njs_core.h>
+#include <njs_object_hash.h>
 #include <njs_regexp.h>
+#include <njs_regexp_pattern.h>
 #include <string.h>
 
 
+static void njs_vm_release_events(njs_vm_t *vm);
+static njs_vm_t *njs_vm_clone_pool(njs_vm_t *vm, nxt_mem_cache_pool_t *nmcp,
+    njs_external_ptr_t external);
 static nxt_int_t njs_vm_init(njs_vm_t *vm);
+static nxt_int_t njs_vm_snapshot_value(njs_vm_t *vm, njs_value_t *value,
+    nxt_uint_t level);
+static nxt_int_t njs_vm_snapshot_object(njs_vm_t *vm, njs_object_t *object,
+    nxt_uint_t level);
 static nxt_int_t njs_vm_handle_events(njs_vm_t *vm);
 
 
+#define NJS_SNAPSHOT_LEVEL_MAX  32
+
+/* The number of memory clusters retained by njs_vm_reset(). */
+#define NJS_VM_RESET_CLUSTERS   32
+
+
 static void *
 njs_alloc(void *mem, size_t size)
 {
@@ -104,11 +119,7 @@ njs_vm_create(njs_vm_opt_t *options)
 
     if (nxt_fast_path(vm != NULL)) {
         vm->mem_cache_pool = mcp;
-
-        ret = njs_regexp_init(vm);
-        if (nxt_slow_path(ret != NXT_OK)) {
-            return NULL;
-        }
+        vm->gc_threshold = options->gc_threshold;
 
         if (options->shared != NULL) {
             vm->shared = options->shared;
@@ -130,6 +141,9 @@ njs_vm_create(njs_vm_opt_t *options)
 
             nxt_lvlhsh_init(&vm->shared->values_hash);
 
+            vm->shared->patterns_owner = vm;
+            nxt_lvlhsh_init(&vm->shared->patterns_hash);
+
             pattern = njs_regexp_pattern_create(vm, (u_char *) "(?:)",
                                                 sizeof("(?:)") - 1, 0);
             if (nxt_slow_path(pattern == NULL)) {
@@ -138,6 +152,13 @@ njs_vm_create(njs_vm_opt_t *options)
 
             vm->shared->empty_regexp_pattern = pattern;
 
+#if (NXT_JIT)
+            vm->shared->jit_owner = vm;
+            vm->shared->jit_threshold = (options->jit_threshold != 0)
+                                        ? options->jit_threshold
+                                        : NJS_JIT_THRESHOLD;
+#endif
+
             nxt_lvlhsh_init(&vm->modules_hash);
 
             ret = njs_builtin_objects_create(vm);
@@ -197,6 +218,23 @@ njs_vm_create(njs_vm_opt_t *options)
 
 void
 njs_vm_destroy(njs_vm_t *vm)
+{
+    njs_vm_release_events(vm);
+
+#if (NXT_JIT)
+    if (vm->shared != NULL && vm->shared->jit_owner == vm) {
+        njs_jit_free(vm->shared);
+    }
+#endif
+
+    njs_regexp_patterns_free(vm);
+
+    nxt_mem_cache_pool_destroy(vm->mem_cache_pool);
+}
+
+
+static void
+njs_vm_release_events(njs_vm_t *vm)
 {
     njs_event_t        *event;
     nxt_lvlhsh_each_t  lhe;
@@ -214,8 +252,6 @@ njs_vm_destroy(njs_vm_t *vm)
             njs_del_event(vm, event, NJS_EVENT_RELEASE);
         }
     }
-
-    nxt_mem_cache_pool_destroy(vm->mem_cache_pool);
 }
 
 
@@ -299,10 +335,6 @@ fail:
 njs_vm_t *
 njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external)
 {
-    njs_vm_t              *nvm;
-    uint32_t              items;
-    nxt_int_t             ret;
-    nxt_array_t           *externals;
     nxt_mem_cache_pool_t  *nmcp;
 
     nxt_thread_log_debug("CLONE:");
@@ -317,6 +349,63 @@ njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external)
         return NULL;
     }
 
+    return njs_vm_clone_pool(vm, nmcp, external);
+}
+
+
+/*
+ * njs_vm_reset() turns a clone of the VM which is not needed anymore into
+ * a new clone as if it was returned by njs_vm_clone() without an external
+ * object, the object should be set by njs_vm_external_set() on reuse.  The
+ * pending events of the clone are released and its memory pool is rewound
+ * retaining some memory clusters, so a reused clone avoids the memory
+ * allocations and page faults of a new one.  The clone is destroyed on
+ * failure.
+ */
+
+njs_vm_t *
+njs_vm_reset(njs_vm_t *vm, njs_vm_t *clone)
+{
+    nxt_mem_cache_pool_t  *nmcp;
+
+    nxt_thread_log_debug("RESET:");
+
+    nmcp = clone->mem_cache_pool;
+
+    njs_vm_release_events(clone);
+
+    njs_regexp_patterns_free(clone);
+
+    nxt_mem_cache_pool_reset(nmcp,
+                             NJS_VM_RESET_CLUSTERS * 2 * nxt_pagesize());
+
+    return njs_vm_clone_pool(vm, nmcp, NULL);
+}
+
+
+void
+njs_vm_external_set(njs_vm_t *vm, njs_external_ptr_t external)
+{
+    vm->external = external;
+}
+
+
+void
+njs_vm_init_stats(njs_vm_t *vm, njs_vm_init_stats_t *stats)
+{
+    *stats = vm->shared->init_stats;
+}
+
+
+static njs_vm_t *
+njs_vm_clone_pool(njs_vm_t *vm, nxt_mem_cache_pool_t *nmcp,
+    njs_external_ptr_t external)
+{
+    njs_vm_t     *nvm;
+    uint32_t     items;
+    nxt_int_t    ret;
+    nxt_array_t  *externals;
+
     nvm = nxt_mem_cache_zalign(nmcp, sizeof(njs_value_t), sizeof(njs_vm_t));
 
     if (nxt_fast_path(nvm != NULL)) {
@@ -336,7 +425,7 @@ njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external)
                                      &njs_array_mem_proto, nvm->mem_cache_pool);
 
         if (nxt_slow_path(externals == NULL)) {
-            return NULL;
+            goto fail;
         }
 
         if (items > 0) {
@@ -356,6 +445,11 @@ njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external)
         nvm->global_scope = vm->global_scope;
         nvm->scope_size = vm->scope_size;
 
+        nvm->property_cache_slots = vm->property_cache_slots;
+
+        nvm->gc_threshold = vm->gc_threshold;
+        vm->cloned = 1;
+
         nvm->debug = vm->debug;
 
         ret = njs_vm_init(nvm);
@@ -365,6 +459,8 @@ njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external)
 
         nvm->retval = njs_value_void;
 
+        vm->shared->init_stats.clones++;
+
         return nvm;
     }
 
@@ -376,6 +472,224 @@ fail:
 }
 
 
+/*
+ * njs_vm_preinit() runs the global code of a compiled VM once and turns
+ * the resulting global scope into a snapshot which is shared by all VMs
+ * cloned afterwards, so the clones start right at the end of the global
+ * code instead of running it again.  All objects reachable from the global
+ * scope are marked as immutable and any attempt to modify them in a clone
+ * throws TypeError.  If the global scope contains values which cannot be
+ * shared, e.g. closures or dates, NJS_DECLINED is returned and the VM is
+ * left to be cloned in the usual way.
+ */
+
+nxt_int_t
+njs_vm_preinit(njs_vm_t *vm)
+{
+    u_char             *current;
+    nxt_int_t          ret;
+    nxt_uint_t         i, n;
+    njs_value_t        *values;
+    njs_vm_ops_t       *ops;
+    njs_vmcode_stop_t  *stop;
+
+    if (vm->accumulative || vm->top_frame != NULL) {
+        return NJS_ERROR;
+    }
+
+    stop = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_vmcode_stop_t));
+    if (nxt_slow_path(stop == NULL)) {
+        return NJS_ERROR;
+    }
+
+    ret = njs_vm_init(vm);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return NJS_ERROR;
+    }
+
+    current = vm->current;
+
+    /* Timers cannot be set up since there is no host request yet. */
+    ops = vm->ops;
+    vm->ops = NULL;
+
+    ret = njs_vmcode_interpreter(vm);
+
+    vm->ops = ops;
+
+    if (ret != NJS_STOP) {
+        return NJS_ERROR;
+    }
+
+    values = (njs_value_t *) ((u_char *) vm->scopes[NJS_SCOPE_GLOBAL]
+                              + NJS_INDEX_GLOBAL_OFFSET);
+    n = vm->scope_size / sizeof(njs_value_t);
+
+    for (i = 0; i < n; i++) {
+        ret = njs_vm_snapshot_value(vm, &values[i], 0);
+        if (ret != NXT_OK) {
+            goto declined;
+        }
+    }
+
+    ret = njs_vm_snapshot_value(vm, &vm->retval, 0);
+    if (ret != NXT_OK) {
+        goto declined;
+    }
+
+    /* The clones stop at once and return the global code result. */
+
+    stop->code.operation = njs_vmcode_stop;
+    stop->code.operands = NJS_VMCODE_1OPERAND;
+    stop->code.retval = NJS_VMCODE_NO_RETVAL;
+    stop->code.opcode = NJS_VMCODE_GENERIC;
+    stop->code.cache = 0;
+    stop->retval = (njs_index_t) &vm->retval;
+
+    vm->current = (u_char *) stop;
+    vm->global_scope = values;
+
+    return NXT_OK;
+
+declined:
+
+    vm->current = current;
+
+    return ret;
+}
+
+
+static nxt_int_t
+njs_vm_snapshot_value(njs_vm_t *vm, njs_value_t *value, nxt_uint_t level)
+{
+    njs_value_t         *proto;
+    njs_function_t      *function;
+    nxt_lvlhsh_query_t  lhq;
+
+    switch (value->type) {
+
+    case NJS_FUNCTION:
+        function = value->data.u.function;
+
+        /* A shared function is copied by each VM on the first access. */
+
+        if (function->object.shared || function->object.immutable) {
+            return NXT_OK;
+        }
+
+        if (function->closure) {
+            return NXT_DECLINED;
+        }
+
+        if (!function->native) {
+            /*
+             * A lambda function prototype is created on the first access
+             * and must be created in advance to be shared.
+             */
+            lhq.key_hash = NJS_PROTOTYPE_HASH;
+            lhq.key = nxt_string_value("prototype");
+            lhq.proto = &njs_object_hash_proto;
+
+            if (nxt_lvlhsh_find(&function->object.hash, &lhq) != NXT_OK) {
+                proto = njs_function_property_prototype_create(vm, value);
+                if (nxt_slow_path(proto == NULL)) {
+                    return NXT_ERROR;
+                }
+            }
+        }
+
+        break;
+
+    case NJS_STRING:
+        /* A rope would be flattened by each VM in the shared memory. */
+        return njs_string_flat(vm, value);
+
+    case NJS_DATE:
+    case NJS_ARRAY_BUFFER:
+    case NJS_TYPED_ARRAY:
+    case NJS_DATA_VIEW:
+        return NXT_DECLINED;
+
+    case NJS_REGEXP:
+        if (value->data.u.regexp->pattern->global) {
+            /* The lastIndex of a global regexp is changed by exec(). */
+            return NXT_DECLINED;
+        }
+
+        break;
+
+    default:
+        if (!njs_is_object(value)) {
+            return NXT_OK;
+        }
+
+        break;
+    }
+
+    return njs_vm_snapshot_object(vm, value->data.u.object, level);
+}
+
+
+static nxt_int_t
+njs_vm_snapshot_object(njs_vm_t *vm, njs_object_t *object, nxt_uint_t level)
+{
+    uint32_t           i;
+    nxt_int_t          ret;
+    njs_value_t        value;
+    njs_array_t        *array;
+    njs_object_prop_t  *prop;
+    njs_object_each_t  each;
+
+    if (object == NULL || object->shared || object->immutable) {
+        return NXT_OK;
+    }
+
+    if (level == NJS_SNAPSHOT_LEVEL_MAX) {
+        return NXT_DECLINED;
+    }
+
+    level++;
+
+    object->immutable = 1;
+
+    ret = njs_vm_snapshot_object(vm, object->__proto__, level);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    njs_object_each_init(&each);
+
+    for ( ;; ) {
+        prop = njs_object_each(object, &each);
+
+        if (prop == NULL) {
+            break;
+        }
+
+        ret = njs_vm_snapshot_value(vm, &prop->value, level);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+    }
+
+    if (object->type == NJS_ARRAY) {
+        array = (njs_array_t *) object;
+
+        for (i = 0; i < array->length; i++) {
+            ret = njs_vm_snapshot_value(vm,
+                                        njs_array_item_value(&array->start[i],
+                                                             &value),
+                                        level);
+            if (ret != NXT_OK) {
+                return ret;
+            }
+        }
+    }
+
+    return NXT_OK;
+}
+
+
 static nxt_int_t
 njs_vm_init(njs_vm_t *vm)
 {
@@ -383,7 +697,6 @@ njs_vm_init(njs_vm_t *vm)
     u_char       *values;
     nxt_int_t    ret;
     njs_frame_t  *frame;
-    nxt_array_t  *backtrace;
 
     scope_size = vm->scope_size + NJS_INDEX_GLOBAL_OFFSET;
 
@@ -411,11 +724,6 @@ njs_vm_init(njs_vm_t *vm)
     memcpy(values + NJS_INDEX_GLOBAL_OFFSET, vm->global_scope,
            vm->scope_size);
 
-    ret = njs_regexp_init(vm);
-    if (nxt_slow_path(ret != NXT_OK)) {
-        return NXT_ERROR;
-    }
-
     ret = njs_builtin_objects_clone(vm);
     if (nxt_slow_path(ret != NXT_OK)) {
         return NXT_ERROR;
@@ -423,22 +731,20 @@ njs_vm_init(njs_vm_t *vm)
 
     nxt_lvlhsh_init(&vm->events_hash);
     nxt_queue_init(&vm->posted_events);
+    nxt_lvlhsh_init(&vm->overlays_hash);
 
-    if (vm->debug != NULL) {
-        backtrace = nxt_array_create(4, sizeof(njs_backtrace_entry_t),
-                                     &njs_array_mem_proto, vm->mem_cache_pool);
-        if (nxt_slow_path(backtrace == NULL)) {
-            return NXT_ERROR;
-        }
-
-        vm->backtrace = backtrace;
-    }
+    /*
+     * The regex context and the backtrace storage are created on the first
+     * use by njs_regexp_init() and njs_vm_add_backtrace_entry().
+     */
 
     vm->trace.level = NXT_LEVEL_TRACE;
     vm->trace.size = 2048;
     vm->trace.handler = njs_parser_trace_handler;
     vm->trace.data = vm;
 
+    njs_gc_init(vm);
+
     return NXT_OK;
 }
 
@@ -694,7 +1000,7 @@ njs_vm_object_prop(njs_vm_t *vm, njs_value_t *value, const nxt_str_t *key)
     lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
     lhq.proto = &njs_object_hash_proto;
 
-    ret = nxt_lvlhsh_find(&value->data.u.object->hash, &lhq);
+    ret = njs_object_own_find(value->data.u.object, &lhq);
     if (nxt_slow_path(ret != NXT_OK)) {
         return NULL;
     }
@@ -131,10 +131,26 @@ typedef struct {
 } njs_vm_ops_t;
 
 
+/*
+ * gc_threshold enables the garbage collector: the VM is collected when
+ * its memory grows by gc_threshold bytes since the previous collection.
+ * The clones inherit gc_threshold of the VM, njs_vm_gc_threshold_set()
+ * changes it after the VM has been created.  If the collector is enabled,
+ * the VM memory returned to the host, e.g. the njs_vm_retval_to_ext_string()
+ * strings, is valid only until the next njs_vm_run() or njs_vm_call().
+ *
+ * jit_threshold is the number of calls after which a function is compiled
+ * to machine code if njs is configured with --jit, 0 is the default of 100.
+ * It is set by the VM which creates the shared data and is ignored
+ * otherwise.
+ */
+
 typedef struct {
     njs_external_ptr_t              external;
     njs_vm_shared_t                 *shared;
     njs_vm_ops_t                    *ops;
+    size_t                          gc_threshold;
+    nxt_uint_t                      jit_threshold;
 
     uint8_t                         trailer;         /* 1 bit */
     uint8_t                         accumulative;    /* 1 bit */
@@ -142,6 +158,30 @@ typedef struct {
 } njs_vm_opt_t;
 
 
+typedef struct {
+    size_t                          size;
+    size_t                          live;
+    size_t                          freed;
+    nxt_uint_t                      collections;
+    nxt_uint_t                      failures;
+} njs_vm_gc_stats_t;
+
+
+/*
+ * The numbers of VMs cloned from the shared VM and of VMs which have
+ * created the subsystems initialized on the first use.  The counters are
+ * shared by all VMs created with the same njs_vm_opt_t.shared, the VM the
+ * scripts are compiled in is counted as well if it uses a subsystem.
+ */
+
+typedef struct {
+    nxt_uint_t                      clones;
+    nxt_uint_t                      regexp;
+    nxt_uint_t                      backtrace;
+    nxt_uint_t                      events;
+} njs_vm_init_stats_t;
+
+
 #define NJS_OK                      NXT_OK
 #define NJS_ERROR                   NXT_ERROR
 #define NJS_AGAIN                   NXT_AGAIN
@@ -153,7 +193,15 @@ NXT_EXPORT njs_vm_t *njs_vm_create(njs_vm_opt_t *options);
 NXT_EXPORT void njs_vm_destroy(njs_vm_t *vm);
 
 NXT_EXPORT nxt_int_t njs_vm_compile(njs_vm_t *vm, u_char **start, u_char *end);
+NXT_EXPORT nxt_int_t njs_vm_cache_save(njs_vm_t *vm, const nxt_str_t *source,
+    nxt_str_t *image);
+NXT_EXPORT nxt_int_t njs_vm_cache_load(njs_vm_t *vm, const nxt_str_t *source,
+    const nxt_str_t *image);
+NXT_EXPORT nxt_int_t njs_vm_preinit(njs_vm_t *vm);
 NXT_EXPORT njs_vm_t *njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external);
+NXT_EXPORT njs_vm_t *njs_vm_reset(njs_vm_t *vm, njs_vm_t *clone);
+NXT_EXPORT void njs_vm_external_set(njs_vm_t *vm, njs_external_ptr_t external);
+NXT_EXPORT void njs_vm_init_stats(njs_vm_t *vm, njs_vm_init_stats_t *stats);
 NXT_EXPORT nxt_int_t njs_vm_call(njs_vm_t *vm, njs_function_t *function,
     njs_value_t *args, nxt_uint_t nargs);
 
@@ -167,6 +215,10 @@ NXT_EXPORT nxt_int_t njs_vm_post_event(njs_vm_t *vm, njs_vm_event_t vm_event,
 
 NXT_EXPORT nxt_int_t njs_vm_run(njs_vm_t *vm);
 
+NXT_EXPORT nxt_int_t njs_vm_gc(njs_vm_t *vm);
+NXT_EXPORT void njs_vm_gc_threshold_set(njs_vm_t *vm, size_t threshold);
+NXT_EXPORT void njs_vm_gc_stats(njs_vm_t *vm, njs_vm_gc_stats_t *stats);
+
 NXT_EXPORT const njs_extern_t *njs_vm_external_prototype(njs_vm_t *vm,
     njs_external_t *external);
 NXT_EXPORT nxt_int_t njs_vm_external_create(njs_vm_t *vm,
@@ -196,6 +248,10 @@ NXT_EXPORT njs_ret_t njs_vm_retval_to_ext_string(njs_vm_t *vm,
 
 NXT_EXPORT void njs_vm_memory_error(njs_vm_t *vm);
 
+NXT_EXPORT njs_ret_t njs_vm_array_buffer_wrap(njs_vm_t *vm, njs_value_t *value,
+    u_char *start, size_t size);
+NXT_EXPORT void njs_vm_array_buffers_detach(njs_vm_t *vm);
+
 NXT_EXPORT void njs_value_void_set(njs_value_t *value);
 NXT_EXPORT void njs_value_boolean_set(njs_value_t *value, int yn);
 NXT_EXPORT void njs_value_number_set(njs_value_t *value, double num);
@@ -62,16 +62,61 @@ typedef struct {
     njs_value_t             retval;
 
     njs_function_t          *function;
-    uint32_t                index;
-    uint32_t                current;
+
+    /*
+     * The sorted values are referred by the "index" permutation,
+     * the "items" are the original array items of the values.
+     * The undefined values are stored at the end of the "items".
+     */
+    njs_value_t             *values;
+    njs_array_item_t        *items;
+    uint32_t                *index;
+    uint32_t                *tmp;
+
+    /* The run boundaries: runs[0] is 0 and runs[n] is the end of run n. */
+    uint32_t                *runs;
+
+    uint32_t                length;
+    uint32_t                voids;
+    uint32_t                total;
+    uint32_t                nruns;
+
+    uint32_t                lo;
+    uint32_t                mid;
+    uint32_t                hi;
+    uint32_t                left;
+    uint32_t                right;
+    uint32_t                out;
+    uint32_t                read;
+    uint32_t                write;
+
+    uint8_t                 compare;     /* 2 bits */
+    uint8_t                 state;       /* 2 bits */
+    uint8_t                 descending;  /* 1 bit */
+    uint8_t                 kind;
 } njs_array_sort_t;
 
 
+typedef enum {
+    NJS_ARRAY_SORT_FUNCTION = 0,
+    NJS_ARRAY_SORT_STRING,
+    NJS_ARRAY_SORT_NUMBER,
+    NJS_ARRAY_SORT_NUMBER_DESC,
+} njs_array_sort_compare_t;
+
+
+typedef enum {
+    NJS_ARRAY_SORT_RUN = 0,
+    NJS_ARRAY_SORT_PASS,
+    NJS_ARRAY_SORT_CHECK,
+    NJS_ARRAY_SORT_MERGE,
+} njs_array_sort_state_t;
+
+
 static njs_ret_t njs_array_prototype_to_string_continuation(njs_vm_t *vm,
     njs_value_t *args, nxt_uint_t nargs, njs_index_t retval);
 static njs_ret_t njs_array_prototype_join_continuation(njs_vm_t *vm,
     njs_value_t *args, nxt_uint_t nargs, njs_index_t unused);
-static njs_value_t *njs_array_copy(njs_value_t *dst, njs_value_t *src);
 static njs_ret_t njs_array_prototype_for_each_continuation(njs_vm_t *vm,
     njs_value_t *args, nxt_uint_t nargs, njs_index_t unused);
 static njs_ret_t njs_array_prototype_some_continuation(njs_vm_t *vm,
@@ -104,6 +149,13 @@ static uint32_t njs_array_reduce_right_index(njs_array_t *array,
     njs_array_iter_t *iter);
 static njs_ret_t njs_array_prototype_sort_continuation(njs_vm_t *vm,
     njs_value_t *args, nxt_uint_t nargs, njs_index_t unused);
+static njs_array_sort_compare_t njs_array_sort_comparator(
+    njs_function_t *function);
+static nxt_bool_t njs_array_sort_next(njs_array_sort_t *sort, uint32_t *a,
+    uint32_t *b);
+static void njs_array_sort_result(njs_array_sort_t *sort, nxt_bool_t greater);
+static void njs_array_sort_run_end(njs_array_sort_t *sort);
+static double njs_array_sort_number(const njs_value_t *value);
 
 
 nxt_noinline njs_array_t *
@@ -119,8 +171,9 @@ njs_array_alloc(njs_vm_t *vm, uint32_t length, uint32_t spare)
 
     size = length + spare;
 
-    array->data = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
-                                      size * sizeof(njs_value_t));
+    array->data = nxt_mem_cache_align(vm->mem_cache_pool,
+                                      sizeof(njs_array_item_t),
+                                      size * sizeof(njs_array_item_t));
     if (nxt_slow_path(array->data == NULL)) {
         return NULL;
     }
@@ -132,13 +185,41 @@ njs_array_alloc(njs_vm_t *vm, uint32_t length, uint32_t spare)
     array->object.type = NJS_ARRAY;
     array->object.shared = 0;
     array->object.extensible = 1;
+    array->object.immutable = 0;
+    array->object.shape = NULL;
+    array->object.slots = NULL;
     array->size = size;
     array->length = length;
+    array->kind = NJS_ARRAY_PACKED_NUMBER;
 
     return array;
 }
 
 
+#if (NXT_NAN_BOXING)
+
+njs_ret_t
+njs_array_item_box(njs_vm_t *vm, njs_array_item_t *item,
+    const njs_value_t *value)
+{
+    njs_value_t  *copy;
+
+    copy = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
+                               sizeof(njs_value_t));
+    if (nxt_slow_path(copy == NULL)) {
+        njs_memory_error(vm);
+        return NXT_ERROR;
+    }
+
+    *copy = *value;
+    *item = (uintptr_t) copy + 1;
+
+    return NXT_OK;
+}
+
+#endif
+
+
 njs_ret_t
 njs_array_add(njs_vm_t *vm, njs_array_t *array, njs_value_t *value)
 {
@@ -148,7 +229,12 @@ njs_array_add(njs_vm_t *vm, njs_array_t *array, njs_value_t *value)
 
     if (nxt_fast_path(ret == NXT_OK)) {
         /* GC: retain value. */
-        array->start[array->length++] = *value;
+        ret = njs_array_value_set(vm, array, &array->start[array->length],
+                                  value);
+
+        if (nxt_fast_path(ret == NXT_OK)) {
+            array->length++;
+        }
     }
 
     return ret;
@@ -159,13 +245,13 @@ njs_ret_t
 njs_array_string_add(njs_vm_t *vm, njs_array_t *array, u_char *start,
     size_t size, size_t length)
 {
-    njs_ret_t  ret;
+    njs_ret_t    ret;
+    njs_value_t  value;
 
-    ret = njs_array_expand(vm, array, 0, 1);
+    ret = njs_string_create(vm, &value, start, size, length);
 
     if (nxt_fast_path(ret == NXT_OK)) {
-        return njs_string_create(vm, &array->start[array->length++],
-                                 start, size, length);
+        return njs_array_add(vm, array, &value);
     }
 
     return ret;
@@ -176,14 +262,22 @@ njs_ret_t
 njs_array_expand(njs_vm_t *vm, njs_array_t *array, uint32_t prepend,
     uint32_t size)
 {
-    njs_value_t  *start, *old;
+    njs_array_item_t  *start, *old;
 
-    size += array->length;
+    /*
+     * The array size is counted from the data start, the items before
+     * the array start are the space left by shift() or unshift().
+     */
 
-    if (nxt_fast_path(size <= array->size && prepend == 0)) {
+    if (nxt_fast_path(prepend == 0
+                      && &array->start[array->length + size]
+                         <= &array->data[array->size]))
+    {
         return NXT_OK;
     }
 
+    size += array->length;
+
     if (size < 16) {
         size *= 2;
 
@@ -191,19 +285,19 @@ njs_array_expand(njs_vm_t *vm, njs_array_t *array, uint32_t prepend,
         size += size / 2;
     }
 
-    start = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
-                                (prepend + size) * sizeof(njs_value_t));
+    start = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_array_item_t),
+                                (prepend + size) * sizeof(njs_array_item_t));
     if (nxt_slow_path(start == NULL)) {
         return NXT_ERROR;
     }
 
-    array->size = size;
+    array->size = prepend + size;
 
     old = array->data;
     array->data = start;
     start += prepend;
 
-    memcpy(start, array->start, array->length * sizeof(njs_value_t));
+    memcpy(start, array->start, array->length * sizeof(njs_array_item_t));
 
     array->start = start;
 
@@ -217,10 +311,11 @@ njs_ret_t
 njs_array_constructor(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    double       num;
-    uint32_t     size;
-    njs_value_t  *value;
-    njs_array_t  *array;
+    double            num;
+    uint32_t          size;
+    njs_ret_t         ret;
+    njs_array_t       *array;
+    njs_array_item_t  *item;
 
     args = &args[1];
     size = nargs - 1;
@@ -242,19 +337,28 @@ njs_array_constructor(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     if (nxt_fast_path(array != NULL)) {
 
         vm->retval.data.u.array = array;
-        value = array->start;
+        item = array->start;
 
         if (args == NULL) {
+            if (size != 0) {
+                array->kind = NJS_ARRAY_HOLEY;
+            }
+
             while (size != 0) {
-                njs_set_invalid(value);
-                value++;
+                njs_array_item_set_invalid(item);
+                item++;
                 size--;
             }
 
         } else {
             while (size != 0) {
                 njs_retain(args);
-                *value++ = *args++;
+
+                ret = njs_array_value_set(vm, array, item++, args++);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return ret;
+                }
+
                 size--;
             }
         }
@@ -293,6 +397,7 @@ njs_array_of(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
         uint32_t     length, i;
+        njs_ret_t    ret;
         njs_array_t  *array;
 
         length = nargs > 1 ? nargs - 1 : 0;
@@ -307,7 +412,11 @@ njs_array_of(njs_vm_t *vm, njs_value_t *args,
         vm->retval.data.truth = 1;
 
         for (i = 0; i < length; i++) {
-            array->start[i] = args[i + 1];
+            ret = njs_array_value_set(vm, array, &array->start[i],
+                                      &args[i + 1]);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
         }
 
         return NXT_OK;
@@ -365,12 +474,12 @@ static njs_ret_t
 njs_array_prototype_length(njs_vm_t *vm, njs_value_t *value,
     njs_value_t *setval, njs_value_t *retval)
 {
-    double       num;
-    int32_t      size;
-    uint32_t     length;
-    njs_ret_t    ret;
-    njs_value_t  *val;
-    njs_array_t  *array;
+    double            num;
+    int32_t           size;
+    uint32_t          length;
+    njs_ret_t         ret;
+    njs_array_t       *array;
+    njs_array_item_t  *item;
 
     array = value->data.u.array;
 
@@ -392,16 +501,21 @@ njs_array_prototype_length(njs_vm_t *vm, njs_value_t *value,
                 return NJS_ERROR;
             }
 
-            val = &array->start[array->length];
+            array->kind = NJS_ARRAY_HOLEY;
+            item = &array->start[array->length];
 
             do {
-                njs_set_invalid(val);
-                val++;
+                njs_array_item_set_invalid(item);
+                item++;
                 size--;
             } while (size != 0);
         }
 
         array->length = length;
+
+        if (length == 0) {
+            array->kind = NJS_ARRAY_PACKED_NUMBER;
+        }
     }
 
     njs_value_number_set(retval, array->length);
@@ -419,10 +533,9 @@ static njs_ret_t
 njs_array_prototype_slice(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    int32_t      start, end, length;
-    uint32_t     n;
-    njs_array_t  *array;
-    njs_value_t  *value;
+    int32_t           start, end, length;
+    njs_array_t       *array;
+    njs_array_item_t  *item;
 
     start = 0;
     length = 0;
@@ -481,14 +594,11 @@ njs_array_prototype_slice(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     vm->retval.data.truth = 1;
 
     if (length != 0) {
-        value = args[0].data.u.array->start;
-        n = 0;
+        array->kind = args[0].data.u.array->kind;
+        item = args[0].data.u.array->start;
 
-        do {
-            /* GC: retain long string and object in values[start]. */
-            array->start[n++] = value[start++];
-            length--;
-        } while (length != 0);
+        /* GC: retain long string and object in values[start]. */
+        memcpy(array->start, &item[start], length * sizeof(njs_array_item_t));
     }
 
     return NXT_OK;
@@ -506,6 +616,10 @@ njs_array_prototype_push(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     if (njs_is_array(&args[0])) {
         array = args[0].data.u.array;
 
+        if (nxt_slow_path(array->object.immutable)) {
+            return njs_object_immutable_error(vm);
+        }
+
         if (nargs != 0) {
             ret = njs_array_expand(vm, array, 0, nargs);
             if (nxt_slow_path(ret != NXT_OK)) {
@@ -514,7 +628,14 @@ njs_array_prototype_push(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
             for (i = 1; i < nargs; i++) {
                 /* GC: njs_retain(&args[i]); */
-                array->start[array->length++] = args[i];
+                ret = njs_array_value_set(vm, array,
+                                          &array->start[array->length],
+                                          &args[i]);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return ret;
+                }
+
+                array->length++;
             }
         }
 
@@ -529,20 +650,26 @@ static njs_ret_t
 njs_array_prototype_pop(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
+    njs_value_t        value;
     njs_array_t        *array;
-    const njs_value_t  *retval, *value;
+    njs_array_item_t   *item;
+    const njs_value_t  *retval;
 
     retval = &njs_value_void;
 
     if (njs_is_array(&args[0])) {
         array = args[0].data.u.array;
 
+        if (nxt_slow_path(array->object.immutable)) {
+            return njs_object_immutable_error(vm);
+        }
+
         if (array->length != 0) {
             array->length--;
-            value = &array->start[array->length];
+            item = &array->start[array->length];
 
-            if (njs_is_valid(value)) {
-                retval = value;
+            if (njs_array_item_is_valid(item)) {
+                retval = njs_array_item_value(item, &value);
             }
         }
     }
@@ -563,6 +690,11 @@ njs_array_prototype_unshift(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     if (njs_is_array(&args[0])) {
         array = args[0].data.u.array;
+
+        if (nxt_slow_path(array->object.immutable)) {
+            return njs_object_immutable_error(vm);
+        }
+
         n = nargs - 1;
 
         if (n != 0) {
@@ -573,14 +705,19 @@ njs_array_prototype_unshift(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
                 }
             }
 
-            array->length += n;
             n = nargs;
 
             do {
                 n--;
                 /* GC: njs_retain(&args[n]); */
+                ret = njs_array_value_set(vm, array, &array->start[-1],
+                                          &args[n]);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return ret;
+                }
+
                 array->start--;
-                array->start[0] = args[n];
+                array->length++;
             } while (n > 1);
         }
 
@@ -595,22 +732,28 @@ static njs_ret_t
 njs_array_prototype_shift(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
+    njs_value_t        value;
     njs_array_t        *array;
-    const njs_value_t  *retval, *value;
+    njs_array_item_t   *item;
+    const njs_value_t  *retval;
 
     retval = &njs_value_void;
 
     if (njs_is_array(&args[0])) {
         array = args[0].data.u.array;
 
+        if (nxt_slow_path(array->object.immutable)) {
+            return njs_object_immutable_error(vm);
+        }
+
         if (array->length != 0) {
             array->length--;
 
-            value = &array->start[0];
+            item = &array->start[0];
             array->start++;
 
-            if (njs_is_valid(value)) {
-                retval = value;
+            if (njs_array_item_is_valid(item)) {
+                retval = njs_array_item_value(item, &value);
             }
         }
     }
@@ -636,6 +779,11 @@ njs_array_prototype_splice(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     if (njs_is_array(&args[0])) {
         array = args[0].data.u.array;
+
+        if (nxt_slow_path(array->object.immutable)) {
+            return njs_object_immutable_error(vm);
+        }
+
         length = array->length;
 
         if (nargs > 1) {
@@ -675,6 +823,8 @@ njs_array_prototype_splice(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     if (array != NULL && (delete >= 0 || nargs > 3)) {
 
         /* Move deleted items to a new array to return. */
+        deleted->kind = array->kind;
+
         for (i = 0, n = start; i < (nxt_uint_t) delete; i++, n++) {
             /* No retention required. */
             deleted->start[i] = array->start[n];
@@ -701,7 +851,7 @@ njs_array_prototype_splice(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             }
 
             memmove(&array->start[start + items], &array->start[n],
-                    (array->length - n) * sizeof(njs_value_t));
+                    (array->length - n) * sizeof(njs_array_item_t));
 
             array->length += delta;
         }
@@ -711,7 +861,11 @@ njs_array_prototype_splice(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
         for (i = 3; i < nargs; i++) {
             /* GC: njs_retain(&args[i]); */
-            array->start[n++] = args[i];
+            ret = njs_array_value_set(vm, array, &array->start[n++],
+                                      &args[i]);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
         }
     }
 
@@ -727,19 +881,24 @@ static njs_ret_t
 njs_array_prototype_reverse(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    nxt_uint_t   i, n, length;
-    njs_value_t  value;
-    njs_array_t  *array;
+    nxt_uint_t        i, n, length;
+    njs_array_t       *array;
+    njs_array_item_t  item;
 
     if (njs_is_array(&args[0])) {
         array = args[0].data.u.array;
+
+        if (nxt_slow_path(array->object.immutable)) {
+            return njs_object_immutable_error(vm);
+        }
+
         length = array->length;
 
         if (length > 1) {
             for (i = 0, n = length - 1; i < n; i++, n--) {
-                value = array->start[i];
+                item = array->start[i];
                 array->start[i] = array->start[n];
-                array->start[n] = value;
+                array->start[n] = item;
             }
         }
 
@@ -808,7 +967,7 @@ njs_array_prototype_join(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     uint32_t          max;
     nxt_uint_t        i, n;
     njs_array_t       *array;
-    njs_value_t       *value, *values;
+    njs_value_t       val, *value, *values;
     njs_array_join_t  *join;
 
     if (!njs_is_array(&args[0])) {
@@ -827,7 +986,7 @@ njs_array_prototype_join(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     max = 0;
 
     for (i = 0; i < array->length; i++) {
-        value = &array->start[i];
+        value = njs_array_item_value(&array->start[i], &val);
 
         if (!njs_is_string(value)
             && njs_is_valid(value)
@@ -852,7 +1011,7 @@ njs_array_prototype_join(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         n = 0;
 
         for (i = 0; i < array->length; i++) {
-            value = &array->start[i];
+            value = njs_array_item_value(&array->start[i], &val);
 
             if (!njs_is_string(value)
                 && njs_is_valid(value)
@@ -884,9 +1043,10 @@ njs_array_prototype_join_continuation(njs_vm_t *vm, njs_value_t *args,
     u_char             *p;
     size_t             size, length, mask;
     uint32_t           max;
+    njs_ret_t          ret;
     nxt_uint_t         i, n;
     njs_array_t        *array;
-    njs_value_t        *value, *values;
+    njs_value_t        val, *value, *values;
     njs_array_join_t   *join;
     njs_string_prop_t  separator, string;
 
@@ -902,7 +1062,7 @@ njs_array_prototype_join_continuation(njs_vm_t *vm, njs_value_t *args,
     array = args[0].data.u.array;
 
     for (i = 0; i < array->length; i++) {
-        value = &array->start[i];
+        value = njs_array_item_value(&array->start[i], &val);
 
         if (njs_is_valid(value) && !njs_is_null_or_void(value)) {
 
@@ -916,6 +1076,11 @@ njs_array_prototype_join_continuation(njs_vm_t *vm, njs_value_t *args,
                 }
             }
 
+            ret = njs_string_flat(vm, value);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+
             (void) njs_string_prop(&string, value);
 
             size += string.size;
@@ -949,7 +1114,7 @@ njs_array_prototype_join_continuation(njs_vm_t *vm, njs_value_t *args,
     n = 0;
 
     for (i = 0; i < array->length; i++) {
-        value = &array->start[i];
+        value = njs_array_item_value(&array->start[i], &val);
 
         if (njs_is_valid(value) && !njs_is_null_or_void(value)) {
             if (!njs_is_string(value)) {
@@ -982,10 +1147,11 @@ static njs_ret_t
 njs_array_prototype_concat(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    size_t       length;
-    nxt_uint_t   i;
-    njs_value_t  *value;
-    njs_array_t  *array;
+    size_t            length;
+    njs_ret_t         ret;
+    nxt_uint_t        i, n;
+    njs_array_t       *array, *src;
+    njs_array_item_t  *item;
 
     length = 0;
 
@@ -1007,35 +1173,29 @@ njs_array_prototype_concat(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     vm->retval.type = NJS_ARRAY;
     vm->retval.data.truth = 1;
 
-    value = array->start;
+    item = array->start;
 
     for (i = 0; i < nargs; i++) {
-        value = njs_array_copy(value, &args[i]);
-    }
-
-    return NXT_OK;
-}
 
+        if (njs_is_array(&args[i])) {
+            src = args[i].data.u.array;
+            n = src->length;
 
-static njs_value_t *
-njs_array_copy(njs_value_t *dst, njs_value_t *src)
-{
-    nxt_uint_t  n;
+            njs_array_kind_merge(array, src->kind);
 
-    n = 1;
+            /* GC: njs_retain src */
+            memcpy(item, src->start, n * sizeof(njs_array_item_t));
+            item += n;
 
-    if (njs_is_array(src)) {
-        n = src->data.u.array->length;
-        src = src->data.u.array->start;
-    }
-
-    while (n != 0) {
-        /* GC: njs_retain src */
-        *dst++ = *src++;
-        n--;
+        } else {
+            ret = njs_array_value_set(vm, array, item++, &args[i]);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+        }
     }
 
-    return dst;
+    return NXT_OK;
 }
 
 
@@ -1043,9 +1203,12 @@ static njs_ret_t
 njs_array_prototype_index_of(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    nxt_int_t    i, index, length;
-    njs_value_t  *value, *start;
-    njs_array_t  *array;
+    double            num;
+    njs_ret_t         ret;
+    nxt_int_t         i, index, length;
+    njs_value_t       val, *value;
+    njs_array_t       *array;
+    njs_array_item_t  *start;
 
     index = -1;
 
@@ -1081,8 +1244,37 @@ njs_array_prototype_index_of(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     value = &args[1];
     start = array->start;
 
+    if (array->kind == NJS_ARRAY_PACKED_NUMBER) {
+
+        /* Only a number can be strictly equal to a number. */
+
+        if (njs_is_number(value)) {
+            num = value->data.u.number;
+
+            do {
+                if (njs_array_item_number(&start[i]) == num) {
+                    index = i;
+                    break;
+                }
+
+                i++;
+
+            } while (i < length);
+        }
+
+        goto done;
+    }
+
     do {
-        if (njs_values_strict_equal(value, &start[i])) {
+        ret = njs_values_strict_equal(vm, value,
+                                      njs_array_item_value(&start[i], &val));
+
+        if (ret != 0) {
+
+            if (nxt_slow_path(ret < 0)) {
+                return ret;
+            }
+
             index = i;
             break;
         }
@@ -1103,9 +1295,12 @@ static njs_ret_t
 njs_array_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
-    nxt_int_t    i, n, index, length;
-    njs_value_t  *value, *start;
-    njs_array_t  *array;
+    double            num;
+    njs_ret_t         ret;
+    nxt_int_t         i, n, index, length;
+    njs_value_t       val, *value;
+    njs_array_t       *array;
+    njs_array_item_t  *start;
 
     index = -1;
 
@@ -1140,8 +1335,35 @@ njs_array_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
     value = &args[1];
     start = array->start;
 
+    if (array->kind == NJS_ARRAY_PACKED_NUMBER) {
+
+        if (njs_is_number(value)) {
+            num = value->data.u.number;
+
+            do {
+                if (njs_array_item_number(&start[i]) == num) {
+                    index = i;
+                    break;
+                }
+
+                i--;
+
+            } while (i >= 0);
+        }
+
+        goto done;
+    }
+
     do {
-        if (njs_values_strict_equal(value, &start[i])) {
+        ret = njs_values_strict_equal(vm, value,
+                                      njs_array_item_value(&start[i], &val));
+
+        if (ret != 0) {
+
+            if (nxt_slow_path(ret < 0)) {
+                return ret;
+            }
+
             index = i;
             break;
         }
@@ -1162,9 +1384,12 @@ static njs_ret_t
 njs_array_prototype_includes(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
+    double             num;
+    njs_ret_t          ret;
     nxt_int_t          i, length;
-    njs_value_t        *value, *start;
+    njs_value_t        val, *value;
     njs_array_t        *array;
+    njs_array_item_t   *start;
     const njs_value_t  *retval;
 
     retval = &njs_value_false;
@@ -1201,10 +1426,44 @@ njs_array_prototype_includes(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     start = array->start;
     value = &args[1];
 
+    if (array->kind == NJS_ARRAY_PACKED_NUMBER) {
+
+        if (!njs_is_number(value)) {
+            goto done;
+        }
+
+        num = value->data.u.number;
+
+        if (isnan(num)) {
+            do {
+                if (isnan(njs_array_item_number(&start[i]))) {
+                    retval = &njs_value_true;
+                    break;
+                }
+
+                i++;
+
+            } while (i < length);
+
+        } else {
+            do {
+                if (njs_array_item_number(&start[i]) == num) {
+                    retval = &njs_value_true;
+                    break;
+                }
+
+                i++;
+
+            } while (i < length);
+        }
+
+        goto done;
+    }
+
     if (njs_is_number(value) && isnan(value->data.u.number)) {
 
         do {
-            value = &start[i];
+            value = njs_array_item_value(&start[i], &val);
 
             if (njs_is_number(value) && isnan(value->data.u.number)) {
                 retval = &njs_value_true;
@@ -1217,7 +1476,15 @@ njs_array_prototype_includes(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     } else {
         do {
-            if (njs_values_strict_equal(value, &start[i])) {
+            ret = njs_values_strict_equal(vm, value,
+                    njs_array_item_value(&start[i], &val));
+
+            if (ret != 0) {
+
+                if (nxt_slow_path(ret < 0)) {
+                    return ret;
+                }
+
                 retval = &njs_value_true;
                 break;
             }
@@ -1239,8 +1506,10 @@ static njs_ret_t
 njs_array_prototype_fill(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    nxt_int_t    i, start, end, length;
-    njs_array_t  *array;
+    nxt_int_t         i, start, end, length;
+    njs_ret_t         ret;
+    njs_array_t       *array;
+    njs_array_item_t  item;
 
     vm->retval = args[0];
 
@@ -1249,6 +1518,11 @@ njs_array_prototype_fill(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     }
 
     array = args[0].data.u.array;
+
+    if (nxt_slow_path(array->object.immutable)) {
+        return njs_object_immutable_error(vm);
+    }
+
     length = array->length;
 
     if (length == 0) {
@@ -1290,8 +1564,21 @@ njs_array_prototype_fill(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
        }
     }
 
+    ret = njs_array_item_set(vm, &item, &args[1]);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    if (start == 0 && end == length) {
+        /* All holes are filled. */
+        array->kind = njs_array_value_kind(&args[1]);
+
+    } else if (start < end) {
+        njs_array_kind_merge(array, njs_array_value_kind(&args[1]));
+    }
+
     for (i = start; i < end; i++) {
-        array->start[i] = args[1];
+        array->start[i] = item;
     }
 
     return NXT_OK;
@@ -1490,7 +1777,7 @@ njs_array_prototype_filter_continuation(njs_vm_t *vm, njs_value_t *args,
     }
 
     /* GC: filter->value */
-    filter->value = array->start[index];
+    njs_array_item_get(&array->start[index], &filter->value);
 
     return njs_array_iterator_apply(vm, &filter->iter, args, nargs);
 }
@@ -1535,7 +1822,7 @@ njs_array_prototype_find_continuation(njs_vm_t *vm, njs_value_t *args,
 
         if (iter->index < iter->length && iter->index < array->length) {
             /* GC: find->value */
-            find->value = array->start[iter->index];
+            njs_array_item_get(&array->start[iter->index], &find->value);
 
             return njs_array_prototype_find_apply(vm, iter, args, nargs);
         }
@@ -1613,14 +1900,12 @@ njs_array_prototype_find_apply(njs_vm_t *vm, njs_array_iter_t *iter,
     arguments[0] = *value;
 
     n = iter->index;
-    value = &args[0].data.u.array->start[n];
+    njs_array_item_get(&args[0].data.u.array->start[n], &arguments[1]);
 
-    if (!njs_is_valid(value)) {
-        value = &njs_value_void;
+    if (!njs_is_valid(&arguments[1])) {
+        arguments[1] = njs_value_void;
     }
 
-    arguments[1] = *value;
-
     njs_value_number_set(&arguments[2], n);
 
     arguments[3] = args[0];
@@ -1660,12 +1945,18 @@ njs_array_prototype_map_continuation(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
     uint32_t         index;
+    njs_ret_t        ret;
     njs_array_map_t  *map;
 
     map = njs_vm_continuation(vm);
 
     if (njs_is_valid(&map->iter.retval)) {
-        map->array->start[map->iter.index] = map->iter.retval;
+        ret = njs_array_value_set(vm, map->array,
+                                  &map->array->start[map->iter.index],
+                                  &map->iter.retval);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
     }
 
     index = njs_array_prototype_map_index(args[0].data.u.array, map);
@@ -1685,23 +1976,25 @@ njs_array_prototype_map_continuation(njs_vm_t *vm, njs_value_t *args,
 static uint32_t
 njs_array_prototype_map_index(njs_array_t *array, njs_array_map_t *map)
 {
-    uint32_t     i, length;
-    njs_value_t  *start;
+    uint32_t          i, length;
+    njs_array_item_t  *start;
 
     start = map->array->start;
     length = nxt_min(array->length, map->iter.length);
 
     for (i = map->iter.index + 1; i < length; i++) {
-        if (njs_is_valid(&array->start[i])) {
+        if (njs_array_item_is_valid(&array->start[i])) {
             map->iter.index = i;
             return i;
         }
 
-        njs_set_invalid(&start[i]);
+        map->array->kind = NJS_ARRAY_HOLEY;
+        njs_array_item_set_invalid(&start[i]);
     }
 
     while (i < map->iter.length) {
-        njs_set_invalid(&start[i++]);
+        map->array->kind = NJS_ARRAY_HOLEY;
+        njs_array_item_set_invalid(&start[i++]);
     }
 
     return NJS_ARRAY_INVALID_INDEX;
@@ -1737,7 +2030,7 @@ njs_array_prototype_reduce(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             return NXT_ERROR;
         }
 
-        iter->retval = array->start[n];
+        njs_array_item_get(&array->start[n], &iter->retval);
     }
 
     return njs_array_prototype_reduce_continuation(vm, args, nargs, unused);
@@ -1768,7 +2061,7 @@ njs_array_prototype_reduce_continuation(njs_vm_t *vm, njs_value_t *args,
     /* GC: array elt, array */
     arguments[1] = iter->retval;
 
-    arguments[2] = array->start[n];
+    njs_array_item_get(&array->start[n], &arguments[2]);
 
     njs_value_number_set(&arguments[3], n);
 
@@ -1806,12 +2099,26 @@ njs_array_iterator_index(njs_array_t *array, njs_array_iter_t *iter)
     uint32_t  i, length;
 
     length = nxt_min(array->length, iter->length);
+    i = iter->index + 1;
+
+    if (array->kind != NJS_ARRAY_HOLEY) {
+        /* A packed array has no holes to skip. */
+
+        if (i < length) {
+            iter->index = i;
+            return i;
+        }
+
+        return NJS_ARRAY_INVALID_INDEX;
+    }
 
-    for (i = iter->index + 1; i < length; i++) {
-        if (njs_is_valid(&array->start[i])) {
+    while (i < length) {
+        if (njs_array_item_is_valid(&array->start[i])) {
             iter->index = i;
             return i;
         }
+
+        i++;
     }
 
     return NJS_ARRAY_INVALID_INDEX;
@@ -1832,7 +2139,7 @@ njs_array_iterator_apply(njs_vm_t *vm, njs_array_iter_t *iter,
     arguments[0] = *value;
 
     n = iter->index;
-    arguments[1] = args[0].data.u.array->start[n];
+    njs_array_item_get(&args[0].data.u.array->start[n], &arguments[1]);
 
     njs_value_number_set(&arguments[2], n);
 
@@ -1873,7 +2180,7 @@ njs_array_prototype_reduce_right(njs_vm_t *vm, njs_value_t *args,
             return NXT_ERROR;
         }
 
-        iter->retval = array->start[n];
+        njs_array_item_get(&array->start[n], &iter->retval);
     }
 
     return njs_array_prototype_reduce_right_continuation(vm, args, nargs,
@@ -1905,7 +2212,7 @@ njs_array_prototype_reduce_right_continuation(njs_vm_t *vm, njs_value_t *args,
     /* GC: array elt, array */
     arguments[1] = iter->retval;
 
-    arguments[2] = array->start[n];
+    njs_array_item_get(&array->start[n], &arguments[2]);
 
     njs_value_number_set(&arguments[3], n);
 
@@ -1923,9 +2230,19 @@ njs_array_reduce_right_index(njs_array_t *array, njs_array_iter_t *iter)
 
     n = nxt_min(iter->index, array->length) - 1;
 
+    if (array->kind != NJS_ARRAY_HOLEY) {
+        /* A packed array has no holes to skip. */
+
+        if (n != NJS_ARRAY_INVALID_INDEX) {
+            iter->index = n;
+        }
+
+        return n;
+    }
+
     while (n != NJS_ARRAY_INVALID_INDEX) {
 
-        if (njs_is_valid(&array->start[n])) {
+        if (njs_array_item_is_valid(&array->start[n])) {
             iter->index = n;
             break;
         }
@@ -1949,6 +2266,11 @@ njs_array_string_sort(njs_vm_t *vm, njs_value_t *args,
             njs_vm_trap_value(vm, &args[i]);
             return NJS_TRAP_STRING_ARG;
         }
+
+        ret = njs_string_flat(vm, &args[i]);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
     }
 
     ret = njs_string_cmp(&args[1], &args[2]);
@@ -1973,102 +2295,498 @@ static njs_ret_t
 njs_array_prototype_sort(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
-    njs_array_sort_t  *sort;
+    u_char                    *p;
+    size_t                    size;
+    uint32_t                  i, n, length, total;
+    njs_ret_t                 ret;
+    njs_array_t               *array;
+    njs_value_t               val, *value;
+    njs_array_item_t          *item;
+    njs_array_sort_t          *sort;
+    njs_array_sort_compare_t  compare;
+
+    if (!njs_is_array(&args[0]) || args[0].data.u.array->length < 2) {
+        vm->retval = args[0];
+        return NXT_OK;
+    }
 
-    if (njs_is_array(&args[0]) && args[0].data.u.array->length > 1) {
+    array = args[0].data.u.array;
 
-        sort = njs_vm_continuation(vm);
-        sort->u.cont.function = njs_array_prototype_sort_continuation;
-        sort->current = 0;
-        sort->retval = njs_value_zero;
+    if (nxt_slow_path(array->object.immutable)) {
+        return njs_object_immutable_error(vm);
+    }
 
-        if (nargs > 1 && njs_is_function(&args[1])) {
-            sort->function = args[1].data.u.function;
+    sort = njs_vm_continuation(vm);
+    sort->u.cont.function = njs_array_prototype_sort_continuation;
 
-        } else {
-            sort->function = (njs_function_t *) &njs_array_string_sort_function;
+    if (nargs > 1 && njs_is_function(&args[1])) {
+        sort->function = args[1].data.u.function;
+        compare = njs_array_sort_comparator(sort->function);
+
+    } else {
+        sort->function = (njs_function_t *) &njs_array_string_sort_function;
+        compare = NJS_ARRAY_SORT_STRING;
+    }
+
+    total = array->length;
+
+    size = (size_t) total * (sizeof(njs_value_t) + sizeof(njs_array_item_t)
+                             + 3 * sizeof(uint32_t))
+           + sizeof(uint32_t);
+
+    p = nxt_mem_cache_alloc(vm->mem_cache_pool, size);
+    if (nxt_slow_path(p == NULL)) {
+        njs_memory_error(vm);
+        return NXT_ERROR;
+    }
+
+    sort->values = (njs_value_t *) p;
+    p += total * sizeof(njs_value_t);
+
+    sort->items = (njs_array_item_t *) p;
+    p += total * sizeof(njs_array_item_t);
+
+    sort->index = (uint32_t *) p;
+    sort->tmp = sort->index + total;
+    sort->runs = sort->tmp + total;
+
+    /*
+     * The holes and undefined values are not compared,
+     * they are moved to the end of the array.
+     */
+
+    length = 0;
+    n = total;
+    item = array->start;
+
+    for (i = 0; i < total; i++, item++) {
+
+        if (!njs_array_item_is_valid(item)) {
+            continue;
+        }
+
+        value = njs_array_item_value(item, &val);
+
+        if (njs_is_void(value)) {
+            n--;
+            sort->items[n] = *item;
+            continue;
         }
 
-        return njs_array_prototype_sort_continuation(vm, args, nargs, unused);
+        sort->items[length] = *item;
+        sort->values[length] = *value;
+        sort->index[length] = length;
+        length++;
     }
 
-    vm->retval = args[0];
+    switch (compare) {
 
-    return NXT_OK;
+    case NJS_ARRAY_SORT_STRING:
+
+        /*
+         * The primitive values are converted to strings and the ropes
+         * are flattened once, the objects are converted by
+         * njs_array_string_sort() on each comparison.
+         */
+
+        for (i = 0; i < length; i++) {
+            value = &sort->values[i];
+
+            if (njs_is_string(value)) {
+                ret = njs_string_flat(vm, value);
+
+            } else if (njs_is_object(value)) {
+                compare = NJS_ARRAY_SORT_FUNCTION;
+                break;
+
+            } else {
+                ret = njs_primitive_value_to_string(vm, value, value);
+            }
+
+            if (nxt_slow_path(ret != NXT_OK)) {
+                nxt_mem_cache_free(vm->mem_cache_pool, sort->values);
+                return ret;
+            }
+        }
+
+        break;
+
+    case NJS_ARRAY_SORT_NUMBER:
+    case NJS_ARRAY_SORT_NUMBER_DESC:
+
+        for (i = 0; i < length; i++) {
+            if (!njs_is_number(&sort->values[i])) {
+                compare = NJS_ARRAY_SORT_FUNCTION;
+                break;
+            }
+        }
+
+        break;
+
+    default:
+        break;
+    }
+
+    sort->compare = compare;
+    sort->kind = array->kind;
+    sort->state = NJS_ARRAY_SORT_RUN;
+    sort->descending = 0;
+    sort->length = length;
+    sort->total = total;
+    sort->voids = total - n;
+    sort->nruns = 0;
+    sort->runs[0] = 0;
+    sort->lo = 0;
+    sort->hi = 1;
+
+    njs_set_invalid(&sort->retval);
+
+    return njs_array_prototype_sort_continuation(vm, args, nargs, unused);
 }
 
 
+/*
+ * The sort function is a stable natural merge sort: the ascending and
+ * strictly descending runs are found first, the latter are reversed, and
+ * then the adjacent runs are merged until one run remains.  Two merged runs
+ * which are already ordered cost one comparison, so the sorted and reversed
+ * arrays are sorted with n - 1 comparisons.
+ *
+ * The algorithm is driven by njs_array_sort_next() which returns the values
+ * to compare and njs_array_sort_result() which takes the comparison result,
+ * so a comparison function call returns to the continuation which resumes
+ * the algorithm.  The string and numeric comparisons are done inline.
+ */
+
 static njs_ret_t
 njs_array_prototype_sort_continuation(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
-    uint32_t          n;
+    double            num;
+    uint32_t          a, b, i, n, length;
+    nxt_bool_t        greater;
     njs_array_t       *array;
-    njs_value_t       value, *start, arguments[3];
+    njs_value_t       arguments[3], *values;
+    njs_array_item_t  *start, *voids;
     njs_array_sort_t  *sort;
 
+    sort = njs_vm_continuation(vm);
+
+    if (njs_is_valid(&sort->retval)) {
+        /* A comparison function has returned. */
+        njs_array_sort_result(sort, njs_array_sort_number(&sort->retval) > 0);
+        njs_set_invalid(&sort->retval);
+    }
+
+    values = sort->values;
+
+    while (njs_array_sort_next(sort, &a, &b)) {
+
+        switch (sort->compare) {
+
+        case NJS_ARRAY_SORT_STRING:
+            greater = (njs_string_cmp(&values[a], &values[b]) > 0);
+            break;
+
+        case NJS_ARRAY_SORT_NUMBER:
+            num = values[a].data.u.number - values[b].data.u.number;
+            greater = (num > 0);
+            break;
+
+        case NJS_ARRAY_SORT_NUMBER_DESC:
+            num = values[b].data.u.number - values[a].data.u.number;
+            greater = (num > 0);
+            break;
+
+        default:
+            arguments[0] = njs_value_void;
+
+            /* GC: values */
+            arguments[1] = values[a];
+            arguments[2] = values[b];
+
+            return njs_function_apply(vm, sort->function, arguments, 3,
+                                      (njs_index_t) &sort->retval);
+        }
+
+        njs_array_sort_result(sort, greater);
+    }
+
+    /* The comparison function might have changed the array. */
+
     array = args[0].data.u.array;
     start = array->start;
+    n = nxt_min(array->length, sort->total);
 
-    sort = njs_vm_continuation(vm);
+    length = sort->length;
+    voids = &sort->items[sort->total - sort->voids];
 
-    if (njs_is_number(&sort->retval)) {
+    njs_array_kind_merge(array, sort->kind);
 
-        /*
-         * The sort function is implemented with the insertion sort algorithm.
-         * Its worst and average computational complexity is O^2.  This point
-         * should be considered as return point from comparison function so
-         * "goto next" moves control to the appropriate step of the algorithm.
-         * The first iteration also goes there because sort->retval is zero.
-         */
-        if (sort->retval.data.u.number <= 0) {
-            goto next;
+    for (i = 0; i < n; i++) {
+
+        if (i < length) {
+            start[i] = sort->items[sort->index[i]];
+
+        } else if (i < length + sort->voids) {
+            start[i] = voids[i - length];
+
+        } else {
+            njs_array_item_set_invalid(&start[i]);
         }
+    }
 
-        n = sort->index;
+    nxt_mem_cache_free(vm->mem_cache_pool, sort->values);
 
-    swap:
+    vm->retval = args[0];
 
-        value = start[n];
-        start[n] = start[n - 1];
-        n--;
-        start[n] = value;
+    return NXT_OK;
+}
 
-        do {
-            if (n > 0) {
 
-                if (njs_is_valid(&start[n])) {
+/*
+ * The "function(a, b) { return a - b }" and "function(a, b) { return b - a }"
+ * comparison functions are recognized by their code and are evaluated inline
+ * if all the values are numbers.
+ */
 
-                    if (njs_is_valid(&start[n - 1])) {
-                        arguments[0] = njs_value_void;
+static njs_array_sort_compare_t
+njs_array_sort_comparator(njs_function_t *function)
+{
+    njs_index_t            a, b;
+    njs_vmcode_3addr_t     *sub;
+    njs_vmcode_return_t    *ret;
+    njs_function_lambda_t  *lambda;
 
-                        /* GC: array elt, array */
-                        arguments[1] = start[n - 1];
-                        arguments[2] = start[n];
+    if (function->native || function->bound != NULL) {
+        return NJS_ARRAY_SORT_FUNCTION;
+    }
 
-                        sort->index = n;
+    lambda = function->u.lambda;
 
-                        return njs_function_apply(vm, sort->function,
-                                                  arguments, 3,
-                                                  (njs_index_t) &sort->retval);
-                    }
+    if (lambda->nargs < 2
+        || (size_t) (lambda->end - lambda->u.start)
+           != sizeof(njs_vmcode_3addr_t) + sizeof(njs_vmcode_return_t))
+    {
+        return NJS_ARRAY_SORT_FUNCTION;
+    }
 
-                    /* Move invalid values to the end of array. */
-                    goto swap;
-                }
+    sub = (njs_vmcode_3addr_t *) lambda->u.start;
+    ret = (njs_vmcode_return_t *) (sub + 1);
+
+    if (sub->code.operation != njs_vmcode_substraction
+        || ret->code.operation != njs_vmcode_return
+        || ret->retval != sub->dst)
+    {
+        return NJS_ARRAY_SORT_FUNCTION;
+    }
+
+    /* The first two arguments follow "this". */
+
+    a = njs_scope_index(1 * sizeof(njs_value_t), NJS_SCOPE_ARGUMENTS);
+    b = njs_scope_index(2 * sizeof(njs_value_t), NJS_SCOPE_ARGUMENTS);
+
+    if (sub->src1 == a && sub->src2 == b) {
+        return NJS_ARRAY_SORT_NUMBER;
+    }
+
+    if (sub->src1 == b && sub->src2 == a) {
+        return NJS_ARRAY_SORT_NUMBER_DESC;
+    }
+
+    return NJS_ARRAY_SORT_FUNCTION;
+}
+
+
+static nxt_bool_t
+njs_array_sort_next(njs_array_sort_t *sort, uint32_t *a, uint32_t *b)
+{
+    uint32_t  left, *index, *runs;
+
+    index = sort->index;
+    runs = sort->runs;
+
+    for ( ;; ) {
+
+        switch (sort->state) {
+
+        case NJS_ARRAY_SORT_RUN:
+
+            /* The run is [lo, hi), index[hi] is compared with index[hi - 1]. */
+
+            if (sort->hi < sort->length) {
+                *a = index[sort->hi - 1];
+                *b = index[sort->hi];
+                return 1;
+            }
+
+            if (sort->lo < sort->length) {
+                njs_array_sort_run_end(sort);
+                continue;
+            }
+
+            sort->read = 0;
+            sort->write = 0;
+            sort->state = NJS_ARRAY_SORT_PASS;
+
+            /* Fall through. */
+
+        case NJS_ARRAY_SORT_PASS:
+
+            if (sort->read + 2 <= sort->nruns) {
+                sort->lo = runs[sort->read];
+                sort->mid = runs[sort->read + 1];
+                sort->hi = runs[sort->read + 2];
+
+                sort->state = NJS_ARRAY_SORT_CHECK;
+
+                *a = index[sort->mid - 1];
+                *b = index[sort->mid];
+                return 1;
+            }
+
+            if (sort->read < sort->nruns) {
+                /* The odd run is left for the next pass. */
+                runs[++sort->write] = runs[sort->read + 1];
+            }
+
+            sort->nruns = sort->write;
+
+            if (sort->nruns <= 1) {
+                return 0;
+            }
+
+            sort->read = 0;
+            sort->write = 0;
+
+            continue;
+
+        default: /* NJS_ARRAY_SORT_MERGE */
+
+            if (sort->left < sort->mid && sort->right < sort->hi) {
+                *a = index[sort->left];
+                *b = index[sort->right];
+                return 1;
             }
 
-        next:
+            /* The rest of the right run is already in place. */
 
-            sort->current++;
-            n = sort->current;
+            left = sort->mid - sort->left;
 
-        } while (n < array->length);
+            memcpy(&sort->tmp[sort->out], &index[sort->left],
+                   left * sizeof(uint32_t));
+
+            memcpy(&index[sort->lo], &sort->tmp[sort->lo],
+                   (sort->out + left - sort->lo) * sizeof(uint32_t));
+
+            runs[++sort->write] = sort->hi;
+            sort->read += 2;
+            sort->state = NJS_ARRAY_SORT_PASS;
+
+            continue;
+        }
     }
+}
 
-    vm->retval = args[0];
 
-    return NXT_OK;
+static void
+njs_array_sort_result(njs_array_sort_t *sort, nxt_bool_t greater)
+{
+    uint32_t  *index;
+
+    index = sort->index;
+
+    switch (sort->state) {
+
+    case NJS_ARRAY_SORT_RUN:
+
+        if (sort->hi == sort->lo + 1) {
+            sort->descending = greater;
+            sort->hi++;
+
+        } else if (greater == sort->descending) {
+            sort->hi++;
+
+        } else {
+            njs_array_sort_run_end(sort);
+        }
+
+        break;
+
+    case NJS_ARRAY_SORT_CHECK:
+
+        if (!greater) {
+            /* The runs are already ordered. */
+            sort->runs[++sort->write] = sort->hi;
+            sort->read += 2;
+            sort->state = NJS_ARRAY_SORT_PASS;
+            break;
+        }
+
+        sort->left = sort->lo;
+        sort->right = sort->mid;
+        sort->out = sort->lo;
+        sort->state = NJS_ARRAY_SORT_MERGE;
+
+        break;
+
+    default: /* NJS_ARRAY_SORT_MERGE */
+
+        /* The left value goes first if the values are equal. */
+
+        if (greater) {
+            sort->tmp[sort->out++] = index[sort->right++];
+
+        } else {
+            sort->tmp[sort->out++] = index[sort->left++];
+        }
+
+        break;
+    }
+}
+
+
+static void
+njs_array_sort_run_end(njs_array_sort_t *sort)
+{
+    uint32_t  i, j, n;
+
+    if (sort->descending) {
+        /* A strictly descending run is reversed, so the sort is stable. */
+
+        i = sort->lo;
+        j = sort->hi - 1;
+
+        while (i < j) {
+            n = sort->index[i];
+            sort->index[i] = sort->index[j];
+            sort->index[j] = n;
+            i++;
+            j--;
+        }
+    }
+
+    sort->runs[++sort->nruns] = sort->hi;
+    sort->lo = sort->hi;
+    sort->hi = sort->lo + 1;
+    sort->descending = 0;
+}
+
+
+/* The comparison function result is converted to number. */
+
+static double
+njs_array_sort_number(const njs_value_t *value)
+{
+    if (njs_is_numeric(value)) {
+        return value->data.u.number;
+    }
+
+    if (njs_is_string(value)) {
+        return njs_string_to_number(value, 0);
+    }
+
+    return NAN;
 }
 
 
@@ -2247,7 +2965,7 @@ static const njs_object_prop_t  njs_array_prototype_properties[] =
         .type = NJS_METHOD,
         .name = njs_string("sort"),
         .value = njs_native_function(njs_array_prototype_sort,
-                     njs_continuation_size(njs_array_iter_t), 0),
+                     njs_continuation_size(njs_array_sort_t), 0),
     },
 };
 
@@ -15,6 +15,294 @@
 #define NJS_ARRAY_SPARE  8
 
 
+/*
+ * The array kind tells which items the array may have, so the array
+ * methods may use specialized loops:
+ *   NJS_ARRAY_PACKED_NUMBER: numbers only;
+ *   NJS_ARRAY_PACKED:        any values but holes;
+ *   NJS_ARRAY_HOLEY:         any values and holes.
+ * A new array is a packed number array, the kind is changed only
+ * towards the holey one when the items are set.
+ */
+
+typedef enum {
+    NJS_ARRAY_PACKED_NUMBER = 0,
+    NJS_ARRAY_PACKED,
+    NJS_ARRAY_HOLEY,
+} njs_array_kind_t;
+
+
+#define njs_array_value_kind(value)                                           \
+    (njs_is_number(value) ? NJS_ARRAY_PACKED_NUMBER                           \
+                          : (njs_is_valid(value) ? NJS_ARRAY_PACKED           \
+                                                 : NJS_ARRAY_HOLEY))
+
+#define njs_array_kind_merge(array, _kind)                                    \
+    (array)->kind = nxt_max((array)->kind, (_kind))
+
+
+#if (NXT_NAN_BOXING)
+
+/*
+ * The array items are stored as 64-bit NaN-boxed values:
+ *
+ *   a number is the IEEE 754 representation plus 2^49, NaNs are
+ *     canonicalized, so numbers are never less than 2^49;
+ *   an object whose type matches the value type is the pointer to
+ *     the object, the pointer is aligned to 8 and is less than 2^49;
+ *   null, void, boolean and invalid values are
+ *     (type << 4 | truth << 3 | 2);
+ *   a short string up to 5 bytes is
+ *     (bytes << 8 | size << 4 | byte string << 3 | 6);
+ *   any other value is stored in a separate njs_value_t, the item is
+ *     the pointer to the value plus 1.
+ *
+ * The pointers are stored as is, so the conservative garbage collector
+ * sees them.
+ */
+
+#define NJS_ARRAY_BOX_NUMBER         ((uint64_t) 1 << 49)
+#define NJS_ARRAY_BOX_NAN            ((uint64_t) 0x7ff8000000000000)
+#define NJS_ARRAY_BOX_STRING_SIZE    5
+
+#define njs_array_box_immediate(type, truth)                                  \
+    ((uint64_t) (type) << 4 | (uint64_t) (truth) << 3 | 2)
+
+#define NJS_ARRAY_BOX_INVALID                                                 \
+    njs_array_box_immediate(NJS_INVALID, 0)
+
+
+typedef union {
+    double                       number;
+    uint64_t                     box;
+} njs_array_box_number_t;
+
+
+njs_ret_t njs_array_item_box(njs_vm_t *vm, njs_array_item_t *item,
+    const njs_value_t *value);
+
+
+nxt_inline njs_value_t *
+njs_array_item_value(const njs_array_item_t *item, njs_value_t *value)
+{
+    uint64_t                box;
+    nxt_uint_t              i, size;
+    njs_object_t            *object;
+    njs_array_box_number_t  num;
+
+    box = *item;
+
+    if (box >= NJS_ARRAY_BOX_NUMBER) {
+        num.box = box - NJS_ARRAY_BOX_NUMBER;
+
+        value->data.type = NJS_NUMBER;
+        value->data.truth = (num.number == num.number && num.number != 0);
+        value->data.u.number = num.number;
+
+        njs_value_int32_hint(value, num.number);
+
+        return value;
+    }
+
+    switch (box & 7) {
+
+    case 0:
+        object = (njs_object_t *) (uintptr_t) box;
+
+        value->data.type = object->type;
+        value->data.truth = 1;
+        value->data.u.object = object;
+
+        return value;
+
+    case 2:
+        switch ((box >> 4) & 0xf) {
+
+        case NJS_NULL:
+            *value = njs_value_null;
+            break;
+
+        case NJS_VOID:
+            *value = njs_value_void;
+            break;
+
+        case NJS_BOOLEAN:
+            *value = (box & 8) ? njs_value_true : njs_value_false;
+            break;
+
+        default:
+            *value = njs_value_invalid;
+            break;
+        }
+
+        return value;
+
+    case 6:
+        size = (box >> 4) & 0x7;
+
+        *value = njs_string_empty;
+        value->short_string.size = size;
+        value->short_string.length = (box & 8) ? 0 : size;
+
+        for (i = 0; i < size; i++) {
+            box >>= 8;
+            value->short_string.start[i] = (u_char) box;
+        }
+
+        return value;
+
+    default:
+        return (njs_value_t *) (uintptr_t) (box - 1);
+    }
+}
+
+
+nxt_inline void
+njs_array_item_get(const njs_array_item_t *item, njs_value_t *value)
+{
+    njs_value_t  *p;
+
+    p = njs_array_item_value(item, value);
+
+    if (p != value) {
+        *value = *p;
+    }
+}
+
+
+nxt_inline njs_ret_t
+njs_array_item_set(njs_vm_t *vm, njs_array_item_t *item,
+    const njs_value_t *value)
+{
+    uint64_t                box;
+    nxt_uint_t              i, size, length;
+    njs_object_t            *object;
+    njs_array_box_number_t  num;
+
+    switch (value->type) {
+
+    case NJS_NUMBER:
+        num.number = value->data.u.number;
+
+        if (num.number != num.number) {
+            num.box = NJS_ARRAY_BOX_NAN;
+        }
+
+        *item = num.box + NJS_ARRAY_BOX_NUMBER;
+
+        return NXT_OK;
+
+    case NJS_NULL:
+    case NJS_VOID:
+    case NJS_INVALID:
+        *item = njs_array_box_immediate(value->type, 0);
+        return NXT_OK;
+
+    case NJS_BOOLEAN:
+        *item = njs_array_box_immediate(NJS_BOOLEAN, value->data.truth != 0);
+        return NXT_OK;
+
+    case NJS_STRING:
+        size = value->short_string.size;
+        length = value->short_string.length;
+
+        if (size <= NJS_ARRAY_BOX_STRING_SIZE
+            && (length == size || length == 0))
+        {
+            box = 0;
+            i = size;
+
+            while (i != 0) {
+                i--;
+                box = box << 8 | value->short_string.start[i];
+            }
+
+            *item = box << 8 | size << 4 | (length != size) << 3 | 6;
+
+            return NXT_OK;
+        }
+
+        break;
+
+    default:
+        if (njs_is_object(value)) {
+            object = value->data.u.object;
+
+            if (object->type == value->type
+                && ((uintptr_t) object & 7) == 0
+                && (uint64_t) (uintptr_t) object < NJS_ARRAY_BOX_NUMBER)
+            {
+                *item = (uintptr_t) object;
+                return NXT_OK;
+            }
+        }
+
+        break;
+    }
+
+    return njs_array_item_box(vm, item, value);
+}
+
+
+#define njs_array_item_is_valid(item)                                         \
+    (*(item) != NJS_ARRAY_BOX_INVALID)
+
+
+/* The number of a packed number array item. */
+
+nxt_inline double
+njs_array_item_number(const njs_array_item_t *item)
+{
+    njs_array_box_number_t  num;
+
+    num.box = *item - NJS_ARRAY_BOX_NUMBER;
+
+    return num.number;
+}
+
+#define njs_array_item_set_invalid(item)                                      \
+    *(item) = NJS_ARRAY_BOX_INVALID
+
+#else
+
+/*
+ * njs_array_item_value() returns a pointer to the item value which must not
+ * be modified, the "value" may be used as a storage for the value.
+ */
+
+#define njs_array_item_value(item, value)                                     \
+    ((void) (value), (item))
+
+#define njs_array_item_get(item, value)                                       \
+    *(value) = *(item)
+
+#define njs_array_item_set(vm, item, value)                                   \
+    (*(item) = *(value), NXT_OK)
+
+#define njs_array_item_is_valid(item)                                         \
+    njs_is_valid(item)
+
+#define njs_array_item_set_invalid(item)                                      \
+    njs_set_invalid(item)
+
+#define njs_array_item_number(item)                                           \
+    (item)->data.u.number
+
+#endif
+
+
+/* Sets an array item and updates the array kind. */
+
+nxt_inline njs_ret_t
+njs_array_value_set(njs_vm_t *vm, njs_array_t *array, njs_array_item_t *item,
+    const njs_value_t *value)
+{
+    njs_array_kind_merge(array, njs_array_value_kind(value));
+
+    return njs_array_item_set(vm, item, value);
+}
+
+
 njs_array_t *njs_array_alloc(njs_vm_t *vm, uint32_t length, uint32_t spare);
 njs_ret_t njs_array_add(njs_vm_t *vm, njs_array_t *array, njs_value_t *value);
 njs_ret_t njs_array_string_add(njs_vm_t *vm, njs_array_t *array, u_char *start,
@@ -13,6 +13,7 @@
 #include <njs_module.h>
 #include <njs_fs.h>
 #include <njs_crypto.h>
+#include <njs_typed_array.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -56,6 +57,12 @@ const njs_object_init_t  *njs_prototype_init[] = {
     &njs_date_prototype_init,
     &njs_hash_prototype_init,
     &njs_hmac_prototype_init,
+    &njs_array_buffer_prototype_init,
+    &njs_data_view_prototype_init,
+    &njs_uint8_array_prototype_init,
+    &njs_uint16_array_prototype_init,
+    &njs_uint32_array_prototype_init,
+    &njs_float64_array_prototype_init,
     &njs_error_prototype_init,
     &njs_eval_error_prototype_init,
     &njs_internal_error_prototype_init,
@@ -78,6 +85,12 @@ const njs_object_init_t    *njs_constructor_init[] = {
     &njs_date_constructor_init,
     &njs_hash_constructor_init,
     &njs_hmac_constructor_init,
+    &njs_array_buffer_constructor_init,
+    &njs_data_view_constructor_init,
+    &njs_uint8_array_constructor_init,
+    &njs_uint16_array_constructor_init,
+    &njs_uint32_array_constructor_init,
+    &njs_float64_array_constructor_init,
     &njs_error_constructor_init,
     &njs_eval_error_constructor_init,
     &njs_internal_error_constructor_init,
@@ -185,6 +198,13 @@ njs_builtin_objects_create(njs_vm_t *vm)
         { .object_value = { .value = njs_value(NJS_DATA, 0, 0.0),
                             .object = { .type = NJS_OBJECT } } },
 
+        { .object =       { .type = NJS_OBJECT } },
+        { .object =       { .type = NJS_OBJECT } },
+        { .object =       { .type = NJS_OBJECT } },
+        { .object =       { .type = NJS_OBJECT } },
+        { .object =       { .type = NJS_OBJECT } },
+        { .object =       { .type = NJS_OBJECT } },
+
         { .object =       { .type = NJS_OBJECT_ERROR } },
         { .object =       { .type = NJS_OBJECT_EVAL_ERROR } },
         { .object =       { .type = NJS_OBJECT_INTERNAL_ERROR } },
@@ -210,6 +230,18 @@ njs_builtin_objects_create(njs_vm_t *vm)
         { njs_hash_constructor,       { NJS_SKIP_ARG, NJS_STRING_ARG } },
         { njs_hmac_constructor,       { NJS_SKIP_ARG, NJS_STRING_ARG,
                                         NJS_STRING_ARG } },
+        { njs_array_buffer_constructor,
+          { NJS_SKIP_ARG, NJS_NUMBER_ARG } },
+        { njs_data_view_constructor,
+          { NJS_SKIP_ARG, NJS_SKIP_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG } },
+        { njs_uint8_array_constructor,
+          { NJS_SKIP_ARG, NJS_SKIP_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG } },
+        { njs_uint16_array_constructor,
+          { NJS_SKIP_ARG, NJS_SKIP_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG } },
+        { njs_uint32_array_constructor,
+          { NJS_SKIP_ARG, NJS_SKIP_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG } },
+        { njs_float64_array_constructor,
+          { NJS_SKIP_ARG, NJS_SKIP_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG } },
         { njs_error_constructor,      { NJS_SKIP_ARG, NJS_STRING_ARG } },
         { njs_eval_error_constructor, { NJS_SKIP_ARG, NJS_STRING_ARG } },
         { njs_internal_error_constructor,
@@ -761,7 +793,7 @@ njs_vm_expression_completions(njs_vm_t *vm, nxt_str_t *expression)
         lhq.key.length = p - lhq.key.start;
         lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
 
-        ret = nxt_lvlhsh_find(&value->data.u.object->hash, &lhq);
+        ret = njs_object_own_find(value->data.u.object, &lhq);
         if (nxt_slow_path(ret != NXT_OK)) {
             return NULL;
         }
@@ -788,16 +820,17 @@ njs_object_completions(njs_vm_t *vm, njs_object_t *object)
     nxt_array_t        *completions;
     njs_object_t       *o;
     njs_object_prop_t  *prop;
+    njs_object_each_t  each;
     nxt_lvlhsh_each_t  lhe;
 
     size = 0;
     o = object;
 
     do {
-        nxt_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
+        njs_object_each_init(&each);
 
         for ( ;; ) {
-            prop = nxt_lvlhsh_each(&o->hash, &lhe);
+            prop = njs_object_each(o, &each);
             if (prop == NULL) {
                 break;
             }
@@ -832,10 +865,10 @@ njs_object_completions(njs_vm_t *vm, njs_object_t *object)
     compl = completions->start;
 
     do {
-        nxt_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
+        njs_object_each_init(&each);
 
         for ( ;; ) {
-            prop = nxt_lvlhsh_each(&o->hash, &lhe);
+            prop = njs_object_each(o, &each);
             if (prop == NULL) {
                 break;
             }
@@ -0,0 +1,1706 @@
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <njs_core.h>
+#include <njs_regexp.h>
+#include <njs_regexp_pattern.h>
+#include <string.h>
+
+
+/*
+ * The code cache stores the bytecode of a compiled VM as an image which
+ * does not depend on the VM memory addresses, so it can be saved on disk
+ * and loaded by another process instead of compiling the same script.
+ * The pointers embedded in the bytecode are replaced with numbers:
+ * operations are numbered by the njs_cache_operations[] table, absolute
+ * scope operands by the constant values table, FUNCTION operands by the
+ * lambdas table and REGEXP operands by the patterns table.  The regexp
+ * patterns are stored as sources and are compiled again on load.
+ *
+ * The image is valid only for the same script and the same njs build.
+ * njs_vm_cache_load() returns NJS_DECLINED for a stale or damaged image
+ * and njs_vm_cache_save() returns NJS_DECLINED if the code refers to
+ * a value which cannot be stored, e.g. an external value.  The script
+ * should be compiled as usual in both cases.
+ */
+
+#define NJS_CACHE_VERSION  1
+
+
+typedef struct {
+    u_char                       magic[4];
+    uint32_t                     fingerprint;
+    uint32_t                     source_hash;
+    uint32_t                     source_size;
+    uint32_t                     values;
+    uint32_t                     patterns;
+    uint32_t                     lambdas;
+    uint32_t                     property_cache_slots;
+} njs_cache_header_t;
+
+
+/*
+ * The operands string describes the operation fields which follow
+ * njs_vmcode_t: "i" is an index, "l" is a lambda, "r" is a regexp
+ * pattern, and "-" is an offset or a number which is stored as is.
+ */
+
+typedef struct {
+    njs_vmcode_operation_t       operation;
+    size_t                       size;
+    const char                   *operands;
+} njs_cache_operation_t;
+
+
+typedef struct {
+    u_char                       *start;
+    size_t                       size;
+    size_t                       capacity;
+} njs_cache_buf_t;
+
+
+typedef struct {
+    const void                   *object;
+    uint32_t                     id;
+} njs_cache_ref_t;
+
+
+typedef struct {
+    nxt_lvlhsh_t                 hash;
+    njs_cache_buf_t              items;  /* of const void * */
+    uint32_t                     count;
+} njs_cache_table_t;
+
+
+typedef struct {
+    njs_vm_t                     *vm;
+    njs_cache_buf_t              body;
+    njs_cache_table_t            values;
+    njs_cache_table_t            patterns;
+    njs_cache_table_t            lambdas;
+} njs_cache_save_t;
+
+
+typedef struct {
+    njs_vm_t                     *vm;
+    const u_char                 *pos;
+    const u_char                 *end;
+    njs_cache_header_t           header;
+    njs_value_t                  **values;
+    njs_regexp_pattern_t         **patterns;
+    njs_function_lambda_t        *lambdas;
+    njs_function_t               **functions;
+    nxt_lvlhsh_t                 variables;
+} njs_cache_load_t;
+
+
+#define NJS_CACHE_VALUE            0
+#define NJS_CACHE_FUNCTION         1
+#define NJS_CACHE_BUILTIN_OBJECT   2
+#define NJS_CACHE_BUILTIN_FUNCTION 3
+
+
+static uint32_t njs_cache_fingerprint(void);
+static const njs_cache_operation_t *njs_cache_operation(
+    njs_vmcode_operation_t operation, uintptr_t *n);
+static njs_vm_code_t *njs_cache_code(njs_vm_t *vm, u_char *start);
+static nxt_int_t njs_cache_save_code(njs_cache_save_t *save, u_char *start);
+static nxt_int_t njs_cache_save_scope(njs_cache_save_t *save,
+    njs_value_t *values, size_t size);
+static nxt_int_t njs_cache_save_scope_value(njs_cache_save_t *save,
+    njs_value_t *value);
+static nxt_int_t njs_cache_save_variables(njs_cache_save_t *save);
+static nxt_int_t njs_cache_save_debug(njs_cache_save_t *save);
+static nxt_int_t njs_cache_save_lambda(njs_cache_save_t *save,
+    njs_function_lambda_t *lambda);
+static nxt_int_t njs_cache_save_value(njs_cache_save_t *save,
+    njs_cache_buf_t *buf, njs_value_t *value);
+static nxt_int_t njs_cache_save_pattern(njs_cache_save_t *save,
+    njs_cache_buf_t *buf, njs_regexp_pattern_t *pattern);
+static nxt_int_t njs_cache_ref(njs_cache_save_t *save,
+    njs_cache_table_t *table, const void *object, uint32_t *id);
+static nxt_int_t njs_cache_ref_test(nxt_lvlhsh_query_t *lhq, void *data);
+static nxt_int_t njs_cache_write(njs_vm_t *vm, njs_cache_buf_t *buf,
+    const void *data, size_t size);
+static nxt_int_t njs_cache_write_uint32(njs_vm_t *vm, njs_cache_buf_t *buf,
+    uint32_t n);
+
+static nxt_int_t njs_cache_load(njs_cache_load_t *load);
+static nxt_int_t njs_cache_load_code(njs_cache_load_t *load, u_char **start,
+    u_char **last);
+static nxt_int_t njs_cache_load_scope(njs_cache_load_t *load,
+    njs_value_t **values, size_t *size);
+static nxt_int_t njs_cache_load_scope_value(njs_cache_load_t *load,
+    njs_value_t *value);
+static nxt_int_t njs_cache_load_variables(njs_cache_load_t *load);
+static nxt_int_t njs_cache_load_debug(njs_cache_load_t *load);
+static nxt_int_t njs_cache_load_lambda(njs_cache_load_t *load,
+    njs_function_lambda_t *lambda);
+static nxt_int_t njs_cache_load_value(njs_cache_load_t *load,
+    njs_value_t **value);
+static nxt_int_t njs_cache_load_pattern(njs_cache_load_t *load,
+    njs_regexp_pattern_t **pattern);
+static nxt_int_t njs_cache_load_string(njs_cache_load_t *load,
+    nxt_str_t *str);
+static const u_char *njs_cache_read(njs_cache_load_t *load, size_t size);
+static nxt_int_t njs_cache_read_uint32(njs_cache_load_t *load, uint32_t *n);
+
+
+static const u_char  njs_cache_magic[4] = { 'N', 'J', 'S', 'C' };
+
+
+static const njs_cache_operation_t  njs_cache_operations[] = {
+
+    { njs_vmcode_object, sizeof(njs_vmcode_object_t), "i" },
+    { njs_vmcode_array, sizeof(njs_vmcode_array_t), "i-" },
+    { njs_vmcode_function, sizeof(njs_vmcode_function_t), "il" },
+    { njs_vmcode_regexp, sizeof(njs_vmcode_regexp_t), "ir" },
+    { njs_vmcode_object_copy, sizeof(njs_vmcode_object_copy_t), "ii" },
+
+    { njs_vmcode_property_get, sizeof(njs_vmcode_prop_get_t), "iii" },
+    { njs_vmcode_property_set, sizeof(njs_vmcode_prop_set_t), "iii" },
+    { njs_vmcode_property_in, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_property_delete, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_property_foreach, sizeof(njs_vmcode_prop_foreach_t), "ii-" },
+    { njs_vmcode_property_next, sizeof(njs_vmcode_prop_next_t), "iii-" },
+    { njs_vmcode_instance_of, sizeof(njs_vmcode_instance_of_t), "iii" },
+
+    { njs_vmcode_increment, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_decrement, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_post_increment, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_post_decrement, sizeof(njs_vmcode_3addr_t), "iii" },
+
+    { njs_vmcode_typeof, sizeof(njs_vmcode_2addr_t), "ii" },
+    { njs_vmcode_void, sizeof(njs_vmcode_2addr_t), "ii" },
+    { njs_vmcode_delete, sizeof(njs_vmcode_2addr_t), "ii" },
+    { njs_vmcode_unary_plus, sizeof(njs_vmcode_2addr_t), "ii" },
+    { njs_vmcode_unary_negation, sizeof(njs_vmcode_2addr_t), "ii" },
+    { njs_vmcode_logical_not, sizeof(njs_vmcode_2addr_t), "ii" },
+    { njs_vmcode_bitwise_not, sizeof(njs_vmcode_2addr_t), "ii" },
+
+    { njs_vmcode_addition, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_substraction, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_multiplication, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_exponentiation, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_division, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_remainder, sizeof(njs_vmcode_3addr_t), "iii" },
+
+    { njs_vmcode_bitwise_and, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_bitwise_xor, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_bitwise_or, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_left_shift, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_right_shift, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_unsigned_right_shift, sizeof(njs_vmcode_3addr_t), "iii" },
+
+    { njs_vmcode_equal, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_not_equal, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_less, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_less_or_equal, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_greater, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_greater_or_equal, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_strict_equal, sizeof(njs_vmcode_3addr_t), "iii" },
+    { njs_vmcode_strict_not_equal, sizeof(njs_vmcode_3addr_t), "iii" },
+
+    { njs_vmcode_test_if_true, sizeof(njs_vmcode_test_jump_t), "ii-" },
+    { njs_vmcode_test_if_false, sizeof(njs_vmcode_test_jump_t), "ii-" },
+
+    { njs_vmcode_move, sizeof(njs_vmcode_move_t), "ii" },
+    { njs_vmcode_jump, sizeof(njs_vmcode_jump_t), "-" },
+    { njs_vmcode_if_true_jump, sizeof(njs_vmcode_cond_jump_t), "-i" },
+    { njs_vmcode_if_false_jump, sizeof(njs_vmcode_cond_jump_t), "-i" },
+    { njs_vmcode_if_equal_jump, sizeof(njs_vmcode_equal_jump_t), "-ii" },
+
+    { njs_vmcode_function_frame, sizeof(njs_vmcode_function_frame_t), "-i" },
+    { njs_vmcode_method_frame, sizeof(njs_vmcode_method_frame_t), "-ii" },
+    { njs_vmcode_function_call, sizeof(njs_vmcode_function_call_t), "i" },
+    { njs_vmcode_return, sizeof(njs_vmcode_return_t), "i" },
+    { njs_vmcode_stop, sizeof(njs_vmcode_stop_t), "i" },
+
+    { njs_vmcode_try_start, sizeof(njs_vmcode_try_start_t), "-i" },
+    { njs_vmcode_try_end, sizeof(njs_vmcode_try_end_t), "-" },
+    { njs_vmcode_throw, sizeof(njs_vmcode_throw_t), "i" },
+    { njs_vmcode_catch, sizeof(njs_vmcode_catch_t), "-i" },
+    { njs_vmcode_finally, sizeof(njs_vmcode_finally_t), "i" },
+};
+
+
+static const nxt_lvlhsh_proto_t  njs_cache_ref_proto
+    nxt_aligned(64) =
+{
+    NXT_LVLHSH_DEFAULT,
+    0,
+    njs_cache_ref_test,
+    njs_lvlhsh_alloc,
+    njs_lvlhsh_free,
+};
+
+
+nxt_int_t
+njs_vm_cache_save(njs_vm_t *vm, const nxt_str_t *source, nxt_str_t *image)
+{
+    uint32_t               i;
+    nxt_int_t              ret;
+    njs_value_t            **values;
+    njs_cache_buf_t        buf;
+    njs_cache_save_t       save;
+    njs_cache_header_t     header;
+    njs_regexp_pattern_t   **patterns;
+    njs_function_lambda_t  **lambdas;
+
+    if (vm->accumulative
+        || vm->parser == NULL
+        || vm->current != vm->parser->code_start
+        || vm->global_scope != vm->parser->local_scope)
+    {
+        return NJS_DECLINED;
+    }
+
+    memset(&save, 0, sizeof(njs_cache_save_t));
+    save.vm = vm;
+
+    ret = njs_cache_save_code(&save, vm->current);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    ret = njs_cache_save_scope(&save, vm->global_scope, vm->scope_size);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    ret = njs_cache_save_variables(&save);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    ret = njs_cache_save_debug(&save);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    /* The lambdas table grows while the lambdas code is stored. */
+
+    for (i = 0; i < save.lambdas.count; i++) {
+        lambdas = (njs_function_lambda_t **) save.lambdas.items.start;
+
+        ret = njs_cache_save_lambda(&save, lambdas[i]);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+    }
+
+    memset(&buf, 0, sizeof(njs_cache_buf_t));
+
+    memcpy(header.magic, njs_cache_magic, sizeof(njs_cache_magic));
+    header.fingerprint = njs_cache_fingerprint();
+    header.source_hash = nxt_djb_hash(source->start, source->length);
+    header.source_size = source->length;
+    header.values = save.values.count;
+    header.patterns = save.patterns.count;
+    header.lambdas = save.lambdas.count;
+    header.property_cache_slots = vm->property_cache_slots;
+
+    ret = njs_cache_write(vm, &buf, &header, sizeof(njs_cache_header_t));
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    values = (njs_value_t **) save.values.items.start;
+
+    for (i = 0; i < save.values.count; i++) {
+        ret = njs_cache_save_value(&save, &buf, values[i]);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+    }
+
+    patterns = (njs_regexp_pattern_t **) save.patterns.items.start;
+
+    for (i = 0; i < save.patterns.count; i++) {
+        ret = njs_cache_save_pattern(&save, &buf, patterns[i]);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+    }
+
+    ret = njs_cache_write(vm, &buf, save.body.start, save.body.size);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    image->start = buf.start;
+    image->length = buf.size;
+
+    return NXT_OK;
+}
+
+
+static uint32_t
+njs_cache_fingerprint(void)
+{
+    uint32_t  build[6];
+
+    build[0] = NJS_CACHE_VERSION;
+    build[1] = nxt_djb_hash(NJS_VERSION, sizeof(NJS_VERSION) - 1);
+    build[2] = sizeof(njs_value_t);
+    build[3] = sizeof(njs_vmcode_t);
+    build[4] = sizeof(njs_function_lambda_t);
+    build[5] = nxt_nitems(njs_cache_operations);
+
+    return nxt_djb_hash(build, sizeof(build));
+}
+
+
+static const njs_cache_operation_t *
+njs_cache_operation(njs_vmcode_operation_t operation, uintptr_t *n)
+{
+    uintptr_t  i;
+
+    for (i = 0; i < nxt_nitems(njs_cache_operations); i++) {
+        if (njs_cache_operations[i].operation == operation) {
+            *n = i;
+            return &njs_cache_operations[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+static njs_vm_code_t *
+njs_cache_code(njs_vm_t *vm, u_char *start)
+{
+    nxt_uint_t     n;
+    njs_vm_code_t  *code;
+
+    if (vm->code == NULL) {
+        return NULL;
+    }
+
+    code = vm->code->start;
+
+    for (n = vm->code->items; n != 0; n--) {
+        if (code->start == start) {
+            return code;
+        }
+
+        code++;
+    }
+
+    return NULL;
+}
+
+
+static nxt_int_t
+njs_cache_save_code(njs_cache_save_t *save, u_char *start)
+{
+    u_char                       *p, *code, *end;
+    size_t                       size;
+    uint32_t                     id;
+    nxt_int_t                    ret;
+    uintptr_t                    n, *operand;
+    const char                   *kind;
+    njs_vm_code_t                *vm_code;
+    njs_vmcode_t                 *vmcode;
+    const njs_cache_operation_t  *op;
+
+    vm_code = njs_cache_code(save->vm, start);
+    if (vm_code == NULL) {
+        return NXT_DECLINED;
+    }
+
+    size = vm_code->end - vm_code->start;
+
+    /* The code is converted in an aligned copy. */
+
+    code = nxt_mem_cache_alloc(save->vm->mem_cache_pool, size);
+    if (nxt_slow_path(code == NULL)) {
+        return NXT_ERROR;
+    }
+
+    memcpy(code, start, size);
+
+    p = code;
+    end = code + size;
+
+    ret = NXT_OK;
+
+    while (p < end) {
+        vmcode = (njs_vmcode_t *) p;
+
+        op = njs_cache_operation(vmcode->operation, &n);
+
+        if (op == NULL || (size_t) (end - p) < op->size) {
+            ret = NXT_DECLINED;
+            goto done;
+        }
+
+        vmcode->operation = (njs_vmcode_operation_t) n;
+        vmcode->opcode = 0;
+
+        operand = (uintptr_t *) (p + sizeof(njs_vmcode_t));
+
+        for (kind = op->operands; *kind != '\0'; kind++, operand++) {
+
+            switch (*kind) {
+
+            case 'i':
+                if (*operand == NJS_INDEX_NONE
+                    || njs_scope_type(*operand) != NJS_SCOPE_ABSOLUTE)
+                {
+                    continue;
+                }
+
+                ret = njs_cache_ref(save, &save->values, (void *) *operand,
+                                    &id);
+                break;
+
+            case 'l':
+                ret = njs_cache_ref(save, &save->lambdas, (void *) *operand,
+                                    &id);
+                break;
+
+            case 'r':
+                ret = njs_cache_ref(save, &save->patterns, (void *) *operand,
+                                    &id);
+                break;
+
+            default:
+                continue;
+            }
+
+            if (nxt_slow_path(ret != NXT_OK)) {
+                goto done;
+            }
+
+            /* An absolute scope index remains absolute and not NONE. */
+            *operand = njs_scope_index(id + 1, NJS_SCOPE_ABSOLUTE);
+        }
+
+        p += op->size;
+    }
+
+    ret = njs_cache_write_uint32(save->vm, &save->body, size);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        goto done;
+    }
+
+    ret = njs_cache_write(save->vm, &save->body, code, size);
+
+done:
+
+    nxt_mem_cache_free(save->vm->mem_cache_pool, code);
+
+    return ret;
+}
+
+
+static nxt_int_t
+njs_cache_save_scope(njs_cache_save_t *save, njs_value_t *values, size_t size)
+{
+    nxt_int_t   ret;
+    nxt_uint_t  n;
+
+    ret = njs_cache_write_uint32(save->vm, &save->body, size);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    for (n = size / sizeof(njs_value_t); n != 0; n--) {
+        ret = njs_cache_save_scope_value(save, values++);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+    }
+
+    return NXT_OK;
+}
+
+
+/*
+ * The initial values of scopes are primitive values, functions declared
+ * in the scope, or the built-in objects and functions referred to by name.
+ * The declared functions have not been used yet, so they are stored as
+ * lambdas, and the built-in ones are stored as indexes in njs_vm_shared_t.
+ */
+
+static nxt_int_t
+njs_cache_save_scope_value(njs_cache_save_t *save, njs_value_t *value)
+{
+    uint32_t         id, type;
+    nxt_int_t        ret;
+    njs_object_t     *object;
+    njs_function_t   *function;
+    njs_vm_shared_t  *shared;
+
+    shared = save->vm->shared;
+
+    if (njs_is_object(value)) {
+        object = value->data.u.object;
+        function = value->data.u.function;
+
+        if (value->type == NJS_OBJECT
+            && object >= &shared->objects[0]
+            && object < &shared->objects[NJS_OBJECT_MAX])
+        {
+            type = NJS_CACHE_BUILTIN_OBJECT;
+            id = object - &shared->objects[0];
+            goto builtin;
+        }
+
+        if (value->type == NJS_FUNCTION
+            && function >= &shared->functions[0]
+            && function < &shared->functions[NJS_FUNCTION_MAX])
+        {
+            type = NJS_CACHE_BUILTIN_FUNCTION;
+            id = function - &shared->functions[0];
+            goto builtin;
+        }
+    }
+
+    if (njs_is_function(value)) {
+
+        if (function->native
+            || function->closure
+            || !nxt_lvlhsh_is_empty(&function->object.hash))
+        {
+            return NXT_DECLINED;
+        }
+
+        ret = njs_cache_ref(save, &save->lambdas, function->u.lambda, &id);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        ret = njs_cache_write_uint32(save->vm, &save->body,
+                                     NJS_CACHE_FUNCTION);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        return njs_cache_write_uint32(save->vm, &save->body, id);
+    }
+
+    if (!njs_is_primitive(value) && njs_is_valid(value)) {
+        return NXT_DECLINED;
+    }
+
+    if (njs_is_string(value)
+        && value->short_string.size == NJS_STRING_LONG)
+    {
+        return NXT_DECLINED;
+    }
+
+    ret = njs_cache_write_uint32(save->vm, &save->body, NJS_CACHE_VALUE);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    return njs_cache_write(save->vm, &save->body, value, sizeof(njs_value_t));
+
+builtin:
+
+    ret = njs_cache_write_uint32(save->vm, &save->body, type);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    return njs_cache_write_uint32(save->vm, &save->body, id);
+}
+
+
+static nxt_int_t
+njs_cache_save_variables(njs_cache_save_t *save)
+{
+    size_t             offset;
+    uint32_t           n;
+    nxt_int_t          ret;
+    njs_variable_t     *var;
+    nxt_lvlhsh_each_t  lhe;
+
+    /* The number of variables is stored after they are counted. */
+
+    offset = save->body.size;
+
+    ret = njs_cache_write_uint32(save->vm, &save->body, 0);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    n = 0;
+
+    nxt_lvlhsh_each_init(&lhe, &njs_variables_hash_proto);
+
+    for ( ;; ) {
+        var = nxt_lvlhsh_each(&save->vm->variables_hash, &lhe);
+        if (var == NULL) {
+            break;
+        }
+
+        if (njs_scope_type(var->index) == NJS_SCOPE_ABSOLUTE) {
+            return NXT_DECLINED;
+        }
+
+        ret = njs_cache_write_uint32(save->vm, &save->body, var->name.length);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        ret = njs_cache_write(save->vm, &save->body, var->name.start,
+                              var->name.length);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        ret = njs_cache_write_uint32(save->vm, &save->body, var->type);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        ret = njs_cache_write_uint32(save->vm, &save->body,
+                                     (var->closure << 8) | var->argument);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        ret = njs_cache_write(save->vm, &save->body, &var->index,
+                              sizeof(njs_index_t));
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        ret = njs_cache_save_scope_value(save, &var->value);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+
+        n++;
+    }
+
+    memcpy(save->body.start + offset, &n, sizeof(uint32_t));
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_save_debug(njs_cache_save_t *save)
+{
+    uint32_t              id;
+    nxt_int_t             ret;
+    nxt_uint_t            n;
+    njs_function_debug_t  *debug;
+
+    n = (save->vm->debug != NULL) ? save->vm->debug->items : 0;
+
+    ret = njs_cache_write_uint32(save->vm, &save->body, n);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    if (n == 0) {
+        return NXT_OK;
+    }
+
+    debug = save->vm->debug->start;
+
+    do {
+        ret = njs_cache_ref(save, &save->lambdas, debug->lambda, &id);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        ret = njs_cache_write_uint32(save->vm, &save->body, id);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        ret = njs_cache_write_uint32(save->vm, &save->body, debug->line);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        ret = njs_cache_write_uint32(save->vm, &save->body,
+                                     debug->name.length);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        ret = njs_cache_write(save->vm, &save->body, debug->name.start,
+                              debug->name.length);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        debug++;
+        n--;
+
+    } while (n != 0);
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_save_lambda(njs_cache_save_t *save, njs_function_lambda_t *lambda)
+{
+    nxt_int_t  ret;
+    uint32_t   info[4];
+
+    info[0] = lambda->nargs;
+    info[1] = lambda->closure_size;
+    info[2] = lambda->nesting;
+    info[3] = lambda->block_closures;
+
+    ret = njs_cache_write(save->vm, &save->body, info, sizeof(info));
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    ret = njs_cache_save_scope(save, lambda->local_scope, lambda->local_size);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    return njs_cache_save_code(save, lambda->u.start);
+}
+
+
+static nxt_int_t
+njs_cache_save_value(njs_cache_save_t *save, njs_cache_buf_t *buf,
+    njs_value_t *value)
+{
+    nxt_int_t     ret;
+    njs_string_t  *string;
+
+    if (!njs_is_primitive(value) && njs_is_valid(value)) {
+        return NXT_DECLINED;
+    }
+
+    ret = njs_cache_write(save->vm, buf, value, sizeof(njs_value_t));
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    if (!njs_is_string(value)
+        || value->short_string.size != NJS_STRING_LONG)
+    {
+        return NXT_OK;
+    }
+
+    string = value->long_string.data;
+
+    if (string->start == NULL || value->long_string.external == 0xff) {
+        return NXT_DECLINED;
+    }
+
+    ret = njs_cache_write_uint32(save->vm, buf, string->length);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    return njs_cache_write(save->vm, buf, string->start,
+                           value->long_string.size);
+}
+
+
+static nxt_int_t
+njs_cache_save_pattern(njs_cache_save_t *save, njs_cache_buf_t *buf,
+    njs_regexp_pattern_t *pattern)
+{
+    size_t     length;
+    uint32_t   flags;
+    nxt_int_t  ret;
+
+    /* The source is stored as "/pattern/flags". */
+
+    length = strlen((char *) pattern->source) - 1 - pattern->flags;
+
+    flags = (pattern->global ? NJS_REGEXP_GLOBAL : 0)
+            | (pattern->ignore_case ? NJS_REGEXP_IGNORE_CASE : 0)
+            | (pattern->multiline ? NJS_REGEXP_MULTILINE : 0);
+
+    ret = njs_cache_write_uint32(save->vm, buf, flags);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    ret = njs_cache_write_uint32(save->vm, buf, length);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    return njs_cache_write(save->vm, buf, pattern->source + 1, length);
+}
+
+
+static nxt_int_t
+njs_cache_ref(njs_cache_save_t *save, njs_cache_table_t *table,
+    const void *object, uint32_t *id)
+{
+    nxt_int_t           ret;
+    njs_cache_ref_t     *ref;
+    nxt_lvlhsh_query_t  lhq;
+
+    lhq.key.start = (u_char *) &object;
+    lhq.key.length = sizeof(void *);
+    lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
+    lhq.proto = &njs_cache_ref_proto;
+
+    if (nxt_lvlhsh_find(&table->hash, &lhq) == NXT_OK) {
+        ref = lhq.value;
+        *id = ref->id;
+
+        return NXT_OK;
+    }
+
+    ref = nxt_mem_cache_alloc(save->vm->mem_cache_pool,
+                              sizeof(njs_cache_ref_t));
+    if (nxt_slow_path(ref == NULL)) {
+        return NXT_ERROR;
+    }
+
+    ref->object = object;
+    ref->id = table->count;
+
+    lhq.replace = 0;
+    lhq.value = ref;
+    lhq.pool = save->vm->mem_cache_pool;
+
+    ret = nxt_lvlhsh_insert(&table->hash, &lhq);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return NXT_ERROR;
+    }
+
+    ret = njs_cache_write(save->vm, &table->items, &object, sizeof(void *));
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    *id = table->count++;
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_ref_test(nxt_lvlhsh_query_t *lhq, void *data)
+{
+    njs_cache_ref_t  *ref;
+
+    ref = data;
+
+    if (memcmp(lhq->key.start, &ref->object, sizeof(void *)) == 0) {
+        return NXT_OK;
+    }
+
+    return NXT_DECLINED;
+}
+
+
+static nxt_int_t
+njs_cache_write(njs_vm_t *vm, njs_cache_buf_t *buf, const void *data,
+    size_t size)
+{
+    u_char  *start;
+    size_t  capacity;
+
+    if (buf->capacity - buf->size < size) {
+        capacity = nxt_max(buf->capacity * 2, buf->size + size);
+        capacity = nxt_max(capacity, 1024);
+
+        start = nxt_mem_cache_alloc(vm->mem_cache_pool, capacity);
+        if (nxt_slow_path(start == NULL)) {
+            return NXT_ERROR;
+        }
+
+        if (buf->start != NULL) {
+            memcpy(start, buf->start, buf->size);
+            nxt_mem_cache_free(vm->mem_cache_pool, buf->start);
+        }
+
+        buf->start = start;
+        buf->capacity = capacity;
+    }
+
+    if (size != 0) {
+        memcpy(buf->start + buf->size, data, size);
+        buf->size += size;
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_write_uint32(njs_vm_t *vm, njs_cache_buf_t *buf, uint32_t n)
+{
+    return njs_cache_write(vm, buf, &n, sizeof(uint32_t));
+}
+
+
+nxt_int_t
+njs_vm_cache_load(njs_vm_t *vm, const nxt_str_t *source,
+    const nxt_str_t *image)
+{
+    nxt_int_t         ret;
+    nxt_uint_t        debug;
+    njs_cache_load_t  load;
+
+    if (vm->accumulative || vm->parser != NULL || vm->current != NULL) {
+        return NJS_ERROR;
+    }
+
+    if (image->length < sizeof(njs_cache_header_t)) {
+        return NJS_DECLINED;
+    }
+
+    memset(&load, 0, sizeof(njs_cache_load_t));
+
+    load.vm = vm;
+    load.pos = image->start;
+    load.end = image->start + image->length;
+
+    memcpy(&load.header, image->start, sizeof(njs_cache_header_t));
+
+    if (memcmp(load.header.magic, njs_cache_magic, sizeof(njs_cache_magic))
+           != 0
+        || load.header.fingerprint != njs_cache_fingerprint()
+        || load.header.source_size != source->length
+        || load.header.source_hash != nxt_djb_hash(source->start,
+                                                   source->length))
+    {
+        return NJS_DECLINED;
+    }
+
+    debug = (vm->debug != NULL) ? vm->debug->items : 0;
+
+    ret = njs_cache_load(&load);
+
+    if (ret != NXT_OK) {
+        /* The VM is left as it was to compile the script as usual. */
+
+        vm->code = NULL;
+        vm->current = NULL;
+
+        if (vm->debug != NULL) {
+            vm->debug->items = debug;
+        }
+
+        return ret;
+    }
+
+    vm->variables_hash = load.variables;
+    vm->property_cache_slots = load.header.property_cache_slots;
+
+    nxt_mem_cache_free(vm->mem_cache_pool, load.values);
+    nxt_mem_cache_free(vm->mem_cache_pool, load.patterns);
+    nxt_mem_cache_free(vm->mem_cache_pool, load.functions);
+
+    return NJS_OK;
+}
+
+
+static nxt_int_t
+njs_cache_load(njs_cache_load_t *load)
+{
+    size_t                scope_size;
+    uint32_t              i;
+    nxt_int_t             ret;
+    njs_value_t           *global_scope;
+    njs_cache_header_t    *header;
+    nxt_mem_cache_pool_t  *pool;
+
+    header = &load->header;
+
+    load->pos += sizeof(njs_cache_header_t);
+
+    /* Every table item takes at least one byte in the image. */
+
+    if (header->values > (size_t) (load->end - load->pos)
+        || header->patterns > (size_t) (load->end - load->pos)
+        || header->lambdas > (size_t) (load->end - load->pos))
+    {
+        return NXT_DECLINED;
+    }
+
+    pool = load->vm->mem_cache_pool;
+
+    load->values = nxt_mem_cache_zalloc(pool,
+                         (header->values + 1) * sizeof(njs_value_t *));
+    load->patterns = nxt_mem_cache_zalloc(pool,
+                         (header->patterns + 1)
+                         * sizeof(njs_regexp_pattern_t *));
+    load->lambdas = nxt_mem_cache_zalloc(pool,
+                         (header->lambdas + 1)
+                         * sizeof(njs_function_lambda_t));
+    load->functions = nxt_mem_cache_zalloc(pool,
+                         (header->lambdas + 1) * sizeof(njs_function_t *));
+
+    if (nxt_slow_path(load->values == NULL
+                      || load->patterns == NULL
+                      || load->lambdas == NULL
+                      || load->functions == NULL))
+    {
+        return NXT_ERROR;
+    }
+
+    for (i = 0; i < header->values; i++) {
+        ret = njs_cache_load_value(load, &load->values[i]);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+    }
+
+    for (i = 0; i < header->patterns; i++) {
+        ret = njs_cache_load_pattern(load, &load->patterns[i]);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+    }
+
+    ret = njs_cache_load_code(load, &load->vm->current, NULL);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    ret = njs_cache_load_scope(load, &global_scope, &scope_size);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    ret = njs_cache_load_variables(load);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    ret = njs_cache_load_debug(load);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    for (i = 0; i < header->lambdas; i++) {
+        ret = njs_cache_load_lambda(load, &load->lambdas[i]);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+    }
+
+    if (load->pos != load->end) {
+        return NXT_DECLINED;
+    }
+
+    load->vm->global_scope = global_scope;
+    load->vm->scope_size = scope_size;
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_load_code(njs_cache_load_t *load, u_char **start, u_char **last)
+{
+    u_char                       *p, *code, *end;
+    uint32_t                     size;
+    nxt_int_t                    ret;
+    uintptr_t                    n, id, *operand;
+    const char                   *kind;
+    const u_char                 *data;
+    njs_vm_code_t                *vm_code;
+    njs_vmcode_t                 *vmcode;
+    const njs_cache_operation_t  *op;
+
+    ret = njs_cache_read_uint32(load, &size);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    data = njs_cache_read(load, size);
+    if (data == NULL) {
+        return NXT_DECLINED;
+    }
+
+    code = nxt_mem_cache_alloc(load->vm->mem_cache_pool, size);
+    if (nxt_slow_path(code == NULL)) {
+        return NXT_ERROR;
+    }
+
+    memcpy(code, data, size);
+
+    p = code;
+    end = code + size;
+
+    while (p < end) {
+        if ((size_t) (end - p) < sizeof(njs_vmcode_t)) {
+            return NXT_DECLINED;
+        }
+
+        vmcode = (njs_vmcode_t *) p;
+
+        n = (uintptr_t) vmcode->operation;
+
+        if (n >= nxt_nitems(njs_cache_operations)) {
+            return NXT_DECLINED;
+        }
+
+        op = &njs_cache_operations[n];
+
+        if ((size_t) (end - p) < op->size) {
+            return NXT_DECLINED;
+        }
+
+        vmcode->operation = op->operation;
+
+        operand = (uintptr_t *) (p + sizeof(njs_vmcode_t));
+
+        for (kind = op->operands; *kind != '\0'; kind++, operand++) {
+
+            if (*kind == '-'
+                || (*kind == 'i'
+                    && (*operand == NJS_INDEX_NONE
+                        || njs_scope_type(*operand) != NJS_SCOPE_ABSOLUTE)))
+            {
+                continue;
+            }
+
+            id = (*operand >> NJS_SCOPE_SHIFT) - 1;
+
+            switch (*kind) {
+
+            case 'i':
+                if (id >= load->header.values) {
+                    return NXT_DECLINED;
+                }
+
+                *operand = (uintptr_t) load->values[id];
+                break;
+
+            case 'l':
+                if (id >= load->header.lambdas) {
+                    return NXT_DECLINED;
+                }
+
+                *operand = (uintptr_t) &load->lambdas[id];
+                break;
+
+            default:
+                if (id >= load->header.patterns) {
+                    return NXT_DECLINED;
+                }
+
+                *operand = (uintptr_t) load->patterns[id];
+                break;
+            }
+        }
+
+        p += op->size;
+    }
+
+#if (NXT_HAVE_COMPUTED_GOTO)
+
+    if (nxt_slow_path(njs_vmcode_opcodes(load->vm, code, end) != NXT_OK)) {
+        return NXT_ERROR;
+    }
+
+#endif
+
+    if (load->vm->code == NULL) {
+        load->vm->code = nxt_array_create(4, sizeof(njs_vm_code_t),
+                                          &njs_array_mem_proto,
+                                          load->vm->mem_cache_pool);
+        if (nxt_slow_path(load->vm->code == NULL)) {
+            return NXT_ERROR;
+        }
+    }
+
+    vm_code = nxt_array_add(load->vm->code, &njs_array_mem_proto,
+                            load->vm->mem_cache_pool);
+    if (nxt_slow_path(vm_code == NULL)) {
+        return NXT_ERROR;
+    }
+
+    vm_code->start = code;
+    vm_code->end = end;
+
+    *start = code;
+
+    if (last != NULL) {
+        *last = end;
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_load_scope(njs_cache_load_t *load, njs_value_t **values,
+    size_t *size)
+{
+    uint32_t     length;
+    nxt_int_t    ret;
+    nxt_uint_t   n;
+    njs_value_t  *value;
+
+    ret = njs_cache_read_uint32(load, &length);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    /* Every scope value takes at least two numbers in the image. */
+
+    if (length % sizeof(njs_value_t) != 0
+        || length / sizeof(njs_value_t)
+           > (size_t) (load->end - load->pos) / (2 * sizeof(uint32_t)))
+    {
+        return NXT_DECLINED;
+    }
+
+    value = nxt_mem_cache_alloc(load->vm->mem_cache_pool, length);
+    if (nxt_slow_path(value == NULL && length != 0)) {
+        return NXT_ERROR;
+    }
+
+    *values = value;
+    *size = length;
+
+    for (n = length / sizeof(njs_value_t); n != 0; n--) {
+        ret = njs_cache_load_scope_value(load, value++);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_load_scope_value(njs_cache_load_t *load, njs_value_t *value)
+{
+    uint32_t        type, id;
+    nxt_int_t       ret;
+    const u_char    *data;
+    njs_function_t  *function;
+
+    ret = njs_cache_read_uint32(load, &type);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    if (type == NJS_CACHE_VALUE) {
+        data = njs_cache_read(load, sizeof(njs_value_t));
+        if (data == NULL) {
+            return NXT_DECLINED;
+        }
+
+        memcpy(value, data, sizeof(njs_value_t));
+
+        if (njs_is_string(value)
+            && value->short_string.size == NJS_STRING_LONG)
+        {
+            return NXT_DECLINED;
+        }
+
+        return NXT_OK;
+    }
+
+    ret = njs_cache_read_uint32(load, &id);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    switch (type) {
+
+    case NJS_CACHE_BUILTIN_OBJECT:
+        if (id >= NJS_OBJECT_MAX) {
+            return NXT_DECLINED;
+        }
+
+        value->data.u.object = &load->vm->shared->objects[id];
+        value->type = NJS_OBJECT;
+        value->data.truth = 1;
+
+        return NXT_OK;
+
+    case NJS_CACHE_BUILTIN_FUNCTION:
+        if (id >= NJS_FUNCTION_MAX) {
+            return NXT_DECLINED;
+        }
+
+        value->data.u.function = &load->vm->shared->functions[id];
+        value->type = NJS_FUNCTION;
+        value->data.truth = 1;
+
+        return NXT_OK;
+
+    case NJS_CACHE_FUNCTION:
+        if (id >= load->header.lambdas) {
+            return NXT_DECLINED;
+        }
+
+        break;
+
+    default:
+        return NXT_DECLINED;
+    }
+
+    function = load->functions[id];
+
+    if (function == NULL) {
+        function = njs_function_alloc(load->vm);
+        if (nxt_slow_path(function == NULL)) {
+            return NXT_ERROR;
+        }
+
+        nxt_mem_cache_free(load->vm->mem_cache_pool, function->u.lambda);
+        function->u.lambda = &load->lambdas[id];
+
+        load->functions[id] = function;
+    }
+
+    value->data.u.function = function;
+    value->type = NJS_FUNCTION;
+    value->data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_load_variables(njs_cache_load_t *load)
+{
+    uint32_t            n, type, flags;
+    nxt_int_t           ret;
+    nxt_str_t           name;
+    const u_char        *data;
+    njs_variable_t      *var;
+    nxt_lvlhsh_query_t  lhq;
+
+    ret = njs_cache_read_uint32(load, &n);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    while (n != 0) {
+        ret = njs_cache_load_string(load, &name);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+
+        var = nxt_mem_cache_zalloc(load->vm->mem_cache_pool,
+                                   sizeof(njs_variable_t));
+        if (nxt_slow_path(var == NULL)) {
+            return NXT_ERROR;
+        }
+
+        var->name = name;
+
+        ret = njs_cache_read_uint32(load, &type);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+
+        ret = njs_cache_read_uint32(load, &flags);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+
+        var->type = type;
+        var->closure = flags >> 8;
+        var->argument = flags & 0xff;
+
+        data = njs_cache_read(load, sizeof(njs_index_t));
+        if (data == NULL) {
+            return NXT_DECLINED;
+        }
+
+        memcpy(&var->index, data, sizeof(njs_index_t));
+
+        if (njs_scope_type(var->index) == NJS_SCOPE_ABSOLUTE) {
+            return NXT_DECLINED;
+        }
+
+        ret = njs_cache_load_scope_value(load, &var->value);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+
+        lhq.key_hash = nxt_djb_hash(name.start, name.length);
+        lhq.key = name;
+        lhq.replace = 0;
+        lhq.value = var;
+        lhq.proto = &njs_variables_hash_proto;
+        lhq.pool = load->vm->mem_cache_pool;
+
+        ret = nxt_lvlhsh_insert(&load->variables, &lhq);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return (ret == NXT_DECLINED) ? NXT_DECLINED : NXT_ERROR;
+        }
+
+        n--;
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_load_debug(njs_cache_load_t *load)
+{
+    uint32_t              n, id, line;
+    nxt_int_t             ret;
+    nxt_str_t             name;
+    njs_function_debug_t  *debug;
+
+    ret = njs_cache_read_uint32(load, &n);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    while (n != 0) {
+        ret = njs_cache_read_uint32(load, &id);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+
+        ret = njs_cache_read_uint32(load, &line);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+
+        ret = njs_cache_load_string(load, &name);
+        if (ret != NXT_OK) {
+            return ret;
+        }
+
+        if (id >= load->header.lambdas) {
+            return NXT_DECLINED;
+        }
+
+        if (load->vm->debug != NULL) {
+            debug = nxt_array_add(load->vm->debug, &njs_array_mem_proto,
+                                  load->vm->mem_cache_pool);
+            if (nxt_slow_path(debug == NULL)) {
+                return NXT_ERROR;
+            }
+
+            debug->line = line;
+            debug->name = name;
+            debug->lambda = &load->lambdas[id];
+        }
+
+        n--;
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_load_lambda(njs_cache_load_t *load, njs_function_lambda_t *lambda)
+{
+    size_t        size;
+    nxt_int_t     ret;
+    uint32_t      info[4];
+    const u_char  *data;
+
+    data = njs_cache_read(load, sizeof(info));
+    if (data == NULL) {
+        return NXT_DECLINED;
+    }
+
+    memcpy(info, data, sizeof(info));
+
+    lambda->nargs = info[0];
+    lambda->closure_size = info[1];
+    lambda->nesting = info[2];
+    lambda->block_closures = info[3];
+
+    ret = njs_cache_load_scope(load, &lambda->local_scope, &size);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    lambda->local_size = size;
+
+    return njs_cache_load_code(load, &lambda->u.start, &lambda->end);
+}
+
+
+static nxt_int_t
+njs_cache_load_value(njs_cache_load_t *load, njs_value_t **value)
+{
+    size_t        size;
+    uint32_t      length;
+    nxt_int_t     ret;
+    njs_value_t   src, *dst;
+    const u_char  *data;
+    njs_string_t  *string;
+
+    data = njs_cache_read(load, sizeof(njs_value_t));
+    if (data == NULL) {
+        return NXT_DECLINED;
+    }
+
+    memcpy(&src, data, sizeof(njs_value_t));
+
+    if (!njs_is_primitive(&src) && njs_is_valid(&src)) {
+        return NXT_DECLINED;
+    }
+
+    if (!njs_is_string(&src) || src.short_string.size != NJS_STRING_LONG) {
+        dst = nxt_mem_cache_align(load->vm->mem_cache_pool,
+                                  sizeof(njs_value_t), sizeof(njs_value_t));
+        if (nxt_slow_path(dst == NULL)) {
+            return NXT_ERROR;
+        }
+
+        *dst = src;
+        *value = dst;
+
+        return NXT_OK;
+    }
+
+    /* Long string value is allocated together with string. */
+
+    ret = njs_cache_read_uint32(load, &length);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    data = njs_cache_read(load, src.long_string.size);
+    if (data == NULL || length > src.long_string.size) {
+        return NXT_DECLINED;
+    }
+
+    size = src.long_string.size;
+
+    if (size != length && length > NJS_STRING_MAP_STRIDE) {
+        size = njs_string_map_offset(size) + njs_string_map_size(length);
+    }
+
+    dst = nxt_mem_cache_align(load->vm->mem_cache_pool, sizeof(njs_value_t),
+                              sizeof(njs_value_t) + sizeof(njs_string_t)
+                              + size);
+    if (nxt_slow_path(dst == NULL)) {
+        return NXT_ERROR;
+    }
+
+    *dst = src;
+
+    /* A saved view is loaded as a string which owns its bytes. */
+    dst->long_string.external = 0;
+
+    string = (njs_string_t *) ((u_char *) dst + sizeof(njs_value_t));
+    dst->long_string.data = string;
+
+    string->start = (u_char *) string + sizeof(njs_string_t);
+    string->length = length;
+    string->retain = 0xffff;
+
+    memcpy(string->start, data, src.long_string.size);
+
+    if (size != src.long_string.size) {
+        njs_string_map_start(string->start + src.long_string.size)[0] = 0;
+    }
+
+    *value = dst;
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_load_pattern(njs_cache_load_t *load, njs_regexp_pattern_t **pattern)
+{
+    uint32_t   flags;
+    nxt_int_t  ret;
+    nxt_str_t  source;
+
+    ret = njs_cache_read_uint32(load, &flags);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    ret = njs_cache_load_string(load, &source);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    *pattern = njs_regexp_pattern_create(load->vm, source.start,
+                                         source.length, flags);
+    if (nxt_slow_path(*pattern == NULL)) {
+        return NXT_ERROR;
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_cache_load_string(njs_cache_load_t *load, nxt_str_t *str)
+{
+    uint32_t      length;
+    nxt_int_t     ret;
+    const u_char  *data;
+
+    ret = njs_cache_read_uint32(load, &length);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    data = njs_cache_read(load, length);
+    if (data == NULL) {
+        return NXT_DECLINED;
+    }
+
+    str->length = length;
+
+    if (length == 0) {
+        str->start = NULL;
+        return NXT_OK;
+    }
+
+    str->start = nxt_mem_cache_alloc(load->vm->mem_cache_pool, length);
+    if (nxt_slow_path(str->start == NULL)) {
+        return NXT_ERROR;
+    }
+
+    memcpy(str->start, data, length);
+
+    return NXT_OK;
+}
+
+
+static const u_char *
+njs_cache_read(njs_cache_load_t *load, size_t size)
+{
+    const u_char  *p;
+
+    p = load->pos;
+
+    if ((size_t) (load->end - p) < size) {
+        return NULL;
+    }
+
+    load->pos = p + size;
+
+    return p;
+}
+
+
+static nxt_int_t
+njs_cache_read_uint32(njs_cache_load_t *load, uint32_t *n)
+{
+    const u_char  *p;
+
+    p = njs_cache_read(load, sizeof(uint32_t));
+    if (p == NULL) {
+        return NXT_DECLINED;
+    }
+
+    memcpy(n, p, sizeof(uint32_t));
+
+    return NXT_OK;
+}
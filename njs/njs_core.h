@@ -39,6 +39,8 @@
 #include <njs_error.h>
 
 #include <njs_event.h>
+#include <njs_gc.h>
+#include <njs_jit.h>
 
 #include <njs_extern.h>
 
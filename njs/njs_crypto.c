@@ -140,6 +140,9 @@ njs_crypto_object_value_alloc(njs_vm_t *vm, nxt_uint_t proto)
         ov->object.type = NJS_OBJECT_VALUE;
         ov->object.shared = 0;
         ov->object.extensible = 1;
+        ov->object.immutable = 0;
+        ov->object.shape = NULL;
+        ov->object.slots = NULL;
 
         ov->object.__proto__ = &vm->prototypes[proto].object;
     }
@@ -162,6 +165,10 @@ njs_crypto_create_hash(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         return NJS_ERROR;
     }
 
+    if (nxt_slow_path(njs_string_flat(vm, &args[1]) != NXT_OK)) {
+        return NJS_ERROR;
+    }
+
     njs_string_get(&args[1], &alg_name);
 
     alg = njs_crypto_alg(vm, &alg_name);
@@ -224,6 +231,10 @@ njs_hash_prototype_update(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     hash = args[0].data.u.object_value;
 
+    if (nxt_slow_path(njs_string_flat(vm, &args[1]) != NXT_OK)) {
+        return NJS_ERROR;
+    }
+
     njs_string_get(&args[1], &data);
 
     dgst = njs_value_data(&hash->value);
@@ -271,6 +282,10 @@ njs_hash_prototype_digest(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     enc = NULL;
 
     if (nargs > 1) {
+        if (nxt_slow_path(njs_string_flat(vm, &args[1]) != NXT_OK)) {
+            return NJS_ERROR;
+        }
+
         njs_string_get(&args[1], &enc_name);
 
         enc = njs_crypto_encoding(vm, &enc_name);
@@ -401,6 +416,10 @@ njs_crypto_create_hmac(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         return NJS_ERROR;
     }
 
+    if (nxt_slow_path(njs_string_flat(vm, &args[1]) != NXT_OK)) {
+        return NJS_ERROR;
+    }
+
     njs_string_get(&args[1], &alg_name);
 
     alg = njs_crypto_alg(vm, &alg_name);
@@ -408,6 +427,10 @@ njs_crypto_create_hmac(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         return NJS_ERROR;
     }
 
+    if (nxt_slow_path(njs_string_flat(vm, &args[2]) != NXT_OK)) {
+        return NJS_ERROR;
+    }
+
     njs_string_get(&args[2], &key);
 
     ctx = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_hmac_t));
@@ -487,6 +510,10 @@ njs_hmac_prototype_update(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     hmac = args[0].data.u.object_value;
 
+    if (nxt_slow_path(njs_string_flat(vm, &args[1]) != NXT_OK)) {
+        return NJS_ERROR;
+    }
+
     njs_string_get(&args[1], &data);
 
     ctx = njs_value_data(&hmac->value);
@@ -534,6 +561,10 @@ njs_hmac_prototype_digest(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     enc = NULL;
 
     if (nargs > 1) {
+        if (nxt_slow_path(njs_string_flat(vm, &args[1]) != NXT_OK)) {
+            return NJS_ERROR;
+        }
+
         njs_string_get(&args[1], &enc_name);
 
         enc = njs_crypto_encoding(vm, &enc_name);
@@ -78,6 +78,10 @@ njs_date_constructor(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             time = njs_gettime();
 
         } else if (nargs == 2 && njs_is_string(&args[1])) {
+            if (nxt_slow_path(njs_string_flat(vm, &args[1]) != NXT_OK)) {
+                return NXT_ERROR;
+            }
+
             time = njs_date_string_parse(&args[1]);
 
         } else {
@@ -136,6 +140,9 @@ njs_date_constructor(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         date->object.type = NJS_DATE;
         date->object.shared = 0;
         date->object.extensible = 1;
+        date->object.immutable = 0;
+        date->object.shape = NULL;
+        date->object.slots = NULL;
         date->object.__proto__ = &vm->prototypes[NJS_PROTOTYPE_DATE].object;
 
         date->time = time;
@@ -75,6 +75,9 @@ njs_error_alloc(njs_vm_t *vm, njs_value_type_t type, const njs_value_t *name,
     error->type = type;
     error->shared = 0;
     error->extensible = 1;
+    error->immutable = 0;
+    error->shape = NULL;
+    error->slots = NULL;
     error->__proto__ = &vm->prototypes[njs_error_prototype_index(type)].object;
 
     lhq.replace = 0;
@@ -613,6 +616,10 @@ njs_error_prototype_to_string(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         name_value = &default_name;
     }
 
+    if (nxt_slow_path(njs_string_flat(vm, name_value) != NXT_OK)) {
+        return NXT_ERROR;
+    }
+
     njs_string_get(name_value, &name);
 
     lhq.key_hash = NJS_MESSAGE_HASH;
@@ -627,6 +634,10 @@ njs_error_prototype_to_string(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         message_value = &njs_string_empty;
     }
 
+    if (nxt_slow_path(njs_string_flat(vm, message_value) != NXT_OK)) {
+        return NXT_ERROR;
+    }
+
     njs_string_get(message_value, &message);
 
     if (name.length == 0) {
@@ -48,6 +48,11 @@ njs_add_event(njs_vm_t *vm, njs_event_t *event)
     nxt_int_t           ret;
     nxt_lvlhsh_query_t  lhq;
 
+    if (vm->event_id == 0) {
+        /* The events hash is allocated on the first event. */
+        vm->shared->init_stats.events++;
+    }
+
     size = snprintf((char *) njs_string_short_start(&event->id),
                     NJS_STRING_SHORT, "%u", vm->event_id++);
     njs_string_short_set(&event->id, size, size);
@@ -114,6 +114,10 @@ njs_fs_read_file(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     if (!njs_is_function(&args[2])) {
         if (njs_is_string(&args[2])) {
+            if (nxt_slow_path(njs_string_flat(vm, &args[2]) != NXT_OK)) {
+                return NJS_ERROR;
+            }
+
             njs_string_get(&args[2], &encoding);
 
         } else if (njs_is_object(&args[2])) {
@@ -121,9 +125,15 @@ njs_fs_read_file(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             lhq.key = nxt_string_value("flag");
             lhq.proto = &njs_object_hash_proto;
 
-            ret = nxt_lvlhsh_find(&args[2].data.u.object->hash, &lhq);
+            ret = njs_object_own_find(args[2].data.u.object, &lhq);
             if (ret == NXT_OK) {
                 prop = lhq.value;
+
+                ret = njs_string_flat(vm, &prop->value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return NJS_ERROR;
+                }
+
                 njs_string_get(&prop->value, &flag);
             }
 
@@ -131,9 +141,15 @@ njs_fs_read_file(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             lhq.key = nxt_string_value("encoding");
             lhq.proto = &njs_object_hash_proto;
 
-            ret = nxt_lvlhsh_find(&args[2].data.u.object->hash, &lhq);
+            ret = njs_object_own_find(args[2].data.u.object, &lhq);
             if (ret == NXT_OK) {
                 prop = lhq.value;
+
+                ret = njs_string_flat(vm, &prop->value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return NJS_ERROR;
+                }
+
                 njs_string_get(&prop->value, &encoding);
             }
 
@@ -328,6 +344,10 @@ njs_fs_read_file_sync(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     if (nargs == 3) {
         if (njs_is_string(&args[2])) {
+            if (nxt_slow_path(njs_string_flat(vm, &args[2]) != NXT_OK)) {
+                return NJS_ERROR;
+            }
+
             njs_string_get(&args[2], &encoding);
 
         } else if (njs_is_object(&args[2])) {
@@ -335,9 +355,15 @@ njs_fs_read_file_sync(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             lhq.key = nxt_string_value("flag");
             lhq.proto = &njs_object_hash_proto;
 
-            ret = nxt_lvlhsh_find(&args[2].data.u.object->hash, &lhq);
+            ret = njs_object_own_find(args[2].data.u.object, &lhq);
             if (ret == NXT_OK) {
                 prop = lhq.value;
+
+                ret = njs_string_flat(vm, &prop->value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return NJS_ERROR;
+                }
+
                 njs_string_get(&prop->value, &flag);
             }
 
@@ -345,9 +371,15 @@ njs_fs_read_file_sync(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             lhq.key = nxt_string_value("encoding");
             lhq.proto = &njs_object_hash_proto;
 
-            ret = nxt_lvlhsh_find(&args[2].data.u.object->hash, &lhq);
+            ret = njs_object_own_find(args[2].data.u.object, &lhq);
             if (ret == NXT_OK) {
                 prop = lhq.value;
+
+                ret = njs_string_flat(vm, &prop->value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return NJS_ERROR;
+                }
+
                 njs_string_get(&prop->value, &encoding);
             }
 
@@ -548,6 +580,10 @@ static njs_ret_t njs_fs_write_file_internal(njs_vm_t *vm, njs_value_t *args,
         return NJS_ERROR;
     }
 
+    if (nxt_slow_path(njs_string_flat(vm, &args[2]) != NXT_OK)) {
+        return NJS_ERROR;
+    }
+
     mode = NULL;
     /* GCC complains about uninitialized flag.length. */
     flag.length = 0;
@@ -557,6 +593,10 @@ static njs_ret_t njs_fs_write_file_internal(njs_vm_t *vm, njs_value_t *args,
 
     if (!njs_is_function(&args[3])) {
         if (njs_is_string(&args[3])) {
+            if (nxt_slow_path(njs_string_flat(vm, &args[3]) != NXT_OK)) {
+                return NJS_ERROR;
+            }
+
             njs_string_get(&args[3], &encoding);
 
         } else if (njs_is_object(&args[3])) {
@@ -564,9 +604,15 @@ static njs_ret_t njs_fs_write_file_internal(njs_vm_t *vm, njs_value_t *args,
             lhq.key = nxt_string_value("flag");
             lhq.proto = &njs_object_hash_proto;
 
-            ret = nxt_lvlhsh_find(&args[3].data.u.object->hash, &lhq);
+            ret = njs_object_own_find(args[3].data.u.object, &lhq);
             if (ret == NXT_OK) {
                 prop = lhq.value;
+
+                ret = njs_string_flat(vm, &prop->value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return NJS_ERROR;
+                }
+
                 njs_string_get(&prop->value, &flag);
             }
 
@@ -574,9 +620,15 @@ static njs_ret_t njs_fs_write_file_internal(njs_vm_t *vm, njs_value_t *args,
             lhq.key = nxt_string_value("encoding");
             lhq.proto = &njs_object_hash_proto;
 
-            ret = nxt_lvlhsh_find(&args[3].data.u.object->hash, &lhq);
+            ret = njs_object_own_find(args[3].data.u.object, &lhq);
             if (ret == NXT_OK) {
                 prop = lhq.value;
+
+                ret = njs_string_flat(vm, &prop->value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return NJS_ERROR;
+                }
+
                 njs_string_get(&prop->value, &encoding);
             }
 
@@ -584,7 +636,7 @@ static njs_ret_t njs_fs_write_file_internal(njs_vm_t *vm, njs_value_t *args,
             lhq.key = nxt_string_value("mode");
             lhq.proto = &njs_object_hash_proto;
 
-            ret = nxt_lvlhsh_find(&args[3].data.u.object->hash, &lhq);
+            ret = njs_object_own_find(args[3].data.u.object, &lhq);
             if (ret == NXT_OK) {
                 prop = lhq.value;
                 mode = &prop->value;
@@ -737,6 +789,10 @@ njs_fs_write_file_sync_internal(njs_vm_t *vm, njs_value_t *args,
         return NJS_ERROR;
     }
 
+    if (nxt_slow_path(njs_string_flat(vm, &args[2]) != NXT_OK)) {
+        return NJS_ERROR;
+    }
+
     mode = NULL;
     /* GCC complains about uninitialized flag.length. */
     flag.length = 0;
@@ -746,6 +802,10 @@ njs_fs_write_file_sync_internal(njs_vm_t *vm, njs_value_t *args,
 
     if (nargs == 4) {
         if (njs_is_string(&args[3])) {
+            if (nxt_slow_path(njs_string_flat(vm, &args[3]) != NXT_OK)) {
+                return NJS_ERROR;
+            }
+
             njs_string_get(&args[3], &encoding);
 
         } else if (njs_is_object(&args[3])) {
@@ -753,9 +813,15 @@ njs_fs_write_file_sync_internal(njs_vm_t *vm, njs_value_t *args,
             lhq.key = nxt_string_value("flag");
             lhq.proto = &njs_object_hash_proto;
 
-            ret = nxt_lvlhsh_find(&args[3].data.u.object->hash, &lhq);
+            ret = njs_object_own_find(args[3].data.u.object, &lhq);
             if (ret == NXT_OK) {
                 prop = lhq.value;
+
+                ret = njs_string_flat(vm, &prop->value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return NJS_ERROR;
+                }
+
                 njs_string_get(&prop->value, &flag);
             }
 
@@ -763,9 +829,15 @@ njs_fs_write_file_sync_internal(njs_vm_t *vm, njs_value_t *args,
             lhq.key = nxt_string_value("encoding");
             lhq.proto = &njs_object_hash_proto;
 
-            ret = nxt_lvlhsh_find(&args[3].data.u.object->hash, &lhq);
+            ret = njs_object_own_find(args[3].data.u.object, &lhq);
             if (ret == NXT_OK) {
                 prop = lhq.value;
+
+                ret = njs_string_flat(vm, &prop->value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return NJS_ERROR;
+                }
+
                 njs_string_get(&prop->value, &encoding);
             }
 
@@ -773,7 +845,7 @@ njs_fs_write_file_sync_internal(njs_vm_t *vm, njs_value_t *args,
             lhq.key = nxt_string_value("mode");
             lhq.proto = &njs_object_hash_proto;
 
-            ret = nxt_lvlhsh_find(&args[3].data.u.object->hash, &lhq);
+            ret = njs_object_own_find(args[3].data.u.object, &lhq);
             if (ret == NXT_OK) {
                 prop = lhq.value;
                 mode = &prop->value;
@@ -914,9 +986,7 @@ static njs_ret_t njs_fs_error(njs_vm_t *vm, const char *syscall,
         lhq.key_hash = NJS_ERRNO_HASH;
         lhq.proto = &njs_object_hash_proto;
 
-        value.data.type = NJS_NUMBER;
-        value.data.truth = 1;
-        value.data.u.number = errn;
+        njs_value_number_set(&value, errn);
 
         prop = njs_object_prop_alloc(vm, &njs_fs_errno_string, &value, 1);
         if (nxt_slow_path(prop == NULL)) {
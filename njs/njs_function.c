@@ -8,10 +8,23 @@
 #include <string.h>
 
 
+static nxt_int_t njs_function_overlay_test(nxt_lvlhsh_query_t *lhq,
+    void *data);
 static njs_ret_t njs_function_activate(njs_vm_t *vm, njs_function_t *function,
     njs_value_t *this, njs_value_t *args, nxt_uint_t nargs, njs_index_t retval);
 
 
+static const nxt_lvlhsh_proto_t  njs_function_overlay_proto
+    nxt_aligned(64) =
+{
+    NXT_LVLHSH_DEFAULT,
+    0,
+    njs_function_overlay_test,
+    njs_lvlhsh_alloc,
+    njs_lvlhsh_free,
+};
+
+
 njs_function_t *
 njs_function_alloc(njs_vm_t *vm)
 {
@@ -56,7 +69,17 @@ njs_function_value_copy(njs_vm_t *vm, njs_value_t *value)
         return function;
     }
 
-    nesting = (function->native) ? 0 : function->u.lambda->nesting;
+    if (function->native) {
+        copy = njs_function_overlay(vm, function, 1);
+
+        if (nxt_fast_path(copy != NULL)) {
+            value->data.u.function = copy;
+        }
+
+        return copy;
+    }
+
+    nesting = function->u.lambda->nesting;
 
     size = sizeof(njs_function_t) + nesting * sizeof(njs_closure_t *);
 
@@ -89,6 +112,78 @@ njs_function_value_copy(njs_vm_t *vm, njs_value_t *value)
 }
 
 
+/*
+ * The shared native functions, e.g. the builtin methods, are used by all
+ * VMs as is until a VM modifies a function.  The function is copied then
+ * to the VM memory and all the following accesses to the shared function
+ * are redirected to the private copy found in the VM overlays hash.  The
+ * private copy is preceded by a pointer to the shared function, so both
+ * functions are the same function for the strict equality.
+ */
+
+njs_function_t *
+njs_function_overlay(njs_vm_t *vm, njs_function_t *function, nxt_bool_t copy)
+{
+    u_char              *p;
+    nxt_int_t           ret;
+    njs_function_t      *overlay;
+    nxt_lvlhsh_query_t  lhq;
+
+    lhq.key.start = (u_char *) &function;
+    lhq.key.length = sizeof(njs_function_t *);
+    lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
+    lhq.proto = &njs_function_overlay_proto;
+
+    if (nxt_lvlhsh_find(&vm->overlays_hash, &lhq) == NXT_OK) {
+        return lhq.value;
+    }
+
+    if (!copy) {
+        return function;
+    }
+
+    p = nxt_mem_cache_alloc(vm->mem_cache_pool,
+                            sizeof(njs_function_t *) + sizeof(njs_function_t));
+    if (nxt_slow_path(p == NULL)) {
+        return NULL;
+    }
+
+    *(njs_function_t **) p = function;
+    overlay = (njs_function_t *) (p + sizeof(njs_function_t *));
+
+    *overlay = *function;
+    overlay->object.__proto__ = &vm->prototypes[NJS_PROTOTYPE_FUNCTION].object;
+    overlay->object.shared = 0;
+    overlay->overlay = 1;
+
+    lhq.replace = 0;
+    lhq.value = overlay;
+    lhq.pool = vm->mem_cache_pool;
+
+    ret = nxt_lvlhsh_insert(&vm->overlays_hash, &lhq);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return NULL;
+    }
+
+    return overlay;
+}
+
+
+static nxt_int_t
+njs_function_overlay_test(nxt_lvlhsh_query_t *lhq, void *data)
+{
+    njs_function_t  *function;
+
+    function = *(njs_function_t **) lhq->key.start;
+
+    if (njs_function_origin((njs_function_t *) data) == function) {
+        return NXT_OK;
+    }
+
+    return NXT_DECLINED;
+}
+
+
 njs_ret_t
 njs_function_native_frame(njs_vm_t *vm, njs_function_t *function,
     const njs_value_t *this, njs_value_t *args, nxt_uint_t nargs,
@@ -322,7 +417,12 @@ njs_function_call(njs_vm_t *vm, njs_index_t retval, size_t advance)
     frame->return_address = vm->current + advance;
 
     lambda = function->u.lambda;
+
+#if (NXT_JIT)
+    vm->current = njs_jit_start(vm, lambda);
+#else
     vm->current = lambda->u.start;
+#endif
 
 #if (NXT_DEBUG)
     vm->scopes[NJS_SCOPE_CALLEE_ARGUMENTS] = NULL;
@@ -527,6 +627,10 @@ njs_function_prototype_apply(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_array_t     *array;
     njs_value_t     *this;
     njs_function_t  *function;
+#if (NXT_NAN_BOXING)
+    njs_ret_t       ret;
+    nxt_uint_t      i;
+#endif
 
     if (!njs_is_function(&args[0])) {
         njs_type_error(vm, "'this' argument is not a function");
@@ -543,9 +647,36 @@ njs_function_prototype_apply(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         }
 
         array = args[2].data.u.array;
-        args = array->start;
         nargs = array->length;
 
+#if (NXT_NAN_BOXING)
+
+        if (nargs != 0) {
+            /* njs_function_activate() copies the arguments to the frame. */
+
+            args = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
+                                       nargs * sizeof(njs_value_t));
+            if (nxt_slow_path(args == NULL)) {
+                njs_memory_error(vm);
+                return NXT_ERROR;
+            }
+
+            for (i = 0; i < nargs; i++) {
+                njs_array_item_get(&array->start[i], &args[i]);
+            }
+
+            ret = njs_function_activate(vm, function, this, args, nargs,
+                                        retval);
+
+            nxt_mem_cache_free(vm->mem_cache_pool, args);
+
+            return ret;
+        }
+
+#else
+        args = array->start;
+#endif
+
     } else {
         if (nargs == 1) {
             this = (njs_value_t *) &njs_value_void;
@@ -624,6 +755,10 @@ njs_function_prototype_bind(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     function->object.__proto__ = &vm->prototypes[NJS_PROTOTYPE_FUNCTION].object;
     function->object.shared = 0;
     function->object.extensible = 1;
+    function->object.immutable = 0;
+    function->object.shape = NULL;
+    function->object.slots = NULL;
+    function->overlay = 0;
 
     if (nargs == 1) {
         args = (njs_value_t *) &njs_value_void;
@@ -17,6 +17,9 @@
 #define NJS_FUNCTION_ARG           7
 #define NJS_REGEXP_ARG             8
 #define NJS_DATE_ARG               9
+#define NJS_ARRAY_BUFFER_ARG       10
+#define NJS_TYPED_ARRAY_ARG        11
+#define NJS_DATA_VIEW_ARG          12
 
 
 struct njs_function_lambda_s {
@@ -37,6 +40,14 @@ struct njs_function_lambda_s {
         u_char                     *start;
         njs_parser_t               *parser;
     } u;
+
+    u_char                         *end;
+
+#if (NXT_JIT)
+    /* The number of calls before the lambda is compiled. */
+    uint32_t                       calls;
+    njs_jit_code_t                 *jit;
+#endif
 };
 
 
@@ -57,6 +68,10 @@ struct njs_function_lambda_s {
 
 #define NJS_FRAME_SPARE_SIZE       512
 
+/* A private copy of a shared native function is the same function. */
+#define njs_function_origin(function)                                         \
+    ((function)->overlay ? ((njs_function_t **) (function))[-1] : (function))
+
 
 typedef struct {
     njs_function_native_t          function;
@@ -148,6 +163,8 @@ struct njs_frame_s {
 
 njs_function_t *njs_function_alloc(njs_vm_t *vm);
 njs_function_t *njs_function_value_copy(njs_vm_t *vm, njs_value_t *value);
+njs_function_t *njs_function_overlay(njs_vm_t *vm, njs_function_t *function,
+    nxt_bool_t copy);
 njs_native_frame_t *njs_function_frame_alloc(njs_vm_t *vm, size_t size);
 njs_ret_t njs_function_prototype_create(njs_vm_t *vm, njs_value_t *value,
     njs_value_t *setval, njs_value_t *retval);
@@ -0,0 +1,118 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+#include <njs_core.h>
+#include <njs_regexp.h>
+#include <njs_core.h>
+#include <string.h>
+
+
+/*
+ * The garbage collector is a conservative mark and sweep collector over
+ * the VM memory cache pool.  The VM structure is allocated in the pool,
+ * so the VM values are the allocations reachable from the VM structure.
+ * The values are not typed in the pool, so any word which points inside
+ * an allocation keeps the allocation alive.
+ *
+ * The collector cannot see pointers held by C code, so the VM is collected
+ * only at the interpreter safe points or by njs_vm_gc() between calls.
+ * The VM memory returned to the host, e.g. the njs_vm_retval_to_ext_string()
+ * strings, is valid only until the VM is run again.
+ * A VM which has been cloned is never collected, because its memory is
+ * shared with the clones.
+ */
+
+static void njs_gc_collect(njs_vm_t *vm);
+
+
+void
+njs_gc_init(njs_vm_t *vm)
+{
+    vm->gc_ticks = NJS_GC_TICKS;
+    vm->gc_trigger = nxt_mem_cache_pool_size(vm->mem_cache_pool)
+                     + vm->gc_threshold;
+}
+
+
+void
+njs_gc_tick(njs_vm_t *vm)
+{
+    vm->gc_ticks = NJS_GC_TICKS;
+
+    if (vm->gc_threshold == 0 || vm->cloned || vm->gc_depth != 1) {
+        return;
+    }
+
+    if (nxt_mem_cache_pool_size(vm->mem_cache_pool) >= vm->gc_trigger) {
+        njs_gc_collect(vm);
+    }
+}
+
+
+nxt_int_t
+njs_vm_gc(njs_vm_t *vm)
+{
+    if (vm->cloned || vm->gc_depth != 0) {
+        return NXT_DECLINED;
+    }
+
+    njs_gc_collect(vm);
+
+    return NXT_OK;
+}
+
+
+void
+njs_vm_gc_threshold_set(njs_vm_t *vm, size_t threshold)
+{
+    vm->gc_threshold = threshold;
+    vm->gc_trigger = nxt_mem_cache_pool_size(vm->mem_cache_pool) + threshold;
+}
+
+
+void
+njs_vm_gc_stats(njs_vm_t *vm, njs_vm_gc_stats_t *stats)
+{
+    *stats = vm->gc_stats;
+
+    stats->size = nxt_mem_cache_pool_size(vm->mem_cache_pool);
+}
+
+
+static void
+njs_gc_collect(njs_vm_t *vm)
+{
+    size_t     size, freed;
+    nxt_int_t  ret;
+
+    /* The property caches may refer to objects which are unreachable. */
+
+    njs_property_cache_flush(vm);
+
+    ret = nxt_mem_cache_mark(vm->mem_cache_pool, &vm, sizeof(njs_vm_t *));
+
+    /* The regexes of unreachable patterns have memory outside the VM. */
+
+    njs_regexp_patterns_sweep(vm);
+
+    freed = nxt_mem_cache_sweep(vm->mem_cache_pool);
+
+    size = nxt_mem_cache_pool_size(vm->mem_cache_pool);
+
+    vm->gc_stats.collections++;
+    vm->gc_stats.freed += freed;
+    vm->gc_stats.live = size;
+
+    if (nxt_slow_path(ret != NXT_OK)) {
+        vm->gc_stats.failures++;
+    }
+
+    /*
+     * The next collection starts after the memory has grown by
+     * the threshold or by a half of the live memory if it is larger,
+     * so the collection time stays proportional to the allocations.
+     */
+
+    vm->gc_trigger = size + nxt_max(vm->gc_threshold, size / 2);
+}
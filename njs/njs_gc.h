@@ -0,0 +1,32 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NJS_GC_H_INCLUDED_
+#define _NJS_GC_H_INCLUDED_
+
+
+/* The number of safe points passed between the VM memory size checks. */
+#define NJS_GC_TICKS           256
+
+
+/*
+ * The safe points are backward jumps and calls of lambda functions, where
+ * all live values are reachable from the VM and no C code holds pointers
+ * to the VM memory.
+ */
+
+#define njs_gc_safe_point(vm)                                                 \
+    do {                                                                      \
+        if (nxt_slow_path(--(vm)->gc_ticks == 0)) {                           \
+            njs_gc_tick(vm);                                                  \
+        }                                                                     \
+    } while (0)
+
+
+void njs_gc_init(njs_vm_t *vm);
+void njs_gc_tick(njs_vm_t *vm);
+
+
+#endif /* _NJS_GC_H_INCLUDED_ */
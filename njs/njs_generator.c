@@ -66,6 +66,8 @@ static nxt_int_t njs_generate_test_jump_expression(njs_vm_t *vm,
     njs_parser_t *parser, njs_parser_node_t *node);
 static nxt_int_t njs_generate_3addr_operation(njs_vm_t *vm,
     njs_parser_t *parser, njs_parser_node_t *node, nxt_bool_t swap);
+static void njs_generate_property_cache(njs_vm_t *vm, njs_vmcode_t *code,
+    njs_parser_node_t *property);
 static nxt_int_t njs_generate_2addr_operation(njs_vm_t *vm,
     njs_parser_t *parser, njs_parser_node_t *node);
 static nxt_int_t njs_generate_typeof_operation(njs_vm_t *vm,
@@ -274,6 +276,12 @@ njs_generator(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
     case NJS_TOKEN_FUNCTION_CONSTRUCTOR:
     case NJS_TOKEN_REGEXP_CONSTRUCTOR:
     case NJS_TOKEN_DATE_CONSTRUCTOR:
+    case NJS_TOKEN_ARRAY_BUFFER_CONSTRUCTOR:
+    case NJS_TOKEN_DATA_VIEW_CONSTRUCTOR:
+    case NJS_TOKEN_UINT8_ARRAY_CONSTRUCTOR:
+    case NJS_TOKEN_UINT16_ARRAY_CONSTRUCTOR:
+    case NJS_TOKEN_UINT32_ARRAY_CONSTRUCTOR:
+    case NJS_TOKEN_FLOAT64_ARRAY_CONSTRUCTOR:
     case NJS_TOKEN_ERROR_CONSTRUCTOR:
     case NJS_TOKEN_EVAL_ERROR_CONSTRUCTOR:
     case NJS_TOKEN_INTERNAL_ERROR_CONSTRUCTOR:
@@ -1411,6 +1419,8 @@ njs_generate_assignment(njs_vm_t *vm, njs_parser_t *parser,
     prop_set->object = object->index;
     prop_set->property = property->index;
 
+    njs_generate_property_cache(vm, &prop_set->code, property);
+
     node->index = expr->index;
     node->temporary = expr->temporary;
 
@@ -1516,6 +1526,8 @@ njs_generate_operation_assignment(njs_vm_t *vm, njs_parser_t *parser,
     prop_get->object = object->index;
     prop_get->property = property->index;
 
+    njs_generate_property_cache(vm, &prop_get->code, property);
+
     expr = node->right;
 
     ret = njs_generator(vm, parser, expr);
@@ -1539,6 +1551,8 @@ njs_generate_operation_assignment(njs_vm_t *vm, njs_parser_t *parser,
     prop_set->object = object->index;
     prop_set->property = property->index;
 
+    njs_generate_property_cache(vm, &prop_set->code, property);
+
     ret = njs_generator_children_indexes_release(vm, parser, lvalue);
     if (nxt_slow_path(ret != NXT_OK)) {
         return ret;
@@ -1761,6 +1775,10 @@ njs_generate_3addr_operation(njs_vm_t *vm, njs_parser_t *parser,
         code->src2 = left->index;
     }
 
+    if (node->token == NJS_TOKEN_PROPERTY) {
+        njs_generate_property_cache(vm, &code->code, right);
+    }
+
     /*
      * The temporary index of MOVE destination
      * will be released here as index of node->left.
@@ -1939,6 +1957,8 @@ found:
     prop_get->object = lvalue->left->index;
     prop_get->property = lvalue->right->index;
 
+    njs_generate_property_cache(vm, &prop_get->code, lvalue->right);
+
     njs_generate_code(parser, njs_vmcode_3addr_t, code);
     code->code.operation = node->u.operation;
     code->code.operands = NJS_VMCODE_3OPERANDS;
@@ -1955,6 +1975,8 @@ found:
     prop_set->object = lvalue->left->index;
     prop_set->property = lvalue->right->index;
 
+    njs_generate_property_cache(vm, &prop_set->code, lvalue->right);
+
     if (post) {
         ret = njs_generator_index_release(vm, parser, index);
         if (nxt_slow_path(ret != NXT_OK)) {
@@ -1966,6 +1988,21 @@ found:
 }
 
 
+static void
+njs_generate_property_cache(njs_vm_t *vm, njs_vmcode_t *code,
+    njs_parser_node_t *property)
+{
+    /* Only property operations with constant names are cached. */
+
+    if (property->token == NJS_TOKEN_STRING) {
+        code->cache = ++vm->property_cache_slots;
+
+    } else {
+        code->cache = 0;
+    }
+}
+
+
 static nxt_int_t
 njs_generate_function_declaration(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node)
@@ -2027,6 +2064,7 @@ njs_generate_function_scope(njs_vm_t *vm, njs_function_lambda_t *lambda,
         lambda->local_size = parser->scope_size;
         lambda->local_scope = parser->local_scope;
         lambda->u.start = parser->code_start;
+        lambda->end = parser->code_end;
     }
 
     return ret;
@@ -2070,6 +2108,17 @@ njs_generate_scope(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
         return NXT_ERROR;
     }
 
+#if (NXT_HAVE_COMPUTED_GOTO)
+
+    if (nxt_slow_path(njs_vmcode_opcodes(vm, parser->code_start,
+                                         parser->code_end)
+                      != NXT_OK))
+    {
+        return NXT_ERROR;
+    }
+
+#endif
+
     scope_size = njs_scope_offset(scope->next_index[0]);
 
     if (scope->type == NJS_SCOPE_GLOBAL) {
@@ -0,0 +1,1318 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <njs_core.h>
+#include <string.h>
+
+#if (NXT_JIT)
+
+#include <sys/mman.h>
+
+
+/*
+ * The baseline JIT compiler translates the bytecode of a lambda to x86-64
+ * machine code once the lambda has been called vm->shared->jit_threshold
+ * times.  The lambdas are created by the VM which compiles the script, so
+ * all clones of the VM call the same machine code.
+ *
+ * Every bytecode instruction is translated separately.  The frequent
+ * numeric and branch operations are inlined with the same fast paths as
+ * in the interpreter, the other operations call their handlers.  Values
+ * are not kept in registers, so the VM state after each instruction is
+ * the same as in the interpreter.  The machine code returns to the
+ * interpreter on calls and returns, traps and exceptions, and on
+ * NXT_AGAIN or NJS_STOP; njs_vmcode_jit_exit() finishes the instruction
+ * as the interpreter does.  A lambda which contains an unknown operation
+ * is not compiled.
+ *
+ * The native code is called with the System V ABI and keeps the VM
+ * in rbx.  The code of a lambda is allocated in a single mapping:
+ *
+ *   njs_jit_code_t   the header, the entry trampoline and the call sites,
+ *   hot code         the instructions in bytecode order,
+ *   cold code        the slow paths, the trampoline entries and exits.
+ */
+
+
+typedef enum {
+    NJS_JIT_GENERIC = 0,
+    NJS_JIT_MOVE,
+    NJS_JIT_JUMP,
+    NJS_JIT_IF_TRUE_JUMP,
+    NJS_JIT_IF_FALSE_JUMP,
+    NJS_JIT_ADDITION,
+    NJS_JIT_SUBSTRACTION,
+    NJS_JIT_MULTIPLICATION,
+    NJS_JIT_DIVISION,
+    NJS_JIT_LESS,
+    NJS_JIT_LESS_OR_EQUAL,
+    NJS_JIT_GREATER,
+    NJS_JIT_GREATER_OR_EQUAL,
+    NJS_JIT_STRICT_EQUAL,
+    NJS_JIT_STRICT_NOT_EQUAL,
+    NJS_JIT_INCREMENT,
+    NJS_JIT_DECREMENT,
+    NJS_JIT_POST_INCREMENT,
+    NJS_JIT_POST_DECREMENT,
+    NJS_JIT_CALL,
+} njs_jit_kind_t;
+
+
+typedef struct {
+    njs_vmcode_operation_t     operation;
+    size_t                     size;
+    njs_jit_kind_t             kind;
+    /* The offset of the jump offset field or 0. */
+    size_t                     offset;
+} njs_jit_operation_t;
+
+
+typedef struct {
+    u_char                     *rel;
+    u_char                     *target;
+} njs_jit_patch_t;
+
+
+typedef struct {
+    u_char                     *p;
+    u_char                     *hot;
+    u_char                     *cold;
+    u_char                     *epilogue;
+
+    u_char                     *start;
+    u_char                     *end;
+
+    /* The native code of the bytecode instructions by 8-byte slots. */
+    u_char                     **labels;
+    uint8_t                    *boundary;
+
+    njs_jit_patch_t            *patches;
+    nxt_uint_t                 npatches;
+} njs_jit_t;
+
+
+/* The maximum machine code sizes of a bytecode instruction. */
+#define NJS_JIT_HOT_SIZE       384
+#define NJS_JIT_COLD_SIZE      256
+
+
+#define NJS_JIT_RAX            0
+#define NJS_JIT_RCX            1
+#define NJS_JIT_RDX            2
+#define NJS_JIT_RBX            3
+#define NJS_JIT_RSI            6
+#define NJS_JIT_RDI            7
+
+#define NJS_JIT_AE             0x3
+#define NJS_JIT_E              0x4
+#define NJS_JIT_NE             0x5
+#define NJS_JIT_A              0x7
+#define NJS_JIT_S              0x8
+
+#define NJS_JIT_ADDSD          0x58
+#define NJS_JIT_MULSD          0x59
+#define NJS_JIT_SUBSD          0x5c
+#define NJS_JIT_DIVSD          0x5e
+
+
+#define njs_jit_byte(jit, c)                                                  \
+    *(jit)->p++ = (u_char) (c)
+
+
+#define njs_jit_slot(jit, code)                                               \
+    (((u_char *) (code) - (jit)->start) / sizeof(uintptr_t))
+
+
+static nxt_int_t njs_jit_compile(njs_vm_t *vm, njs_function_lambda_t *lambda);
+static const njs_jit_operation_t *njs_jit_operation(njs_vmcode_t *code);
+static nxt_int_t njs_jit_instruction(njs_jit_t *jit, u_char *code,
+    const njs_jit_operation_t *op, njs_jit_call_t *call);
+static void njs_jit_generic(njs_jit_t *jit, u_char *code, u_char *exec,
+    const njs_jit_operation_t *op);
+static void njs_jit_number(njs_jit_t *jit, njs_vmcode_3addr_t *code,
+    const njs_jit_operation_t *op);
+static void njs_jit_compare(njs_jit_t *jit, njs_vmcode_3addr_t *code,
+    const njs_jit_operation_t *op);
+static void njs_jit_incdec(njs_jit_t *jit, njs_vmcode_3addr_t *code,
+    const njs_jit_operation_t *op);
+static void njs_jit_boolean(njs_jit_t *jit, nxt_uint_t reg);
+static void njs_jit_number_store(njs_jit_t *jit, nxt_uint_t reg,
+    nxt_uint_t xmm);
+static nxt_bool_t njs_jit_target(njs_jit_t *jit, u_char *target);
+static void njs_jit_branch(njs_jit_t *jit, u_char *code, u_char *target);
+static u_char *njs_jit_cold(njs_jit_t *jit);
+static void njs_jit_hot(njs_jit_t *jit, u_char *hot);
+static void njs_jit_operand(njs_jit_t *jit, nxt_uint_t reg, njs_index_t index);
+static void njs_jit_mov_imm(njs_jit_t *jit, nxt_uint_t reg, uintptr_t imm);
+static void njs_jit_modrm(njs_jit_t *jit, nxt_uint_t reg, nxt_uint_t base,
+    intptr_t disp);
+static void njs_jit_load(njs_jit_t *jit, nxt_uint_t reg, nxt_uint_t base,
+    intptr_t disp);
+static void njs_jit_store(njs_jit_t *jit, nxt_uint_t base, intptr_t disp,
+    nxt_uint_t reg);
+static void njs_jit_sse(njs_jit_t *jit, u_char prefix, u_char op,
+    nxt_uint_t xmm, nxt_uint_t base, intptr_t disp);
+static void njs_jit_sse_rr(njs_jit_t *jit, u_char prefix, u_char op,
+    nxt_uint_t dst, nxt_uint_t src);
+static void njs_jit_cmp_byte(njs_jit_t *jit, nxt_uint_t base, intptr_t disp,
+    u_char imm);
+static void njs_jit_cmp_rax(njs_jit_t *jit, intptr_t imm);
+static void njs_jit_call(njs_jit_t *jit, void *function);
+static u_char *njs_jit_jcc(njs_jit_t *jit, nxt_uint_t cc);
+static u_char *njs_jit_jmp(njs_jit_t *jit);
+static void njs_jit_patch(njs_jit_t *jit, u_char *rel, u_char *target);
+static void njs_jit_link(u_char *rel, u_char *target);
+
+
+static const njs_jit_operation_t  njs_jit_operations[] = {
+
+    { njs_vmcode_object, sizeof(njs_vmcode_object_t), NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_array, sizeof(njs_vmcode_array_t), NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_function, sizeof(njs_vmcode_function_t), NJS_JIT_GENERIC,
+      0 },
+    { njs_vmcode_regexp, sizeof(njs_vmcode_regexp_t), NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_object_copy, sizeof(njs_vmcode_object_copy_t),
+      NJS_JIT_GENERIC, 0 },
+
+    { njs_vmcode_property_get, sizeof(njs_vmcode_prop_get_t),
+      NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_property_set, sizeof(njs_vmcode_prop_set_t),
+      NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_property_in, sizeof(njs_vmcode_3addr_t), NJS_JIT_GENERIC,
+      0 },
+    { njs_vmcode_property_delete, sizeof(njs_vmcode_3addr_t),
+      NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_property_foreach, sizeof(njs_vmcode_prop_foreach_t),
+      NJS_JIT_GENERIC, offsetof(njs_vmcode_prop_foreach_t, offset) },
+    { njs_vmcode_property_next, sizeof(njs_vmcode_prop_next_t),
+      NJS_JIT_GENERIC, offsetof(njs_vmcode_prop_next_t, offset) },
+    { njs_vmcode_instance_of, sizeof(njs_vmcode_instance_of_t),
+      NJS_JIT_GENERIC, 0 },
+
+    { njs_vmcode_increment, sizeof(njs_vmcode_3addr_t), NJS_JIT_INCREMENT,
+      0 },
+    { njs_vmcode_decrement, sizeof(njs_vmcode_3addr_t), NJS_JIT_DECREMENT,
+      0 },
+    { njs_vmcode_post_increment, sizeof(njs_vmcode_3addr_t),
+      NJS_JIT_POST_INCREMENT, 0 },
+    { njs_vmcode_post_decrement, sizeof(njs_vmcode_3addr_t),
+      NJS_JIT_POST_DECREMENT, 0 },
+
+    { njs_vmcode_typeof, sizeof(njs_vmcode_2addr_t), NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_void, sizeof(njs_vmcode_2addr_t), NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_delete, sizeof(njs_vmcode_2addr_t), NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_unary_plus, sizeof(njs_vmcode_2addr_t), NJS_JIT_GENERIC,
+      0 },
+    { njs_vmcode_unary_negation, sizeof(njs_vmcode_2addr_t),
+      NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_logical_not, sizeof(njs_vmcode_2addr_t), NJS_JIT_GENERIC,
+      0 },
+    { njs_vmcode_bitwise_not, sizeof(njs_vmcode_2addr_t), NJS_JIT_GENERIC,
+      0 },
+
+    { njs_vmcode_addition, sizeof(njs_vmcode_3addr_t), NJS_JIT_ADDITION, 0 },
+    { njs_vmcode_substraction, sizeof(njs_vmcode_3addr_t),
+      NJS_JIT_SUBSTRACTION, 0 },
+    { njs_vmcode_multiplication, sizeof(njs_vmcode_3addr_t),
+      NJS_JIT_MULTIPLICATION, 0 },
+    { njs_vmcode_exponentiation, sizeof(njs_vmcode_3addr_t),
+      NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_division, sizeof(njs_vmcode_3addr_t), NJS_JIT_DIVISION, 0 },
+    { njs_vmcode_remainder, sizeof(njs_vmcode_3addr_t), NJS_JIT_GENERIC, 0 },
+
+    { njs_vmcode_bitwise_and, sizeof(njs_vmcode_3addr_t), NJS_JIT_GENERIC,
+      0 },
+    { njs_vmcode_bitwise_xor, sizeof(njs_vmcode_3addr_t), NJS_JIT_GENERIC,
+      0 },
+    { njs_vmcode_bitwise_or, sizeof(njs_vmcode_3addr_t), NJS_JIT_GENERIC,
+      0 },
+    { njs_vmcode_left_shift, sizeof(njs_vmcode_3addr_t), NJS_JIT_GENERIC,
+      0 },
+    { njs_vmcode_right_shift, sizeof(njs_vmcode_3addr_t), NJS_JIT_GENERIC,
+      0 },
+    { njs_vmcode_unsigned_right_shift, sizeof(njs_vmcode_3addr_t),
+      NJS_JIT_GENERIC, 0 },
+
+    { njs_vmcode_equal, sizeof(njs_vmcode_3addr_t), NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_not_equal, sizeof(njs_vmcode_3addr_t), NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_less, sizeof(njs_vmcode_3addr_t), NJS_JIT_LESS, 0 },
+    { njs_vmcode_less_or_equal, sizeof(njs_vmcode_3addr_t),
+      NJS_JIT_LESS_OR_EQUAL, 0 },
+    { njs_vmcode_greater, sizeof(njs_vmcode_3addr_t), NJS_JIT_GREATER, 0 },
+    { njs_vmcode_greater_or_equal, sizeof(njs_vmcode_3addr_t),
+      NJS_JIT_GREATER_OR_EQUAL, 0 },
+    { njs_vmcode_strict_equal, sizeof(njs_vmcode_3addr_t),
+      NJS_JIT_STRICT_EQUAL, 0 },
+    { njs_vmcode_strict_not_equal, sizeof(njs_vmcode_3addr_t),
+      NJS_JIT_STRICT_NOT_EQUAL, 0 },
+
+    { njs_vmcode_test_if_true, sizeof(njs_vmcode_test_jump_t),
+      NJS_JIT_GENERIC, offsetof(njs_vmcode_test_jump_t, offset) },
+    { njs_vmcode_test_if_false, sizeof(njs_vmcode_test_jump_t),
+      NJS_JIT_GENERIC, offsetof(njs_vmcode_test_jump_t, offset) },
+
+    { njs_vmcode_move, sizeof(njs_vmcode_move_t), NJS_JIT_MOVE, 0 },
+    { njs_vmcode_jump, sizeof(njs_vmcode_jump_t), NJS_JIT_JUMP,
+      offsetof(njs_vmcode_jump_t, offset) },
+    { njs_vmcode_if_true_jump, sizeof(njs_vmcode_cond_jump_t),
+      NJS_JIT_IF_TRUE_JUMP, offsetof(njs_vmcode_cond_jump_t, offset) },
+    { njs_vmcode_if_false_jump, sizeof(njs_vmcode_cond_jump_t),
+      NJS_JIT_IF_FALSE_JUMP, offsetof(njs_vmcode_cond_jump_t, offset) },
+    { njs_vmcode_if_equal_jump, sizeof(njs_vmcode_equal_jump_t),
+      NJS_JIT_GENERIC, offsetof(njs_vmcode_equal_jump_t, offset) },
+
+    { njs_vmcode_function_frame, sizeof(njs_vmcode_function_frame_t),
+      NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_method_frame, sizeof(njs_vmcode_method_frame_t),
+      NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_function_call, sizeof(njs_vmcode_function_call_t),
+      NJS_JIT_CALL, 0 },
+    { njs_vmcode_return, sizeof(njs_vmcode_return_t), NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_stop, sizeof(njs_vmcode_stop_t), NJS_JIT_GENERIC, 0 },
+
+    { njs_vmcode_try_start, sizeof(njs_vmcode_try_start_t), NJS_JIT_GENERIC,
+      offsetof(njs_vmcode_try_start_t, offset) },
+    { njs_vmcode_try_end, sizeof(njs_vmcode_try_end_t), NJS_JIT_GENERIC,
+      offsetof(njs_vmcode_try_end_t, offset) },
+    { njs_vmcode_throw, sizeof(njs_vmcode_throw_t), NJS_JIT_GENERIC, 0 },
+    { njs_vmcode_catch, sizeof(njs_vmcode_catch_t), NJS_JIT_GENERIC,
+      offsetof(njs_vmcode_catch_t, offset) },
+    { njs_vmcode_finally, sizeof(njs_vmcode_finally_t), NJS_JIT_GENERIC, 0 },
+};
+
+
+u_char *
+njs_jit_count(njs_vm_t *vm, njs_function_lambda_t *lambda)
+{
+    if (lambda->calls < vm->shared->jit_threshold) {
+        lambda->calls++;
+
+        /* A lambda which cannot be compiled is not compiled again. */
+
+        if (lambda->calls == vm->shared->jit_threshold
+            && njs_jit_compile(vm, lambda) == NXT_OK)
+        {
+            return (u_char *) &lambda->jit->start;
+        }
+    }
+
+    return lambda->u.start;
+}
+
+
+void
+njs_jit_free(njs_vm_shared_t *shared)
+{
+    njs_jit_code_t  *code, *next;
+
+    for (code = shared->jit_code; code != NULL; code = next) {
+        next = code->next;
+        (void) munmap(code, code->size);
+    }
+
+    shared->jit_code = NULL;
+}
+
+
+njs_ret_t
+njs_vmcode_jit(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2,
+    njs_value_t *unused)
+{
+    njs_vmcode_jit_t  *code;
+
+    code = (njs_vmcode_jit_t *) vm->current;
+
+    return code->native(vm);
+}
+
+
+static nxt_int_t
+njs_jit_compile(njs_vm_t *vm, njs_function_lambda_t *lambda)
+{
+    u_char                     *p, *code, *mem, *hot_end, *cold_end;
+    size_t                     size, slots, hot, cold;
+    nxt_int_t                  ret;
+    nxt_uint_t                 n, ncalls;
+    njs_jit_t                  jit;
+    njs_jit_call_t             *call;
+    njs_jit_code_t             *jc;
+    const njs_jit_operation_t  *op;
+
+    if (lambda->end == NULL) {
+        return NXT_DECLINED;
+    }
+
+    n = 0;
+    ncalls = 0;
+
+    for (p = lambda->u.start; p < lambda->end; p += op->size) {
+        op = njs_jit_operation((njs_vmcode_t *) p);
+        if (op == NULL) {
+            return NXT_DECLINED;
+        }
+
+        if (op->kind == NJS_JIT_CALL) {
+            ncalls++;
+        }
+
+        n++;
+    }
+
+    if (p != lambda->end) {
+        return NXT_DECLINED;
+    }
+
+    slots = (lambda->end - lambda->u.start) / sizeof(uintptr_t) + 1;
+
+    size = slots * (sizeof(u_char *) + sizeof(uint8_t))
+           + 2 * (n + 1) * sizeof(njs_jit_patch_t);
+
+    mem = nxt_mem_cache_zalign(vm->mem_cache_pool, sizeof(void *), size);
+    if (nxt_slow_path(mem == NULL)) {
+        return NXT_ERROR;
+    }
+
+    jit.labels = (u_char **) mem;
+    jit.patches = (njs_jit_patch_t *) (mem + slots * sizeof(u_char *));
+    jit.boundary = (uint8_t *) (jit.patches + 2 * (n + 1));
+    jit.npatches = 0;
+
+    jit.start = lambda->u.start;
+    jit.end = lambda->end;
+
+    for (p = jit.start; p < jit.end; p += op->size) {
+        op = njs_jit_operation((njs_vmcode_t *) p);
+        jit.boundary[njs_jit_slot(&jit, p)] = 1;
+    }
+
+    hot = nxt_align_size((n + 1) * NJS_JIT_HOT_SIZE, 64);
+    cold = (n + 1) * NJS_JIT_COLD_SIZE;
+
+    size = nxt_align_size(sizeof(njs_jit_code_t)
+                          + ncalls * sizeof(njs_jit_call_t), 64);
+
+    size = nxt_align_size(size + hot + cold, nxt_pagesize());
+
+    jc = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+              -1, 0);
+
+    if (nxt_slow_path(jc == MAP_FAILED)) {
+        nxt_mem_cache_free(vm->mem_cache_pool, mem);
+        return NXT_ERROR;
+    }
+
+    jc->size = size;
+
+    jc->start.code.operation = njs_vmcode_jit;
+    jc->start.code.operands = NJS_VMCODE_NO_OPERAND;
+    jc->start.code.retval = NJS_VMCODE_NO_RETVAL;
+
+    jit.hot = (u_char *) jc + nxt_align_size(sizeof(njs_jit_code_t)
+                                             + ncalls * sizeof(njs_jit_call_t),
+                                             64);
+    jit.cold = jit.hot + hot;
+
+    hot_end = jit.cold;
+    cold_end = (u_char *) jc + size;
+
+    /* The shared epilogue: pop rbx; ret. */
+
+    jit.p = jit.cold;
+    jit.epilogue = jit.p;
+    njs_jit_byte(&jit, 0x5b);
+    njs_jit_byte(&jit, 0xc3);
+    jit.cold = jit.p;
+
+    /* The entry: push rbx; mov rbx, rdi. */
+
+    jit.p = jit.hot;
+    jc->start.native = (njs_jit_native_t) jit.p;
+    njs_jit_byte(&jit, 0x53);
+    njs_jit_byte(&jit, 0x48);
+    njs_jit_byte(&jit, 0x89);
+    njs_jit_byte(&jit, 0xfb);
+
+    call = jc->calls;
+    ret = NXT_OK;
+
+    for (code = jit.start; code < jit.end; code += op->size) {
+        op = njs_jit_operation((njs_vmcode_t *) code);
+
+        jit.labels[njs_jit_slot(&jit, code)] = jit.p;
+
+        ret = njs_jit_instruction(&jit, code, op, call);
+        if (ret != NXT_OK) {
+            break;
+        }
+
+        if (op->kind == NJS_JIT_CALL) {
+            call++;
+        }
+
+        if (nxt_slow_path(jit.p > hot_end || jit.cold > cold_end)) {
+            ret = NXT_ERROR;
+            break;
+        }
+    }
+
+    if (ret == NXT_OK) {
+        /* The code after the last instruction continues in the interpreter. */
+
+        jit.labels[njs_jit_slot(&jit, jit.end)] = jit.p;
+
+        njs_jit_mov_imm(&jit, NJS_JIT_RAX, (uintptr_t) jit.end);
+        njs_jit_store(&jit, NJS_JIT_RBX, offsetof(njs_vm_t, current),
+                      NJS_JIT_RAX);
+
+        /* xor eax, eax */
+        njs_jit_byte(&jit, 0x31);
+        njs_jit_byte(&jit, 0xc0);
+
+        njs_jit_link(njs_jit_jmp(&jit), jit.epilogue);
+
+        for (n = 0; n < jit.npatches; n++) {
+            njs_jit_link(jit.patches[n].rel,
+                         jit.labels[njs_jit_slot(&jit, jit.patches[n].target)]);
+        }
+
+        jc->next = vm->shared->jit_code;
+
+        if (mprotect(jc, size, PROT_READ | PROT_EXEC) != 0) {
+            ret = NXT_ERROR;
+        }
+    }
+
+    nxt_mem_cache_free(vm->mem_cache_pool, mem);
+
+    if (ret != NXT_OK) {
+        (void) munmap(jc, size);
+        return ret;
+    }
+
+    vm->shared->jit_code = jc;
+    lambda->jit = jc;
+
+    return NXT_OK;
+}
+
+
+static const njs_jit_operation_t *
+njs_jit_operation(njs_vmcode_t *code)
+{
+    nxt_uint_t  i;
+
+    for (i = 0; i < nxt_nitems(njs_jit_operations); i++) {
+        if (njs_jit_operations[i].operation == code->operation) {
+            return &njs_jit_operations[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+static nxt_int_t
+njs_jit_instruction(njs_jit_t *jit, u_char *code, const njs_jit_operation_t *op,
+    njs_jit_call_t *call)
+{
+    u_char                  *rel, *target, *hot;
+    njs_vmcode_t            *vmcode;
+    njs_vmcode_move_t       *move;
+    njs_vmcode_cond_jump_t  *cond_jump;
+
+    vmcode = (njs_vmcode_t *) code;
+
+    switch (op->kind) {
+
+    case NJS_JIT_MOVE:
+        if (vmcode->operands != NJS_VMCODE_2OPERANDS
+            || vmcode->retval != NJS_VMCODE_RETVAL)
+        {
+            break;
+        }
+
+        move = (njs_vmcode_move_t *) code;
+
+        njs_jit_operand(jit, NJS_JIT_RSI, move->src);
+        njs_jit_operand(jit, NJS_JIT_RDI, move->dst);
+
+        njs_jit_sse(jit, 0xf3, 0x6f, 0, NJS_JIT_RSI, 0);
+        njs_jit_sse(jit, 0xf3, 0x7f, 0, NJS_JIT_RDI, 0);
+
+        /* njs_retain(). */
+
+        njs_jit_cmp_byte(jit, NJS_JIT_RSI, offsetof(njs_value_t, data.truth),
+                         NJS_STRING_LONG);
+        rel = njs_jit_jcc(jit, NJS_JIT_NE);
+
+        /* mov rdi, rsi */
+        njs_jit_byte(jit, 0x48);
+        njs_jit_byte(jit, 0x89);
+        njs_jit_byte(jit, 0xf7);
+
+        njs_jit_call(jit, njs_value_retain);
+
+        njs_jit_link(rel, jit->p);
+
+        return NXT_OK;
+
+    case NJS_JIT_JUMP:
+        target = code + ((njs_vmcode_jump_t *) code)->offset;
+
+        if (!njs_jit_target(jit, target)) {
+            break;
+        }
+
+        njs_jit_branch(jit, code, target);
+
+        return NXT_OK;
+
+    case NJS_JIT_IF_TRUE_JUMP:
+    case NJS_JIT_IF_FALSE_JUMP:
+        cond_jump = (njs_vmcode_cond_jump_t *) code;
+        target = code + cond_jump->offset;
+
+        if (vmcode->operands != NJS_VMCODE_2OPERANDS
+            || !njs_jit_target(jit, target))
+        {
+            break;
+        }
+
+        njs_jit_operand(jit, NJS_JIT_RSI, cond_jump->cond);
+        njs_jit_cmp_byte(jit, NJS_JIT_RSI, offsetof(njs_value_t, data.truth),
+                         0);
+
+        if (target > code) {
+            rel = njs_jit_jcc(jit, (op->kind == NJS_JIT_IF_TRUE_JUMP)
+                                   ? NJS_JIT_NE : NJS_JIT_E);
+            njs_jit_patch(jit, rel, target);
+
+        } else {
+            rel = njs_jit_jcc(jit, (op->kind == NJS_JIT_IF_TRUE_JUMP)
+                                   ? NJS_JIT_E : NJS_JIT_NE);
+            njs_jit_branch(jit, code, target);
+            njs_jit_link(rel, jit->p);
+        }
+
+        return NXT_OK;
+
+    case NJS_JIT_ADDITION:
+    case NJS_JIT_SUBSTRACTION:
+    case NJS_JIT_MULTIPLICATION:
+    case NJS_JIT_DIVISION:
+        if (vmcode->operands != NJS_VMCODE_3OPERANDS
+            || vmcode->retval != NJS_VMCODE_RETVAL)
+        {
+            break;
+        }
+
+        njs_jit_number(jit, (njs_vmcode_3addr_t *) code, op);
+
+        return NXT_OK;
+
+    case NJS_JIT_LESS:
+    case NJS_JIT_LESS_OR_EQUAL:
+    case NJS_JIT_GREATER:
+    case NJS_JIT_GREATER_OR_EQUAL:
+    case NJS_JIT_STRICT_EQUAL:
+    case NJS_JIT_STRICT_NOT_EQUAL:
+        if (vmcode->operands != NJS_VMCODE_3OPERANDS
+            || vmcode->retval != NJS_VMCODE_RETVAL)
+        {
+            break;
+        }
+
+        njs_jit_compare(jit, (njs_vmcode_3addr_t *) code, op);
+
+        return NXT_OK;
+
+    case NJS_JIT_INCREMENT:
+    case NJS_JIT_DECREMENT:
+    case NJS_JIT_POST_INCREMENT:
+    case NJS_JIT_POST_DECREMENT:
+        if (vmcode->operands != NJS_VMCODE_3OPERANDS
+            || vmcode->retval != NJS_VMCODE_RETVAL)
+        {
+            break;
+        }
+
+        njs_jit_incdec(jit, (njs_vmcode_3addr_t *) code, op);
+
+        return NXT_OK;
+
+    case NJS_JIT_CALL:
+        /*
+         * The call is executed from its copy, so a called lambda returns
+         * to the trampoline which follows the copy.
+         */
+
+        memcpy(&call->call, code, sizeof(njs_vmcode_function_call_t));
+
+        call->resume.code.operation = njs_vmcode_jit;
+        call->resume.code.operands = NJS_VMCODE_NO_OPERAND;
+        call->resume.code.retval = NJS_VMCODE_NO_RETVAL;
+
+        njs_jit_generic(jit, code, (u_char *) &call->call, op);
+
+        /* The trampoline entry: push rbx; mov rbx, rdi; jmp next. */
+
+        hot = njs_jit_cold(jit);
+
+        call->resume.native = (njs_jit_native_t) jit->p;
+
+        njs_jit_byte(jit, 0x53);
+        njs_jit_byte(jit, 0x48);
+        njs_jit_byte(jit, 0x89);
+        njs_jit_byte(jit, 0xfb);
+
+        njs_jit_patch(jit, njs_jit_jmp(jit), code + op->size);
+
+        njs_jit_hot(jit, hot);
+
+        return NXT_OK;
+
+    default:
+        break;
+    }
+
+    njs_jit_generic(jit, code, code, op);
+
+    return NXT_OK;
+}
+
+
+/*
+ * A generic instruction calls the operation as the interpreter does.
+ * The size of the instruction continues with the next instruction,
+ * the jump offset of the instruction branches to the jump target and
+ * the other results are completed by njs_vmcode_jit_exit() which returns
+ * to the interpreter.
+ */
+
+static void
+njs_jit_generic(njs_jit_t *jit, u_char *code, u_char *exec,
+    const njs_jit_operation_t *op)
+{
+    u_char                *rel, *hot, *target;
+    njs_ret_t             offset;
+    njs_vmcode_generic_t  *vmcode;
+
+    vmcode = (njs_vmcode_generic_t *) code;
+
+    njs_jit_mov_imm(jit, NJS_JIT_RAX, (uintptr_t) exec);
+    njs_jit_store(jit, NJS_JIT_RBX, offsetof(njs_vm_t, current), NJS_JIT_RAX);
+
+    switch (vmcode->code.operands) {
+
+    case NJS_VMCODE_3OPERANDS:
+        njs_jit_operand(jit, NJS_JIT_RDX, vmcode->operand3);
+        njs_jit_operand(jit, NJS_JIT_RSI, vmcode->operand2);
+        break;
+
+    case NJS_VMCODE_2OPERANDS:
+        njs_jit_mov_imm(jit, NJS_JIT_RDX, vmcode->operand1);
+        njs_jit_operand(jit, NJS_JIT_RSI, vmcode->operand2);
+        break;
+
+    default:
+        njs_jit_mov_imm(jit, NJS_JIT_RDX, vmcode->operand1);
+
+        /* xor esi, esi */
+        njs_jit_byte(jit, 0x31);
+        njs_jit_byte(jit, 0xf6);
+        break;
+    }
+
+    if (vmcode->code.retval) {
+        njs_jit_operand(jit, NJS_JIT_RCX, vmcode->operand1);
+
+    } else {
+        /* xor ecx, ecx */
+        njs_jit_byte(jit, 0x31);
+        njs_jit_byte(jit, 0xc9);
+    }
+
+    /* mov rdi, rbx */
+    njs_jit_byte(jit, 0x48);
+    njs_jit_byte(jit, 0x89);
+    njs_jit_byte(jit, 0xdf);
+
+    njs_jit_call(jit, vmcode->code.operation);
+
+    njs_jit_cmp_rax(jit, op->size);
+    rel = njs_jit_jcc(jit, NJS_JIT_NE);
+
+    hot = njs_jit_cold(jit);
+
+    njs_jit_link(rel, jit->p);
+
+    if (op->offset != 0) {
+        offset = *(njs_ret_t *) (code + op->offset);
+        target = code + offset;
+
+        if (njs_jit_target(jit, target) && offset == (int32_t) offset) {
+            njs_jit_cmp_rax(jit, offset);
+            rel = njs_jit_jcc(jit, NJS_JIT_NE);
+
+            njs_jit_branch(jit, code, target);
+
+            njs_jit_link(rel, jit->p);
+        }
+    }
+
+    /* njs_vmcode_jit_exit(vm, ret, exec) */
+
+    /* mov rdi, rbx; mov rsi, rax */
+    njs_jit_byte(jit, 0x48);
+    njs_jit_byte(jit, 0x89);
+    njs_jit_byte(jit, 0xdf);
+    njs_jit_byte(jit, 0x48);
+    njs_jit_byte(jit, 0x89);
+    njs_jit_byte(jit, 0xc6);
+
+    njs_jit_mov_imm(jit, NJS_JIT_RDX, (uintptr_t) exec);
+    njs_jit_call(jit, njs_vmcode_jit_exit);
+
+    njs_jit_link(njs_jit_jmp(jit), jit->epilogue);
+
+    njs_jit_hot(jit, hot);
+}
+
+
+static void
+njs_jit_number(njs_jit_t *jit, njs_vmcode_3addr_t *code,
+    const njs_jit_operation_t *op)
+{
+    u_char  *slow1, *slow2, *done;
+    u_char  instruction;
+
+    switch (op->kind) {
+
+    case NJS_JIT_ADDITION:
+        instruction = NJS_JIT_ADDSD;
+        break;
+
+    case NJS_JIT_SUBSTRACTION:
+        instruction = NJS_JIT_SUBSD;
+        break;
+
+    case NJS_JIT_MULTIPLICATION:
+        instruction = NJS_JIT_MULSD;
+        break;
+
+    default:
+        instruction = NJS_JIT_DIVSD;
+        break;
+    }
+
+    njs_jit_operand(jit, NJS_JIT_RSI, code->src1);
+    njs_jit_operand(jit, NJS_JIT_RDX, code->src2);
+
+    njs_jit_cmp_byte(jit, NJS_JIT_RSI, 0, NJS_NUMBER);
+    slow1 = njs_jit_jcc(jit, NJS_JIT_A);
+    njs_jit_cmp_byte(jit, NJS_JIT_RDX, 0, NJS_NUMBER);
+    slow2 = njs_jit_jcc(jit, NJS_JIT_A);
+
+    njs_jit_sse(jit, 0xf2, 0x10, 0, NJS_JIT_RSI,
+                offsetof(njs_value_t, data.u.number));
+    njs_jit_sse(jit, 0xf2, instruction, 0, NJS_JIT_RDX,
+                offsetof(njs_value_t, data.u.number));
+
+    njs_jit_operand(jit, NJS_JIT_RDI, code->dst);
+    njs_jit_number_store(jit, NJS_JIT_RDI, 0);
+
+    done = njs_jit_jmp(jit);
+
+    njs_jit_link(slow1, jit->p);
+    njs_jit_link(slow2, jit->p);
+
+    njs_jit_generic(jit, (u_char *) code, (u_char *) code, op);
+
+    njs_jit_link(done, jit->p);
+}
+
+
+static void
+njs_jit_compare(njs_jit_t *jit, njs_vmcode_3addr_t *code,
+    const njs_jit_operation_t *op)
+{
+    u_char      *slow1, *slow2, *done;
+    nxt_uint_t  x, y, cc;
+
+    njs_jit_operand(jit, NJS_JIT_RSI, code->src1);
+    njs_jit_operand(jit, NJS_JIT_RDX, code->src2);
+
+    if (op->kind == NJS_JIT_STRICT_EQUAL
+        || op->kind == NJS_JIT_STRICT_NOT_EQUAL)
+    {
+        /*
+         * njs_values_strict_equal(vm, value1, value2) fails only if
+         * a rope cannot be flattened, the generic operation then
+         * reports the memory error.
+         */
+
+        /* mov rdi, rbx */
+        njs_jit_byte(jit, 0x48);
+        njs_jit_byte(jit, 0x89);
+        njs_jit_byte(jit, 0xdf);
+
+        njs_jit_call(jit, njs_values_strict_equal);
+
+        /* test rax, rax */
+        njs_jit_byte(jit, 0x48);
+        njs_jit_byte(jit, 0x85);
+        njs_jit_byte(jit, 0xc0);
+
+        slow1 = njs_jit_jcc(jit, NJS_JIT_S);
+
+        /* setcc al */
+        njs_jit_byte(jit, 0x0f);
+        njs_jit_byte(jit, 0x90 | ((op->kind == NJS_JIT_STRICT_EQUAL)
+                                  ? NJS_JIT_NE : NJS_JIT_E));
+        njs_jit_byte(jit, 0xc0);
+
+        njs_jit_operand(jit, NJS_JIT_RDI, code->dst);
+        njs_jit_boolean(jit, NJS_JIT_RDI);
+
+        done = njs_jit_jmp(jit);
+
+        njs_jit_link(slow1, jit->p);
+
+        njs_jit_generic(jit, (u_char *) code, (u_char *) code, op);
+
+        njs_jit_link(done, jit->p);
+
+        return;
+    }
+
+    njs_jit_cmp_byte(jit, NJS_JIT_RSI, 0, NJS_NUMBER);
+    slow1 = njs_jit_jcc(jit, NJS_JIT_A);
+    njs_jit_cmp_byte(jit, NJS_JIT_RDX, 0, NJS_NUMBER);
+    slow2 = njs_jit_jcc(jit, NJS_JIT_A);
+
+    /*
+     * "a < b" is "b > a": the unordered result of NaN operands sets
+     * the carry flag, so "above" and "above or equal" are false.
+     */
+
+    x = NJS_JIT_RSI;
+    y = NJS_JIT_RDX;
+    cc = NJS_JIT_A;
+
+    switch (op->kind) {
+
+    case NJS_JIT_LESS:
+        x = NJS_JIT_RDX;
+        y = NJS_JIT_RSI;
+        break;
+
+    case NJS_JIT_LESS_OR_EQUAL:
+        x = NJS_JIT_RDX;
+        y = NJS_JIT_RSI;
+        cc = NJS_JIT_AE;
+        break;
+
+    case NJS_JIT_GREATER_OR_EQUAL:
+        cc = NJS_JIT_AE;
+        break;
+
+    default:
+        break;
+    }
+
+    njs_jit_sse(jit, 0xf2, 0x10, 0, x, offsetof(njs_value_t, data.u.number));
+    njs_jit_sse(jit, 0xf2, 0x10, 1, y, offsetof(njs_value_t, data.u.number));
+
+    /* ucomisd xmm0, xmm1 */
+    njs_jit_sse_rr(jit, 0x66, 0x2e, 0, 1);
+
+    /* setcc al */
+    njs_jit_byte(jit, 0x0f);
+    njs_jit_byte(jit, 0x90 | cc);
+    njs_jit_byte(jit, 0xc0);
+
+    njs_jit_operand(jit, NJS_JIT_RDI, code->dst);
+    njs_jit_boolean(jit, NJS_JIT_RDI);
+
+    done = njs_jit_jmp(jit);
+
+    njs_jit_link(slow1, jit->p);
+    njs_jit_link(slow2, jit->p);
+
+    njs_jit_generic(jit, (u_char *) code, (u_char *) code, op);
+
+    njs_jit_link(done, jit->p);
+}
+
+
+static void
+njs_jit_incdec(njs_jit_t *jit, njs_vmcode_3addr_t *code,
+    const njs_jit_operation_t *op)
+{
+    u_char      *slow1, *slow2, *done;
+    u_char      instruction;
+    nxt_bool_t  post;
+
+    instruction = (op->kind == NJS_JIT_INCREMENT
+                   || op->kind == NJS_JIT_POST_INCREMENT)
+                  ? NJS_JIT_ADDSD : NJS_JIT_SUBSD;
+
+    post = (op->kind == NJS_JIT_POST_INCREMENT
+            || op->kind == NJS_JIT_POST_DECREMENT);
+
+    /* The variable in value1 is released by the operation handler. */
+
+    njs_jit_operand(jit, NJS_JIT_RSI, code->src1);
+    njs_jit_operand(jit, NJS_JIT_RDX, code->src2);
+
+    njs_jit_cmp_byte(jit, NJS_JIT_RDX, 0, NJS_NUMBER);
+    slow1 = njs_jit_jcc(jit, NJS_JIT_A);
+    njs_jit_cmp_byte(jit, NJS_JIT_RSI, offsetof(njs_value_t, data.truth),
+                     NJS_STRING_LONG);
+    slow2 = njs_jit_jcc(jit, NJS_JIT_E);
+
+    /* mov eax, 0x3ff00000; shl rax, 32; movq xmm1, rax: 1.0. */
+    njs_jit_byte(jit, 0xb8);
+    njs_jit_byte(jit, 0x00);
+    njs_jit_byte(jit, 0x00);
+    njs_jit_byte(jit, 0xf0);
+    njs_jit_byte(jit, 0x3f);
+    njs_jit_byte(jit, 0x48);
+    njs_jit_byte(jit, 0xc1);
+    njs_jit_byte(jit, 0xe0);
+    njs_jit_byte(jit, 0x20);
+    njs_jit_byte(jit, 0x66);
+    njs_jit_byte(jit, 0x48);
+    njs_jit_byte(jit, 0x0f);
+    njs_jit_byte(jit, 0x6e);
+    njs_jit_byte(jit, 0xc8);
+
+    njs_jit_sse(jit, 0xf2, 0x10, 0, NJS_JIT_RDX,
+                offsetof(njs_value_t, data.u.number));
+
+    njs_jit_operand(jit, NJS_JIT_RDI, code->dst);
+
+    if (post) {
+        /* movapd xmm2, xmm0 */
+        njs_jit_sse_rr(jit, 0x66, 0x28, 2, 0);
+        njs_jit_sse_rr(jit, 0xf2, instruction, 2, 1);
+
+        njs_jit_number_store(jit, NJS_JIT_RSI, 2);
+        njs_jit_number_store(jit, NJS_JIT_RDI, 0);
+
+    } else {
+        njs_jit_sse_rr(jit, 0xf2, instruction, 0, 1);
+
+        njs_jit_number_store(jit, NJS_JIT_RSI, 0);
+
+        njs_jit_sse(jit, 0xf3, 0x6f, 0, NJS_JIT_RSI, 0);
+        njs_jit_sse(jit, 0xf3, 0x7f, 0, NJS_JIT_RDI, 0);
+    }
+
+    done = njs_jit_jmp(jit);
+
+    njs_jit_link(slow1, jit->p);
+    njs_jit_link(slow2, jit->p);
+
+    njs_jit_generic(jit, (u_char *) code, (u_char *) code, op);
+
+    njs_jit_link(done, jit->p);
+}
+
+
+/* Stores njs_value_true or njs_value_false by al to the value in reg. */
+
+static void
+njs_jit_boolean(njs_jit_t *jit, nxt_uint_t reg)
+{
+    njs_jit_mov_imm(jit, NJS_JIT_RCX, (uintptr_t) &njs_value_false);
+    njs_jit_mov_imm(jit, NJS_JIT_RDX, (uintptr_t) &njs_value_true);
+
+    /* test al, al; cmovne rcx, rdx */
+    njs_jit_byte(jit, 0x84);
+    njs_jit_byte(jit, 0xc0);
+    njs_jit_byte(jit, 0x48);
+    njs_jit_byte(jit, 0x0f);
+    njs_jit_byte(jit, 0x40 | NJS_JIT_NE);
+    njs_jit_byte(jit, 0xca);
+
+    njs_jit_sse(jit, 0xf3, 0x6f, 0, NJS_JIT_RCX, 0);
+    njs_jit_sse(jit, 0xf3, 0x7f, 0, reg, 0);
+}
+
+
+/* njs_value_number_set() of the number in xmm to the value in reg. */
+
+static void
+njs_jit_number_store(njs_jit_t *jit, nxt_uint_t reg, nxt_uint_t xmm)
+{
+    njs_jit_sse(jit, 0xf2, 0x11, xmm, reg,
+                offsetof(njs_value_t, data.u.number));
+
+    /* mov dword [reg], NJS_NUMBER: the type and no int32 flag */
+    njs_jit_byte(jit, 0xc7);
+    njs_jit_modrm(jit, 0, reg, 0);
+    njs_jit_byte(jit, NJS_NUMBER);
+    njs_jit_byte(jit, 0);
+    njs_jit_byte(jit, 0);
+    njs_jit_byte(jit, 0);
+
+    /* xorpd xmm3, xmm3; ucomisd xmm, xmm3; setne al */
+    njs_jit_sse_rr(jit, 0x66, 0x57, 3, 3);
+    njs_jit_sse_rr(jit, 0x66, 0x2e, xmm, 3);
+
+    njs_jit_byte(jit, 0x0f);
+    njs_jit_byte(jit, 0x90 | NJS_JIT_NE);
+    njs_jit_byte(jit, 0xc0);
+
+    /* mov [reg + truth], al */
+    njs_jit_byte(jit, 0x88);
+    njs_jit_modrm(jit, NJS_JIT_RAX, reg, offsetof(njs_value_t, data.truth));
+}
+
+
+static nxt_bool_t
+njs_jit_target(njs_jit_t *jit, u_char *target)
+{
+    if (target < jit->start || target > jit->end) {
+        return 0;
+    }
+
+    if (((target - jit->start) % sizeof(uintptr_t)) != 0) {
+        return 0;
+    }
+
+    return (target == jit->end || jit->boundary[njs_jit_slot(jit, target)]);
+}
+
+
+/* A backward branch is a safe point of the garbage collector. */
+
+static void
+njs_jit_branch(njs_jit_t *jit, u_char *code, u_char *target)
+{
+    if (target > code) {
+        njs_jit_patch(jit, njs_jit_jmp(jit), target);
+        return;
+    }
+
+    /* sub dword [rbx + gc_ticks], 1 */
+    njs_jit_byte(jit, 0x83);
+    njs_jit_modrm(jit, 5, NJS_JIT_RBX, offsetof(njs_vm_t, gc_ticks));
+    njs_jit_byte(jit, 0x01);
+
+    njs_jit_patch(jit, njs_jit_jcc(jit, NJS_JIT_NE), target);
+
+    /* mov rdi, rbx */
+    njs_jit_byte(jit, 0x48);
+    njs_jit_byte(jit, 0x89);
+    njs_jit_byte(jit, 0xdf);
+
+    njs_jit_call(jit, njs_gc_tick);
+
+    njs_jit_patch(jit, njs_jit_jmp(jit), target);
+}
+
+
+static u_char *
+njs_jit_cold(njs_jit_t *jit)
+{
+    u_char  *hot;
+
+    hot = jit->p;
+    jit->p = jit->cold;
+
+    return hot;
+}
+
+
+static void
+njs_jit_hot(njs_jit_t *jit, u_char *hot)
+{
+    jit->cold = jit->p;
+    jit->p = hot;
+}
+
+
+static void
+njs_jit_operand(njs_jit_t *jit, nxt_uint_t reg, njs_index_t index)
+{
+    uintptr_t  scope;
+
+    scope = (uintptr_t) index & NJS_SCOPE_MASK;
+
+    if (scope == NJS_SCOPE_ABSOLUTE) {
+        njs_jit_mov_imm(jit, reg, index);
+        return;
+    }
+
+    njs_jit_load(jit, reg, NJS_JIT_RBX,
+                 offsetof(njs_vm_t, scopes) + scope * sizeof(njs_value_t *));
+
+    if (njs_scope_offset(index) != 0) {
+        /* add reg, imm32 */
+        njs_jit_byte(jit, 0x48);
+        njs_jit_byte(jit, 0x81);
+        njs_jit_byte(jit, 0xc0 | reg);
+        *(int32_t *) jit->p = (int32_t) njs_scope_offset(index);
+        jit->p += 4;
+    }
+}
+
+
+static void
+njs_jit_mov_imm(njs_jit_t *jit, nxt_uint_t reg, uintptr_t imm)
+{
+    if (imm <= 0xffffffff) {
+        /* mov r32, imm32 */
+        njs_jit_byte(jit, 0xb8 | reg);
+        *(uint32_t *) jit->p = (uint32_t) imm;
+        jit->p += 4;
+        return;
+    }
+
+    /* mov r64, imm64 */
+    njs_jit_byte(jit, 0x48);
+    njs_jit_byte(jit, 0xb8 | reg);
+    *(uint64_t *) jit->p = imm;
+    jit->p += 8;
+}
+
+
+static void
+njs_jit_modrm(njs_jit_t *jit, nxt_uint_t reg, nxt_uint_t base, intptr_t disp)
+{
+    if (disp == 0 && base != 5) {
+        njs_jit_byte(jit, (reg << 3) | base);
+
+    } else if (disp >= -128 && disp <= 127) {
+        njs_jit_byte(jit, 0x40 | (reg << 3) | base);
+        njs_jit_byte(jit, disp);
+
+    } else {
+        njs_jit_byte(jit, 0x80 | (reg << 3) | base);
+        *(int32_t *) jit->p = (int32_t) disp;
+        jit->p += 4;
+    }
+}
+
+
+static void
+njs_jit_load(njs_jit_t *jit, nxt_uint_t reg, nxt_uint_t base, intptr_t disp)
+{
+    njs_jit_byte(jit, 0x48);
+    njs_jit_byte(jit, 0x8b);
+    njs_jit_modrm(jit, reg, base, disp);
+}
+
+
+static void
+njs_jit_store(njs_jit_t *jit, nxt_uint_t base, intptr_t disp, nxt_uint_t reg)
+{
+    njs_jit_byte(jit, 0x48);
+    njs_jit_byte(jit, 0x89);
+    njs_jit_modrm(jit, reg, base, disp);
+}
+
+
+static void
+njs_jit_sse(njs_jit_t *jit, u_char prefix, u_char op, nxt_uint_t xmm,
+    nxt_uint_t base, intptr_t disp)
+{
+    njs_jit_byte(jit, prefix);
+    njs_jit_byte(jit, 0x0f);
+    njs_jit_byte(jit, op);
+    njs_jit_modrm(jit, xmm, base, disp);
+}
+
+
+static void
+njs_jit_sse_rr(njs_jit_t *jit, u_char prefix, u_char op, nxt_uint_t dst,
+    nxt_uint_t src)
+{
+    njs_jit_byte(jit, prefix);
+    njs_jit_byte(jit, 0x0f);
+    njs_jit_byte(jit, op);
+    njs_jit_byte(jit, 0xc0 | (dst << 3) | src);
+}
+
+
+static void
+njs_jit_cmp_byte(njs_jit_t *jit, nxt_uint_t base, intptr_t disp, u_char imm)
+{
+    njs_jit_byte(jit, 0x80);
+    njs_jit_modrm(jit, 7, base, disp);
+    njs_jit_byte(jit, imm);
+}
+
+
+static void
+njs_jit_cmp_rax(njs_jit_t *jit, intptr_t imm)
+{
+    if (imm >= -128 && imm <= 127) {
+        /* cmp rax, imm8 */
+        njs_jit_byte(jit, 0x48);
+        njs_jit_byte(jit, 0x83);
+        njs_jit_byte(jit, 0xf8);
+        njs_jit_byte(jit, imm);
+        return;
+    }
+
+    /* cmp rax, imm32 */
+    njs_jit_byte(jit, 0x48);
+    njs_jit_byte(jit, 0x3d);
+    *(int32_t *) jit->p = (int32_t) imm;
+    jit->p += 4;
+}
+
+
+static void
+njs_jit_call(njs_jit_t *jit, void *function)
+{
+    njs_jit_mov_imm(jit, NJS_JIT_RAX, (uintptr_t) function);
+
+    /* call rax */
+    njs_jit_byte(jit, 0xff);
+    njs_jit_byte(jit, 0xd0);
+}
+
+
+static u_char *
+njs_jit_jcc(njs_jit_t *jit, nxt_uint_t cc)
+{
+    njs_jit_byte(jit, 0x0f);
+    njs_jit_byte(jit, 0x80 | cc);
+    jit->p += 4;
+
+    return jit->p - 4;
+}
+
+
+static u_char *
+njs_jit_jmp(njs_jit_t *jit)
+{
+    njs_jit_byte(jit, 0xe9);
+    jit->p += 4;
+
+    return jit->p - 4;
+}
+
+
+static void
+njs_jit_patch(njs_jit_t *jit, u_char *rel, u_char *target)
+{
+    jit->patches[jit->npatches].rel = rel;
+    jit->patches[jit->npatches].target = target;
+    jit->npatches++;
+}
+
+
+static void
+njs_jit_link(u_char *rel, u_char *target)
+{
+    *(int32_t *) rel = (int32_t) (target - (rel + 4));
+}
+
+#endif
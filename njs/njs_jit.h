@@ -0,0 +1,71 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NJS_JIT_H_INCLUDED_
+#define _NJS_JIT_H_INCLUDED_
+
+
+#if (NXT_JIT)
+
+/* The default number of calls after which a lambda is compiled. */
+#define NJS_JIT_THRESHOLD      100
+
+
+typedef njs_ret_t (*njs_jit_native_t)(njs_vm_t *vm);
+
+
+/*
+ * The bytecode trampoline through which the interpreter enters
+ * the machine code: njs_vmcode_jit() calls the native entry.
+ */
+
+typedef struct {
+    njs_vmcode_t               code;
+    njs_jit_native_t           native;
+} njs_vmcode_jit_t;
+
+
+/*
+ * A call site copy of njs_vmcode_function_call_t is immediately followed
+ * by a trampoline which continues the native code after the call, so the
+ * return address of the called frame points to the trampoline.
+ */
+
+typedef struct {
+    njs_vmcode_function_call_t call;
+    njs_vmcode_jit_t           resume;
+} njs_jit_call_t;
+
+
+struct njs_jit_code_s {
+    njs_jit_code_t             *next;
+    size_t                     size;
+    njs_vmcode_jit_t           start;
+    njs_jit_call_t             calls[];
+};
+
+
+/*
+ * The start of a lambda code: the machine code after the lambda has been
+ * called vm->shared->jit_threshold times or the bytecode otherwise.
+ */
+
+#define njs_jit_start(vm, lambda)                                             \
+    (nxt_fast_path((lambda)->jit != NULL) ? (u_char *) &(lambda)->jit->start  \
+                                          : njs_jit_count(vm, lambda))
+
+
+u_char *njs_jit_count(njs_vm_t *vm, njs_function_lambda_t *lambda);
+void njs_jit_free(njs_vm_shared_t *shared);
+
+njs_ret_t njs_vmcode_jit(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2,
+    njs_value_t *unused);
+njs_ret_t njs_vmcode_jit_exit(njs_vm_t *vm, njs_ret_t ret,
+    njs_vmcode_generic_t *vmcode);
+
+#endif
+
+
+#endif /* _NJS_JIT_H_INCLUDED_ */
@@ -5,6 +5,7 @@
  */
 
 #include <njs_core.h>
+#include <nxt_dtoa.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -282,6 +283,11 @@ njs_json_stringify(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     if (nargs >= 4 && (njs_is_string(&args[3]) || njs_is_number(&args[3]))) {
         if (njs_is_string(&args[3])) {
+            ret = njs_string_flat(vm, &args[3]);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+
             njs_string_get(&args[3], &stringify->space);
             stringify->space.length = nxt_min(stringify->space.length, 10);
 
@@ -839,8 +845,7 @@ njs_json_parse_number(njs_json_parse_ctx_t *ctx, njs_value_t *value,
     start = p;
     num = njs_number_dec_parse(&p, ctx->end);
     if (p != start) {
-        *value = njs_value_zero;
-        value->data.u.number = sign * num;
+        njs_value_number_set(value, sign * num);
 
         return p;
     }
@@ -901,7 +906,7 @@ njs_json_skip_space(const u_char *start, const u_char *end)
 
 #define njs_json_is_non_empty(_value)                                         \
     (((_value)->type == NJS_OBJECT)                                           \
-      && !nxt_lvlhsh_is_empty(&(_value)->data.u.object->hash))                \
+      && !njs_object_is_empty((_value)->data.u.object))                       \
      || (((_value)->type == NJS_ARRAY) && (_value)->data.u.array->length != 0)
 
 
@@ -910,7 +915,7 @@ njs_json_parse_continuation(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
     nxt_int_t           ret;
-    njs_value_t         *key, *value;
+    njs_value_t         *key, *value, key_value;
     njs_json_state_t    *state;
     njs_json_parse_t    *parse;
     njs_object_prop_t   *prop;
@@ -923,12 +928,13 @@ njs_json_parse_continuation(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         switch (state->type) {
         case NJS_JSON_OBJECT_START:
             if (state->index < state->keys->length) {
-                key = &state->keys->start[state->index];
+                key = njs_array_item_value(&state->keys->start[state->index],
+                                           &key_value);
                 njs_string_get(key, &lhq.key);
                 lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
                 lhq.proto = &njs_object_hash_proto;
 
-                ret = nxt_lvlhsh_find(&state->value.data.u.object->hash, &lhq);
+                ret = njs_object_own_find(state->value.data.u.object, &lhq);
                 if (nxt_slow_path(ret == NXT_DECLINED)) {
                     state->index++;
                     break;
@@ -958,7 +964,13 @@ njs_json_parse_continuation(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             return njs_json_parse_continuation_apply(vm, parse);
 
         case NJS_JSON_OBJECT_REPLACED:
-            key = &state->keys->start[state->index];
+            ret = njs_object_dictionary(vm, state->value.data.u.object);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                goto memory_error;
+            }
+
+            key = njs_array_item_value(&state->keys->start[state->index],
+                                       &key_value);
             njs_string_get(key, &lhq.key);
             lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
             lhq.replace = 1;
@@ -985,6 +997,8 @@ njs_json_parse_continuation(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
                 return NXT_ERROR;
             }
 
+            njs_property_cache_flush(vm);
+
             state->index++;
             state->type = NJS_JSON_OBJECT_START;
 
@@ -992,7 +1006,9 @@ njs_json_parse_continuation(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
         case NJS_JSON_ARRAY_START:
             if (state->index < state->value.data.u.array->length) {
-                value = &state->value.data.u.array->start[state->index];
+                value = njs_array_item_value(
+                            &state->value.data.u.array->start[state->index],
+                            &key_value);
 
                 if (njs_json_is_non_empty(value)) {
                     state = njs_json_push_parse_state(vm, parse, value);
@@ -1010,8 +1026,12 @@ njs_json_parse_continuation(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             return njs_json_parse_continuation_apply(vm, parse);
 
         case NJS_JSON_ARRAY_REPLACED:
-            value = &state->value.data.u.array->start[state->index];
-            *value = parse->retval;
+            ret = njs_array_value_set(vm, state->value.data.u.array,
+                            &state->value.data.u.array->start[state->index],
+                            &parse->retval);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NXT_ERROR;
+            }
 
             state->index++;
             state->type = NJS_JSON_ARRAY_START;
@@ -1045,7 +1065,8 @@ njs_json_parse_continuation_apply(njs_vm_t *vm, njs_json_parse_t *parse)
 
     switch (state->type) {
     case NJS_JSON_OBJECT_START:
-        arguments[1] = state->keys->start[state->index];
+        njs_array_item_get(&state->keys->start[state->index],
+                           &arguments[1]);
         arguments[2] = *state->prop_value;
 
         state->type = NJS_JSON_OBJECT_REPLACED;
@@ -1055,7 +1076,8 @@ njs_json_parse_continuation_apply(njs_vm_t *vm, njs_json_parse_t *parse)
         size = snprintf((char *) njs_string_short_start(&arguments[1]),
                         NJS_STRING_SHORT, "%u", state->index);
         njs_string_short_set(&arguments[1], size, size);
-        arguments[2] = state->value.data.u.array->start[state->index];
+        njs_array_item_get(&state->value.data.u.array->start[state->index],
+                           &arguments[2]);
 
         state->type = NJS_JSON_ARRAY_REPLACED;
         break;
@@ -1189,7 +1211,7 @@ njs_json_stringify_continuation(njs_vm_t *vm, njs_value_t *args,
     nxt_int_t             i;
     njs_ret_t             ret;
     nxt_str_t             str;
-    njs_value_t           *key, *value;
+    njs_value_t           *key, *value, item;
     njs_function_t        *to_json;
     njs_json_state_t      *state;
     njs_object_prop_t     *prop;
@@ -1221,12 +1243,13 @@ njs_json_stringify_continuation(njs_vm_t *vm, njs_value_t *args,
                 break;
             }
 
-            key = &state->keys->start[state->index++];
+            key = njs_array_item_value(&state->keys->start[state->index++],
+                                       &item);
             njs_string_get(key, &lhq.key);
             lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
             lhq.proto = &njs_object_hash_proto;
 
-            ret = nxt_lvlhsh_find(&state->value.data.u.object->hash, &lhq);
+            ret = njs_object_own_find(state->value.data.u.object, &lhq);
             if (nxt_slow_path(ret == NXT_DECLINED)) {
                 break;
             }
@@ -1332,7 +1355,9 @@ njs_json_stringify_continuation(njs_vm_t *vm, njs_value_t *args,
                 njs_json_stringify_indent(stringify->stack.items);
             }
 
-            value = &state->value.data.u.array->start[state->index++];
+            value = njs_array_item_value(
+                        &state->value.data.u.array->start[state->index++],
+                        &item);
 
             if (njs_is_object(value)) {
                 to_json = njs_object_to_json_function(vm, value);
@@ -1548,7 +1573,7 @@ njs_json_stringify_array(njs_vm_t *vm, njs_json_stringify_t  *stringify)
 {
     njs_ret_t    ret;
     uint32_t     i, n, k, properties_length, array_length;
-    njs_value_t  *value, num_value;
+    njs_value_t  *value, num_value, item, property;
     njs_array_t  *properties, *array;
 
     properties_length = 1;
@@ -1556,7 +1581,7 @@ njs_json_stringify_array(njs_vm_t *vm, njs_json_stringify_t  *stringify)
     array_length = array->length;
 
     for (i = 0; i < array_length; i++) {
-        if (njs_is_valid(&array->start[i])) {
+        if (njs_array_item_is_valid(&array->start[i])) {
             properties_length++;
         }
     }
@@ -1567,15 +1592,19 @@ njs_json_stringify_array(njs_vm_t *vm, njs_json_stringify_t  *stringify)
     }
 
     n = 0;
-    properties->start[n++] = njs_string_empty;
+    ret = njs_array_value_set(vm, properties, &properties->start[n++],
+                              &njs_string_empty);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return NXT_ERROR;
+    }
 
     for (i = 0; i < array_length; i++) {
-        value = &array->start[i];
-
-        if (!njs_is_valid(&array->start[i])) {
+        if (!njs_array_item_is_valid(&array->start[i])) {
             continue;
         }
 
+        value = njs_array_item_value(&array->start[i], &item);
+
         switch (value->type) {
         case NJS_OBJECT_NUMBER:
             value = &value->data.u.object_value->value;
@@ -1592,9 +1621,14 @@ njs_json_stringify_array(njs_vm_t *vm, njs_json_stringify_t  *stringify)
 
         case NJS_OBJECT_STRING:
             value = &value->data.u.object_value->value;
-            break;
+            /* Fall through. */
 
         case NJS_STRING:
+            ret = njs_string_flat(vm, value);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NXT_ERROR;
+            }
+
             break;
 
         default:
@@ -1602,13 +1636,25 @@ njs_json_stringify_array(njs_vm_t *vm, njs_json_stringify_t  *stringify)
         }
 
         for (k = 0; k < n; k ++) {
-            if (njs_values_strict_equal(value, &properties->start[k]) == 1) {
+            ret = njs_values_strict_equal(vm, value,
+                    njs_array_item_value(&properties->start[k], &property));
+
+            if (ret != 0) {
+
+                if (nxt_slow_path(ret < 0)) {
+                    return ret;
+                }
+
                 break;
             }
         }
 
         if (k == n) {
-            properties->start[n++] = *value;
+            ret = njs_array_value_set(vm, properties,
+                                      &properties->start[n++], value);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NXT_ERROR;
+            }
         }
     }
 
@@ -1734,6 +1780,10 @@ njs_json_append_string(njs_json_stringify_t *stringify, njs_value_t *value)
     static char   hex2char[16] = { '0', '1', '2', '3', '4', '5', '6', '7',
                                    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
 
+    if (nxt_slow_path(njs_string_flat(stringify->vm, value) != NXT_OK)) {
+        return NXT_ERROR;
+    }
+
     (void) njs_string_prop(&str, value);
 
     p = str.start;
@@ -1839,12 +1889,12 @@ njs_json_append_number(njs_json_stringify_t *stringify, njs_value_t *value)
         return njs_json_buf_append(stringify, "null", 4);
 
     } else {
-        p = njs_json_buf_reserve(stringify, 64);
+        p = njs_json_buf_reserve(stringify, NXT_DTOA_MAX_LEN);
         if (nxt_slow_path(p == NULL)) {
             return NXT_ERROR;
         }
 
-        size = njs_num_to_buf(num, p, 64);
+        size = nxt_dtoa(num, p);
 
         njs_json_buf_written(stringify, size);
     }
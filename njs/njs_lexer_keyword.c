@@ -67,6 +67,12 @@ static const njs_keyword_t  njs_keywords[] = {
     { nxt_string("Function"),      NJS_TOKEN_FUNCTION_CONSTRUCTOR, 0 },
     { nxt_string("RegExp"),        NJS_TOKEN_REGEXP_CONSTRUCTOR, 0 },
     { nxt_string("Date"),          NJS_TOKEN_DATE_CONSTRUCTOR, 0 },
+    { nxt_string("ArrayBuffer"),   NJS_TOKEN_ARRAY_BUFFER_CONSTRUCTOR, 0 },
+    { nxt_string("DataView"),      NJS_TOKEN_DATA_VIEW_CONSTRUCTOR, 0 },
+    { nxt_string("Uint8Array"),    NJS_TOKEN_UINT8_ARRAY_CONSTRUCTOR, 0 },
+    { nxt_string("Uint16Array"),   NJS_TOKEN_UINT16_ARRAY_CONSTRUCTOR, 0 },
+    { nxt_string("Uint32Array"),   NJS_TOKEN_UINT32_ARRAY_CONSTRUCTOR, 0 },
+    { nxt_string("Float64Array"),  NJS_TOKEN_FLOAT64_ARRAY_CONSTRUCTOR, 0 },
     { nxt_string("Error"),         NJS_TOKEN_ERROR_CONSTRUCTOR, 0 },
     { nxt_string("EvalError"),     NJS_TOKEN_EVAL_ERROR_CONSTRUCTOR, 0 },
     { nxt_string("InternalError"), NJS_TOKEN_INTERNAL_ERROR_CONSTRUCTOR, 0 },
@@ -181,14 +181,61 @@ njs_object_math_atanh(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 }
 
 
+/*
+ * njs_math_cube_error() returns |x^3 - num| with the rounding errors
+ * of the x^2 and x^3 products taken into account by fma().
+ */
+
+static double
+njs_math_cube_error(double x, double num)
+{
+    double  x2, x3, e2, e3;
+
+    x2 = x * x;
+    e2 = fma(x, x, -x2);
+    x3 = x2 * x;
+    e3 = fma(x2, x, -x3);
+
+    return fabs((x3 - num) + e3 + e2 * x);
+}
+
+
+static double
+njs_math_cbrt_correct(double root, double num)
+{
+    double  next;
+
+    next = root - (root * root * root - num) / (3 * root * root);
+
+    if (njs_math_cube_error(next, num) < njs_math_cube_error(root, num)) {
+        return next;
+    }
+
+    return root;
+}
+
+
 static njs_ret_t
 njs_object_math_cbrt(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    double  num;
+    double  num, root;
 
     if (nargs > 1) {
-        num = cbrt(args[1].data.u.number);
+        num = args[1].data.u.number;
+        root = cbrt(num);
+
+        /*
+         * cbrt() may be 1 ulp off, e.g. for 27, so the root is corrected
+         * by a Newton step if the cube of the result is closer to the number.
+         */
+
+        if (isfinite(root) && root != 0) {
+            num = njs_math_cbrt_correct(root, num);
+
+        } else {
+            num = root;
+        }
 
     } else {
         num = NAN;
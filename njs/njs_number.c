@@ -5,9 +5,11 @@
  */
 
 #include <njs_core.h>
+#include <nxt_dtoa.h>
 #include <math.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <float.h>
 
 
@@ -27,8 +29,13 @@ uint32_t
 njs_value_to_index(const njs_value_t *value)
 {
     double       num;
+    njs_value_t  val;
     njs_array_t  *array;
 
+    if (njs_is_int32(value) && value->data.integer >= 0) {
+        return value->data.integer;
+    }
+
     num = NAN;
 
     if (nxt_fast_path(njs_is_numeric(value))) {
@@ -48,9 +55,12 @@ njs_value_to_index(const njs_value_t *value)
                 return 0;
             }
 
-            if (array->length == 1 && njs_is_valid(&array->start[0])) {
+            if (array->length == 1
+                && njs_array_item_is_valid(&array->start[0]))
+            {
                 /* A single value array is the zeroth array value. */
-                return njs_value_to_index(&array->start[0]);
+                return njs_value_to_index(njs_array_item_value(&array->start[0],
+                                                               &val));
             }
         }
     }
@@ -63,19 +73,55 @@ njs_value_to_index(const njs_value_t *value)
 }
 
 
+/*
+ * njs_number_dec_parse() rounds a decimal number correctly.  The numbers
+ * with at most 19 significant digits and a small exponent are exactly
+ * multiplied or divided by an exact power of 10, and the rest are passed
+ * to strtod() without a decimal point, so the locale does not matter.
+ * The significant digits beyond NJS_DEC_DIGITS_MAX are replaced by a
+ * single non-zero digit which keeps the rounding direction.
+ */
+
+#define NJS_DEC_DIGITS_MAX  800
+
+
 double
 njs_number_dec_parse(const u_char **start, const u_char *end)
 {
-    u_char        c;
-    double        num, frac, scale, exponent;
-    nxt_bool_t    minus;
+    u_char        c, *d;
+    size_t        n;
+    int64_t       exp10, exponent;
+    uint64_t      significand;
+    nxt_bool_t    minus, fraction, sticky;
     const u_char  *e, *p;
+    u_char        digits[NJS_DEC_DIGITS_MAX + 32];
+
+    static const double  powers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+        1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+        1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
 
     p = *start;
 
-    num = 0;
+    n = 0;
+    exp10 = 0;
+    significand = 0;
+    fraction = 0;
+    sticky = 0;
+
+    for ( ;; ) {
+
+        if (p == end) {
+            break;
+        }
+
+        if (*p == '.' && !fraction) {
+            fraction = 1;
+            p++;
+            continue;
+        }
 
-    while (p < end) {
         /* Values less than '0' become >= 208. */
         c = *p - '0';
 
@@ -83,28 +129,23 @@ njs_number_dec_parse(const u_char **start, const u_char *end)
             break;
         }
 
-        num = num * 10 + c;
         p++;
-    }
-
-    if (p < end && *p == '.') {
-
-        frac = 0;
-        scale = 1;
 
-        for (p++; p < end; p++) {
-            /* Values less than '0' become >= 208. */
-            c = *p - '0';
+        if (n == 0 && c == 0) {
+            /* Leading zeros. */
+            exp10 -= fraction;
+            continue;
+        }
 
-            if (nxt_slow_path(c > 9)) {
-                break;
-            }
+        if (n < NJS_DEC_DIGITS_MAX) {
+            digits[n++] = '0' + c;
+            significand = significand * 10 + c;
+            exp10 -= fraction;
 
-            frac = frac * 10 + c;
-            scale *= 10;
+        } else {
+            sticky |= (c != 0);
+            exp10 += !fraction;
         }
-
-        num += frac / scale;
     }
 
     e = p + 1;
@@ -137,20 +178,48 @@ njs_number_dec_parse(const u_char **start, const u_char *end)
                     break;
                 }
 
-                exponent = exponent * 10 + c;
+                /* Any larger exponent overflows or underflows. */
+
+                if (exponent < 100000) {
+                    exponent = exponent * 10 + c;
+                }
+
                 p++;
             }
 
-            if (num != 0) {
-                exponent = minus ? -exponent : exponent;
-                num = num * pow(10.0, exponent);
-            }
+            exp10 += minus ? -exponent : exponent;
         }
     }
 
     *start = p;
 
-    return num;
+    if (n == 0) {
+        return 0;
+    }
+
+    if (n <= 19 && significand <= (1ULL << 53)
+        && exp10 >= -22 && exp10 <= 22)
+    {
+        if (exp10 < 0) {
+            return (double) significand / powers[-exp10];
+        }
+
+        return (double) significand * powers[exp10];
+    }
+
+    d = &digits[n];
+
+    if (sticky) {
+        *d++ = '1';
+        exp10--;
+    }
+
+    *d++ = 'e';
+
+    (void) snprintf((char *) d, digits + sizeof(digits) - d, "%" PRId64,
+                    exp10);
+
+    return strtod((char *) digits, NULL);
 }
 
 
@@ -277,7 +346,7 @@ njs_number_to_string(njs_vm_t *vm, njs_value_t *string,
     double             num;
     size_t             size;
     const njs_value_t  *value;
-    u_char             buf[128];
+    u_char             buf[NXT_DTOA_MAX_LEN];
 
     num = number->data.u.number;
 
@@ -294,7 +363,7 @@ njs_number_to_string(njs_vm_t *vm, njs_value_t *string,
         }
 
     } else {
-        size = njs_num_to_buf(num, buf, sizeof(buf));
+        size = nxt_dtoa(num, buf);
 
         return njs_string_new(vm, string, buf, size, size);
     }
@@ -305,34 +374,6 @@ njs_number_to_string(njs_vm_t *vm, njs_value_t *string,
 }
 
 
-size_t
-njs_num_to_buf(double num, u_char *buf, size_t size)
-{
-    double      n;
-    const char  *fmt;
-
-    n = fabs(num);
-
-    if (n == 0) {
-        fmt = "%g";
-
-    } else if (n < 1) {
-        fmt = "%f";
-
-    } else if (n < 1000000) {
-        fmt = "%g";
-
-    } else if (n < 1e20) {
-        fmt = "%1.f";
-
-    } else {
-        fmt = "%1.e";
-    }
-
-    return snprintf((char *) buf, size, fmt, num);
-}
-
-
 njs_ret_t
 njs_number_constructor(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
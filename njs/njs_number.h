@@ -19,7 +19,6 @@ int64_t njs_number_radix_parse(const u_char **start, const u_char *end,
     uint8_t radix);
 njs_ret_t njs_number_to_string(njs_vm_t *vm, njs_value_t *string,
     const njs_value_t *number);
-size_t njs_num_to_buf(double num, u_char *buf, size_t size);
 njs_ret_t njs_number_constructor(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused);
 njs_ret_t njs_number_global_is_nan(njs_vm_t *vm, njs_value_t *args,
@@ -33,6 +32,31 @@ njs_ret_t njs_number_parse_float(njs_vm_t *vm, njs_value_t *args,
 nxt_noinline uint32_t njs_number_to_integer(double num);
 
 
+#define njs_value_to_int32(value)                                             \
+    (njs_is_int32(value)                                                      \
+     ? (value)->data.integer                                                  \
+     : (int32_t) njs_number_to_integer((value)->data.u.number))
+
+
+/* Sets the int32 flag of a number value, see njs_is_int32(). */
+nxt_inline void
+njs_value_int32_hint(njs_value_t *value, double num)
+{
+    int32_t  i;
+
+    value->data.int32 = 0;
+
+    if (num >= -2147483648.0 && num <= 2147483647.0) {
+        i = (int32_t) num;
+
+        if (i == num && (i != 0 || !signbit(num))) {
+            value->data.int32 = 1;
+            value->data.integer = i;
+        }
+    }
+}
+
+
 extern const njs_object_init_t  njs_number_constructor_init;
 extern const njs_object_init_t  njs_number_prototype_init;
 
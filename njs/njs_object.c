@@ -5,6 +5,7 @@
  */
 
 #include <njs_core.h>
+#include <njs_typed_array.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -14,10 +15,16 @@ static njs_ret_t njs_object_property_query(njs_vm_t *vm,
     njs_property_query_t *pq, njs_value_t *value, njs_object_t *object);
 static njs_ret_t njs_array_property_query(njs_vm_t *vm,
     njs_property_query_t *pq, njs_value_t *object, uint32_t index);
+static njs_ret_t njs_typed_array_property_query(njs_vm_t *vm,
+    njs_property_query_t *pq, njs_value_t *object, uint32_t index);
 static njs_ret_t njs_object_query_prop_handler(njs_property_query_t *pq,
     njs_object_t *object);
 static njs_ret_t njs_define_property(njs_vm_t *vm, njs_object_t *object,
     const njs_value_t *name, const njs_object_t *descriptor);
+static njs_object_slot_t *njs_object_shape_find(const njs_object_t *object,
+    nxt_lvlhsh_query_t *lhq);
+static nxt_int_t njs_object_shape_transition(njs_vm_t *vm,
+    njs_object_t *object, const njs_value_t *name, uint32_t key_hash);
 
 
 nxt_noinline njs_object_t *
@@ -34,6 +41,9 @@ njs_object_alloc(njs_vm_t *vm)
         object->type = NJS_OBJECT;
         object->shared = 0;
         object->extensible = 1;
+        object->immutable = 0;
+        object->shape = NULL;
+        object->slots = NULL;
     }
 
     return object;
@@ -78,6 +88,9 @@ njs_object_value_alloc(njs_vm_t *vm, const njs_value_t *value, nxt_uint_t type)
         ov->object.type = njs_object_value_type(type);
         ov->object.shared = 0;
         ov->object.extensible = 1;
+        ov->object.immutable = 0;
+        ov->object.shape = NULL;
+        ov->object.slots = NULL;
 
         index = njs_primitive_prototype_index(type);
         ov->object.__proto__ = &vm->prototypes[index].object;
@@ -152,7 +165,11 @@ njs_object_hash_test(nxt_lvlhsh_query_t *lhq, void *data)
             return NXT_DECLINED;
         }
 
-        start = prop->name.long_string.data->start;
+        start = njs_string_long_start(&prop->name);
+
+        if (nxt_slow_path(start == NULL)) {
+            return NXT_DECLINED;
+        }
     }
 
     if (memcmp(start, lhq->key.start, lhq->key.length) == 0) {
@@ -198,7 +215,7 @@ njs_object_property(njs_vm_t *vm, const njs_object_t *object,
     lhq->proto = &njs_object_hash_proto;
 
     do {
-        ret = nxt_lvlhsh_find(&object->hash, lhq);
+        ret = njs_object_own_find(object, lhq);
 
         if (nxt_fast_path(ret == NXT_OK)) {
             return lhq->value;
@@ -210,7 +227,7 @@ njs_object_property(njs_vm_t *vm, const njs_object_t *object,
             return lhq->value;
         }
 
-        object = object->__proto__;
+        object = njs_object_proto(vm, object);
 
     } while (object != NULL);
 
@@ -218,6 +235,335 @@ njs_object_property(njs_vm_t *vm, const njs_object_t *object,
 }
 
 
+nxt_int_t
+njs_object_own_find(const njs_object_t *object, nxt_lvlhsh_query_t *lhq)
+{
+    njs_object_slot_t  *slot;
+
+    if (object->shape != NULL) {
+        slot = njs_object_shape_find(object, lhq);
+
+        if (slot != NULL && slot->prop.type != NJS_WHITEOUT) {
+            lhq->value = &slot->prop;
+            return NXT_OK;
+        }
+
+        return NXT_DECLINED;
+    }
+
+    return nxt_lvlhsh_find(&object->hash, lhq);
+}
+
+
+static njs_object_slot_t *
+njs_object_shape_find(const njs_object_t *object, nxt_lvlhsh_query_t *lhq)
+{
+    nxt_str_t           name;
+    njs_object_shape_t  *shape;
+
+    for (shape = object->shape; shape != NULL; shape = shape->parent) {
+
+        if (shape->key_hash == lhq->key_hash) {
+            njs_string_get(&shape->name, &name);
+
+            if (nxt_strstr_eq(&name, &lhq->key)) {
+                return &object->slots[shape->slots - 1];
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+/*
+ * njs_object_prop_add() adds a new own property with void value.
+ * A plain object without properties in the hashes stores it in the slots
+ * and moves to the next shape, otherwise the property is inserted in the
+ * private hash.  The lhq must contain the key and its hash.
+ */
+
+njs_object_prop_t *
+njs_object_prop_add(njs_vm_t *vm, njs_object_t *object,
+    const njs_value_t *name, nxt_lvlhsh_query_t *lhq)
+{
+    nxt_int_t          ret;
+    njs_object_prop_t  *prop;
+    njs_object_slot_t  *slot;
+
+    if (object->shape != NULL) {
+        slot = njs_object_shape_find(object, lhq);
+
+        if (slot != NULL) {
+            /* A deleted property is revived in its slot. */
+            prop = &slot->prop;
+            goto done;
+        }
+    }
+
+    if (object->shape != NULL
+        || (object->type == NJS_OBJECT
+            && !object->shared
+            && nxt_lvlhsh_is_empty(&object->hash)
+            && nxt_lvlhsh_is_empty(&object->shared_hash)))
+    {
+        ret = njs_object_shape_transition(vm, object, name, lhq->key_hash);
+
+        if (ret == NXT_OK) {
+            prop = &object->slots[object->shape->slots - 1].prop;
+
+            /* GC: retain. */
+            prop->name = *name;
+
+            goto done;
+        }
+
+        if (nxt_slow_path(ret == NXT_ERROR)) {
+            return NULL;
+        }
+
+        ret = njs_object_dictionary(vm, object);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NULL;
+        }
+    }
+
+    prop = njs_object_prop_alloc(vm, name, &njs_value_void, 1);
+    if (nxt_slow_path(prop == NULL)) {
+        return NULL;
+    }
+
+    lhq->replace = 0;
+    lhq->value = prop;
+    lhq->proto = &njs_object_hash_proto;
+    lhq->pool = vm->mem_cache_pool;
+
+    ret = nxt_lvlhsh_insert(&object->hash, lhq);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return NULL;
+    }
+
+    return prop;
+
+done:
+
+    prop->value = njs_value_void;
+    prop->type = NJS_PROPERTY;
+    prop->enumerable = 1;
+    prop->writable = 1;
+    prop->configurable = 1;
+
+    return prop;
+}
+
+
+/*
+ * njs_object_shape_transition() moves the object to the shape with
+ * the additional property and expands the slots if needed.  NXT_DECLINED
+ * is returned if the object has too many properties or the shape has
+ * too many transitions, e.g. if the object is used as a dictionary.
+ */
+
+static nxt_int_t
+njs_object_shape_transition(njs_vm_t *vm, njs_object_t *object,
+    const njs_value_t *name, uint32_t key_hash)
+{
+    nxt_str_t           key, str;
+    nxt_uint_t          n, size;
+    njs_object_slot_t   *slots;
+    njs_object_shape_t  *parent, *shape;
+
+    parent = object->shape;
+
+    if (parent == NULL) {
+        parent = vm->shape_root;
+
+        if (parent == NULL) {
+            parent = nxt_mem_cache_zalign(vm->mem_cache_pool,
+                                          sizeof(njs_value_t),
+                                          sizeof(njs_object_shape_t));
+            if (nxt_slow_path(parent == NULL)) {
+                return NXT_ERROR;
+            }
+
+            vm->shape_root = parent;
+        }
+    }
+
+    n = parent->slots;
+
+    if (n == NJS_OBJECT_SHAPE_MAX) {
+        return NXT_DECLINED;
+    }
+
+    njs_string_get(name, &key);
+
+    for (shape = parent->child; shape != NULL; shape = shape->next) {
+
+        if (shape->key_hash == key_hash) {
+            njs_string_get(&shape->name, &str);
+
+            if (nxt_strstr_eq(&str, &key)) {
+                goto found;
+            }
+        }
+    }
+
+    if (parent->transitions == NJS_OBJECT_SHAPE_TRANSITIONS) {
+        return NXT_DECLINED;
+    }
+
+    shape = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
+                                sizeof(njs_object_shape_t));
+    if (nxt_slow_path(shape == NULL)) {
+        return NXT_ERROR;
+    }
+
+    /* GC: retain. */
+    shape->name = *name;
+
+    shape->parent = (parent != vm->shape_root) ? parent : NULL;
+    shape->child = NULL;
+    shape->next = parent->child;
+    shape->key_hash = key_hash;
+    shape->slots = n + 1;
+    shape->transitions = 0;
+
+    parent->child = shape;
+    parent->transitions++;
+
+found:
+
+    /* The slots array grows as 2, 4, 8, 16. */
+
+    if (n == 0 || (n >= 2 && (n & (n - 1)) == 0)) {
+        size = (n == 0) ? 2 : 2 * n;
+
+        slots = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
+                                    size * sizeof(njs_object_slot_t));
+        if (nxt_slow_path(slots == NULL)) {
+            return NXT_ERROR;
+        }
+
+        if (n != 0) {
+            memcpy(slots, object->slots, n * sizeof(njs_object_slot_t));
+            nxt_mem_cache_free(vm->mem_cache_pool, object->slots);
+        }
+
+        object->slots = slots;
+    }
+
+    object->shape = shape;
+
+    return NXT_OK;
+}
+
+
+/*
+ * njs_object_dictionary() moves the object properties from the slots to
+ * the private hash.  The slots are not freed because the hash refers to
+ * them, so the njs_object_prop_t of the object stay in place.
+ */
+
+nxt_int_t
+njs_object_dictionary(njs_vm_t *vm, njs_object_t *object)
+{
+    nxt_int_t           ret;
+    nxt_uint_t          n;
+    njs_object_prop_t   *prop;
+    nxt_lvlhsh_query_t  lhq;
+
+    if (object->shape == NULL) {
+        return NXT_OK;
+    }
+
+    lhq.replace = 0;
+    lhq.proto = &njs_object_hash_proto;
+    lhq.pool = vm->mem_cache_pool;
+
+    for (n = 0; n < object->shape->slots; n++) {
+        prop = &object->slots[n].prop;
+
+        if (prop->type == NJS_WHITEOUT) {
+            continue;
+        }
+
+        njs_string_get(&prop->name, &lhq.key);
+        lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
+        lhq.value = prop;
+
+        ret = nxt_lvlhsh_insert(&object->hash, &lhq);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+    }
+
+    object->shape = NULL;
+    object->slots = NULL;
+
+    return NXT_OK;
+}
+
+
+/*
+ * A deleted property of an object with shape is marked as whiteout
+ * and stays in its slot, so the object keeps its shape.
+ */
+
+void
+njs_object_prop_delete(njs_vm_t *vm, njs_object_t *object,
+    nxt_lvlhsh_query_t *lhq)
+{
+    njs_object_prop_t  *prop;
+
+    if (object->shape != NULL) {
+        prop = lhq->value;
+
+        prop->type = NJS_WHITEOUT;
+        prop->value = njs_value_void;
+
+        return;
+    }
+
+    lhq->pool = vm->mem_cache_pool;
+
+    (void) nxt_lvlhsh_delete(&object->hash, lhq);
+
+    njs_property_cache_flush(vm);
+}
+
+
+njs_object_prop_t *
+njs_object_each(njs_object_t *object, njs_object_each_t *each)
+{
+    njs_object_prop_t  *prop;
+
+    if (object->shape != NULL) {
+
+        while (each->slot < object->shape->slots) {
+            prop = &object->slots[each->slot++].prop;
+
+            if (prop->type != NJS_WHITEOUT) {
+                return prop;
+            }
+        }
+
+        return NULL;
+    }
+
+    return nxt_lvlhsh_each(&object->hash, &each->lhe);
+}
+
+
+njs_ret_t
+njs_object_immutable_error(njs_vm_t *vm)
+{
+    njs_type_error(vm, "cannot modify preinitialized object");
+
+    return NXT_ERROR;
+}
+
+
 /*
  * The njs_property_query() returns values
  *   NXT_OK               property has been found in object,
@@ -225,7 +571,10 @@ njs_object_property(njs_vm_t *vm, const njs_object_t *object,
  *   NJS_PRIMITIVE_VALUE  property operation was applied to a numeric
  *                        or boolean value,
  *   NJS_STRING_VALUE     property operation was applied to a string,
- *   NJS_ARRAY_VALUE      object is array,
+ *   NJS_ARRAY_VALUE      object is array, pq->lhq.value points to
+ *                        the njs_array_item_t,
+ *   NJS_TYPED_ARRAY_VALUE
+ *                        object is typed array, the element is to be set,
  *   NJS_EXTERNAL_VALUE   object is external entity,
  *   NJS_TRAP_PROPERTY    the property trap must be called,
  *   NXT_ERROR            exception has been thrown.
@@ -296,13 +645,33 @@ njs_property_query(njs_vm_t *vm, njs_property_query_t *pq, njs_value_t *object,
     case NJS_OBJECT_TYPE_ERROR:
     case NJS_OBJECT_URI_ERROR:
     case NJS_OBJECT_VALUE:
+    case NJS_ARRAY_BUFFER:
+    case NJS_DATA_VIEW:
+        obj = object->data.u.object;
+        break;
+
+    case NJS_TYPED_ARRAY:
+        if (njs_typed_array_key(property, &index)) {
+            return njs_typed_array_property_query(vm, pq, object, index);
+        }
+
         obj = object->data.u.object;
         break;
 
     case NJS_FUNCTION:
-        function = njs_function_value_copy(vm, object);
-        if (nxt_slow_path(function == NULL)) {
-            return NXT_ERROR;
+        function = object->data.u.function;
+
+        if (function->object.shared && function->native
+            && pq->query <= NJS_PROPERTY_QUERY_IN)
+        {
+            /* A shared native function is copied only to be modified. */
+            function = njs_function_overlay(vm, function, 0);
+
+        } else {
+            function = njs_function_value_copy(vm, object);
+            if (nxt_slow_path(function == NULL)) {
+                return NXT_ERROR;
+            }
         }
 
         obj = &function->object;
@@ -326,6 +695,11 @@ njs_property_query(njs_vm_t *vm, njs_property_query_t *pq, njs_value_t *object,
             ret = njs_primitive_value_to_string(vm, &pq->value, property);
 
             if (nxt_fast_path(ret == NXT_OK)) {
+                ret = njs_string_flat(vm, &pq->value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return ret;
+                }
+
                 njs_string_get(&pq->value, &pq->lhq.key);
                 njs_type_error(vm, "cannot get property '%.*s' of undefined",
                                (int) pq->lhq.key.length, pq->lhq.key.start);
@@ -338,12 +712,23 @@ njs_property_query(njs_vm_t *vm, njs_property_query_t *pq, njs_value_t *object,
         return NXT_ERROR;
     }
 
+    if (nxt_slow_path(obj != NULL && obj->immutable
+                      && pq->query > NJS_PROPERTY_QUERY_IN))
+    {
+        return njs_object_immutable_error(vm);
+    }
+
     if (nxt_fast_path(njs_is_primitive(property))) {
 
         ret = njs_primitive_value_to_string(vm, &pq->value, property);
 
         if (nxt_fast_path(ret == NXT_OK)) {
 
+            ret = njs_string_flat(vm, &pq->value);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+
             njs_string_get(&pq->value, &pq->lhq.key);
             pq->lhq.key_hash = hash(pq->lhq.key.start, pq->lhq.key.length);
 
@@ -382,18 +767,12 @@ njs_object_property_query(njs_vm_t *vm, njs_property_query_t *pq,
     do {
         pq->prototype = object;
 
-        ret = nxt_lvlhsh_find(&object->hash, &pq->lhq);
+        ret = njs_object_own_find(object, &pq->lhq);
 
         if (ret == NXT_OK) {
-            prop = pq->lhq.value;
+            pq->shared = 0;
 
-            if (prop->type != NJS_WHITEOUT) {
-                pq->shared = 0;
-
-                return ret;
-            }
-
-            goto next;
+            return ret;
         }
 
         if (pq->query > NJS_PROPERTY_QUERY_IN) {
@@ -430,9 +809,7 @@ njs_object_property_query(njs_vm_t *vm, njs_property_query_t *pq,
             return ret;
         }
 
-    next:
-
-        object = object->__proto__;
+        object = njs_object_proto(vm, object);
 
     } while (object != NULL);
 
@@ -450,13 +827,19 @@ static njs_ret_t
 njs_array_property_query(njs_vm_t *vm, njs_property_query_t *pq,
     njs_value_t *object, uint32_t index)
 {
-    uint32_t     size;
-    njs_ret_t    ret;
-    njs_value_t  *value;
-    njs_array_t  *array;
+    uint32_t          size;
+    njs_ret_t         ret;
+    njs_array_t       *array;
+    njs_array_item_t  *item;
 
     array = object->data.u.array;
 
+    if (nxt_slow_path(array->object.immutable
+                      && pq->query > NJS_PROPERTY_QUERY_IN))
+    {
+        return njs_object_immutable_error(vm);
+    }
+
     if (index >= array->length) {
         if (pq->query != NJS_PROPERTY_QUERY_SET) {
             return NXT_DECLINED;
@@ -469,11 +852,15 @@ njs_array_property_query(njs_vm_t *vm, njs_property_query_t *pq,
             return ret;
         }
 
-        value = &array->start[array->length];
+        if (size != 0) {
+            array->kind = NJS_ARRAY_HOLEY;
+        }
+
+        item = &array->start[array->length];
 
         while (size != 0) {
-            njs_set_invalid(value);
-            value++;
+            njs_array_item_set_invalid(item);
+            item++;
             size--;
         }
 
@@ -486,6 +873,54 @@ njs_array_property_query(njs_vm_t *vm, njs_property_query_t *pq,
 }
 
 
+static njs_ret_t
+njs_typed_array_property_query(njs_vm_t *vm, njs_property_query_t *pq,
+    njs_value_t *object, uint32_t index)
+{
+    njs_object_prop_t  *prop;
+    njs_typed_array_t  *array;
+
+    array = object->data.u.typed_array;
+
+    /*
+     * The typed array elements are neither created nor deleted,
+     * the out of bounds elements are not looked up in the prototypes.
+     */
+
+    if (index >= njs_typed_array_length(array)) {
+        return (pq->query > NJS_PROPERTY_QUERY_IN) ? NJS_PRIMITIVE_VALUE
+                                                   : NXT_DECLINED;
+    }
+
+    switch (pq->query) {
+
+    case NJS_PROPERTY_QUERY_SET:
+        return NJS_TYPED_ARRAY_VALUE;
+
+    case NJS_PROPERTY_QUERY_DELETE:
+        return NJS_PRIMITIVE_VALUE;
+
+    default:
+        /* The element is returned as the scratch property. */
+
+        prop = &pq->scratch;
+
+        njs_typed_array_get(array, index, &prop->value);
+        prop->name = njs_string_empty;
+        prop->type = NJS_PROPERTY;
+        prop->enumerable = 1;
+        prop->writable = 1;
+        prop->configurable = 0;
+
+        pq->lhq.value = prop;
+        pq->prototype = &array->object;
+        pq->shared = 1;
+
+        return NXT_OK;
+    }
+}
+
+
 static njs_ret_t
 njs_object_query_prop_handler(njs_property_query_t *pq, njs_object_t *object)
 {
@@ -636,11 +1071,11 @@ njs_object_keys_array(njs_vm_t *vm, const njs_value_t *object)
 {
     size_t             size;
     uint32_t           i, n, keys_length, array_length;
-    njs_value_t        *value;
+    njs_ret_t          ret;
+    njs_value_t        value;
     njs_array_t        *keys, *array;
-    nxt_lvlhsh_t       *hash;
     njs_object_prop_t  *prop;
-    nxt_lvlhsh_each_t  lhe;
+    njs_object_each_t  each;
 
     array = NULL;
     keys_length = 0;
@@ -651,18 +1086,20 @@ njs_object_keys_array(njs_vm_t *vm, const njs_value_t *object)
         array_length = array->length;
 
         for (i = 0; i < array_length; i++) {
-            if (njs_is_valid(&array->start[i])) {
+            if (njs_array_item_is_valid(&array->start[i])) {
                 keys_length++;
             }
         }
-    }
 
-    nxt_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
+    } else if (njs_is_typed_array(object)) {
+        array_length = njs_typed_array_length(object->data.u.typed_array);
+        keys_length = array_length;
+    }
 
-    hash = &object->data.u.object->hash;
+    njs_object_each_init(&each);
 
     for ( ;; ) {
-        prop = nxt_lvlhsh_each(hash, &lhe);
+        prop = njs_object_each(object->data.u.object, &each);
 
         if (prop == NULL) {
             break;
@@ -681,29 +1118,38 @@ njs_object_keys_array(njs_vm_t *vm, const njs_value_t *object)
     n = 0;
 
     for (i = 0; i < array_length; i++) {
-        if (njs_is_valid(&array->start[i])) {
-            value = &keys->start[n++];
+        if (array == NULL || njs_array_item_is_valid(&array->start[i])) {
             /*
              * The maximum array index is 4294967294, so
              * it can be stored as a short string inside value.
              */
-            size = snprintf((char *) njs_string_short_start(value),
+            size = snprintf((char *) njs_string_short_start(&value),
                             NJS_STRING_SHORT, "%u", i);
-            njs_string_short_set(value, size, size);
+            njs_string_short_set(&value, size, size);
+
+            ret = njs_array_value_set(vm, keys, &keys->start[n++], &value);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NULL;
+            }
         }
     }
 
-    nxt_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
+    njs_object_each_init(&each);
 
     for ( ;; ) {
-        prop = nxt_lvlhsh_each(hash, &lhe);
+        prop = njs_object_each(object->data.u.object, &each);
 
         if (prop == NULL) {
             break;
         }
 
         if (prop->enumerable) {
-            njs_string_copy(&keys->start[n++], &prop->name);
+            njs_string_copy(&value, &prop->name);
+
+            ret = njs_array_value_set(vm, keys, &keys->start[n++], &value);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NULL;
+            }
         }
     }
 
@@ -726,6 +1172,10 @@ njs_object_define_property(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         return NXT_ERROR;
     }
 
+    if (nxt_slow_path(value->data.u.object->immutable)) {
+        return njs_object_immutable_error(vm);
+    }
+
     if (!value->data.u.object->extensible) {
         njs_type_error(vm, "object is not extensible");
         return NXT_ERROR;
@@ -758,9 +1208,8 @@ njs_object_define_properties(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
     nxt_int_t          ret;
-    nxt_lvlhsh_t       *hash;
     njs_object_t       *object;
-    nxt_lvlhsh_each_t  lhe;
+    njs_object_each_t  each;
     njs_object_prop_t  *prop;
     const njs_value_t  *value, *descriptor;
 
@@ -773,6 +1222,10 @@ njs_object_define_properties(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         return NXT_ERROR;
     }
 
+    if (nxt_slow_path(value->data.u.object->immutable)) {
+        return njs_object_immutable_error(vm);
+    }
+
     if (!value->data.u.object->extensible) {
         njs_type_error(vm, "object is not extensible");
         return NXT_ERROR;
@@ -785,13 +1238,12 @@ njs_object_define_properties(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         return NXT_ERROR;
     }
 
-    nxt_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
+    njs_object_each_init(&each);
 
     object = value->data.u.object;
-    hash = &descriptor->data.u.object->hash;
 
     for ( ;; ) {
-        prop = nxt_lvlhsh_each(hash, &lhe);
+        prop = njs_object_each(descriptor->data.u.object, &each);
 
         if (prop == NULL) {
             break;
@@ -825,16 +1277,18 @@ njs_define_property(njs_vm_t *vm, njs_object_t *object, const njs_value_t *name,
     lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
     lhq.proto = &njs_object_hash_proto;
 
-    ret = nxt_lvlhsh_find(&object->hash, &lhq);
+    ret = njs_object_own_find(object, &lhq);
 
     if (ret != NXT_OK) {
-        prop = njs_object_prop_alloc(vm, name, &njs_value_void, 0);
+        prop = njs_object_prop_add(vm, object, name, &lhq);
 
         if (nxt_slow_path(prop == NULL)) {
             return NXT_ERROR;
         }
 
-        lhq.value = prop;
+        prop->enumerable = 0;
+        prop->writable = 0;
+        prop->configurable = 0;
 
     } else {
         prop = lhq.value;
@@ -877,14 +1331,6 @@ njs_define_property(njs_vm_t *vm, njs_object_t *object, const njs_value_t *name,
         prop->writable = pr->value.data.truth;
     }
 
-    lhq.replace = 0;
-    lhq.pool = vm->mem_cache_pool;
-
-    ret = nxt_lvlhsh_insert(&object->hash, &lhq);
-    if (nxt_slow_path(ret != NXT_OK)) {
-        return NXT_ERROR;
-    }
-
     return NXT_OK;
 }
 
@@ -935,12 +1381,12 @@ njs_object_get_own_property_descriptor(njs_vm_t *vm, njs_value_t *args,
 
         if ((double) index == num
             && index < array->length
-            && njs_is_valid(&array->start[index]))
+            && njs_array_item_is_valid(&array->start[index]))
         {
             prop = &array_prop;
 
             array_prop.name = *property;
-            array_prop.value = array->start[index];
+            njs_array_item_get(&array->start[index], &array_prop.value);
 
             array_prop.configurable = 1;
             array_prop.enumerable = 1;
@@ -1074,10 +1520,9 @@ static njs_ret_t
 njs_object_freeze(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    nxt_lvlhsh_t       *hash;
     njs_object_t       *object;
     njs_object_prop_t  *prop;
-    nxt_lvlhsh_each_t  lhe;
+    njs_object_each_t  each;
     const njs_value_t  *value;
 
     value = njs_arg(args, nargs, 1);
@@ -1090,12 +1535,10 @@ njs_object_freeze(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     object = value->data.u.object;
     object->extensible = 0;
 
-    nxt_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
-
-    hash = &object->hash;
+    njs_object_each_init(&each);
 
     for ( ;; ) {
-        prop = nxt_lvlhsh_each(hash, &lhe);
+        prop = njs_object_each(object, &each);
 
         if (prop == NULL) {
             break;
@@ -1115,10 +1558,9 @@ static njs_ret_t
 njs_object_is_frozen(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    nxt_lvlhsh_t       *hash;
     njs_object_t       *object;
     njs_object_prop_t  *prop;
-    nxt_lvlhsh_each_t  lhe;
+    njs_object_each_t  each;
     const njs_value_t  *value, *retval;
 
     value = njs_arg(args, nargs, 1);
@@ -1131,16 +1573,14 @@ njs_object_is_frozen(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     retval = &njs_value_false;
 
     object = value->data.u.object;
-    nxt_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
-
-    hash = &object->hash;
+    njs_object_each_init(&each);
 
     if (object->extensible) {
         goto done;
     }
 
     for ( ;; ) {
-        prop = nxt_lvlhsh_each(hash, &lhe);
+        prop = njs_object_each(object, &each);
 
         if (prop == NULL) {
             break;
@@ -1165,11 +1605,10 @@ static njs_ret_t
 njs_object_seal(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    nxt_lvlhsh_t       *hash;
     njs_object_t       *object;
     const njs_value_t  *value;
     njs_object_prop_t  *prop;
-    nxt_lvlhsh_each_t  lhe;
+    njs_object_each_t  each;
 
     value = njs_arg(args, nargs, 1);
 
@@ -1181,12 +1620,10 @@ njs_object_seal(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     object = value->data.u.object;
     object->extensible = 0;
 
-    nxt_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
-
-    hash = &object->hash;
+    njs_object_each_init(&each);
 
     for ( ;; ) {
-        prop = nxt_lvlhsh_each(hash, &lhe);
+        prop = njs_object_each(object, &each);
 
         if (prop == NULL) {
             break;
@@ -1205,10 +1642,9 @@ static njs_ret_t
 njs_object_is_sealed(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    nxt_lvlhsh_t       *hash;
     njs_object_t       *object;
     njs_object_prop_t  *prop;
-    nxt_lvlhsh_each_t  lhe;
+    njs_object_each_t  each;
     const njs_value_t  *value, *retval;
 
     value = njs_arg(args, nargs, 1);
@@ -1221,16 +1657,14 @@ njs_object_is_sealed(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     retval = &njs_value_false;
 
     object = value->data.u.object;
-    nxt_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
-
-    hash = &object->hash;
+    njs_object_each_init(&each);
 
     if (object->extensible) {
         goto done;
     }
 
     for ( ;; ) {
-        prop = nxt_lvlhsh_each(hash, &lhe);
+        prop = njs_object_each(object, &each);
 
         if (prop == NULL) {
             break;
@@ -1312,7 +1746,7 @@ njs_primitive_prototype_get_proto(njs_vm_t *vm, njs_value_t *value,
      * and have to return different results for primitive type and for objects.
      */
     if (njs_is_object(value)) {
-        proto = value->data.u.object->__proto__;
+        proto = njs_object_proto(vm, value->data.u.object);
 
     } else {
         index = njs_primitive_prototype_index(value->type);
@@ -1537,7 +1971,7 @@ njs_object_prototype_get_proto(njs_vm_t *vm, njs_value_t *value,
 {
     njs_object_t  *proto;
 
-    proto = value->data.u.object->__proto__;
+    proto = njs_object_proto(vm, value->data.u.object);
 
     if (nxt_fast_path(proto != NULL)) {
         retval->data.u.object = proto;
@@ -1578,7 +2012,7 @@ njs_object_prototype_create_constructor(njs_vm_t *vm, njs_value_t *value,
                 goto found;
             }
 
-            object = object->__proto__;
+            object = njs_object_proto(vm, object);
 
         } while (object != NULL);
 
@@ -1676,6 +2110,18 @@ static const njs_value_t  njs_object_function_string =
 static const njs_value_t  njs_object_regexp_string =
                                      njs_long_string("[object RegExp]");
 static const njs_value_t  njs_object_date_string = njs_string("[object Date]");
+static const njs_value_t  njs_object_array_buffer_string =
+                                     njs_long_string("[object ArrayBuffer]");
+static const njs_value_t  njs_object_data_view_string =
+                                     njs_long_string("[object DataView]");
+static const njs_value_t  njs_object_uint8_array_string =
+                                     njs_long_string("[object Uint8Array]");
+static const njs_value_t  njs_object_uint16_array_string =
+                                     njs_long_string("[object Uint16Array]");
+static const njs_value_t  njs_object_uint32_array_string =
+                                     njs_long_string("[object Uint32Array]");
+static const njs_value_t  njs_object_float64_array_string =
+                                     njs_long_string("[object Float64Array]");
 static const njs_value_t  njs_object_error_string =
                                      njs_string("[object Error]");
 static const njs_value_t  njs_object_eval_error_string =
@@ -1735,6 +2181,14 @@ njs_object_prototype_to_string(njs_vm_t *vm, njs_value_t *args,
         &njs_object_function_string,
         &njs_object_regexp_string,
         &njs_object_date_string,
+        &njs_object_object_string,
+        &njs_object_object_string,
+        &njs_object_array_buffer_string,
+        &njs_object_data_view_string,
+        &njs_object_uint8_array_string,
+        &njs_object_uint16_array_string,
+        &njs_object_uint32_array_string,
+        &njs_object_float64_array_string,
         &njs_object_error_string,
         &njs_object_eval_error_string,
         &njs_object_internal_error_string,
@@ -1761,7 +2215,7 @@ njs_object_prototype_to_string(njs_vm_t *vm, njs_value_t *args,
                 goto found;
             }
 
-            object = object->__proto__;
+            object = njs_object_proto(vm, object);
 
         } while (object != NULL);
 
@@ -1799,7 +2253,9 @@ njs_object_prototype_has_own_property(njs_vm_t *vm, njs_value_t *args,
             array = value->data.u.array;
             index = njs_string_to_index(prop);
 
-            if (index < array->length && njs_is_valid(&array->start[index])) {
+            if (index < array->length
+                && njs_array_item_is_valid(&array->start[index]))
+            {
                 retval = &njs_value_true;
                 goto done;
             }
@@ -1809,7 +2265,7 @@ njs_object_prototype_has_own_property(njs_vm_t *vm, njs_value_t *args,
         lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
         lhq.proto = &njs_object_hash_proto;
 
-        ret = nxt_lvlhsh_find(&value->data.u.object->hash, &lhq);
+        ret = njs_object_own_find(value->data.u.object, &lhq);
 
         if (ret == NXT_OK) {
             retval = &njs_value_true;
@@ -1840,7 +2296,7 @@ njs_object_prototype_is_prototype_of(njs_vm_t *vm, njs_value_t *args,
         object = value->data.u.object;
 
         do {
-            object = object->__proto__;
+            object = njs_object_proto(vm, object);
 
             if (object == proto) {
                 retval = &njs_value_true;
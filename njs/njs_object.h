@@ -30,6 +30,68 @@ typedef struct {
 } njs_object_prop_t;
 
 
+/*
+ * Plain objects which get their properties by assignment share hidden
+ * classes.  A shape describes the names and the order of the properties
+ * and the object stores the properties themselves in its slots array,
+ * so objects built by the same code share a single shape instead of
+ * having private hashes.  The shapes form a transition tree rooted in
+ * vm->shape_root.  An object with too many properties falls back to
+ * the private hash, see njs_object_dictionary().
+ */
+
+struct njs_object_shape_s {
+    /* The name of the last property, must be aligned to njs_value_t. */
+    njs_value_t                 name;
+
+    njs_object_shape_t          *parent;
+    /* The shapes with one more property. */
+    njs_object_shape_t          *child;
+    njs_object_shape_t          *next;
+
+    uint32_t                    key_hash;
+    /* The number of properties, it is also the number of used slots. */
+    uint32_t                    slots;
+    uint32_t                    transitions;
+};
+
+
+union njs_object_slot_u {
+    njs_object_prop_t           prop;
+    /* Aligns the slots to njs_value_t. */
+    njs_value_t                 align[3];
+};
+
+
+#define NJS_OBJECT_SHAPE_MAX          16
+#define NJS_OBJECT_SHAPE_TRANSITIONS  32
+
+
+typedef struct {
+    nxt_lvlhsh_each_t           lhe;
+    uint32_t                    slot;
+} njs_object_each_t;
+
+
+#define njs_object_each_init(each)                                            \
+    do {                                                                      \
+        nxt_lvlhsh_each_init(&(each)->lhe, &njs_object_hash_proto);           \
+        (each)->slot = 0;                                                     \
+    } while (0)
+
+
+#define njs_object_is_empty(object)                                           \
+    ((object)->shape == NULL && nxt_lvlhsh_is_empty(&(object)->hash))
+
+
+/* A shared native function has no __proto__ of its own. */
+#define njs_object_proto(vm, obj)                                             \
+    (((obj)->__proto__ == NULL && (obj)->shared                               \
+      && (obj)->type == NJS_FUNCTION)                                         \
+     ? &(vm)->prototypes[NJS_PROTOTYPE_FUNCTION].object                       \
+     : (obj)->__proto__)
+
+
 typedef struct {
     nxt_lvlhsh_query_t          lhq;
 
@@ -58,8 +120,18 @@ njs_object_t *njs_object_value_alloc(njs_vm_t *vm, const njs_value_t *value,
 njs_array_t *njs_object_keys_array(njs_vm_t *vm, const njs_value_t *object);
 njs_object_prop_t *njs_object_property(njs_vm_t *vm, const njs_object_t *obj,
     nxt_lvlhsh_query_t *lhq);
+nxt_int_t njs_object_own_find(const njs_object_t *object,
+    nxt_lvlhsh_query_t *lhq);
+njs_object_prop_t *njs_object_prop_add(njs_vm_t *vm, njs_object_t *object,
+    const njs_value_t *name, nxt_lvlhsh_query_t *lhq);
+void njs_object_prop_delete(njs_vm_t *vm, njs_object_t *object,
+    nxt_lvlhsh_query_t *lhq);
+nxt_int_t njs_object_dictionary(njs_vm_t *vm, njs_object_t *object);
+njs_object_prop_t *njs_object_each(njs_object_t *object,
+    njs_object_each_t *each);
 njs_ret_t njs_property_query(njs_vm_t *vm, njs_property_query_t *pq,
     njs_value_t *object, njs_value_t *property);
+njs_ret_t njs_object_immutable_error(njs_vm_t *vm);
 nxt_int_t njs_object_hash_create(njs_vm_t *vm, nxt_lvlhsh_t *hash,
     const njs_object_prop_t *prop, nxt_uint_t n);
 njs_ret_t njs_object_constructor(njs_vm_t *vm, njs_value_t *args,
@@ -1926,9 +1926,8 @@ njs_parser_terminal(njs_vm_t *vm, njs_parser_t *parser, njs_token_t token)
         nxt_thread_log_debug("JS: %f", parser->lexer->number);
 
         num = parser->lexer->number;
-        node->u.value.data.u.number = num;
-        node->u.value.type = NJS_NUMBER;
-        node->u.value.data.truth = njs_is_number_true(num);
+        njs_value_number_set(&node->u.value, num);
+        njs_value_int32_hint(&node->u.value, num);
 
         break;
 
@@ -2005,6 +2004,30 @@ njs_parser_terminal(njs_vm_t *vm, njs_parser_t *parser, njs_token_t token)
         node->index = NJS_INDEX_DATE;
         break;
 
+    case NJS_TOKEN_ARRAY_BUFFER_CONSTRUCTOR:
+        node->index = NJS_INDEX_ARRAY_BUFFER;
+        break;
+
+    case NJS_TOKEN_DATA_VIEW_CONSTRUCTOR:
+        node->index = NJS_INDEX_DATA_VIEW;
+        break;
+
+    case NJS_TOKEN_UINT8_ARRAY_CONSTRUCTOR:
+        node->index = NJS_INDEX_UINT8_ARRAY;
+        break;
+
+    case NJS_TOKEN_UINT16_ARRAY_CONSTRUCTOR:
+        node->index = NJS_INDEX_UINT16_ARRAY;
+        break;
+
+    case NJS_TOKEN_UINT32_ARRAY_CONSTRUCTOR:
+        node->index = NJS_INDEX_UINT32_ARRAY;
+        break;
+
+    case NJS_TOKEN_FLOAT64_ARRAY_CONSTRUCTOR:
+        node->index = NJS_INDEX_FLOAT64_ARRAY;
+        break;
+
     case NJS_TOKEN_ERROR_CONSTRUCTOR:
         node->index = NJS_INDEX_OBJECT_ERROR;
         break;
@@ -2256,9 +2279,8 @@ njs_parser_array(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *obj)
         }
 
         node->token = NJS_TOKEN_NUMBER;
-        node->u.value.data.u.number = index;
-        node->u.value.type = NJS_NUMBER;
-        node->u.value.data.truth = (index != 0);
+        njs_value_number_set(&node->u.value, index);
+        njs_value_int32_hint(&node->u.value, index);
         index++;
 
         object = njs_parser_node_alloc(vm);
@@ -177,6 +177,12 @@ typedef enum {
     NJS_TOKEN_FUNCTION_CONSTRUCTOR,
     NJS_TOKEN_REGEXP_CONSTRUCTOR,
     NJS_TOKEN_DATE_CONSTRUCTOR,
+    NJS_TOKEN_ARRAY_BUFFER_CONSTRUCTOR,
+    NJS_TOKEN_DATA_VIEW_CONSTRUCTOR,
+    NJS_TOKEN_UINT8_ARRAY_CONSTRUCTOR,
+    NJS_TOKEN_UINT16_ARRAY_CONSTRUCTOR,
+    NJS_TOKEN_UINT32_ARRAY_CONSTRUCTOR,
+    NJS_TOKEN_FLOAT64_ARRAY_CONSTRUCTOR,
     NJS_TOKEN_ERROR_CONSTRUCTOR,
     NJS_TOKEN_EVAL_ERROR_CONSTRUCTOR,
     NJS_TOKEN_INTERNAL_ERROR_CONSTRUCTOR,
@@ -755,8 +755,8 @@ njs_parser_unary_expression(njs_vm_t *vm, njs_parser_t *parser,
 
         /* Optimization of common negative number. */
         num = -node->u.value.data.u.number;
-        node->u.value.data.u.number = num;
-        node->u.value.data.truth = njs_is_number_true(num);
+        njs_value_number_set(&node->u.value, num);
+        njs_value_int32_hint(&node->u.value, num);
 
         return next;
     }
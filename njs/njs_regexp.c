@@ -16,8 +16,21 @@ static void *njs_regexp_malloc(size_t size, void *memory_data);
 static void njs_regexp_free(void *p, void *memory_data);
 static njs_regexp_flags_t njs_regexp_flags(u_char **start, u_char *end,
     nxt_bool_t bound);
-static int njs_regexp_pattern_compile(njs_vm_t *vm, nxt_regex_t *regex,
-    u_char *source, int options);
+static nxt_int_t njs_regexp_pattern_hash_test(nxt_lvlhsh_query_t *lhq,
+    void *data);
+static int njs_regexp_pattern_compile(njs_vm_t *vm,
+    njs_regexp_pattern_t *pattern, nxt_regex_t *regex, int options);
+static nxt_int_t njs_regexp_pattern_add(njs_vm_t *vm,
+    njs_regexp_pattern_t *pattern);
+static void njs_regexp_pattern_free(njs_regexp_pattern_t *pattern);
+static void njs_regexp_pattern_literal(njs_regexp_pattern_t *pattern,
+    const u_char *p, const u_char *end);
+static const u_char *njs_regexp_literal_class(const u_char *p,
+    const u_char *end);
+static const u_char *njs_regexp_literal_group(const u_char *p,
+    const u_char *end);
+static const u_char *njs_regexp_literal_quantifier(const u_char *p,
+    const u_char *end, nxt_uint_t *min);
 static u_char *njs_regexp_compile_trace_handler(nxt_trace_t *trace,
     nxt_trace_data_t *td, u_char *start);
 static u_char *njs_regexp_match_trace_handler(nxt_trace_t *trace,
@@ -28,9 +41,33 @@ static njs_ret_t njs_regexp_string_create(njs_vm_t *vm, njs_value_t *value,
     u_char *start, uint32_t size, int32_t length);
 
 
+/* The maximum number of the patterns cached in the shared data. */
+#define NJS_REGEXP_PATTERNS_MAX  256
+
+
+static const nxt_lvlhsh_proto_t  njs_regexp_pattern_hash_proto
+    nxt_aligned(64) =
+{
+    NXT_LVLHSH_DEFAULT,
+    0,
+    njs_regexp_pattern_hash_test,
+    njs_lvlhsh_alloc,
+    njs_lvlhsh_free,
+};
+
+
+/*
+ * The regex context and the single match data are created on the first
+ * use of regular expressions in a VM, most of the VMs never need them.
+ */
+
 njs_ret_t
 njs_regexp_init(njs_vm_t *vm)
 {
+    if (nxt_fast_path(vm->regex_context != NULL)) {
+        return NXT_OK;
+    }
+
     vm->regex_context = nxt_regex_context_create(njs_regexp_malloc,
                                           njs_regexp_free, vm->mem_cache_pool);
     if (nxt_slow_path(vm->regex_context == NULL)) {
@@ -44,6 +81,8 @@ njs_regexp_init(njs_vm_t *vm)
 
     vm->regex_context->trace = &vm->trace;
 
+    vm->shared->init_stats.regexp++;
+
     return NXT_OK;
 }
 
@@ -253,24 +292,59 @@ njs_regexp_pattern_t *
 njs_regexp_pattern_create(njs_vm_t *vm, u_char *start, size_t length,
     njs_regexp_flags_t flags)
 {
-    int                   options, ret;
+    int                   ret;
     u_char                *p, *end;
     size_t                size;
+    njs_vm_t              *owner;
+    nxt_bool_t            cached;
+    njs_vm_shared_t       *shared;
+    nxt_lvlhsh_query_t    lhq;
     njs_regexp_pattern_t  *pattern;
 
+    shared = vm->shared;
+
+    lhq.key_hash = nxt_djb_hash_add(nxt_djb_hash(start, length), flags);
+    lhq.key.length = length;
+    lhq.key.start = start;
+    lhq.proto = &njs_regexp_pattern_hash_proto;
+    lhq.data = &flags;
+
+    if (nxt_lvlhsh_find(&shared->patterns_hash, &lhq) == NXT_OK) {
+        return lhq.value;
+    }
+
+    /*
+     * A new pattern is allocated and compiled in the memory of the VM
+     * which has created the shared data and is cached there, so the clones
+     * of the VM reuse the pattern instead of compiling it again.  The memory
+     * is freed only with the VM, so the number of cached patterns is limited
+     * and the rest of patterns are allocated in the memory of the VM.
+     */
+
+    cached = (shared->npatterns < NJS_REGEXP_PATTERNS_MAX);
+    owner = cached ? shared->patterns_owner : vm;
+
+    ret = njs_regexp_init(owner);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return NULL;
+    }
+
     size = 1;  /* A trailing "/". */
     size += ((flags & NJS_REGEXP_GLOBAL) != 0);
     size += ((flags & NJS_REGEXP_IGNORE_CASE) != 0);
     size += ((flags & NJS_REGEXP_MULTILINE) != 0);
 
-    pattern = nxt_mem_cache_zalloc(vm->mem_cache_pool,
+    /* The source and the literal. */
+
+    pattern = nxt_mem_cache_zalloc(owner->mem_cache_pool,
                                    sizeof(njs_regexp_pattern_t)
-                                   + 1 + length + size + 1);
+                                   + 1 + length + size + 1 + length);
     if (nxt_slow_path(pattern == NULL)) {
         return NULL;
     }
 
     pattern->flags = size;
+    pattern->regex_context = owner->regex_context;
 
     p = (u_char *) pattern + sizeof(njs_regexp_pattern_t);
     pattern->source = p;
@@ -286,70 +360,251 @@ njs_regexp_pattern_create(njs_vm_t *vm, u_char *start, size_t length,
         *p++ = 'g';
     }
 
-#ifdef PCRE_JAVASCRIPT_COMPAT
-    /* JavaScript compatibility has been introduced in PCRE-7.7. */
-    options = PCRE_JAVASCRIPT_COMPAT;
-#else
-    options = 0;
-#endif
-
     pattern->ignore_case = ((flags & NJS_REGEXP_IGNORE_CASE) != 0);
     if (pattern->ignore_case) {
         *p++ = 'i';
-         options |= PCRE_CASELESS;
     }
 
     pattern->multiline = ((flags & NJS_REGEXP_MULTILINE) != 0);
     if (pattern->multiline) {
         *p++ = 'm';
-         options |= PCRE_MULTILINE;
     }
 
     *p++ = '\0';
 
-    ret = njs_regexp_pattern_compile(vm, &pattern->regex[0],
-                                     &pattern->source[1], options);
+    pattern->literal = p;
+
+    /* The byte string variant is compiled by njs_regexp_pattern_byte(). */
+
+    ret = njs_regexp_pattern_compile(vm, pattern, &pattern->regex[1],
+                                     NXT_REGEX_UTF8);
     if (nxt_slow_path(ret < 0)) {
+        nxt_mem_cache_free(owner->mem_cache_pool, pattern);
+        return NULL;
+    }
+
+    if (nxt_slow_path(njs_regexp_pattern_add(owner, pattern) != NXT_OK)) {
+        njs_regexp_pattern_free(pattern);
+        nxt_mem_cache_free(owner->mem_cache_pool, pattern);
+        njs_memory_error(vm);
         return NULL;
     }
 
     pattern->ncaptures = ret;
 
-    ret = njs_regexp_pattern_compile(vm, &pattern->regex[1],
-                                     &pattern->source[1], options | PCRE_UTF8);
-    if (nxt_fast_path(ret >= 0)) {
+    *end = '/';
+
+    njs_regexp_pattern_literal(pattern, start, start + length);
+
+    if (cached) {
+        lhq.replace = 0;
+        lhq.value = pattern;
+        lhq.pool = owner->mem_cache_pool;
 
-        if (nxt_slow_path((u_int) ret != pattern->ncaptures)) {
-            njs_internal_error(vm, NULL);
-            nxt_mem_cache_free(vm->mem_cache_pool, pattern);
+        ret = nxt_lvlhsh_insert(&shared->patterns_hash, &lhq);
+        if (nxt_slow_path(ret != NXT_OK)) {
             return NULL;
         }
 
-    } else if (ret != NXT_DECLINED) {
-        nxt_mem_cache_free(vm->mem_cache_pool, pattern);
-        return NULL;
+        shared->npatterns++;
     }
 
+    return pattern;
+}
+
+
+static nxt_int_t
+njs_regexp_pattern_hash_test(nxt_lvlhsh_query_t *lhq, void *data)
+{
+    size_t                length;
+    njs_regexp_flags_t    flags;
+    njs_regexp_pattern_t  *pattern;
+
+    pattern = data;
+    flags = *(njs_regexp_flags_t *) lhq->data;
+
+    if (pattern->global != ((flags & NJS_REGEXP_GLOBAL) != 0)
+        || pattern->ignore_case != ((flags & NJS_REGEXP_IGNORE_CASE) != 0)
+        || pattern->multiline != ((flags & NJS_REGEXP_MULTILINE) != 0))
+    {
+        return NXT_DECLINED;
+    }
+
+    length = strlen((char *) pattern->source) - pattern->flags - 1;
+
+    if (length == lhq->key.length
+        && memcmp(&pattern->source[1], lhq->key.start, length) == 0)
+    {
+        return NXT_OK;
+    }
+
+    return NXT_DECLINED;
+}
+
+
+/*
+ * Most of the patterns never match byte strings, so the byte string
+ * variant of a pattern is compiled on the first match of a byte string.
+ */
+
+nxt_regex_t *
+njs_regexp_pattern_byte(njs_vm_t *vm, njs_regexp_pattern_t *pattern)
+{
+    int     ret;
+    u_char  *end;
+
+    /* The pattern source is zero-terminated during compilation. */
+
+    end = pattern->source + strlen((char *) pattern->source) - pattern->flags;
+    *end = '\0';
+
+    ret = njs_regexp_pattern_compile(vm, pattern, &pattern->regex[0], 0);
+
     *end = '/';
 
-    return pattern;
+    if (nxt_slow_path(ret < 0)) {
+        return NULL;
+    }
+
+    if (nxt_slow_path((u_int) ret != pattern->ncaptures)) {
+        njs_internal_error(vm, NULL);
+        return NULL;
+    }
+
+    pattern->byte_compiled = 1;
+
+    return &pattern->regex[0];
+}
+
+
+/*
+ * The compiled regexes may have JIT code which is allocated outside of
+ * the VM memory, so the patterns are listed in the VM and their regexes
+ * are freed by njs_regexp_patterns_sweep() when the collector finds the
+ * patterns unreachable, or by njs_regexp_patterns_free() with the VM.
+ */
+
+static nxt_int_t
+njs_regexp_pattern_add(njs_vm_t *vm, njs_regexp_pattern_t *pattern)
+{
+    nxt_uint_t            size;
+    njs_regexp_pattern_t  **patterns;
+
+    if (vm->npatterns == vm->patterns_size) {
+        size = (vm->patterns_size != 0) ? vm->patterns_size * 2 : 16;
+
+        patterns = nxt_malloc(size * sizeof(njs_regexp_pattern_t *));
+        if (nxt_slow_path(patterns == NULL)) {
+            return NXT_ERROR;
+        }
+
+        if (vm->patterns != NULL) {
+            memcpy(patterns, vm->patterns,
+                   vm->npatterns * sizeof(njs_regexp_pattern_t *));
+            nxt_free(vm->patterns);
+        }
+
+        vm->patterns = patterns;
+        vm->patterns_size = size;
+    }
+
+    vm->patterns[vm->npatterns++] = pattern;
+
+    return NXT_OK;
+}
+
+
+/*
+ * njs_regexp_patterns_sweep() is called between the marking and
+ * the sweeping of the VM memory.
+ */
+
+void
+njs_regexp_patterns_sweep(njs_vm_t *vm)
+{
+    nxt_uint_t            i, n;
+    njs_regexp_pattern_t  *pattern;
+
+    n = 0;
+
+    for (i = 0; i < vm->npatterns; i++) {
+        pattern = vm->patterns[i];
+
+        if (nxt_mem_cache_is_marked(vm->mem_cache_pool, pattern)) {
+            vm->patterns[n++] = pattern;
+
+        } else {
+            njs_regexp_pattern_free(pattern);
+        }
+    }
+
+    vm->npatterns = n;
+}
+
+
+void
+njs_regexp_patterns_free(njs_vm_t *vm)
+{
+    nxt_uint_t  i;
+
+    for (i = 0; i < vm->npatterns; i++) {
+        njs_regexp_pattern_free(vm->patterns[i]);
+    }
+
+    if (vm->patterns != NULL) {
+        nxt_free(vm->patterns);
+    }
+
+    vm->patterns = NULL;
+    vm->npatterns = 0;
+    vm->patterns_size = 0;
+}
+
+
+static void
+njs_regexp_pattern_free(njs_regexp_pattern_t *pattern)
+{
+    nxt_regex_free(&pattern->regex[0], pattern->regex_context);
+    nxt_regex_free(&pattern->regex[1], pattern->regex_context);
 }
 
 
 static int
-njs_regexp_pattern_compile(njs_vm_t *vm, nxt_regex_t *regex, u_char *source,
-    int options)
+njs_regexp_pattern_compile(njs_vm_t *vm, njs_regexp_pattern_t *pattern,
+    nxt_regex_t *regex, int options)
 {
     nxt_int_t            ret;
+    nxt_trace_t          *trace;
     nxt_trace_handler_t  handler;
+    nxt_regex_context_t  *ctx;
+
+    options |= NXT_REGEX_JAVASCRIPT_COMPAT;
+
+    if (pattern->ignore_case) {
+        options |= NXT_REGEX_CASELESS;
+    }
+
+    if (pattern->multiline) {
+        options |= NXT_REGEX_MULTILINE;
+    }
+
+    /*
+     * The pattern may be compiled in the context of the VM which owns
+     * the shared patterns, but the errors are reported to the current VM.
+     */
+
+    ctx = pattern->regex_context;
+    trace = ctx->trace;
+    ctx->trace = &vm->trace;
 
     handler = vm->trace.handler;
     vm->trace.handler = njs_regexp_compile_trace_handler;
 
     /* Zero length means a zero-terminated string. */
-    ret = nxt_regex_compile(regex, source, 0, options, vm->regex_context);
+    ret = nxt_regex_compile(regex, &pattern->source[1], 0, options, ctx);
 
     vm->trace.handler = handler;
+    ctx->trace = trace;
 
     if (nxt_fast_path(ret == NXT_OK)) {
         return regex->ncaptures;
@@ -359,6 +614,402 @@ njs_regexp_pattern_compile(njs_vm_t *vm, nxt_regex_t *regex, u_char *source,
 }
 
 
+/*
+ * njs_regexp_pattern_literal() finds the longest literal string which
+ * is contained in every string matched by the pattern.  The literal at
+ * the start of a "^" anchored pattern is preferred because it is compared
+ * only at the subject start.  The analysis is conservative, so the
+ * patterns with top level alternatives, inline options, or unusual syntax
+ * have no literal.  The literal is not used for case-insensitive patterns.
+ */
+
+static void
+njs_regexp_pattern_literal(njs_regexp_pattern_t *pattern, const u_char *p,
+    const u_char *end)
+{
+    u_char        c, *q, *run, *chr, *best;
+    size_t        n, best_size;
+    nxt_bool_t    anchored, prefix;
+    nxt_uint_t    min;
+    const u_char  *next;
+
+    if (pattern->ignore_case) {
+        return;
+    }
+
+    anchored = 0;
+    prefix = 0;
+
+    if (p < end && *p == '^') {
+        anchored = !pattern->multiline;
+        p++;
+    }
+
+    q = pattern->literal;
+    run = q;
+    best = q;
+    best_size = 0;
+
+    while (p < end) {
+        c = *p;
+
+        switch (c) {
+
+        case '\\':
+            if (p + 1 == end) {
+                return;
+            }
+
+            c = p[1];
+            p += 2;
+
+            switch (c) {
+
+            case 'd':
+            case 'D':
+            case 'w':
+            case 'W':
+            case 's':
+            case 'S':
+            case 'b':
+            case 'B':
+            case 'v':
+                /* "\v" is the vertical space class in PCRE. */
+                goto atom;
+
+            case 'f':
+                c = '\f';
+                break;
+
+            case 'n':
+                c = '\n';
+                break;
+
+            case 'r':
+                c = '\r';
+                break;
+
+            case 't':
+                c = '\t';
+                break;
+
+            default:
+                if (c >= 0x80 || (c >= '0' && c <= '9')
+                    || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z'))
+                {
+                    return;
+                }
+            }
+
+            chr = q;
+            *q++ = c;
+
+            goto literal;
+
+        case '.':
+        case '^':
+        case '$':
+            p++;
+            goto atom;
+
+        case '[':
+            p = njs_regexp_literal_class(p, end);
+            if (p == NULL) {
+                return;
+            }
+
+            goto atom;
+
+        case '(':
+            if (p + 1 < end
+                && (p[1] == '*'
+                    || (p[1] == '?'
+                        && (p + 2 == end
+                            || (p[2] != ':' && p[2] != '=' && p[2] != '!'
+                                && p[2] != '<')))))
+            {
+                /* Verbs and inline options. */
+                return;
+            }
+
+            p = njs_regexp_literal_group(p, end);
+            if (p == NULL) {
+                return;
+            }
+
+            goto atom;
+
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+            /* A quantifier of a group, a class, or an escape. */
+            p = njs_regexp_literal_quantifier(p, end, &min);
+            if (p == NULL) {
+                return;
+            }
+
+            continue;
+
+        case '|':
+        case ')':
+        case ']':
+        case '}':
+            return;
+
+        default:
+            n = 1;
+
+            /* A UTF-8 character is quantified as a whole. */
+
+            if (c >= 0x80) {
+                while (p + n < end && (p[n] & 0xc0) == 0x80) {
+                    n++;
+                }
+            }
+
+            chr = q;
+            q = memcpy(q, p, n);
+            q += n;
+            p += n;
+
+            goto literal;
+        }
+
+    literal:
+
+        if (p == end || (*p != '*' && *p != '+' && *p != '?' && *p != '{')) {
+            continue;
+        }
+
+        next = njs_regexp_literal_quantifier(p, end, &min);
+        if (next == NULL) {
+            return;
+        }
+
+        p = next;
+
+        if (min == 0) {
+            q = chr;
+        }
+
+    atom:
+
+        if (anchored) {
+            anchored = 0;
+
+            if (q != run) {
+                /*
+                 * The literal follows "^", the rest of the pattern
+                 * is scanned only for top level alternatives.
+                 */
+                prefix = 1;
+                best = run;
+                best_size = q - run;
+            }
+        }
+
+        if (!prefix && (size_t) (q - run) > best_size) {
+            best = run;
+            best_size = q - run;
+        }
+
+        run = q;
+    }
+
+    if (anchored && q != run) {
+        prefix = 1;
+        best = run;
+        best_size = q - run;
+
+    } else if (!prefix && (size_t) (q - run) > best_size) {
+        best = run;
+        best_size = q - run;
+    }
+
+    memmove(pattern->literal, best, best_size);
+    pattern->literal_size = best_size;
+    pattern->literal_prefix = prefix;
+}
+
+
+static const u_char *
+njs_regexp_literal_class(const u_char *p, const u_char *end)
+{
+    p++;
+
+    if (p < end && *p == '^') {
+        p++;
+    }
+
+    /* "[]" and "[^]" are different in JavaScript and PCRE. */
+
+    if (p < end && *p == ']') {
+        return NULL;
+    }
+
+    while (p < end) {
+
+        switch (*p) {
+
+        case ']':
+            return p + 1;
+
+        case '[':
+            /* POSIX classes. */
+            return NULL;
+
+        case '\\':
+            if (p + 1 == end) {
+                return NULL;
+            }
+
+            p += 2;
+            break;
+
+        default:
+            p++;
+        }
+    }
+
+    return NULL;
+}
+
+
+static const u_char *
+njs_regexp_literal_group(const u_char *p, const u_char *end)
+{
+    nxt_uint_t  level;
+
+    level = 0;
+
+    while (p < end) {
+
+        switch (*p) {
+
+        case '\\':
+            if (p + 1 == end) {
+                return NULL;
+            }
+
+            p += 2;
+            continue;
+
+        case '[':
+            p = njs_regexp_literal_class(p, end);
+            if (p == NULL) {
+                return NULL;
+            }
+
+            continue;
+
+        case '(':
+            level++;
+            break;
+
+        case ')':
+            if (--level == 0) {
+                return p + 1;
+            }
+
+            break;
+        }
+
+        p++;
+    }
+
+    return NULL;
+}
+
+
+/*
+ * njs_regexp_literal_quantifier() skips a quantifier and sets the minimum
+ * number of repetitions to 0 or 1.
+ */
+
+static const u_char *
+njs_regexp_literal_quantifier(const u_char *p, const u_char *end,
+    nxt_uint_t *min)
+{
+    switch (*p) {
+
+    case '*':
+    case '?':
+        *min = 0;
+        p++;
+        break;
+
+    case '+':
+        *min = 1;
+        p++;
+        break;
+
+    default:
+        /* "{n}", "{n,}", or "{n,m}". */
+        p++;
+
+        if (p == end || *p < '0' || *p > '9') {
+            return NULL;
+        }
+
+        *min = 0;
+
+        do {
+            if (*p != '0') {
+                *min = 1;
+            }
+
+            p++;
+
+        } while (p < end && *p >= '0' && *p <= '9');
+
+        if (p < end && *p == ',') {
+            do {
+                p++;
+            } while (p < end && *p >= '0' && *p <= '9');
+        }
+
+        if (p == end || *p != '}') {
+            return NULL;
+        }
+
+        p++;
+    }
+
+    /* Lazy and possessive quantifiers. */
+
+    if (p < end && (*p == '?' || *p == '+')) {
+        p++;
+    }
+
+    return p;
+}
+
+
+/*
+ * njs_regexp_literal_match() tests whether a subject contains the pattern
+ * literal, so the subjects without the literal are rejected without
+ * running the regex.
+ */
+
+nxt_bool_t
+njs_regexp_literal_match(njs_regexp_pattern_t *pattern, const u_char *start,
+    size_t size)
+{
+    if (size < pattern->literal_size) {
+        return 0;
+    }
+
+    if (pattern->literal_prefix) {
+        return (memcmp(start, pattern->literal, pattern->literal_size) == 0);
+    }
+
+    return (njs_string_search(start, start + size, pattern->literal,
+                              pattern->literal_size)
+            != NULL);
+}
+
+
 static u_char *
 njs_regexp_compile_trace_handler(nxt_trace_t *trace, nxt_trace_data_t *td,
     u_char *start)
@@ -432,6 +1083,9 @@ njs_regexp_alloc(njs_vm_t *vm, njs_regexp_pattern_t *pattern)
         regexp->object.type = NJS_REGEXP;
         regexp->object.shared = 0;
         regexp->object.extensible = 1;
+        regexp->object.immutable = 0;
+        regexp->object.shape = NULL;
+        regexp->object.slots = NULL;
         regexp->last_index = 0;
         regexp->pattern = pattern;
     }
@@ -557,6 +1211,7 @@ njs_regexp_prototype_test(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 {
     njs_ret_t             ret;
     nxt_uint_t            n;
+    nxt_regex_t           *regex;
     njs_value_t           *value;
     const njs_value_t     *retval;
     njs_string_prop_t     string;
@@ -582,9 +1237,21 @@ njs_regexp_prototype_test(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     pattern = args[0].data.u.regexp->pattern;
 
-    if (nxt_regex_is_valid(&pattern->regex[n])) {
-        ret = njs_regexp_match(vm, &pattern->regex[n], string.start,
-                               string.size, vm->single_match_data);
+    regex = njs_regexp_pattern_regex(vm, pattern, n);
+    if (nxt_slow_path(regex == NULL)) {
+        return NXT_ERROR;
+    }
+
+    if (nxt_regex_is_valid(regex)
+        && njs_regexp_prefilter(pattern, string.start, string.size))
+    {
+        ret = njs_regexp_init(vm);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
+        ret = njs_regexp_match(vm, regex, string.start, string.size,
+                               vm->single_match_data);
         if (ret >= 0) {
             retval = &njs_value_true;
 
@@ -605,6 +1272,7 @@ njs_regexp_prototype_exec(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 {
     njs_ret_t               ret;
     njs_utf8_t              utf8;
+    nxt_regex_t             *regex;
     njs_value_t             *value;
     njs_regexp_t            *regexp;
     njs_string_prop_t       string;
@@ -643,18 +1311,29 @@ njs_regexp_prototype_exec(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     pattern = regexp->pattern;
 
-    if (nxt_regex_is_valid(&pattern->regex[type])) {
-        string.start += regexp->last_index;
-        string.size -= regexp->last_index;
+    regex = njs_regexp_pattern_regex(vm, pattern, type);
+    if (nxt_slow_path(regex == NULL)) {
+        return NXT_ERROR;
+    }
 
-        match_data = nxt_regex_match_data(&pattern->regex[type],
-                                          vm->regex_context);
+    string.start += regexp->last_index;
+    string.size -= regexp->last_index;
+
+    if (nxt_regex_is_valid(regex)
+        && njs_regexp_prefilter(pattern, string.start, string.size))
+    {
+        ret = njs_regexp_init(vm);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
+        match_data = nxt_regex_match_data(regex, vm->regex_context);
         if (nxt_slow_path(match_data == NULL)) {
             return NXT_ERROR;
         }
 
-        ret = njs_regexp_match(vm, &pattern->regex[type], string.start,
-                               string.size, match_data);
+        ret = njs_regexp_match(vm, regex, string.start, string.size,
+                               match_data);
         if (ret >= 0) {
             return njs_regexp_exec_result(vm, regexp, utf8, string.start,
                                           match_data);
@@ -683,6 +1362,7 @@ njs_regexp_exec_result(njs_vm_t *vm, njs_regexp_t *regexp, njs_utf8_t utf8,
     int32_t             size, length;
     njs_ret_t           ret;
     nxt_uint_t          i, n;
+    njs_value_t         value;
     njs_array_t         *array;
     njs_object_prop_t   *prop;
     nxt_lvlhsh_query_t  lhq;
@@ -706,14 +1386,23 @@ njs_regexp_exec_result(njs_vm_t *vm, njs_regexp_t *regexp, njs_utf8_t utf8,
 
             length = njs_string_length(utf8, start, size);
 
-            ret = njs_regexp_string_create(vm, &array->start[i], start, size,
-                                           length);
+            length = (length >= 0) ? length : 0;
+
+            ret = njs_string_view(vm, &value, &regexp->string, start, size,
+                                  length);
             if (nxt_slow_path(ret != NXT_OK)) {
                 goto fail;
             }
 
+            ret = njs_array_value_set(vm, array, &array->start[i], &value);
+
         } else {
-            array->start[i] = njs_value_void;
+            ret = njs_array_value_set(vm, array, &array->start[i],
+                                      &njs_value_void);
+        }
+
+        if (nxt_slow_path(ret != NXT_OK)) {
+            goto fail;
         }
     }
 
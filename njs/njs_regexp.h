@@ -16,6 +16,26 @@ typedef enum {
 } njs_regexp_flags_t;
 
 
+/*
+ * The compiled regex of a pattern for a string type, the byte string
+ * variant is compiled on demand.  NULL is returned on compilation error.
+ */
+
+#define njs_regexp_pattern_regex(vm, pattern, type)                           \
+    (nxt_fast_path((type) != NJS_REGEXP_BYTE || (pattern)->byte_compiled)     \
+     ? &(pattern)->regex[type] : njs_regexp_pattern_byte(vm, pattern))
+
+
+/*
+ * A subject may match a pattern only if it contains the pattern literal,
+ * the literal is empty if the pattern has no required literal.
+ */
+
+#define njs_regexp_prefilter(pattern, start, size)                            \
+    ((pattern)->literal_size == 0                                             \
+     || njs_regexp_literal_match(pattern, start, size))
+
+
 njs_ret_t njs_regexp_init(njs_vm_t *vm);
 njs_ret_t njs_regexp_constructor(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused);
@@ -25,6 +45,12 @@ njs_token_t njs_regexp_literal(njs_vm_t *vm, njs_parser_t *parser,
     njs_value_t *value);
 njs_regexp_pattern_t *njs_regexp_pattern_create(njs_vm_t *vm,
     u_char *string, size_t length, njs_regexp_flags_t flags);
+nxt_regex_t *njs_regexp_pattern_byte(njs_vm_t *vm,
+    njs_regexp_pattern_t *pattern);
+void njs_regexp_patterns_sweep(njs_vm_t *vm);
+void njs_regexp_patterns_free(njs_vm_t *vm);
+nxt_bool_t njs_regexp_literal_match(njs_regexp_pattern_t *pattern,
+    const u_char *start, size_t size);
 nxt_int_t njs_regexp_match(njs_vm_t *vm, nxt_regex_t *regex, u_char *subject,
     size_t len, nxt_regex_match_data_t *match_data);
 njs_regexp_t *njs_regexp_alloc(njs_vm_t *vm, njs_regexp_pattern_t *pattern);
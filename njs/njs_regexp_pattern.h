@@ -7,8 +7,12 @@
 #ifndef _NJS_REGEXP_PATTERN_H_INCLUDED_
 #define _NJS_REGEXP_PATTERN_H_INCLUDED_
 
-#include <nxt_pcre.h>
 #include <nxt_regex.h>
+#if (NXT_HAVE_PCRE2)
+#include <nxt_pcre2.h>
+#else
+#include <nxt_pcre.h>
+#endif
 
 
 typedef enum {
@@ -20,6 +24,9 @@ typedef enum {
 struct njs_regexp_pattern_s {
     nxt_regex_t           regex[2];
 
+    /* The regex context of the VM owning the pattern memory. */
+    nxt_regex_context_t   *regex_context;
+
     /*
      * A pattern source is used by RegExp.toString() method and
      * RegExp.source property.  So it is is stored in form "/pattern/flags"
@@ -30,19 +37,30 @@ struct njs_regexp_pattern_s {
      */
     u_char                *source;
 
+    /*
+     * A literal string which is contained in every matching string,
+     * or at its start if literal_prefix is set.
+     */
+    u_char                *literal;
+    uint32_t              literal_size;
+
 #if (NXT_64BIT)
     uint32_t              ncaptures;
-    uint8_t               flags;        /* 2 bits */
+    uint8_t               flags;          /* 2 bits */
 
-    uint8_t               global;       /* 1 bit */
-    uint8_t               ignore_case;  /* 1 bit */
-    uint8_t               multiline;    /* 1 bit */
+    uint8_t               global;         /* 1 bit */
+    uint8_t               ignore_case;    /* 1 bit */
+    uint8_t               multiline;      /* 1 bit */
+    uint8_t               byte_compiled;  /* 1 bit */
+    uint8_t               literal_prefix; /* 1 bit */
 #else
     uint16_t              ncaptures;
-    uint8_t               flags;        /* 2 bits */
+    uint8_t               flags;          /* 2 bits */
     uint8_t               global:1;
     uint8_t               ignore_case:1;
     uint8_t               multiline:1;
+    uint8_t               byte_compiled:1;
+    uint8_t               literal_prefix:1;
 #endif
 };
 
@@ -8,6 +8,9 @@
 #include <njs_regexp.h>
 #include <njs_regexp_pattern.h>
 #include <string.h>
+#if (NXT_HAVE_SSE2)
+#include <emmintrin.h>
+#endif
 
 
 typedef struct {
@@ -62,12 +65,14 @@ static nxt_noinline void njs_string_slice_args(njs_slice_prop_t *slice,
     njs_value_t *args, nxt_uint_t nargs);
 static njs_ret_t njs_string_from_char_code(njs_vm_t *vm,
     njs_value_t *args, nxt_uint_t nargs, njs_index_t unused);
+static const u_char *njs_string_search_last(const u_char *start,
+    const u_char *last, const u_char *search, size_t size);
 static njs_ret_t njs_string_starts_or_ends_with(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, nxt_bool_t starts);
 static njs_ret_t njs_string_match_multiple(njs_vm_t *vm, njs_value_t *args,
     njs_regexp_pattern_t *pattern);
 static njs_ret_t njs_string_split_part_add(njs_vm_t *vm, njs_array_t *array,
-    njs_utf8_t utf8, u_char *start, size_t size);
+    const njs_value_t *string, njs_utf8_t utf8, u_char *start, size_t size);
 static njs_ret_t njs_string_replace_regexp(njs_vm_t *vm, njs_value_t *args,
     njs_string_replace_t *r);
 static njs_ret_t njs_string_replace_regexp_function(njs_vm_t *vm,
@@ -88,8 +93,8 @@ static njs_ret_t njs_string_replace_parse(njs_vm_t *vm,
 static njs_ret_t njs_string_replace_substitute(njs_vm_t *vm,
     njs_string_replace_t *r, int *captures);
 static njs_ret_t njs_string_replace_join(njs_vm_t *vm, njs_string_replace_t *r);
-static void njs_string_replacement_copy(njs_string_replace_part_t *string,
-    const njs_value_t *value);
+static njs_ret_t njs_string_replacement_copy(njs_vm_t *vm,
+    njs_string_replace_part_t *string, const njs_value_t *value);
 static njs_ret_t njs_string_encode(njs_vm_t *vm, njs_value_t *value,
     const uint32_t *escape);
 static njs_ret_t njs_string_decode(njs_vm_t *vm, njs_value_t *value,
@@ -393,6 +398,212 @@ njs_string_copy(njs_value_t *dst, njs_value_t *src)
 }
 
 
+static size_t
+njs_string_size(const njs_value_t *value, size_t *length)
+{
+    size_t  size;
+
+    size = value->short_string.size;
+
+    if (size != NJS_STRING_LONG) {
+        *length = value->short_string.length;
+
+    } else {
+        size = value->long_string.size;
+        *length = value->long_string.data->length;
+    }
+
+    return size;
+}
+
+
+/*
+ * njs_string_concat() concatenates two strings.  The concatenation
+ * of NJS_STRING_ROPE_MIN or more bytes is created as a rope.
+ */
+
+njs_ret_t
+njs_string_concat(njs_vm_t *vm, njs_value_t *dst, const njs_value_t *val1,
+    const njs_value_t *val2)
+{
+    u_char             *start;
+    size_t             size, size1, size2, length, length1, length2;
+    nxt_str_t          str1, str2;
+    njs_ret_t          ret;
+    njs_string_rope_t  *rope;
+
+    size1 = njs_string_size(val1, &length1);
+    size2 = njs_string_size(val2, &length2);
+
+    if (size2 == 0) {
+        *dst = *val1;
+        return NXT_OK;
+    }
+
+    if (size1 == 0) {
+        *dst = *val2;
+        return NXT_OK;
+    }
+
+    size = size1 + size2;
+
+    if (nxt_slow_path(size > NJS_STRING_MAX_LENGTH)) {
+        njs_range_error(vm, "Invalid string length");
+        return NXT_ERROR;
+    }
+
+    length = (length1 != 0 && length2 != 0) ? length1 + length2 : 0;
+
+    if (size < NJS_STRING_ROPE_MIN) {
+        njs_string_get(val1, &str1);
+        njs_string_get(val2, &str2);
+
+        start = njs_string_alloc(vm, dst, size, length);
+        if (nxt_slow_path(start == NULL)) {
+            njs_memory_error(vm);
+            return NXT_ERROR;
+        }
+
+        memcpy(start, str1.start, str1.length);
+        memcpy(start + str1.length, str2.start, str2.length);
+
+        return NXT_OK;
+    }
+
+    ret = njs_string_flat(vm, val2);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    rope = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_string_rope_t));
+    if (nxt_slow_path(rope == NULL)) {
+        njs_memory_error(vm);
+        return NXT_ERROR;
+    }
+
+    rope->string.start = NULL;
+    rope->string.length = length;
+    rope->string.retain = 1;
+    rope->size = size;
+    rope->pool = vm->mem_cache_pool;
+    rope->left = *val1;
+    rope->right = *val2;
+
+    dst->type = NJS_STRING;
+    njs_string_truth(dst, size);
+    dst->short_string.size = NJS_STRING_LONG;
+    dst->short_string.length = 0;
+    dst->long_string.external = 0;
+    dst->long_string.size = size;
+    dst->long_string.data = &rope->string;
+
+    return NXT_OK;
+}
+
+
+u_char *
+njs_string_rope_flatten(njs_string_t *string)
+{
+    u_char             *start, *p;
+    uint32_t           size, total, map_offset, *map;
+    nxt_str_t          str;
+    njs_string_rope_t  *rope, *node;
+    const njs_value_t  *left;
+
+    rope = (njs_string_rope_t *) string;
+    size = rope->size;
+
+    if (size != string->length && string->length > NJS_STRING_MAP_STRIDE) {
+        map_offset = njs_string_map_offset(size);
+        total = map_offset + njs_string_map_size(string->length);
+
+    } else {
+        map_offset = 0;
+        total = size;
+    }
+
+    start = nxt_mem_cache_alloc(rope->pool, total);
+    if (nxt_slow_path(start == NULL)) {
+        return NULL;
+    }
+
+    /* The tree is copied from the end along the left operands. */
+
+    p = start + size;
+    node = rope;
+
+    for ( ;; ) {
+        njs_string_get(&node->right, &str);
+
+        p -= str.length;
+        memcpy(p, str.start, str.length);
+
+        left = &node->left;
+
+        if (!njs_string_is_rope(left)) {
+            break;
+        }
+
+        node = (njs_string_rope_t *) left->long_string.data;
+    }
+
+    njs_string_get(left, &str);
+    memcpy(start, str.start, str.length);
+
+    if (map_offset != 0) {
+        map = (uint32_t *) (start + map_offset);
+        map[0] = 0;
+    }
+
+    string->start = start;
+
+    /* The operands are not required anymore. */
+
+    njs_set_invalid(&rope->left);
+    njs_set_invalid(&rope->right);
+
+    return start;
+}
+
+
+/*
+ * njs_string_rope_get() is used by njs_string_get() in the paths which
+ * have no VM to report the memory error.
+ */
+
+void
+njs_string_rope_get(const njs_value_t *value, nxt_str_t *str)
+{
+    u_char  *start;
+
+    start = njs_string_rope_flatten(value->long_string.data);
+
+    if (nxt_fast_path(start != NULL)) {
+        str->length = value->long_string.size;
+        str->start = start;
+        return;
+    }
+
+    str->length = 0;
+    str->start = (u_char *) "";
+}
+
+
+njs_ret_t
+njs_string_flat(njs_vm_t *vm, const njs_value_t *value)
+{
+    if (njs_is_string(value)
+        && njs_string_is_rope(value)
+        && njs_string_rope_flatten(value->long_string.data) == NULL)
+    {
+        njs_memory_error(vm);
+        return NXT_ERROR;
+    }
+
+    return NXT_OK;
+}
+
+
 /*
  * njs_string_validate() validates an UTF-8 string, evaluates its length,
  * sets njs_string_prop_t struct.
@@ -424,6 +635,10 @@ njs_string_validate(njs_vm_t *vm, njs_string_prop_t *string, njs_value_t *value)
         }
 
     } else {
+        if (nxt_slow_path(njs_string_flat(vm, value) != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
         string->start = value->long_string.data->start;
         size = value->long_string.size;
         length = value->long_string.data->length;
@@ -483,6 +698,9 @@ njs_string_prop(njs_string_prop_t *string, njs_value_t *value)
         length = value->short_string.length;
 
     } else {
+        /* The callers flatten ropes with njs_string_flat(). */
+        nxt_assert(!njs_string_is_rope(value));
+
         string->start = value->long_string.data->start;
         size = value->long_string.size;
         length = value->long_string.data->length;
@@ -633,6 +851,8 @@ njs_string_eq(const njs_value_t *v1, const njs_value_t *v2)
             return 0;
         }
 
+        nxt_assert(!njs_string_is_rope(v1) && !njs_string_is_rope(v2));
+
         start1 = v1->long_string.data->start;
         start2 = v2->long_string.data->start;
     }
@@ -644,39 +864,24 @@ njs_string_eq(const njs_value_t *v1, const njs_value_t *v2)
 nxt_int_t
 njs_string_cmp(const njs_value_t *v1, const njs_value_t *v2)
 {
-    size_t        size, size1, size2;
-    nxt_int_t     ret;
-    const u_char  *start1, *start2;
+    size_t     size;
+    nxt_int_t  ret;
+    nxt_str_t  str1, str2;
 
-    size1 = v1->short_string.size;
+    nxt_assert(!njs_string_is_rope(v1) && !njs_string_is_rope(v2));
 
-    if (size1 != NJS_STRING_LONG) {
-        start1 = v1->short_string.start;
+    njs_string_get(v1, &str1);
+    njs_string_get(v2, &str2);
 
-    } else {
-        size1 = v1->long_string.size;
-        start1 = v1->long_string.data->start;
-    }
+    size = nxt_min(str1.length, str2.length);
 
-    size2 = v2->short_string.size;
-
-    if (size2 != NJS_STRING_LONG) {
-        start2 = v2->short_string.start;
-
-    } else {
-        size2 = v2->long_string.size;
-        start2 = v2->long_string.data->start;
-    }
-
-    size = nxt_min(size1, size2);
-
-    ret = memcmp(start1, start2, size);
+    ret = memcmp(str1.start, str2.start, size);
 
     if (ret != 0) {
         return ret;
     }
 
-    return (size1 - size2);
+    return (str1.length - str2.length);
 }
 
 
@@ -738,6 +943,12 @@ njs_string_prototype_to_string(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs
 
     value = vm->retval;
 
+    if (nxt_slow_path(njs_string_flat(vm, &value) != NXT_OK
+                      || njs_string_flat(vm, &args[1]) != NXT_OK))
+    {
+        return NXT_ERROR;
+    }
+
     (void) njs_string_prop(&string, &value);
 
     if (nxt_slow_path(string.length != 0)) {
@@ -775,10 +986,9 @@ static njs_ret_t
 njs_string_prototype_concat(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    u_char             *p, *start;
-    size_t             size, length, mask;
-    nxt_uint_t         i;
-    njs_string_prop_t  string;
+    njs_ret_t    ret;
+    nxt_uint_t   i;
+    njs_value_t  value;
 
     if (njs_is_null_or_void(&args[0])) {
         njs_type_error(vm, "'this' argument is null or undefined");
@@ -793,42 +1003,17 @@ njs_string_prototype_concat(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         }
     }
 
-    if (nargs == 1) {
-        njs_string_copy(&vm->retval, &args[0]);
-        return NXT_OK;
-    }
-
-    size = 0;
-    length = 0;
-    mask = -1;
-
-    for (i = 0; i < nargs; i++) {
-        (void) njs_string_prop(&string, &args[i]);
+    njs_string_copy(&vm->retval, &args[0]);
 
-        size += string.size;
-        length += string.length;
+    for (i = 1; i < nargs; i++) {
+        value = vm->retval;
 
-        if (string.length == 0 && string.size != 0) {
-            mask = 0;
+        ret = njs_string_concat(vm, &vm->retval, &value, &args[i]);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
         }
     }
 
-    length &= mask;
-
-    start = njs_string_alloc(vm, &vm->retval, size, length);
-    if (nxt_slow_path(start == NULL)) {
-        return NXT_ERROR;
-    }
-
-    p = start;
-
-    for (i = 0; i < nargs; i++) {
-        (void) njs_string_prop(&string, &args[i]);
-
-        p = memcpy(p, string.start, string.size);
-        p += string.size;
-    }
-
     return NXT_OK;
 }
 
@@ -850,7 +1035,7 @@ njs_string_prototype_from_utf8(njs_vm_t *vm, njs_value_t *args,
 
     if (string.length != 0) {
         /* ASCII or UTF8 string. */
-        return njs_string_slice(vm, &vm->retval, &string, &slice);
+        return njs_string_slice(vm, &vm->retval, &args[0], &string, &slice);
     }
 
     string.start += slice.start;
@@ -858,16 +1043,8 @@ njs_string_prototype_from_utf8(njs_vm_t *vm, njs_value_t *args,
     length = nxt_utf8_length(string.start, slice.length);
 
     if (length >= 0) {
-
-        if (length < NJS_STRING_MAP_STRIDE || (size_t) length == slice.length) {
-            /* ASCII or short UTF-8 string. */
-            return njs_string_create(vm, &vm->retval, string.start,
-                                     slice.length, length);
-        }
-
-        /* Long UTF-8 string. */
-        return njs_string_new(vm, &vm->retval, string.start, slice.length,
-                              length);
+        return njs_string_view(vm, &vm->retval, &args[0], string.start,
+                               slice.length, length);
     }
 
     vm->retval = njs_value_null;
@@ -895,7 +1072,7 @@ njs_string_prototype_to_utf8(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     njs_string_slice_args(&slice, args, nargs);
 
-    return njs_string_slice(vm, &vm->retval, &string, &slice);
+    return njs_string_slice(vm, &vm->retval, &args[0], &string, &slice);
 }
 
 
@@ -917,7 +1094,7 @@ njs_string_prototype_from_bytes(njs_vm_t *vm, njs_value_t *args,
 
     if (string.length != 0) {
         /* ASCII or UTF8 string. */
-        return njs_string_slice(vm, &vm->retval, &string, &slice);
+        return njs_string_slice(vm, &vm->retval, &args[0], &string, &slice);
     }
 
     size = 0;
@@ -973,7 +1150,7 @@ njs_string_prototype_to_bytes(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     if (string.length == 0) {
         /* Byte string. */
-        return njs_string_slice(vm, &vm->retval, &string, &slice);
+        return njs_string_slice(vm, &vm->retval, &args[0], &string, &slice);
     }
 
     p = njs_string_alloc(vm, &vm->retval, slice.length, 0);
@@ -1028,7 +1205,7 @@ njs_string_prototype_slice(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
     njs_string_slice_prop(&string, &slice, args, nargs);
 
-    return njs_string_slice(vm, &vm->retval, &string, &slice);
+    return njs_string_slice(vm, &vm->retval, &args[0], &string, &slice);
 }
 
 
@@ -1084,7 +1261,7 @@ njs_string_prototype_substring(njs_vm_t *vm, njs_value_t *args,
     slice.start = start;
     slice.length = length;
 
-    return njs_string_slice(vm, &vm->retval, &string, &slice);
+    return njs_string_slice(vm, &vm->retval, &args[0], &string, &slice);
 }
 
 
@@ -1140,7 +1317,7 @@ njs_string_prototype_substr(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     slice.start = start;
     slice.length = length;
 
-    return njs_string_slice(vm, &vm->retval, &string, &slice);
+    return njs_string_slice(vm, &vm->retval, &args[0], &string, &slice);
 }
 
 
@@ -1169,7 +1346,7 @@ njs_string_prototype_char_at(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     slice.start = start;
     slice.length = length;
 
-    return njs_string_slice(vm, &vm->retval, &string, &slice);
+    return njs_string_slice(vm, &vm->retval, &args[0], &string, &slice);
 }
 
 
@@ -1238,10 +1415,10 @@ njs_string_slice_args(njs_slice_prop_t *slice, njs_value_t *args,
 
 
 nxt_noinline njs_ret_t
-njs_string_slice(njs_vm_t *vm, njs_value_t *dst,
+njs_string_slice(njs_vm_t *vm, njs_value_t *dst, const njs_value_t *value,
     const njs_string_prop_t *string, njs_slice_prop_t *slice)
 {
-    size_t        size, n, length;
+    size_t        size, length;
     const u_char  *p, *start, *end;
 
     length = slice->length;
@@ -1257,29 +1434,81 @@ njs_string_slice(njs_vm_t *vm, njs_value_t *dst,
             length = 0;
         }
 
-    } else {
+    } else if (length != 0) {
         /* UTF-8 string. */
         end = start + string->size;
         start = njs_string_offset(start, end, slice->start);
 
         /* Evaluate size of the slice in bytes and ajdust length. */
-        p = start;
-        n = length;
+        p = nxt_utf8_skip(start, end, length);
+        size = p - start;
 
-        do {
-            p = nxt_utf8_next(p, end);
-            n--;
-        } while (n != 0 && p < end);
+        if (p == end) {
+            length = nxt_utf8_count(start, size);
+        }
 
-        size = p - start;
-        length -= n;
+    } else {
+        /* Empty UTF-8 string. */
+        size = 0;
     }
 
     if (nxt_fast_path(size != 0)) {
-        return njs_string_new(vm, &vm->retval, start, size, length);
+        return njs_string_view(vm, dst, value, start, size, length);
     }
 
-    vm->retval = njs_string_empty;
+    *dst = njs_string_empty;
+
+    return NXT_OK;
+}
+
+
+/*
+ * njs_string_view() creates a view of the parent string bytes
+ * or copies the bytes if the view is not appropriate.
+ */
+
+nxt_noinline njs_ret_t
+njs_string_view(njs_vm_t *vm, njs_value_t *dst, const njs_value_t *parent,
+    const u_char *start, uint32_t size, uint32_t length)
+{
+    uint32_t           shared;
+    njs_string_view_t  *view;
+
+    if (size <= NJS_STRING_SHORT
+        || parent->short_string.size != NJS_STRING_LONG
+        || parent->long_string.external == 0xff
+        || (size != length && length >= NJS_STRING_MAP_STRIDE))
+    {
+        return njs_string_new(vm, dst, start, size, length);
+    }
+
+    shared = parent->long_string.size;
+
+    if (parent->long_string.external == NJS_STRING_VIEW) {
+        shared = ((njs_string_view_t *) parent->long_string.data)->size;
+    }
+
+    if ((uint64_t) size * NJS_STRING_VIEW_RATIO < shared) {
+        return njs_string_new(vm, dst, start, size, length);
+    }
+
+    view = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_string_view_t));
+    if (nxt_slow_path(view == NULL)) {
+        return NXT_ERROR;
+    }
+
+    view->string.start = (u_char *) start;
+    view->string.length = length;
+    view->string.retain = 1;
+    view->size = shared;
+
+    dst->type = NJS_STRING;
+    njs_string_truth(dst, size);
+    dst->short_string.size = NJS_STRING_LONG;
+    dst->short_string.length = 0;
+    dst->long_string.external = NJS_STRING_VIEW;
+    dst->long_string.size = size;
+    dst->long_string.data = &view->string;
 
     return NXT_OK;
 }
@@ -1382,12 +1611,160 @@ range_error:
 }
 
 
+/*
+ * njs_string_search() returns the first position in the start - end range
+ * where the search string is found or NULL.  The candidate positions are
+ * found by the first and the last search bytes, with SSE2 it is done for
+ * 16 positions at once.
+ */
+
+const u_char *
+njs_string_search(const u_char *start, const u_char *end, const u_char *search,
+    size_t size)
+{
+    const u_char  *p, *last;
+#if (NXT_HAVE_SSE2)
+    nxt_uint_t    i, mask;
+    __m128i       first, final, v;
+#endif
+
+    if (nxt_slow_path((size_t) (end - start) < size)) {
+        return NULL;
+    }
+
+    if (size == 0) {
+        return start;
+    }
+
+    /* The last position where the search string can start. */
+    last = end - size;
+
+    if (size == 1) {
+        return memchr(start, search[0], last - start + 1);
+    }
+
+    p = start;
+
+#if (NXT_HAVE_SSE2)
+
+    first = _mm_set1_epi8(search[0]);
+    final = _mm_set1_epi8(search[size - 1]);
+
+    while (last - p >= 15) {
+        v = _mm_and_si128(
+                _mm_cmpeq_epi8(first, _mm_loadu_si128((__m128i *) p)),
+                _mm_cmpeq_epi8(final,
+                               _mm_loadu_si128((__m128i *) &p[size - 1])));
+
+        mask = _mm_movemask_epi8(v);
+
+        for (i = 0; mask != 0; i++, mask >>= 1) {
+            if ((mask & 1) != 0
+                && memcmp(&p[i + 1], &search[1], size - 2) == 0)
+            {
+                return &p[i];
+            }
+        }
+
+        p += 16;
+    }
+
+#endif
+
+    for ( ;; ) {
+        p = memchr(p, search[0], last - p + 1);
+
+        if (p == NULL || memcmp(&p[1], &search[1], size - 1) == 0) {
+            return p;
+        }
+
+        if (p == last) {
+            return NULL;
+        }
+
+        p++;
+    }
+}
+
+
+/*
+ * njs_string_search_last() returns the last position in the start - last
+ * range where the search string is found or NULL.  The search string must
+ * fit after the last position.
+ */
+
+static const u_char *
+njs_string_search_last(const u_char *start, const u_char *last,
+    const u_char *search, size_t size)
+{
+    const u_char  *p;
+#if (NXT_HAVE_SSE2)
+    nxt_uint_t    i, mask;
+    __m128i       first, final, v;
+#endif
+
+    if (nxt_slow_path(last < start)) {
+        return NULL;
+    }
+
+    if (size == 0) {
+        return last;
+    }
+
+    p = last;
+
+#if (NXT_HAVE_SSE2)
+
+    first = _mm_set1_epi8(search[0]);
+    final = _mm_set1_epi8(search[size - 1]);
+
+    /* The positions from p - 15 to p are tested. */
+
+    while (p - start >= 15) {
+        v = _mm_and_si128(
+                _mm_cmpeq_epi8(first, _mm_loadu_si128((__m128i *) (p - 15))),
+                _mm_cmpeq_epi8(final,
+                        _mm_loadu_si128((__m128i *) (p - 15 + size - 1))));
+
+        mask = _mm_movemask_epi8(v);
+
+        for (i = 0; mask != 0; i++, mask = (mask << 1) & 0xFFFF) {
+            if ((mask & 0x8000) != 0
+                && memcmp(p - i, search, size) == 0)
+            {
+                return p - i;
+            }
+        }
+
+        if (p - start == 15) {
+            return NULL;
+        }
+
+        p -= 16;
+    }
+
+#endif
+
+    for ( ;; ) {
+        if (*p == search[0] && memcmp(p, search, size) == 0) {
+            return p;
+        }
+
+        if (p == start) {
+            return NULL;
+        }
+
+        p--;
+    }
+}
+
+
 static njs_ret_t
 njs_string_prototype_index_of(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
     ssize_t            index, length, search_length;
-    const u_char       *p, *end;
+    const u_char       *p, *start, *end;
     njs_string_prop_t  string, search;
 
     if (nargs > 1) {
@@ -1410,29 +1787,30 @@ njs_string_prototype_index_of(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             if (string.size == (size_t) length) {
                 /* Byte or ASCII string. */
 
-                end -= (search.size - 1);
-
-                for (p = string.start + index; p < end; p++) {
-                    if (memcmp(p, search.start, search.size) == 0) {
-                        goto done;
-                    }
-
-                    index++;
+                p = njs_string_search(string.start + index, end, search.start,
+                                      search.size);
+                if (p != NULL) {
+                    index = p - string.start;
+                    goto done;
                 }
 
             } else {
                 /* UTF-8 string. */
 
-                p = njs_string_offset(string.start, end, index);
-                end -= search.size - 1;
+                start = njs_string_offset(string.start, end, index);
 
-                while (p < end) {
-                    if (memcmp(p, search.start, search.size) == 0) {
-                        goto done;
+                for (p = start; /* void */; p++) {
+                    p = njs_string_search(p, end, search.start, search.size);
+                    if (p == NULL) {
+                        break;
                     }
 
-                    index++;
-                    p = nxt_utf8_next(p, end);
+                    /* The index is counted only for a character match. */
+
+                    if (p == end || (*p & 0xC0) != 0x80) {
+                        index += nxt_utf8_count(start, p - start);
+                        goto done;
+                    }
                 }
             }
 
@@ -1457,7 +1835,7 @@ njs_string_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
     ssize_t            index, start, length, search_length;
-    const u_char       *p, *end;
+    const u_char       *p, *last, *end;
     njs_string_prop_t  string, search;
 
     index = -1;
@@ -1466,7 +1844,7 @@ njs_string_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
         length = njs_string_prop(&string, &args[0]);
         search_length = njs_string_prop(&search, &args[1]);
 
-        if (length < search_length) {
+        if (length < search_length || string.size < search.size) {
             goto done;
         }
 
@@ -1493,23 +1871,19 @@ njs_string_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
                 index = start;
             }
 
-            p = string.start + index;
-
-            do {
-                if (memcmp(p, search.start, search.size) == 0) {
-                    goto done;
-                }
-
-                index--;
-                p--;
+            p = njs_string_search_last(string.start, string.start + index,
+                                       search.start, search.size);
 
-            } while (p >= string.start);
+            index = (p != NULL) ? p - string.start : -1;
 
         } else {
             /* UTF-8 string. */
 
             end = string.start + string.size;
-            p = njs_string_offset(string.start, end, index);
+
+            /* The offset map has no entry for the string end. */
+            p = (index < length) ? njs_string_offset(string.start, end, index)
+                                 : end;
             end -= search.size;
 
             while (p > end) {
@@ -1517,18 +1891,24 @@ njs_string_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
                 p = nxt_utf8_prev(p);
             }
 
+            last = p;
+
             for ( ;; ) {
-                if (memcmp(p, search.start, search.size) == 0) {
+                p = njs_string_search_last(string.start, p, search.start,
+                                           search.size);
+                if (p == NULL) {
+                    index = -1;
                     goto done;
                 }
 
-                index--;
+                /* The index is counted only for a character match. */
 
-                if (p <= string.start) {
-                    break;
+                if (p == string.start + string.size || (*p & 0xC0) != 0x80) {
+                    index -= nxt_utf8_count(p, last - p);
+                    goto done;
                 }
 
-                p = nxt_utf8_prev(p);
+                p--;
             }
         }
     }
@@ -1583,14 +1963,8 @@ njs_string_prototype_includes(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
                 p = njs_string_offset(string.start, end, index);
             }
 
-            end -= search.size - 1;
-
-            while (p < end) {
-                if (memcmp(p, search.start, search.size) == 0) {
-                    goto done;
-                }
-
-                p++;
+            if (njs_string_search(p, end, search.start, search.size) != NULL) {
+                goto done;
             }
         }
     }
@@ -1772,7 +2146,6 @@ njs_string_index(njs_string_prop_t *string, uint32_t offset)
 nxt_noinline void
 njs_string_offset_map_init(const u_char *start, size_t size)
 {
-    size_t        offset;
     uint32_t      *map;
     nxt_uint_t    n;
     const u_char  *p, *end;
@@ -1781,20 +2154,17 @@ njs_string_offset_map_init(const u_char *start, size_t size)
     map = njs_string_map_start(end);
     p = start;
     n = 0;
-    offset = NJS_STRING_MAP_STRIDE;
-
-    do {
-        if (offset == 0) {
-            map[n++] = p - start;
-            offset = NJS_STRING_MAP_STRIDE;
-        }
 
+    for ( ;; ) {
         /* The UTF-8 string should be valid since its length is known. */
-        p = nxt_utf8_next(p, end);
+        p = nxt_utf8_skip(p, end, NJS_STRING_MAP_STRIDE);
 
-        offset--;
+        if (p == end) {
+            return;
+        }
 
-    } while (p < end);
+        map[n++] = p - start;
+    }
 }
 
 
@@ -1808,37 +2178,55 @@ static njs_ret_t
 njs_string_prototype_to_lower_case(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
-    size_t             size;
+    size_t             size, length;
     u_char             *p, *start;
+    uint32_t           u;
     const u_char       *s, *end;
     njs_string_prop_t  string;
 
     (void) njs_string_prop(&string, &args[0]);
 
-    start = njs_string_alloc(vm, &vm->retval, string.size, string.length);
-    if (nxt_slow_path(start == NULL)) {
-        return NXT_ERROR;
-    }
-
-    p = start;
     s = string.start;
     size = string.size;
 
     if (string.length == 0 || string.length == size) {
         /* Byte or ASCII string. */
 
+        start = njs_string_alloc(vm, &vm->retval, size, string.length);
+        if (nxt_slow_path(start == NULL)) {
+            return NXT_ERROR;
+        }
+
+        p = start;
+
         while (size != 0) {
             *p++ = nxt_lower_case(*s++);
             size--;
         }
 
     } else {
-        /* UTF-8 string. */
+        /*
+         * UTF-8 string.  A case mapped character can have
+         * a different UTF-8 size, so the size is calculated first.
+         */
         end = s + size;
+        size = 0;
 
-        while (size != 0) {
+        for (length = string.length; length != 0; length--) {
+            u = nxt_utf8_lower_case(&s, end);
+            size += nxt_utf8_size(u);
+        }
+
+        start = njs_string_alloc(vm, &vm->retval, size, string.length);
+        if (nxt_slow_path(start == NULL)) {
+            return NXT_ERROR;
+        }
+
+        p = start;
+        s = string.start;
+
+        for (length = string.length; length != 0; length--) {
             p = nxt_utf8_encode(p, nxt_utf8_lower_case(&s, end));
-            size--;
         }
     }
 
@@ -1856,37 +2244,55 @@ static njs_ret_t
 njs_string_prototype_to_upper_case(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
-    size_t             size;
+    size_t             size, length;
     u_char             *p, *start;
+    uint32_t           u;
     const u_char       *s, *end;
     njs_string_prop_t  string;
 
     (void) njs_string_prop(&string, &args[0]);
 
-    start = njs_string_alloc(vm, &vm->retval, string.size, string.length);
-    if (nxt_slow_path(start == NULL)) {
-        return NXT_ERROR;
-    }
-
-    p = start;
     s = string.start;
     size = string.size;
 
     if (string.length == 0 || string.length == size) {
         /* Byte or ASCII string. */
 
+        start = njs_string_alloc(vm, &vm->retval, size, string.length);
+        if (nxt_slow_path(start == NULL)) {
+            return NXT_ERROR;
+        }
+
+        p = start;
+
         while (size != 0) {
             *p++ = nxt_upper_case(*s++);
             size--;
         }
 
     } else {
-        /* UTF-8 string. */
+        /*
+         * UTF-8 string.  A case mapped character can have
+         * a different UTF-8 size, so the size is calculated first.
+         */
         end = s + size;
+        size = 0;
 
-        while (size != 0) {
+        for (length = string.length; length != 0; length--) {
+            u = nxt_utf8_upper_case(&s, end);
+            size += nxt_utf8_size(u);
+        }
+
+        start = njs_string_alloc(vm, &vm->retval, size, string.length);
+        if (nxt_slow_path(start == NULL)) {
+            return NXT_ERROR;
+        }
+
+        p = start;
+        s = string.start;
+
+        for (length = string.length; length != 0; length--) {
             p = nxt_utf8_encode(p, nxt_utf8_upper_case(&s, end));
-            size--;
         }
     }
 
@@ -2084,6 +2490,7 @@ njs_string_prototype_search(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     int                   ret, *captures;
     nxt_int_t             index;
     nxt_uint_t            n;
+    nxt_regex_t           *regex;
     njs_string_prop_t     string;
     njs_regexp_pattern_t  *pattern;
 
@@ -2123,9 +2530,21 @@ njs_string_prototype_search(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
         n = (string.length != 0);
 
-        if (nxt_regex_is_valid(&pattern->regex[n])) {
-            ret = njs_regexp_match(vm, &pattern->regex[n], string.start,
-                                   string.size, vm->single_match_data);
+        regex = njs_regexp_pattern_regex(vm, pattern, n);
+        if (nxt_slow_path(regex == NULL)) {
+            return NXT_ERROR;
+        }
+
+        if (nxt_regex_is_valid(regex)
+            && njs_regexp_prefilter(pattern, string.start, string.size))
+        {
+            ret = njs_regexp_init(vm);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NXT_ERROR;
+            }
+
+            ret = njs_regexp_match(vm, regex, string.start, string.size,
+                                   vm->single_match_data);
             if (ret >= 0) {
                 captures = nxt_regex_captures(vm->single_match_data);
                 index = njs_string_index(&string, captures[0]);
@@ -2208,6 +2627,8 @@ njs_string_match_multiple(njs_vm_t *vm, njs_value_t *args,
     int32_t            size, length;
     njs_ret_t          ret;
     njs_utf8_t         utf8;
+    nxt_regex_t        *regex;
+    njs_value_t        value;
     njs_array_t        *array;
     njs_regexp_utf8_t  type;
     njs_string_prop_t  string;
@@ -2229,12 +2650,24 @@ njs_string_match_multiple(njs_vm_t *vm, njs_value_t *args,
         }
     }
 
-    if (nxt_regex_is_valid(&pattern->regex[type])) {
+    regex = njs_regexp_pattern_regex(vm, pattern, type);
+    if (nxt_slow_path(regex == NULL)) {
+        return NXT_ERROR;
+    }
+
+    if (nxt_regex_is_valid(regex)
+        && njs_regexp_prefilter(pattern, string.start, string.size))
+    {
+        ret = njs_regexp_init(vm);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
         array = NULL;
 
         do {
-            ret = njs_regexp_match(vm, &pattern->regex[type], string.start,
-                                   string.size, vm->single_match_data);
+            ret = njs_regexp_match(vm, regex, string.start, string.size,
+                                   vm->single_match_data);
             if (ret >= 0) {
                 if (array != NULL) {
                     ret = njs_array_expand(vm, array, 0, 1);
@@ -2263,8 +2696,15 @@ njs_string_match_multiple(njs_vm_t *vm, njs_value_t *args,
 
                 length = njs_string_length(utf8, start, size);
 
-                ret = njs_string_create(vm, &array->start[array->length],
-                                        start, size, length);
+                ret = njs_string_view(vm, &value, &args[0], start, size,
+                                      length);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return ret;
+                }
+
+                ret = njs_array_value_set(vm, array,
+                                          &array->start[array->length],
+                                          &value);
                 if (nxt_slow_path(ret != NXT_OK)) {
                     return ret;
                 }
@@ -2298,6 +2738,7 @@ njs_string_prototype_split(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     size_t                size;
     uint32_t              limit;
     njs_utf8_t            utf8;
+    nxt_regex_t           *regex;
     njs_array_t           *array;
     const u_char          *end;
     njs_regexp_utf8_t     type;
@@ -2353,10 +2794,10 @@ njs_string_prototype_split(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             end = string.start + string.size;
 
             do {
-                for (p = start; p < end; p++) {
-                    if (memcmp(p, split.start, split.size) == 0) {
-                        break;
-                    }
+                p = (u_char *) njs_string_search(start, end, split.start,
+                                                 split.size);
+                if (p == NULL) {
+                    p = (u_char *) end;
                 }
 
                 next = p + split.size;
@@ -2369,7 +2810,8 @@ njs_string_prototype_split(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
                 size = p - start;
 
-                ret = njs_string_split_part_add(vm, array, utf8, start, size);
+                ret = njs_string_split_part_add(vm, array, &args[0], utf8,
+                                                start, size);
                 if (nxt_slow_path(ret != NXT_OK)) {
                     return ret;
                 }
@@ -2384,16 +2826,28 @@ njs_string_prototype_split(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         case NJS_REGEXP:
             pattern = args[1].data.u.regexp->pattern;
 
-            if (!nxt_regex_is_valid(&pattern->regex[type])) {
+            regex = njs_regexp_pattern_regex(vm, pattern, type);
+            if (nxt_slow_path(regex == NULL)) {
+                return NXT_ERROR;
+            }
+
+            if (!nxt_regex_is_valid(regex)
+                || !njs_regexp_prefilter(pattern, string.start, string.size))
+            {
                 goto single;
             }
 
+            ret = njs_regexp_init(vm);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NXT_ERROR;
+            }
+
             start = string.start;
             end = string.start + string.size;
 
             do {
-                ret = njs_regexp_match(vm, &pattern->regex[type], start,
-                                       end - start, vm->single_match_data);
+                ret = njs_regexp_match(vm, regex, start, end - start,
+                                       vm->single_match_data);
                 if (ret >= 0) {
                     captures = nxt_regex_captures(vm->single_match_data);
 
@@ -2416,7 +2870,8 @@ njs_string_prototype_split(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
                 size = p - start;
 
-                ret = njs_string_split_part_add(vm, array, utf8, start, size);
+                ret = njs_string_split_part_add(vm, array, &args[0], utf8,
+                                                start, size);
                 if (nxt_slow_path(ret != NXT_OK)) {
                     return ret;
                 }
@@ -2437,7 +2892,11 @@ njs_string_prototype_split(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 single:
 
     /* GC: retain. */
-    array->start[0] = args[0];
+    ret = njs_array_value_set(vm, array, &array->start[0], &args[0]);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
     array->length = 1;
 
 done:
@@ -2451,14 +2910,21 @@ done:
 
 
 static njs_ret_t
-njs_string_split_part_add(njs_vm_t *vm, njs_array_t *array, njs_utf8_t utf8,
-    u_char *start, size_t size)
+njs_string_split_part_add(njs_vm_t *vm, njs_array_t *array,
+    const njs_value_t *string, njs_utf8_t utf8, u_char *start, size_t size)
 {
-    ssize_t  length;
+    ssize_t      length;
+    njs_ret_t    ret;
+    njs_value_t  value;
 
     length = njs_string_length(utf8, start, size);
 
-    return njs_array_string_add(vm, array, start, size, length);
+    ret = njs_string_view(vm, &value, string, start, size, length);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    return njs_array_add(vm, array, &value);
 }
 
 
@@ -2476,6 +2942,7 @@ njs_string_prototype_replace(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     nxt_regex_t           *regex;
     njs_string_prop_t     string;
     njs_string_replace_t  *r;
+    njs_regexp_pattern_t  *pattern;
 
     if (nargs == 1) {
         goto original;
@@ -2502,9 +2969,16 @@ njs_string_prototype_replace(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     }
 
     if (njs_is_regexp(&args[1])) {
-        regex = &args[1].data.u.regexp->pattern->regex[r->type];
+        pattern = args[1].data.u.regexp->pattern;
+
+        regex = njs_regexp_pattern_regex(vm, pattern, r->type);
+        if (nxt_slow_path(regex == NULL)) {
+            return NXT_ERROR;
+        }
 
-        if (!nxt_regex_is_valid(regex)) {
+        if (!nxt_regex_is_valid(regex)
+            || !njs_regexp_prefilter(pattern, string.start, string.size))
+        {
             goto original;
         }
 
@@ -2526,10 +3000,14 @@ njs_string_prototype_replace(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     /* A literal replacement is stored in the second part. */
 
     if (nargs == 2) {
-        njs_string_replacement_copy(&r->part[1], &njs_string_void);
+        /* A short string cannot fail. */
+        (void) njs_string_replacement_copy(vm, &r->part[1], &njs_string_void);
 
     } else if (njs_is_string(&args[2])) {
-        njs_string_replacement_copy(&r->part[1], &args[2]);
+        ret = njs_string_replacement_copy(vm, &r->part[1], &args[2]);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
 
         start = r->part[1].start;
 
@@ -2563,6 +3041,11 @@ njs_string_prototype_replace(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_set_invalid(&r->part[0].value);
 
     if (regex != NULL) {
+        ret = njs_regexp_init(vm);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
         r->match_data = nxt_regex_match_data(regex, vm->regex_context);
         if (nxt_slow_path(r->match_data == NULL)) {
             return NXT_ERROR;
@@ -2702,7 +3185,8 @@ njs_string_replace_regexp_function(njs_vm_t *vm, njs_value_t *args,
 
         length = njs_string_length(r->utf8, start, size);
 
-        ret = njs_string_create(vm, &arguments[i], start, size, length);
+        ret = njs_string_view(vm, &arguments[i], &args[0], start, size,
+                              length);
         if (nxt_slow_path(ret != NXT_OK)) {
             return NXT_ERROR;
         }
@@ -2714,8 +3198,8 @@ njs_string_replace_regexp_function(njs_vm_t *vm, njs_value_t *args,
     /* The whole string being examined. */
     length = njs_string_length(r->utf8, r->part[0].start, r->part[0].size);
 
-    ret = njs_string_create(vm, &arguments[n + 2], r->part[0].start,
-                            r->part[0].size, length);
+    ret = njs_string_view(vm, &arguments[n + 2], &args[0], r->part[0].start,
+                          r->part[0].size, length);
 
     if (nxt_slow_path(ret != NXT_OK)) {
         return NXT_ERROR;
@@ -2732,12 +3216,17 @@ static njs_ret_t
 njs_string_replace_regexp_continuation(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
+    njs_ret_t             ret;
     njs_string_replace_t  *r;
 
     r = njs_vm_continuation(vm);
 
     if (njs_is_string(&r->retval)) {
-        njs_string_replacement_copy(&r->part[1], &r->retval);
+        ret = njs_string_replacement_copy(vm, &r->part[1], &r->retval);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            nxt_regex_match_data_free(r->match_data, vm->regex_context);
+            return ret;
+        }
 
         if (args[1].data.u.regexp->pattern->global) {
             r->part += 2;
@@ -2778,47 +3267,45 @@ njs_string_replace_search(njs_vm_t *vm, njs_value_t *args,
     njs_string_get(&args[1], &search);
 
     p = r->part[0].start;
-    end = (p + r->part[0].size) - (search.length - 1);
+    end = p + r->part[0].size;
 
-    do {
-        if (memcmp(p, search.start, search.length) == 0) {
-
-            if (r->substitutions != NULL) {
-                captures[0] = p - r->part[0].start;
-                captures[1] = captures[0] + search.length;
+    for ( ;; ) {
+        p = (u_char *) njs_string_search(p, end, search.start, search.length);
+        if (p == NULL) {
+            njs_string_copy(&vm->retval, &args[0]);
+            return NXT_OK;
+        }
 
-                ret = njs_string_replace_substitute(vm, r, captures);
-                if (nxt_slow_path(ret != NXT_OK)) {
-                    return ret;
-                }
+        if (r->utf8 != NJS_STRING_UTF8 || p == end || (*p & 0xC0) != 0x80) {
+            break;
+        }
 
-            } else {
-                r->part[2].start = p + search.length;
-                size = p - r->part[0].start;
-                r->part[2].size = r->part[0].size - size - search.length;
-                r->part[0].size = size;
-                njs_set_invalid(&r->part[2].value);
+        /* A match inside of a character. */
+        p++;
+    }
 
-                if (r->function != NULL) {
-                    return njs_string_replace_search_function(vm, args, r);
-                }
-            }
+    if (r->substitutions != NULL) {
+        captures[0] = p - r->part[0].start;
+        captures[1] = captures[0] + search.length;
 
-            return njs_string_replace_join(vm, r);
+        ret = njs_string_replace_substitute(vm, r, captures);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
         }
 
-        if (r->utf8 < 2) {
-            p++;
-
-        } else {
-            p = (u_char *) nxt_utf8_next(p, end);
+    } else {
+        r->part[2].start = p + search.length;
+        size = p - r->part[0].start;
+        r->part[2].size = r->part[0].size - size - search.length;
+        r->part[0].size = size;
+        njs_set_invalid(&r->part[2].value);
+
+        if (r->function != NULL) {
+            return njs_string_replace_search_function(vm, args, r);
         }
+    }
 
-    } while (p < end);
-
-    njs_string_copy(&vm->retval, &args[0]);
-
-    return NXT_OK;
+    return njs_string_replace_join(vm, r);
 }
 
 
@@ -2852,12 +3339,16 @@ static njs_ret_t
 njs_string_replace_search_continuation(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
+    njs_ret_t             ret;
     njs_string_replace_t  *r;
 
     r = njs_vm_continuation(vm);
 
     if (njs_is_string(&r->retval)) {
-        njs_string_replacement_copy(&r->part[1], &r->retval);
+        ret = njs_string_replacement_copy(vm, &r->part[1], &r->retval);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
 
         return njs_string_replace_join(vm, r);
     }
@@ -3097,12 +3588,16 @@ njs_string_replace_join(njs_vm_t *vm, njs_string_replace_t *r)
 }
 
 
-static void
-njs_string_replacement_copy(njs_string_replace_part_t *string,
+static njs_ret_t
+njs_string_replacement_copy(njs_vm_t *vm, njs_string_replace_part_t *string,
     const njs_value_t *value)
 {
     size_t  size;
 
+    if (nxt_slow_path(njs_string_flat(vm, value) != NXT_OK)) {
+        return NXT_ERROR;
+    }
+
     string->value = *value;
 
     size = value->short_string.size;
@@ -3116,6 +3611,8 @@ njs_string_replacement_copy(njs_string_replace_part_t *string,
     }
 
     string->size = size;
+
+    return NXT_OK;
 }
 
 
@@ -3173,8 +3670,8 @@ njs_string_to_number(const njs_value_t *value, nxt_bool_t parse_float)
         p = value->short_string.start;
 
     } else {
-        size = value->long_string.size;
-        p = value->long_string.data->start;
+        p = njs_string_long_start(value);
+        size = (p != NULL) ? value->long_string.size : 0;
     }
 
     end = p + size;
@@ -3252,8 +3749,13 @@ njs_string_to_index(const njs_value_t *value)
         p = value->short_string.start;
 
     } else {
-        size = value->long_string.size;
+        if (njs_string_is_rope(value)) {
+            /* A rope is too long to be an index. */
+            return NAN;
+        }
+
         p = value->long_string.data->start;
+        size = value->long_string.size;
     }
 
     if (size == 0) {
@@ -3299,6 +3801,10 @@ njs_string_to_c_string(njs_vm_t *vm, njs_value_t *value)
         }
 
     } else {
+        if (nxt_slow_path(njs_string_flat(vm, value) != NXT_OK)) {
+            return NULL;
+        }
+
         start = value->long_string.data->start;
         size = value->long_string.size;
 
@@ -20,6 +20,9 @@
  *    This structure has the start field to support external strings.
  *    The long strings can have optional UTF-8 offset map.
  *
+ * A long string created by concatenation can be a rope and a long string
+ * created by slicing can be a view of another string, see below.
+ *
  * The number of the string variants is limited to 2 variants to minimize
  * overhead of processing string fields.
  */
@@ -78,6 +81,74 @@ struct njs_string_s {
 };
 
 
+/*
+ * A rope is a long string created by concatenation of two strings which
+ * have not been copied yet.  The rope njs_string_t start field is NULL
+ * until the first access to the string bytes flattens the rope: the bytes
+ * of the whole concatenation tree are copied to a new buffer and the rope
+ * becomes a usual long string.  The size and length of a rope are known
+ * without flattening.
+ *
+ * The left operand of a rope can be a rope, so the repeated "s += chunk"
+ * builds a left-deep tree which is flattened with one linear copy.
+ * The right operand is always flattened before creation of a rope to
+ * flatten the tree without recursion.
+ *
+ * The VM flattens ropes with njs_string_flat() which reports the memory
+ * error: the native functions get the string arguments flattened by
+ * njs_normalize_args() and the comparison operations flatten their
+ * operands, so njs_string_prop(), njs_string_eq(), and njs_string_cmp()
+ * never see a rope.  The rope keeps the memory pool only to be flattened
+ * by njs_string_get() in the debug and log paths which have no VM, these
+ * paths treat a rope as an empty string if the flattening fails.
+ */
+
+typedef struct {
+    njs_string_t          string;
+    uint32_t              size;
+    nxt_mem_cache_pool_t  *pool;
+    njs_value_t           left;
+    njs_value_t           right;
+} njs_string_rope_t;
+
+
+/* The minimum size of a concatenation created as a rope. */
+#define NJS_STRING_ROPE_MIN    256
+
+#define njs_string_is_rope(value)                                             \
+    ((value)->short_string.size == NJS_STRING_LONG                            \
+     && (value)->long_string.data->start == NULL)
+
+#define njs_string_long_start(value)                                          \
+    (nxt_fast_path((value)->long_string.data->start != NULL)                  \
+     ? (value)->long_string.data->start                                       \
+     : njs_string_rope_flatten((value)->long_string.data))
+
+
+/*
+ * A view is a long string slice which shares the bytes of the parent long
+ * string instead of copying them.  The view value long_string.external field
+ * is NJS_STRING_VIEW and the njs_string_t start field points inside the
+ * parent bytes, the conservative garbage collector keeps the parent bytes
+ * alive while the view is reachable.  The size field is the size of all
+ * the shared bytes, so a view of a view refers to the bytes directly.
+ *
+ * A small slice is copied to not keep a large string alive: a view is
+ * created only if the slice is at least 1/NJS_STRING_VIEW_RATIO of the
+ * shared bytes.  A view has no UTF-8 offset map, so a UTF-8 slice which
+ * requires the map is copied as well.
+ */
+
+typedef struct {
+    njs_string_t          string;
+    uint32_t              size;
+} njs_string_view_t;
+
+
+#define NJS_STRING_VIEW        1
+#define NJS_STRING_VIEW_RATIO  32
+
+
 typedef struct {
     size_t    size;
     size_t    length;
@@ -99,11 +170,14 @@ typedef enum {
 } njs_utf8_t;
 
 
+/*
+ * njs_string_length() expects a part of a valid UTF-8 string
+ * which starts and ends on character boundaries.
+ */
+
 nxt_inline uint32_t
 njs_string_length(njs_utf8_t utf8, u_char *start, size_t size)
 {
-    ssize_t  length;
-
     switch (utf8) {
 
     case NJS_STRING_BYTE:
@@ -114,9 +188,7 @@ njs_string_length(njs_utf8_t utf8, u_char *start, size_t size)
 
     case NJS_STRING_UTF8:
     default:
-        length = nxt_utf8_length(start, size);
-
-        return (length >= 0) ? length : 0;
+        return nxt_utf8_count(start, size);
     }
 }
 
@@ -130,6 +202,11 @@ njs_ret_t njs_string_base64(njs_vm_t *vm, njs_value_t *value,
 njs_ret_t njs_string_base64url(njs_vm_t *vm, njs_value_t *value,
 	const nxt_str_t *src);
 void njs_string_copy(njs_value_t *dst, njs_value_t *src);
+njs_ret_t njs_string_concat(njs_vm_t *vm, njs_value_t *dst,
+    const njs_value_t *val1, const njs_value_t *val2);
+u_char *njs_string_rope_flatten(njs_string_t *string);
+void njs_string_rope_get(const njs_value_t *value, nxt_str_t *str);
+njs_ret_t njs_string_flat(njs_vm_t *vm, const njs_value_t *value);
 njs_ret_t njs_string_validate(njs_vm_t *vm, njs_string_prop_t *string,
     njs_value_t *value);
 nxt_noinline size_t njs_string_prop(njs_string_prop_t *string,
@@ -138,8 +215,14 @@ njs_ret_t njs_string_constructor(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused);
 nxt_bool_t njs_string_eq(const njs_value_t *val1, const njs_value_t *val2);
 nxt_int_t njs_string_cmp(const njs_value_t *val1, const njs_value_t *val2);
+njs_ret_t njs_string_view(njs_vm_t *vm, njs_value_t *dst,
+    const njs_value_t *parent, const u_char *start, uint32_t size,
+    uint32_t length);
 njs_ret_t njs_string_slice(njs_vm_t *vm, njs_value_t *dst,
-    const njs_string_prop_t *string, njs_slice_prop_t *slice);
+    const njs_value_t *value, const njs_string_prop_t *string,
+    njs_slice_prop_t *slice);
+const u_char *njs_string_search(const u_char *start, const u_char *end,
+    const u_char *search, size_t size);
 const u_char *njs_string_offset(const u_char *start, const u_char *end,
     size_t index);
 nxt_noinline uint32_t njs_string_index(njs_string_prop_t *string,
@@ -0,0 +1,1829 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <njs_core.h>
+#include <njs_typed_array.h>
+#include <nxt_dtoa.h>
+#include <string.h>
+#include <math.h>
+
+
+/*
+ * An ArrayBuffer is a contiguous memory allocated in the VM pool or
+ * a host memory wrapped by njs_vm_array_buffer_wrap() without copying.
+ * Typed arrays and DataViews are views of an ArrayBuffer.  The wrapped
+ * buffers are linked in the vm->wrapped_buffers list and are detached
+ * by njs_vm_array_buffers_detach() before the host memory is reused,
+ * the detached buffer size and all its views lengths are zero.
+ */
+
+typedef enum {
+    NJS_DATA_VIEW_INT8 = 0,
+    NJS_DATA_VIEW_UINT8,
+    NJS_DATA_VIEW_INT16,
+    NJS_DATA_VIEW_UINT16,
+    NJS_DATA_VIEW_INT32,
+    NJS_DATA_VIEW_UINT32,
+    NJS_DATA_VIEW_FLOAT32,
+    NJS_DATA_VIEW_FLOAT64,
+} njs_data_view_type_t;
+
+
+static njs_array_buffer_t *njs_array_buffer_alloc(njs_vm_t *vm, uint32_t size);
+static njs_typed_array_t *njs_array_buffer_view_alloc(njs_vm_t *vm,
+    njs_value_type_t type, nxt_uint_t prototype, njs_array_buffer_t *buffer,
+    uint32_t offset, uint32_t length);
+static njs_ret_t njs_typed_array_create(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_typed_array_type_t type);
+static njs_ret_t njs_typed_array_copy(njs_vm_t *vm, njs_typed_array_t *array,
+    uint32_t offset, const njs_value_t *source);
+static njs_ret_t njs_typed_array_index(njs_vm_t *vm, double num,
+    uint32_t *index);
+static uint32_t njs_typed_array_relative(njs_value_t *args, nxt_uint_t nargs,
+    nxt_uint_t n, uint32_t length, uint32_t dflt);
+static u_char *njs_data_view_pointer(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_data_view_type_t type);
+static njs_ret_t njs_data_view_get(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_data_view_type_t type);
+static njs_ret_t njs_data_view_set(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_data_view_type_t type);
+
+
+static const uint8_t  njs_data_view_sizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+
+static const njs_object_init_t  *njs_typed_array_constructors[] = {
+    &njs_uint8_array_constructor_init,
+    &njs_uint16_array_constructor_init,
+    &njs_uint32_array_constructor_init,
+    &njs_float64_array_constructor_init,
+};
+
+
+static njs_array_buffer_t *
+njs_array_buffer_alloc(njs_vm_t *vm, uint32_t size)
+{
+    njs_array_buffer_t  *buffer;
+
+    buffer = nxt_mem_cache_alloc(vm->mem_cache_pool,
+                                 sizeof(njs_array_buffer_t));
+    if (nxt_slow_path(buffer == NULL)) {
+        goto memory_error;
+    }
+
+    buffer->start = NULL;
+
+    if (size != 0) {
+        /* The alignment allows aligned access to the Float64Array elements. */
+        buffer->start = nxt_mem_cache_zalign(vm->mem_cache_pool,
+                                             sizeof(double), size);
+        if (nxt_slow_path(buffer->start == NULL)) {
+            goto memory_error;
+        }
+    }
+
+    nxt_lvlhsh_init(&buffer->object.hash);
+    nxt_lvlhsh_init(&buffer->object.shared_hash);
+    buffer->object.__proto__ =
+                          &vm->prototypes[NJS_PROTOTYPE_ARRAY_BUFFER].object;
+    buffer->object.type = NJS_ARRAY_BUFFER;
+    buffer->object.shared = 0;
+    buffer->object.extensible = 1;
+    buffer->object.immutable = 0;
+    buffer->object.shape = NULL;
+    buffer->object.slots = NULL;
+    buffer->size = size;
+    buffer->next = NULL;
+
+    return buffer;
+
+memory_error:
+
+    njs_memory_error(vm);
+
+    return NULL;
+}
+
+
+static njs_typed_array_t *
+njs_array_buffer_view_alloc(njs_vm_t *vm, njs_value_type_t type,
+    nxt_uint_t prototype, njs_array_buffer_t *buffer, uint32_t offset,
+    uint32_t length)
+{
+    njs_typed_array_t  *array;
+
+    array = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_typed_array_t));
+    if (nxt_slow_path(array == NULL)) {
+        njs_memory_error(vm);
+        return NULL;
+    }
+
+    nxt_lvlhsh_init(&array->object.hash);
+    nxt_lvlhsh_init(&array->object.shared_hash);
+    array->object.__proto__ = &vm->prototypes[prototype].object;
+    array->object.type = type;
+    array->object.shared = 0;
+    array->object.extensible = 1;
+    array->object.immutable = 0;
+    array->object.shape = NULL;
+    array->object.slots = NULL;
+    array->buffer = buffer;
+    array->offset = offset;
+    array->length = length;
+    array->type = 0;
+
+    return array;
+}
+
+
+njs_ret_t
+njs_vm_array_buffer_wrap(njs_vm_t *vm, njs_value_t *value, u_char *start,
+    size_t size)
+{
+    njs_array_buffer_t  *buffer;
+
+    if (nxt_slow_path(size > NJS_ARRAY_MAX_LENGTH)) {
+        njs_range_error(vm, "Invalid array buffer length");
+        return NXT_ERROR;
+    }
+
+    buffer = njs_array_buffer_alloc(vm, 0);
+    if (nxt_slow_path(buffer == NULL)) {
+        return NXT_ERROR;
+    }
+
+    buffer->start = start;
+    buffer->size = size;
+
+    buffer->next = vm->wrapped_buffers;
+    vm->wrapped_buffers = buffer;
+
+    value->data.u.array_buffer = buffer;
+    value->type = NJS_ARRAY_BUFFER;
+    value->data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+void
+njs_vm_array_buffers_detach(njs_vm_t *vm)
+{
+    njs_array_buffer_t  *buffer, *next;
+
+    for (buffer = vm->wrapped_buffers; buffer != NULL; buffer = next) {
+        next = buffer->next;
+
+        buffer->start = NULL;
+        buffer->size = 0;
+        buffer->next = NULL;
+    }
+
+    vm->wrapped_buffers = NULL;
+}
+
+
+/* The elements are stored in the host byte order and may be unaligned. */
+
+void
+njs_typed_array_get(const njs_typed_array_t *array, uint32_t index,
+    njs_value_t *value)
+{
+    u_char    *p;
+    double    num;
+    uint16_t  u16;
+    uint32_t  u32;
+
+    p = njs_typed_array_start(array);
+
+    switch (array->type) {
+
+    case NJS_TYPED_ARRAY_UINT8:
+        njs_value_int32_set(value, p[index]);
+        return;
+
+    case NJS_TYPED_ARRAY_UINT16:
+        memcpy(&u16, &p[index * 2], sizeof(uint16_t));
+        njs_value_int32_set(value, u16);
+        return;
+
+    case NJS_TYPED_ARRAY_UINT32:
+        memcpy(&u32, &p[index * 4], sizeof(uint32_t));
+
+        if (u32 <= 0x7fffffff) {
+            njs_value_int32_set(value, (int32_t) u32);
+
+        } else {
+            njs_value_number_set(value, u32);
+        }
+
+        return;
+
+    default:
+        memcpy(&num, &p[index * 8], sizeof(double));
+        njs_value_number_set(value, num);
+        njs_value_int32_hint(value, num);
+        return;
+    }
+}
+
+
+void
+njs_typed_array_set(njs_typed_array_t *array, uint32_t index,
+    const njs_value_t *value)
+{
+    u_char    *p;
+    double    num;
+    uint16_t  u16;
+    uint32_t  u32;
+
+    p = njs_typed_array_start(array);
+
+    if (array->type == NJS_TYPED_ARRAY_FLOAT64) {
+        num = njs_typed_array_number(value);
+        memcpy(&p[index * 8], &num, sizeof(double));
+        return;
+    }
+
+    /* The integer elements are modulo 2^8, 2^16, and 2^32. */
+
+    if (njs_is_int32(value)) {
+        u32 = value->data.integer;
+
+    } else {
+        u32 = njs_number_to_integer(njs_typed_array_number(value));
+    }
+
+    switch (array->type) {
+
+    case NJS_TYPED_ARRAY_UINT8:
+        p[index] = (u_char) u32;
+        return;
+
+    case NJS_TYPED_ARRAY_UINT16:
+        u16 = (uint16_t) u32;
+        memcpy(&p[index * 2], &u16, sizeof(uint16_t));
+        return;
+
+    default:
+        memcpy(&p[index * 4], &u32, sizeof(uint32_t));
+        return;
+    }
+}
+
+
+double
+njs_typed_array_number(const njs_value_t *value)
+{
+    if (njs_is_numeric(value)) {
+        return value->data.u.number;
+    }
+
+    if (njs_is_string(value)) {
+        return njs_string_to_number(value, 0);
+    }
+
+    return NAN;
+}
+
+
+/*
+ * njs_typed_array_key() tests whether a property key is a canonical
+ * numeric string, i.e. a number or a string which is the same as the
+ * number converted back to string, or "-0".  Such keys never become
+ * ordinary properties of a typed array: the index is set to
+ * NJS_ARRAY_INVALID_INDEX if the number is not an integer index.
+ */
+
+nxt_bool_t
+njs_typed_array_key(const njs_value_t *key, uint32_t *index)
+{
+    double     num;
+    size_t     size;
+    u_char     buf[NXT_DTOA_MAX_LEN];
+    nxt_str_t  str;
+
+    if (njs_is_numeric(key)) {
+        num = key->data.u.number;
+
+    } else if (njs_is_string(key) && !njs_string_is_rope(key)) {
+        njs_string_get(key, &str);
+
+        if (str.length == 0 || str.length > NXT_DTOA_MAX_LEN) {
+            return 0;
+        }
+
+        num = njs_string_to_number(key, 0);
+
+        if (isnan(num)) {
+            if (str.length != 3 || memcmp(str.start, "NaN", 3) != 0) {
+                return 0;
+            }
+
+        } else if (isinf(num)) {
+            if (str.length != ((num > 0) ? 8 : 9)
+                || memcmp(str.start, (num > 0) ? "Infinity" : "-Infinity",
+                          str.length) != 0)
+            {
+                return 0;
+            }
+
+        } else {
+            /* nxt_dtoa() prints the negative zero as "-0". */
+
+            size = nxt_dtoa(num, buf);
+
+            if (size != str.length || memcmp(str.start, buf, size) != 0) {
+                return 0;
+            }
+
+            if (num == 0 && signbit(num)) {
+                /* The "-0" key is not an integer index. */
+                *index = NJS_ARRAY_INVALID_INDEX;
+                return 1;
+            }
+        }
+
+    } else {
+        return 0;
+    }
+
+    /* The negative zero number is the "0" key as well. */
+
+    *index = ((uint32_t) num == num && num < NJS_ARRAY_MAX_LENGTH)
+             ? (uint32_t) num : NJS_ARRAY_INVALID_INDEX;
+
+    return 1;
+}
+
+
+static njs_ret_t
+njs_typed_array_index(njs_vm_t *vm, double num, uint32_t *index)
+{
+    if (isnan(num)) {
+        num = 0;
+    }
+
+    num = trunc(num);
+
+    if (nxt_slow_path(num < 0 || num > NJS_ARRAY_MAX_LENGTH)) {
+        njs_range_error(vm, "Invalid index");
+        return NXT_ERROR;
+    }
+
+    *index = num;
+
+    return NXT_OK;
+}
+
+
+/*
+ * The begin and end arguments of slice(), subarray(), and fill() are
+ * relative to the end if they are negative.  The arguments have been
+ * converted to integers but a void value has retained its type.
+ */
+
+static uint32_t
+njs_typed_array_relative(njs_value_t *args, nxt_uint_t nargs, nxt_uint_t n,
+    uint32_t length, uint32_t dflt)
+{
+    double  num;
+
+    if (n >= nargs || njs_is_void(&args[n])) {
+        return dflt;
+    }
+
+    num = args[n].data.u.number;
+
+    if (num < 0) {
+        num += length;
+        return (num < 0) ? 0 : num;
+    }
+
+    return (num > length) ? length : num;
+}
+
+
+njs_ret_t
+njs_array_buffer_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint32_t            size;
+    njs_ret_t           ret;
+    njs_array_buffer_t  *buffer;
+
+    if (nxt_slow_path(!vm->top_frame->ctor)) {
+        njs_type_error(vm, "Constructor ArrayBuffer requires 'new'");
+        return NXT_ERROR;
+    }
+
+    size = 0;
+
+    if (nargs > 1) {
+        ret = njs_typed_array_index(vm, args[1].data.u.number, &size);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+    }
+
+    buffer = njs_array_buffer_alloc(vm, size);
+    if (nxt_slow_path(buffer == NULL)) {
+        return NXT_ERROR;
+    }
+
+    vm->retval.data.u.array_buffer = buffer;
+    vm->retval.type = NJS_ARRAY_BUFFER;
+    vm->retval.data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_array_buffer_is_view(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
+    njs_index_t unused)
+{
+    const njs_value_t  *value;
+
+    value = &njs_value_false;
+
+    if (nargs > 1
+        && (njs_is_typed_array(&args[1]) || njs_is_data_view(&args[1])))
+    {
+        value = &njs_value_true;
+    }
+
+    vm->retval = *value;
+
+    return NXT_OK;
+}
+
+
+static const njs_object_prop_t  njs_array_buffer_constructor_properties[] =
+{
+    /* ArrayBuffer.name == "ArrayBuffer". */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("ArrayBuffer"),
+    },
+
+    /* ArrayBuffer.length == 1. */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 1, 1.0),
+    },
+
+    /* ArrayBuffer.prototype. */
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("prototype"),
+        .value = njs_prop_handler(njs_object_prototype_create),
+    },
+
+    /* ArrayBuffer.isView(). */
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("isView"),
+        .value = njs_native_function(njs_array_buffer_is_view, 0, 0),
+    },
+};
+
+
+const njs_object_init_t  njs_array_buffer_constructor_init = {
+    nxt_string("ArrayBuffer"),
+    njs_array_buffer_constructor_properties,
+    nxt_nitems(njs_array_buffer_constructor_properties),
+};
+
+
+static njs_ret_t
+njs_array_buffer_prototype_byte_length(njs_vm_t *vm, njs_value_t *value,
+    njs_value_t *setval, njs_value_t *retval)
+{
+    *retval = njs_value_void;
+
+    if (njs_is_array_buffer(value)) {
+        njs_value_number_set(retval, value->data.u.array_buffer->size);
+    }
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_array_buffer_prototype_slice(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint32_t            start, end;
+    njs_array_buffer_t  *buffer, *copy;
+
+    buffer = args[0].data.u.array_buffer;
+
+    start = njs_typed_array_relative(args, nargs, 1, buffer->size, 0);
+    end = njs_typed_array_relative(args, nargs, 2, buffer->size,
+                                   buffer->size);
+
+    if (end < start) {
+        end = start;
+    }
+
+    copy = njs_array_buffer_alloc(vm, end - start);
+    if (nxt_slow_path(copy == NULL)) {
+        return NXT_ERROR;
+    }
+
+    if (end != start) {
+        memcpy(copy->start, &buffer->start[start], end - start);
+    }
+
+    vm->retval.data.u.array_buffer = copy;
+    vm->retval.type = NJS_ARRAY_BUFFER;
+    vm->retval.data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+static const njs_object_prop_t  njs_array_buffer_prototype_properties[] =
+{
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("byteLength"),
+        .value = njs_prop_handler(njs_array_buffer_prototype_byte_length),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("slice"),
+        .value = njs_native_function(njs_array_buffer_prototype_slice, 0,
+                     NJS_ARRAY_BUFFER_ARG, NJS_INTEGER_ARG, NJS_INTEGER_ARG),
+    },
+};
+
+
+const njs_object_init_t  njs_array_buffer_prototype_init = {
+    nxt_string("ArrayBuffer"),
+    njs_array_buffer_prototype_properties,
+    nxt_nitems(njs_array_buffer_prototype_properties),
+};
+
+
+static njs_ret_t
+njs_typed_array_create(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
+    njs_typed_array_type_t type)
+{
+    uint32_t            size, offset, length;
+    njs_ret_t           ret;
+    const nxt_str_t     *name;
+    njs_typed_array_t   *array;
+    njs_array_buffer_t  *buffer;
+    const njs_value_t   *value;
+
+    name = &njs_typed_array_constructors[type]->name;
+
+    if (nxt_slow_path(!vm->top_frame->ctor)) {
+        njs_type_error(vm, "Constructor %.*s requires 'new'",
+                       (int) name->length, name->start);
+        return NXT_ERROR;
+    }
+
+    size = njs_typed_array_element_size(type);
+    value = (nargs > 1) ? &args[1] : &njs_value_void;
+
+    if (njs_is_array_buffer(value)) {
+        /* new Uint8Array(buffer, byteOffset, length). */
+
+        buffer = value->data.u.array_buffer;
+        offset = 0;
+
+        if (nargs > 2) {
+            ret = njs_typed_array_index(vm, args[2].data.u.number, &offset);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+        }
+
+        if (nxt_slow_path(offset % size != 0)) {
+            njs_range_error(vm, "start offset of %.*s should be "
+                            "a multiple of %u", (int) name->length,
+                            name->start, size);
+            return NXT_ERROR;
+        }
+
+        if (nargs > 3 && !njs_is_void(&args[3])) {
+            ret = njs_typed_array_index(vm, args[3].data.u.number, &length);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+
+            if (nxt_slow_path((uint64_t) offset + (uint64_t) length * size
+                              > buffer->size))
+            {
+                njs_range_error(vm, "Invalid typed array length: %u",
+                                length);
+                return NXT_ERROR;
+            }
+
+        } else {
+            if (nxt_slow_path(buffer->size % size != 0)) {
+                njs_range_error(vm, "byte length of %.*s should be "
+                                "a multiple of %u", (int) name->length,
+                                name->start, size);
+                return NXT_ERROR;
+            }
+
+            if (nxt_slow_path(offset > buffer->size)) {
+                njs_range_error(vm, "Start offset %u is outside the bounds "
+                                "of the buffer", offset);
+                return NXT_ERROR;
+            }
+
+            length = (buffer->size - offset) / size;
+        }
+
+    } else {
+        /* new Uint8Array(length), new Uint8Array(array). */
+
+        offset = 0;
+
+        if (njs_is_typed_array(value)) {
+            length = njs_typed_array_length(value->data.u.typed_array);
+
+        } else if (njs_is_array(value)) {
+            length = value->data.u.array->length;
+
+        } else if (njs_is_object(value)) {
+            length = 0;
+
+        } else {
+            ret = njs_typed_array_index(vm, njs_typed_array_number(value),
+                                        &length);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+        }
+
+        if (nxt_slow_path((uint64_t) length * size > NJS_ARRAY_MAX_LENGTH)) {
+            njs_range_error(vm, "Invalid typed array length: %u", length);
+            return NXT_ERROR;
+        }
+
+        buffer = njs_array_buffer_alloc(vm, length * size);
+        if (nxt_slow_path(buffer == NULL)) {
+            return NXT_ERROR;
+        }
+    }
+
+    array = njs_array_buffer_view_alloc(vm, NJS_TYPED_ARRAY,
+                                        NJS_PROTOTYPE_UINT8_ARRAY + type,
+                                        buffer, offset, length);
+    if (nxt_slow_path(array == NULL)) {
+        return NXT_ERROR;
+    }
+
+    array->type = type;
+
+    if (njs_is_typed_array(value) || njs_is_array(value)) {
+        ret = njs_typed_array_copy(vm, array, 0, value);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+    }
+
+    vm->retval.data.u.typed_array = array;
+    vm->retval.type = NJS_TYPED_ARRAY;
+    vm->retval.data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+/*
+ * Copies the typed array or array elements to the typed array
+ * starting from the offset, the elements must fit in the array.
+ */
+
+static njs_ret_t
+njs_typed_array_copy(njs_vm_t *vm, njs_typed_array_t *array, uint32_t offset,
+    const njs_value_t *source)
+{
+    u_char              *p;
+    uint32_t            i, length, size;
+    njs_value_t         value;
+    njs_array_t         *from;
+    njs_typed_array_t   *src, copy;
+    njs_array_buffer_t  buffer;
+
+    if (njs_is_array(source)) {
+        from = source->data.u.array;
+
+        for (i = 0; i < from->length; i++) {
+            value = njs_value_void;
+
+            if (njs_array_item_is_valid(&from->start[i])) {
+                njs_array_item_get(&from->start[i], &value);
+            }
+
+            njs_typed_array_set(array, offset + i, &value);
+        }
+
+        return NXT_OK;
+    }
+
+    src = source->data.u.typed_array;
+    length = njs_typed_array_length(src);
+
+    if (length == 0) {
+        return NXT_OK;
+    }
+
+    if (src->type == array->type) {
+        size = njs_typed_array_element_size(array->type);
+
+        memmove(njs_typed_array_start(array) + offset * size,
+                njs_typed_array_start(src), length * size);
+
+        return NXT_OK;
+    }
+
+    if (src->buffer == array->buffer) {
+        /* The source elements may be overwritten while they are copied. */
+
+        size = length * njs_typed_array_element_size(src->type);
+
+        p = nxt_mem_cache_alloc(vm->mem_cache_pool, size);
+        if (nxt_slow_path(p == NULL)) {
+            njs_memory_error(vm);
+            return NXT_ERROR;
+        }
+
+        memcpy(p, njs_typed_array_start(src), size);
+
+        buffer.start = p;
+        buffer.size = size;
+
+        copy = *src;
+        copy.buffer = &buffer;
+        copy.offset = 0;
+        src = &copy;
+    }
+
+    for (i = 0; i < length; i++) {
+        njs_typed_array_get(src, i, &value);
+        njs_typed_array_set(array, offset + i, &value);
+    }
+
+    return NXT_OK;
+}
+
+
+njs_ret_t
+njs_uint8_array_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_typed_array_create(vm, args, nargs, NJS_TYPED_ARRAY_UINT8);
+}
+
+
+njs_ret_t
+njs_uint16_array_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_typed_array_create(vm, args, nargs, NJS_TYPED_ARRAY_UINT16);
+}
+
+
+njs_ret_t
+njs_uint32_array_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_typed_array_create(vm, args, nargs, NJS_TYPED_ARRAY_UINT32);
+}
+
+
+njs_ret_t
+njs_float64_array_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_typed_array_create(vm, args, nargs, NJS_TYPED_ARRAY_FLOAT64);
+}
+
+
+static const njs_object_prop_t  njs_uint8_array_constructor_properties[] =
+{
+    /* Uint8Array.name == "Uint8Array". */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("Uint8Array"),
+    },
+
+    /* Uint8Array.length == 3. */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 1, 3.0),
+    },
+
+    /* Uint8Array.prototype. */
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("prototype"),
+        .value = njs_prop_handler(njs_object_prototype_create),
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_long_string("BYTES_PER_ELEMENT"),
+        .value = njs_value(NJS_NUMBER, 1, 1.0),
+    },
+};
+
+
+const njs_object_init_t  njs_uint8_array_constructor_init = {
+    nxt_string("Uint8Array"),
+    njs_uint8_array_constructor_properties,
+    nxt_nitems(njs_uint8_array_constructor_properties),
+};
+
+
+static const njs_object_prop_t  njs_uint16_array_constructor_properties[] =
+{
+    /* Uint16Array.name == "Uint16Array". */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("Uint16Array"),
+    },
+
+    /* Uint16Array.length == 3. */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 1, 3.0),
+    },
+
+    /* Uint16Array.prototype. */
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("prototype"),
+        .value = njs_prop_handler(njs_object_prototype_create),
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_long_string("BYTES_PER_ELEMENT"),
+        .value = njs_value(NJS_NUMBER, 1, 2.0),
+    },
+};
+
+
+const njs_object_init_t  njs_uint16_array_constructor_init = {
+    nxt_string("Uint16Array"),
+    njs_uint16_array_constructor_properties,
+    nxt_nitems(njs_uint16_array_constructor_properties),
+};
+
+
+static const njs_object_prop_t  njs_uint32_array_constructor_properties[] =
+{
+    /* Uint32Array.name == "Uint32Array". */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("Uint32Array"),
+    },
+
+    /* Uint32Array.length == 3. */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 1, 3.0),
+    },
+
+    /* Uint32Array.prototype. */
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("prototype"),
+        .value = njs_prop_handler(njs_object_prototype_create),
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_long_string("BYTES_PER_ELEMENT"),
+        .value = njs_value(NJS_NUMBER, 1, 4.0),
+    },
+};
+
+
+const njs_object_init_t  njs_uint32_array_constructor_init = {
+    nxt_string("Uint32Array"),
+    njs_uint32_array_constructor_properties,
+    nxt_nitems(njs_uint32_array_constructor_properties),
+};
+
+
+static const njs_object_prop_t  njs_float64_array_constructor_properties[] =
+{
+    /* Float64Array.name == "Float64Array". */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("Float64Array"),
+    },
+
+    /* Float64Array.length == 3. */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 1, 3.0),
+    },
+
+    /* Float64Array.prototype. */
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("prototype"),
+        .value = njs_prop_handler(njs_object_prototype_create),
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_long_string("BYTES_PER_ELEMENT"),
+        .value = njs_value(NJS_NUMBER, 1, 8.0),
+    },
+};
+
+
+const njs_object_init_t  njs_float64_array_constructor_init = {
+    nxt_string("Float64Array"),
+    njs_float64_array_constructor_properties,
+    nxt_nitems(njs_float64_array_constructor_properties),
+};
+
+
+/*
+ * The typed array and DataView getters are invoked with the object
+ * which is not a view if they are accessed via the prototype.
+ */
+
+static njs_ret_t
+njs_typed_array_prototype_buffer(njs_vm_t *vm, njs_value_t *value,
+    njs_value_t *setval, njs_value_t *retval)
+{
+    *retval = njs_value_void;
+
+    if (njs_is_typed_array(value) || njs_is_data_view(value)) {
+        retval->data.u.array_buffer = value->data.u.typed_array->buffer;
+        retval->type = NJS_ARRAY_BUFFER;
+        retval->data.truth = 1;
+    }
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_typed_array_prototype_byte_length(njs_vm_t *vm, njs_value_t *value,
+    njs_value_t *setval, njs_value_t *retval)
+{
+    njs_typed_array_t  *array;
+
+    *retval = njs_value_void;
+
+    if (njs_is_typed_array(value)) {
+        array = value->data.u.typed_array;
+        njs_value_number_set(retval, njs_typed_array_length(array)
+                             * njs_typed_array_element_size(array->type));
+
+    } else if (njs_is_data_view(value)) {
+        njs_value_number_set(retval,
+                          njs_typed_array_length(value->data.u.typed_array));
+    }
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_typed_array_prototype_byte_offset(njs_vm_t *vm, njs_value_t *value,
+    njs_value_t *setval, njs_value_t *retval)
+{
+    njs_typed_array_t  *array;
+
+    *retval = njs_value_void;
+
+    if (njs_is_typed_array(value) || njs_is_data_view(value)) {
+        array = value->data.u.typed_array;
+        njs_value_number_set(retval, (array->buffer->size != 0)
+                                     ? array->offset : 0);
+    }
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_typed_array_prototype_length(njs_vm_t *vm, njs_value_t *value,
+    njs_value_t *setval, njs_value_t *retval)
+{
+    *retval = njs_value_void;
+
+    if (njs_is_typed_array(value)) {
+        njs_value_number_set(retval,
+                          njs_typed_array_length(value->data.u.typed_array));
+    }
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_typed_array_prototype_bytes_per_element(njs_vm_t *vm, njs_value_t *value,
+    njs_value_t *setval, njs_value_t *retval)
+{
+    *retval = njs_value_void;
+
+    if (njs_is_typed_array(value)) {
+        njs_value_number_set(retval, njs_typed_array_element_size(
+                                         value->data.u.typed_array->type));
+    }
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_typed_array_prototype_subarray(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint32_t           start, end, length;
+    njs_typed_array_t  *array, *view;
+
+    array = args[0].data.u.typed_array;
+    length = njs_typed_array_length(array);
+
+    start = njs_typed_array_relative(args, nargs, 1, length, 0);
+    end = njs_typed_array_relative(args, nargs, 2, length, length);
+
+    if (end < start) {
+        end = start;
+    }
+
+    view = njs_array_buffer_view_alloc(vm, NJS_TYPED_ARRAY,
+                                       NJS_PROTOTYPE_UINT8_ARRAY + array->type,
+                                       array->buffer,
+                                       array->offset + start
+                                       * njs_typed_array_element_size(
+                                                                array->type),
+                                       end - start);
+    if (nxt_slow_path(view == NULL)) {
+        return NXT_ERROR;
+    }
+
+    view->type = array->type;
+
+    vm->retval.data.u.typed_array = view;
+    vm->retval.type = NJS_TYPED_ARRAY;
+    vm->retval.data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_typed_array_prototype_slice(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint32_t            start, end, length, size;
+    njs_typed_array_t   *array, *copy;
+    njs_array_buffer_t  *buffer;
+
+    array = args[0].data.u.typed_array;
+    length = njs_typed_array_length(array);
+
+    start = njs_typed_array_relative(args, nargs, 1, length, 0);
+    end = njs_typed_array_relative(args, nargs, 2, length, length);
+
+    if (end < start) {
+        end = start;
+    }
+
+    size = njs_typed_array_element_size(array->type);
+
+    buffer = njs_array_buffer_alloc(vm, (end - start) * size);
+    if (nxt_slow_path(buffer == NULL)) {
+        return NXT_ERROR;
+    }
+
+    copy = njs_array_buffer_view_alloc(vm, NJS_TYPED_ARRAY,
+                                       NJS_PROTOTYPE_UINT8_ARRAY + array->type,
+                                       buffer, 0, end - start);
+    if (nxt_slow_path(copy == NULL)) {
+        return NXT_ERROR;
+    }
+
+    copy->type = array->type;
+
+    if (end != start) {
+        memcpy(buffer->start, njs_typed_array_start(array) + start * size,
+               (end - start) * size);
+    }
+
+    vm->retval.data.u.typed_array = copy;
+    vm->retval.type = NJS_TYPED_ARRAY;
+    vm->retval.data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_typed_array_prototype_set(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint32_t           offset, length;
+    njs_ret_t          ret;
+    njs_typed_array_t  *array;
+
+    array = args[0].data.u.typed_array;
+
+    if (nargs < 2
+        || !(njs_is_typed_array(&args[1]) || njs_is_array(&args[1])))
+    {
+        njs_type_error(vm, "invalid source");
+        return NXT_ERROR;
+    }
+
+    offset = 0;
+
+    if (nargs > 2) {
+        ret = njs_typed_array_index(vm, args[2].data.u.number, &offset);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+    }
+
+    if (njs_is_array(&args[1])) {
+        length = args[1].data.u.array->length;
+
+    } else {
+        length = njs_typed_array_length(args[1].data.u.typed_array);
+    }
+
+    if (nxt_slow_path((uint64_t) offset + length
+                      > njs_typed_array_length(array)))
+    {
+        njs_range_error(vm, "offset is out of bounds");
+        return NXT_ERROR;
+    }
+
+    ret = njs_typed_array_copy(vm, array, offset, &args[1]);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    vm->retval = njs_value_void;
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_typed_array_prototype_fill(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint32_t           i, start, end, length;
+    njs_typed_array_t  *array;
+    const njs_value_t  *value;
+
+    array = args[0].data.u.typed_array;
+    length = njs_typed_array_length(array);
+    value = (nargs > 1) ? &args[1] : &njs_value_void;
+
+    start = njs_typed_array_relative(args, nargs, 2, length, 0);
+    end = njs_typed_array_relative(args, nargs, 3, length, length);
+
+    if (array->type == NJS_TYPED_ARRAY_UINT8 && end > start) {
+        njs_typed_array_set(array, start, value);
+
+        memset(njs_typed_array_start(array) + start + 1,
+               njs_typed_array_start(array)[start], end - start - 1);
+
+    } else {
+        for (i = start; i < end; i++) {
+            njs_typed_array_set(array, i, value);
+        }
+    }
+
+    vm->retval = args[0];
+
+    return NXT_OK;
+}
+
+
+static const njs_object_prop_t  njs_typed_array_prototype_properties[] =
+{
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("buffer"),
+        .value = njs_prop_handler(njs_typed_array_prototype_buffer),
+    },
+
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("byteLength"),
+        .value = njs_prop_handler(njs_typed_array_prototype_byte_length),
+    },
+
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("byteOffset"),
+        .value = njs_prop_handler(njs_typed_array_prototype_byte_offset),
+    },
+
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("length"),
+        .value = njs_prop_handler(njs_typed_array_prototype_length),
+    },
+
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_long_string("BYTES_PER_ELEMENT"),
+        .value = njs_prop_handler(njs_typed_array_prototype_bytes_per_element),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("subarray"),
+        .value = njs_native_function(njs_typed_array_prototype_subarray, 0,
+                     NJS_TYPED_ARRAY_ARG, NJS_INTEGER_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("slice"),
+        .value = njs_native_function(njs_typed_array_prototype_slice, 0,
+                     NJS_TYPED_ARRAY_ARG, NJS_INTEGER_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("set"),
+        .value = njs_native_function(njs_typed_array_prototype_set, 0,
+                     NJS_TYPED_ARRAY_ARG, NJS_SKIP_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("fill"),
+        .value = njs_native_function(njs_typed_array_prototype_fill, 0,
+                     NJS_TYPED_ARRAY_ARG, NJS_NUMBER_ARG, NJS_INTEGER_ARG,
+                     NJS_INTEGER_ARG),
+    },
+};
+
+
+/* The typed array prototypes share the properties. */
+
+const njs_object_init_t  njs_uint8_array_prototype_init = {
+    nxt_string("Uint8Array"),
+    njs_typed_array_prototype_properties,
+    nxt_nitems(njs_typed_array_prototype_properties),
+};
+
+
+const njs_object_init_t  njs_uint16_array_prototype_init = {
+    nxt_string("Uint16Array"),
+    njs_typed_array_prototype_properties,
+    nxt_nitems(njs_typed_array_prototype_properties),
+};
+
+
+const njs_object_init_t  njs_uint32_array_prototype_init = {
+    nxt_string("Uint32Array"),
+    njs_typed_array_prototype_properties,
+    nxt_nitems(njs_typed_array_prototype_properties),
+};
+
+
+const njs_object_init_t  njs_float64_array_prototype_init = {
+    nxt_string("Float64Array"),
+    njs_typed_array_prototype_properties,
+    nxt_nitems(njs_typed_array_prototype_properties),
+};
+
+
+njs_ret_t
+njs_data_view_constructor(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
+    njs_index_t unused)
+{
+    uint32_t            offset, length;
+    njs_ret_t           ret;
+    njs_typed_array_t   *view;
+    njs_array_buffer_t  *buffer;
+
+    if (nxt_slow_path(!vm->top_frame->ctor)) {
+        njs_type_error(vm, "Constructor DataView requires 'new'");
+        return NXT_ERROR;
+    }
+
+    if (nxt_slow_path(nargs < 2 || !njs_is_array_buffer(&args[1]))) {
+        njs_type_error(vm, "First argument to DataView constructor "
+                       "must be an ArrayBuffer");
+        return NXT_ERROR;
+    }
+
+    buffer = args[1].data.u.array_buffer;
+    offset = 0;
+
+    if (nargs > 2) {
+        ret = njs_typed_array_index(vm, args[2].data.u.number, &offset);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+    }
+
+    if (nxt_slow_path(offset > buffer->size)) {
+        njs_range_error(vm, "Start offset %u is outside the bounds "
+                        "of the buffer", offset);
+        return NXT_ERROR;
+    }
+
+    length = buffer->size - offset;
+
+    if (nargs > 3 && !njs_is_void(&args[3])) {
+        ret = njs_typed_array_index(vm, args[3].data.u.number, &length);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        if (nxt_slow_path((uint64_t) offset + length > buffer->size)) {
+            njs_range_error(vm, "Invalid DataView length %u", length);
+            return NXT_ERROR;
+        }
+    }
+
+    view = njs_array_buffer_view_alloc(vm, NJS_DATA_VIEW,
+                                       NJS_PROTOTYPE_DATA_VIEW, buffer,
+                                       offset, length);
+    if (nxt_slow_path(view == NULL)) {
+        return NXT_ERROR;
+    }
+
+    vm->retval.data.u.typed_array = view;
+    vm->retval.type = NJS_DATA_VIEW;
+    vm->retval.data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+static const njs_object_prop_t  njs_data_view_constructor_properties[] =
+{
+    /* DataView.name == "DataView". */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("DataView"),
+    },
+
+    /* DataView.length == 3. */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 1, 3.0),
+    },
+
+    /* DataView.prototype. */
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("prototype"),
+        .value = njs_prop_handler(njs_object_prototype_create),
+    },
+};
+
+
+const njs_object_init_t  njs_data_view_constructor_init = {
+    nxt_string("DataView"),
+    njs_data_view_constructor_properties,
+    nxt_nitems(njs_data_view_constructor_properties),
+};
+
+
+static u_char *
+njs_data_view_pointer(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
+    njs_data_view_type_t type)
+{
+    uint32_t           index;
+    njs_ret_t          ret;
+    njs_typed_array_t  *view;
+
+    view = args[0].data.u.typed_array;
+    index = 0;
+
+    if (nargs > 1) {
+        ret = njs_typed_array_index(vm, args[1].data.u.number, &index);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NULL;
+        }
+    }
+
+    if (nxt_slow_path((uint64_t) index + njs_data_view_sizes[type]
+                      > njs_typed_array_length(view)))
+    {
+        njs_range_error(vm, "Offset is outside the bounds of the DataView");
+        return NULL;
+    }
+
+    return njs_typed_array_start(view) + index;
+}
+
+
+/*
+ * The DataView values are stored in the big-endian byte order by default
+ * and in the little-endian order if the littleEndian argument is true.
+ */
+
+static njs_ret_t
+njs_data_view_get(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
+    njs_data_view_type_t type)
+{
+    float       f;
+    u_char      *p;
+    double      num;
+    uint32_t    u32;
+    uint64_t    u64;
+    nxt_uint_t  i, size, little;
+
+    p = njs_data_view_pointer(vm, args, nargs, type);
+    if (nxt_slow_path(p == NULL)) {
+        return NXT_ERROR;
+    }
+
+    size = njs_data_view_sizes[type];
+    little = (nargs > 2 && args[2].data.truth);
+    u64 = 0;
+
+    for (i = 0; i < size; i++) {
+        u64 = (u64 << 8) | p[little ? size - 1 - i : i];
+    }
+
+    switch (type) {
+
+    case NJS_DATA_VIEW_INT8:
+        num = (int8_t) u64;
+        break;
+
+    case NJS_DATA_VIEW_UINT8:
+    case NJS_DATA_VIEW_UINT16:
+    case NJS_DATA_VIEW_UINT32:
+        num = u64;
+        break;
+
+    case NJS_DATA_VIEW_INT16:
+        num = (int16_t) u64;
+        break;
+
+    case NJS_DATA_VIEW_INT32:
+        num = (int32_t) u64;
+        break;
+
+    case NJS_DATA_VIEW_FLOAT32:
+        u32 = (uint32_t) u64;
+        memcpy(&f, &u32, sizeof(float));
+        num = f;
+        break;
+
+    default:
+        memcpy(&num, &u64, sizeof(double));
+        break;
+    }
+
+    njs_value_number_set(&vm->retval, num);
+    njs_value_int32_hint(&vm->retval, num);
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_data_view_set(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
+    njs_data_view_type_t type)
+{
+    float       f;
+    u_char      *p;
+    double      num;
+    uint32_t    u32;
+    uint64_t    u64;
+    nxt_uint_t  i, size, little;
+
+    p = njs_data_view_pointer(vm, args, nargs, type);
+    if (nxt_slow_path(p == NULL)) {
+        return NXT_ERROR;
+    }
+
+    num = (nargs > 2) ? args[2].data.u.number : NAN;
+
+    switch (type) {
+
+    case NJS_DATA_VIEW_FLOAT32:
+        f = num;
+        memcpy(&u32, &f, sizeof(float));
+        u64 = u32;
+        break;
+
+    case NJS_DATA_VIEW_FLOAT64:
+        memcpy(&u64, &num, sizeof(double));
+        break;
+
+    default:
+        u64 = njs_number_to_integer(num);
+        break;
+    }
+
+    size = njs_data_view_sizes[type];
+    little = (nargs > 3 && args[3].data.truth);
+
+    for (i = 0; i < size; i++) {
+        p[little ? i : size - 1 - i] = (u_char) u64;
+        u64 >>= 8;
+    }
+
+    vm->retval = njs_value_void;
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_int8(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_INT8);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_uint8(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_UINT8);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_int16(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_INT16);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_uint16(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_UINT16);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_int32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_INT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_uint32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_UINT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_float32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_FLOAT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_float64(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_FLOAT64);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_int8(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_INT8);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_uint8(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_UINT8);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_int16(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_INT16);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_uint16(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_UINT16);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_int32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_INT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_uint32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_UINT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_float32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_FLOAT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_float64(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_FLOAT64);
+}
+
+
+static const njs_object_prop_t  njs_data_view_prototype_properties[] =
+{
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("buffer"),
+        .value = njs_prop_handler(njs_typed_array_prototype_buffer),
+    },
+
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("byteLength"),
+        .value = njs_prop_handler(njs_typed_array_prototype_byte_length),
+    },
+
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("byteOffset"),
+        .value = njs_prop_handler(njs_typed_array_prototype_byte_offset),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getInt8"),
+        .value = njs_native_function(njs_data_view_prototype_get_int8, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getUint8"),
+        .value = njs_native_function(njs_data_view_prototype_get_uint8, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getInt16"),
+        .value = njs_native_function(njs_data_view_prototype_get_int16, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getUint16"),
+        .value = njs_native_function(njs_data_view_prototype_get_uint16, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getInt32"),
+        .value = njs_native_function(njs_data_view_prototype_get_int32, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getUint32"),
+        .value = njs_native_function(njs_data_view_prototype_get_uint32, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getFloat32"),
+        .value = njs_native_function(njs_data_view_prototype_get_float32, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getFloat64"),
+        .value = njs_native_function(njs_data_view_prototype_get_float64, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setInt8"),
+        .value = njs_native_function(njs_data_view_prototype_set_int8, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setUint8"),
+        .value = njs_native_function(njs_data_view_prototype_set_uint8, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setInt16"),
+        .value = njs_native_function(njs_data_view_prototype_set_int16, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setUint16"),
+        .value = njs_native_function(njs_data_view_prototype_set_uint16, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setInt32"),
+        .value = njs_native_function(njs_data_view_prototype_set_int32, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setUint32"),
+        .value = njs_native_function(njs_data_view_prototype_set_uint32, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setFloat32"),
+        .value = njs_native_function(njs_data_view_prototype_set_float32, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setFloat64"),
+        .value = njs_native_function(njs_data_view_prototype_set_float64, 0,
+                     NJS_DATA_VIEW_ARG, NJS_NUMBER_ARG, NJS_NUMBER_ARG),
+    },
+};
+
+
+const njs_object_init_t  njs_data_view_prototype_init = {
+    nxt_string("DataView"),
+    njs_data_view_prototype_properties,
+    nxt_nitems(njs_data_view_prototype_properties),
+};
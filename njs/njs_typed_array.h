@@ -0,0 +1,70 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NJS_TYPED_ARRAY_H_INCLUDED_
+#define _NJS_TYPED_ARRAY_H_INCLUDED_
+
+
+/*
+ * The order of the typed array types is the order of
+ * the typed array prototypes and constructors.
+ */
+
+typedef enum {
+    NJS_TYPED_ARRAY_UINT8 = 0,
+    NJS_TYPED_ARRAY_UINT16,
+    NJS_TYPED_ARRAY_UINT32,
+    NJS_TYPED_ARRAY_FLOAT64,
+} njs_typed_array_type_t;
+
+
+#define njs_typed_array_element_size(type)                                    \
+    ((type) == NJS_TYPED_ARRAY_FLOAT64 ? 8 : 1 << (type))
+
+#define njs_typed_array_start(array)                                          \
+    (&(array)->buffer->start[(array)->offset])
+
+/* A view of a detached buffer has no elements. */
+
+#define njs_typed_array_length(array)                                         \
+    (nxt_fast_path((array)->buffer->size != 0) ? (array)->length : 0)
+
+
+void njs_typed_array_get(const njs_typed_array_t *array, uint32_t index,
+    njs_value_t *value);
+void njs_typed_array_set(njs_typed_array_t *array, uint32_t index,
+    const njs_value_t *value);
+double njs_typed_array_number(const njs_value_t *value);
+nxt_bool_t njs_typed_array_key(const njs_value_t *key, uint32_t *index);
+
+njs_ret_t njs_array_buffer_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused);
+njs_ret_t njs_data_view_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused);
+njs_ret_t njs_uint8_array_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused);
+njs_ret_t njs_uint16_array_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused);
+njs_ret_t njs_uint32_array_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused);
+njs_ret_t njs_float64_array_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused);
+
+
+extern const njs_object_init_t  njs_array_buffer_constructor_init;
+extern const njs_object_init_t  njs_array_buffer_prototype_init;
+extern const njs_object_init_t  njs_data_view_constructor_init;
+extern const njs_object_init_t  njs_data_view_prototype_init;
+extern const njs_object_init_t  njs_uint8_array_constructor_init;
+extern const njs_object_init_t  njs_uint8_array_prototype_init;
+extern const njs_object_init_t  njs_uint16_array_constructor_init;
+extern const njs_object_init_t  njs_uint16_array_prototype_init;
+extern const njs_object_init_t  njs_uint32_array_constructor_init;
+extern const njs_object_init_t  njs_uint32_array_prototype_init;
+extern const njs_object_init_t  njs_float64_array_constructor_init;
+extern const njs_object_init_t  njs_float64_array_prototype_init;
+
+
+#endif /* _NJS_TYPED_ARRAY_H_INCLUDED_ */
@@ -6,6 +6,7 @@
 
 #include <njs_core.h>
 #include <njs_regexp.h>
+#include <njs_typed_array.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -13,7 +14,7 @@
 
 struct njs_property_next_s {
     int32_t                        index;
-    nxt_lvlhsh_each_t              lhe;
+    njs_object_each_t              each;
 };
 
 
@@ -23,19 +24,44 @@ struct njs_property_next_s {
  * and should fit in CPU L1 instruction cache.
  */
 
-static njs_ret_t njs_method_private_copy(njs_vm_t *vm,
-    njs_property_query_t *pq);
-static nxt_noinline njs_ret_t njs_values_equal(const njs_value_t *val1,
-    const njs_value_t *val2);
+/*
+ * Only own properties of ordinary objects are cached: the properties
+ * stored in slots are cached by the object shape and the slot number,
+ * the properties in a private hash are cached by the object itself
+ * because their njs_object_prop_t stay in place until they are deleted.
+ * Functions are excluded since a shared function is copied on first
+ * access.
+ */
+
+#define njs_property_cacheable(value, pq, prop)                               \
+    ((prop)->type == NJS_PROPERTY && !(pq)->shared                            \
+     && njs_is_object(value) && !njs_is_array(value)                          \
+     && !njs_is_function(value)                                               \
+     && (pq)->prototype == (value)->data.u.object)
+
+
+static njs_property_cache_t *njs_property_cache(njs_vm_t *vm, uint32_t slot);
+static njs_property_cache_entry_t *njs_property_cache_find(
+    njs_property_cache_t *cache, const void *object);
+static void njs_property_cache_add(njs_property_cache_t *cache,
+    const void *object, void *value);
+static njs_object_prop_t *njs_property_cache_prop(njs_property_cache_t *cache,
+    njs_object_t *object);
+static void njs_property_cache_prop_add(njs_property_cache_t *cache,
+    njs_object_t *object, njs_object_prop_t *prop);
+static nxt_noinline njs_ret_t njs_values_equal(njs_vm_t *vm,
+    const njs_value_t *val1, const njs_value_t *val2);
 static nxt_noinline njs_ret_t njs_values_compare(const njs_value_t *val1,
     const njs_value_t *val2);
+static njs_ret_t njs_values_flat(njs_vm_t *vm, const njs_value_t *val1,
+    const njs_value_t *val2);
 static njs_ret_t njs_function_frame_create(njs_vm_t *vm, njs_value_t *value,
     const njs_value_t *this, uintptr_t nargs, nxt_bool_t ctor);
 static njs_object_t *njs_function_new_object(njs_vm_t *vm, njs_value_t *value);
 static void njs_vm_scopes_restore(njs_vm_t *vm, njs_frame_t *frame,
     njs_native_frame_t *previous);
 static njs_ret_t njs_vmcode_continuation(njs_vm_t *vm, njs_value_t *invld1,
-    njs_value_t *invld2);
+    njs_value_t *invld2, njs_value_t *unused);
 static njs_native_frame_t *
     njs_function_previous_frame(njs_native_frame_t *frame);
 static njs_ret_t njs_function_frame_free(njs_vm_t *vm,
@@ -45,20 +71,20 @@ static void njs_vm_trap(njs_vm_t *vm, nxt_uint_t trap, njs_value_t *value1,
     njs_value_t *value2);
 static njs_ret_t njs_vm_trap_argument(njs_vm_t *vm, nxt_uint_t trap);
 static njs_ret_t njs_vmcode_number_primitive(njs_vm_t *vm, njs_value_t *invld,
-    njs_value_t *narg);
+    njs_value_t *narg, njs_value_t *unused);
 static njs_ret_t njs_vmcode_string_primitive(njs_vm_t *vm, njs_value_t *invld,
-    njs_value_t *narg);
+    njs_value_t *narg, njs_value_t *unused);
 static njs_ret_t njs_vmcode_number_argument(njs_vm_t *vm, njs_value_t *invld1,
-    njs_value_t *inlvd2);
+    njs_value_t *inlvd2, njs_value_t *unused);
 static njs_ret_t njs_vmcode_string_argument(njs_vm_t *vm, njs_value_t *invld1,
-    njs_value_t *inlvd2);
+    njs_value_t *inlvd2, njs_value_t *unused);
 static njs_ret_t njs_primitive_value(njs_vm_t *vm, njs_value_t *value,
     nxt_uint_t hint);
 static njs_ret_t njs_vmcode_restart(njs_vm_t *vm, njs_value_t *invld1,
-    njs_value_t *invld2);
+    njs_value_t *invld2, njs_value_t *unused);
 static njs_ret_t njs_object_value_to_string(njs_vm_t *vm, njs_value_t *value);
 static njs_ret_t njs_vmcode_value_to_string(njs_vm_t *vm, njs_value_t *invld1,
-    njs_value_t *invld2);
+    njs_value_t *invld2, njs_value_t *unused);
 
 static njs_ret_t njs_vm_add_backtrace_entry(njs_vm_t *vm, njs_frame_t *frame);
 
@@ -100,6 +126,39 @@ const njs_value_t  njs_string_memory_error = njs_string("MemoryError");
  * values is passed as arguments although they are not always used.
  */
 
+#if (NXT_HAVE_COMPUTED_GOTO)
+
+/*
+ * The threaded code interpreter jumps directly to a handler of the next
+ * operation by its opcode.  The most frequent operations are handled in
+ * place with their own operands decoding, the handlers write a result
+ * directly to a destination operand and fall back to the generic handler
+ * if operands are not numbers.
+ */
+
+#define njs_vmcode_dispatch()                                                 \
+    vmcode = (njs_vmcode_generic_t *) vm->current;                            \
+    goto *labels[vmcode->code.opcode]
+
+
+#define njs_vmcode_operands()                                                 \
+    value1 = njs_vmcode_operand(vm, vmcode->operand2);                        \
+    value2 = njs_vmcode_operand(vm, vmcode->operand3)
+
+
+/* An integer result which does not fit in int32 becomes a double. */
+
+#define njs_vmcode_integer_set(value, inum)                                   \
+    if (nxt_fast_path((inum) == (int32_t) (inum))) {                          \
+        njs_value_int32_set(value, (int32_t) (inum));                         \
+                                                                              \
+    } else {                                                                  \
+        njs_value_number_set(value, (inum));                                  \
+    }
+
+#endif
+
+
 nxt_noinline nxt_int_t
 njs_vmcode_interpreter(njs_vm_t *vm)
 {
@@ -109,9 +168,523 @@ njs_vmcode_interpreter(njs_vm_t *vm)
     njs_frame_t           *frame;
     njs_native_frame_t    *previous;
     njs_vmcode_generic_t  *vmcode;
+#if (NXT_HAVE_COMPUTED_GOTO)
+    double                  num, delta;
+    int64_t                 inum;
+    nxt_bool_t              truth;
+    njs_vmcode_cond_jump_t  *cond_jump;
+
+    static const void * const  labels[] = {
+        &&generic,              /* NJS_VMCODE_GENERIC */
+        &&move,                 /* NJS_VMCODE_MOVE */
+        &&jump,                 /* NJS_VMCODE_JUMP */
+        &&if_true_jump,         /* NJS_VMCODE_IF_TRUE_JUMP */
+        &&if_false_jump,        /* NJS_VMCODE_IF_FALSE_JUMP */
+        &&addition,             /* NJS_VMCODE_ADDITION */
+        &&substraction,         /* NJS_VMCODE_SUBSTRACTION */
+        &&multiplication,       /* NJS_VMCODE_MULTIPLICATION */
+        &&less,                 /* NJS_VMCODE_LESS */
+        &&less_or_equal,        /* NJS_VMCODE_LESS_OR_EQUAL */
+        &&greater,              /* NJS_VMCODE_GREATER */
+        &&greater_or_equal,     /* NJS_VMCODE_GREATER_OR_EQUAL */
+        &&equal,                /* NJS_VMCODE_EQUAL */
+        &&not_equal,            /* NJS_VMCODE_NOT_EQUAL */
+        &&strict_equal,         /* NJS_VMCODE_STRICT_EQUAL */
+        &&strict_not_equal,     /* NJS_VMCODE_STRICT_NOT_EQUAL */
+        &&increment,            /* NJS_VMCODE_INCREMENT */
+        &&decrement,            /* NJS_VMCODE_DECREMENT */
+        &&post_increment,       /* NJS_VMCODE_POST_INCREMENT */
+        &&post_decrement,       /* NJS_VMCODE_POST_DECREMENT */
+        &&less_jump,            /* NJS_VMCODE_LESS_JUMP */
+        &&less_or_equal_jump,   /* NJS_VMCODE_LESS_OR_EQUAL_JUMP */
+        &&greater_jump,         /* NJS_VMCODE_GREATER_JUMP */
+        &&greater_or_equal_jump,
+                                /* NJS_VMCODE_GREATER_OR_EQUAL_JUMP */
+        &&equal_jump,           /* NJS_VMCODE_EQUAL_JUMP */
+        &&not_equal_jump,       /* NJS_VMCODE_NOT_EQUAL_JUMP */
+        &&strict_equal_jump,    /* NJS_VMCODE_STRICT_EQUAL_JUMP */
+        &&strict_not_equal_jump,
+                                /* NJS_VMCODE_STRICT_NOT_EQUAL_JUMP */
+    };
+#endif
+
+    vm->gc_depth++;
 
 start:
 
+#if (NXT_HAVE_COMPUTED_GOTO)
+
+    njs_vmcode_dispatch();
+
+generic:
+
+    value2 = (njs_value_t *) vmcode->operand1;
+    value1 = NULL;
+
+    switch (vmcode->code.operands) {
+
+    case NJS_VMCODE_3OPERANDS:
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        /* Fall through. */
+
+    case NJS_VMCODE_2OPERANDS:
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+    }
+
+operation:
+
+    retval = njs_vmcode_retval(vm, vmcode);
+
+    ret = vmcode->code.operation(vm, value1, value2, retval);
+
+    if (nxt_slow_path(ret < 0 && ret >= NJS_PREEMPT)) {
+        goto done;
+    }
+
+    vm->current += ret;
+
+    njs_vmcode_dispatch();
+
+move:
+
+    value1 = njs_vmcode_operand(vm, vmcode->operand2);
+    retval = njs_vmcode_operand(vm, vmcode->operand1);
+
+    *retval = *value1;
+    njs_retain(value1);
+
+    vm->current += sizeof(njs_vmcode_move_t);
+
+    njs_vmcode_dispatch();
+
+jump:
+
+    ret = ((njs_vmcode_jump_t *) vmcode)->offset;
+
+    goto branch;
+
+if_true_jump:
+
+    value1 = njs_vmcode_operand(vm, vmcode->operand2);
+
+    if (njs_is_true(value1)) {
+        ret = ((njs_vmcode_cond_jump_t *) vmcode)->offset;
+        goto branch;
+    }
+
+    vm->current += sizeof(njs_vmcode_cond_jump_t);
+
+    njs_vmcode_dispatch();
+
+if_false_jump:
+
+    value1 = njs_vmcode_operand(vm, vmcode->operand2);
+
+    if (!njs_is_true(value1)) {
+        ret = ((njs_vmcode_cond_jump_t *) vmcode)->offset;
+        goto branch;
+    }
+
+    vm->current += sizeof(njs_vmcode_cond_jump_t);
+
+    njs_vmcode_dispatch();
+
+branch:
+
+    vm->current += ret;
+
+    if (ret < 0) {
+        njs_gc_safe_point(vm);
+    }
+
+    njs_vmcode_dispatch();
+
+addition:
+
+    njs_vmcode_operands();
+
+    if (njs_is_int32(value1) && njs_is_int32(value2)) {
+        inum = (int64_t) value1->data.integer + value2->data.integer;
+        goto integer;
+    }
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        num = value1->data.u.number + value2->data.u.number;
+        goto number;
+    }
+
+    goto operation;
+
+substraction:
+
+    njs_vmcode_operands();
+
+    if (njs_is_int32(value1) && njs_is_int32(value2)) {
+        inum = (int64_t) value1->data.integer - value2->data.integer;
+        goto integer;
+    }
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        num = value1->data.u.number - value2->data.u.number;
+        goto number;
+    }
+
+    goto operation;
+
+multiplication:
+
+    njs_vmcode_operands();
+
+    if (njs_is_int32(value1) && njs_is_int32(value2)) {
+        inum = (int64_t) value1->data.integer * value2->data.integer;
+
+        /* A zero product may be -0 which is not an integer. */
+
+        if (inum != 0) {
+            goto integer;
+        }
+    }
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        num = value1->data.u.number * value2->data.u.number;
+        goto number;
+    }
+
+    goto operation;
+
+number:
+
+    retval = njs_vmcode_operand(vm, vmcode->operand1);
+    njs_value_number_set(retval, num);
+
+    vm->current += sizeof(njs_vmcode_3addr_t);
+
+    njs_vmcode_dispatch();
+
+integer:
+
+    retval = njs_vmcode_operand(vm, vmcode->operand1);
+    njs_vmcode_integer_set(retval, inum);
+
+    vm->current += sizeof(njs_vmcode_3addr_t);
+
+    njs_vmcode_dispatch();
+
+less:
+
+    njs_vmcode_operands();
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        truth = (value1->data.u.number < value2->data.u.number);
+        goto boolean;
+    }
+
+    goto operation;
+
+less_or_equal:
+
+    njs_vmcode_operands();
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        truth = (value1->data.u.number <= value2->data.u.number);
+        goto boolean;
+    }
+
+    goto operation;
+
+greater:
+
+    njs_vmcode_operands();
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        truth = (value1->data.u.number > value2->data.u.number);
+        goto boolean;
+    }
+
+    goto operation;
+
+greater_or_equal:
+
+    njs_vmcode_operands();
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        truth = (value1->data.u.number >= value2->data.u.number);
+        goto boolean;
+    }
+
+    goto operation;
+
+equal:
+
+    njs_vmcode_operands();
+
+    ret = njs_values_equal(vm, value1, value2);
+
+    if (nxt_fast_path(ret >= 0)) {
+        truth = ret;
+        goto boolean;
+    }
+
+    goto operation;
+
+not_equal:
+
+    njs_vmcode_operands();
+
+    ret = njs_values_equal(vm, value1, value2);
+
+    if (nxt_fast_path(ret >= 0)) {
+        truth = !ret;
+        goto boolean;
+    }
+
+    goto operation;
+
+strict_equal:
+
+    njs_vmcode_operands();
+
+    ret = njs_values_strict_equal(vm, value1, value2);
+
+    if (nxt_fast_path(ret >= 0)) {
+        truth = ret;
+        goto boolean;
+    }
+
+    goto operation;
+
+strict_not_equal:
+
+    njs_vmcode_operands();
+
+    ret = njs_values_strict_equal(vm, value1, value2);
+
+    if (nxt_fast_path(ret >= 0)) {
+        truth = !ret;
+        goto boolean;
+    }
+
+    goto operation;
+
+boolean:
+
+    retval = njs_vmcode_operand(vm, vmcode->operand1);
+    *retval = truth ? njs_value_true : njs_value_false;
+
+    vm->current += sizeof(njs_vmcode_3addr_t);
+
+    njs_vmcode_dispatch();
+
+less_jump:
+
+    njs_vmcode_operands();
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        truth = (value1->data.u.number < value2->data.u.number);
+        goto boolean_jump;
+    }
+
+    goto operation;
+
+less_or_equal_jump:
+
+    njs_vmcode_operands();
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        truth = (value1->data.u.number <= value2->data.u.number);
+        goto boolean_jump;
+    }
+
+    goto operation;
+
+greater_jump:
+
+    njs_vmcode_operands();
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        truth = (value1->data.u.number > value2->data.u.number);
+        goto boolean_jump;
+    }
+
+    goto operation;
+
+greater_or_equal_jump:
+
+    njs_vmcode_operands();
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        truth = (value1->data.u.number >= value2->data.u.number);
+        goto boolean_jump;
+    }
+
+    goto operation;
+
+equal_jump:
+
+    njs_vmcode_operands();
+
+    ret = njs_values_equal(vm, value1, value2);
+
+    if (nxt_fast_path(ret >= 0)) {
+        truth = ret;
+        goto boolean_jump;
+    }
+
+    goto operation;
+
+not_equal_jump:
+
+    njs_vmcode_operands();
+
+    ret = njs_values_equal(vm, value1, value2);
+
+    if (nxt_fast_path(ret >= 0)) {
+        truth = !ret;
+        goto boolean_jump;
+    }
+
+    goto operation;
+
+strict_equal_jump:
+
+    njs_vmcode_operands();
+
+    ret = njs_values_strict_equal(vm, value1, value2);
+
+    if (nxt_fast_path(ret >= 0)) {
+        truth = ret;
+        goto boolean_jump;
+    }
+
+    goto operation;
+
+strict_not_equal_jump:
+
+    njs_vmcode_operands();
+
+    ret = njs_values_strict_equal(vm, value1, value2);
+
+    if (nxt_fast_path(ret >= 0)) {
+        truth = !ret;
+        goto boolean_jump;
+    }
+
+    goto operation;
+
+boolean_jump:
+
+    retval = njs_vmcode_operand(vm, vmcode->operand1);
+    *retval = truth ? njs_value_true : njs_value_false;
+
+    /* The next operation is a conditional jump on the result. */
+
+    cond_jump = (njs_vmcode_cond_jump_t *)
+                    (vm->current + sizeof(njs_vmcode_3addr_t));
+
+    if (truth == (cond_jump->code.operation == njs_vmcode_if_true_jump)) {
+        vm->current = (u_char *) cond_jump;
+        ret = cond_jump->offset;
+
+        goto branch;
+    }
+
+    vm->current += sizeof(njs_vmcode_3addr_t) + sizeof(njs_vmcode_cond_jump_t);
+
+    njs_vmcode_dispatch();
+
+increment:
+
+    delta = 1.0;
+
+    goto incdec;
+
+decrement:
+
+    delta = -1.0;
+
+incdec:
+
+    njs_vmcode_operands();
+
+    if (njs_is_int32(value2)) {
+        inum = value2->data.integer + (int64_t) delta;
+
+        njs_release(vm, value1);
+        njs_vmcode_integer_set(value1, inum);
+
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        *retval = *value1;
+
+        vm->current += sizeof(njs_vmcode_3addr_t);
+
+        njs_vmcode_dispatch();
+    }
+
+    if (nxt_fast_path(njs_is_numeric(value2))) {
+        num = value2->data.u.number + delta;
+
+        njs_release(vm, value1);
+        njs_value_number_set(value1, num);
+
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        *retval = *value1;
+
+        vm->current += sizeof(njs_vmcode_3addr_t);
+
+        njs_vmcode_dispatch();
+    }
+
+    goto operation;
+
+post_increment:
+
+    delta = 1.0;
+
+    goto post_incdec;
+
+post_decrement:
+
+    delta = -1.0;
+
+post_incdec:
+
+    njs_vmcode_operands();
+
+    if (njs_is_int32(value2)) {
+        inum = value2->data.integer;
+
+        njs_release(vm, value1);
+        njs_vmcode_integer_set(value1, inum + (int64_t) delta);
+
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        njs_value_int32_set(retval, (int32_t) inum);
+
+        vm->current += sizeof(njs_vmcode_3addr_t);
+
+        njs_vmcode_dispatch();
+    }
+
+    if (nxt_fast_path(njs_is_numeric(value2))) {
+        num = value2->data.u.number;
+
+        njs_release(vm, value1);
+        njs_value_number_set(value1, num + delta);
+
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        njs_value_number_set(retval, num);
+
+        vm->current += sizeof(njs_vmcode_3addr_t);
+
+        njs_vmcode_dispatch();
+    }
+
+    goto operation;
+
+done:
+
+#else
+
     for ( ;; ) {
 
         vmcode = (njs_vmcode_generic_t *) vm->current;
@@ -146,7 +719,9 @@ start:
             value1 = njs_vmcode_operand(vm, vmcode->operand2);
         }
 
-        ret = vmcode->code.operation(vm, value1, value2);
+        retval = njs_vmcode_retval(vm, vmcode);
+
+        ret = vmcode->code.operation(vm, value1, value2, retval);
 
         /*
          * On success an operation returns size of the bytecode,
@@ -161,14 +736,10 @@ start:
         }
 
         vm->current += ret;
-
-        if (vmcode->code.retval) {
-            retval = njs_vmcode_operand(vm, vmcode->operand1);
-            //njs_release(vm, retval);
-            *retval = vm->retval;
-        }
     }
 
+#endif
+
     switch (ret) {
 
     case NJS_TRAP_NUMBER:
@@ -208,7 +779,7 @@ start:
             if (catch != NULL) {
                 vm->current = catch;
 
-                if (vm->debug != NULL) {
+                if (vm->backtrace != NULL) {
                     nxt_array_reset(vm->backtrace);
                 }
 
@@ -218,11 +789,13 @@ start:
             if (vm->debug != NULL
                 && njs_vm_add_backtrace_entry(vm, frame) != NXT_OK)
             {
+                vm->gc_depth--;
                 return NXT_ERROR;
             }
 
             previous = frame->native.previous;
             if (previous == NULL) {
+                vm->gc_depth--;
                 return NXT_ERROR;
             }
 
@@ -237,10 +810,236 @@ start:
 
     /* NXT_AGAIN, NJS_STOP. */
 
+    vm->gc_depth--;
+
     return ret;
 }
 
 
+#if (NXT_HAVE_COMPUTED_GOTO)
+
+typedef struct {
+    njs_vmcode_operation_t     operation;
+    size_t                     size;
+    uint8_t                    opcode;
+    uint8_t                    operands;
+    uint8_t                    retval;
+    /* The superinstruction opcode if a conditional jump follows. */
+    uint8_t                    jump;
+} njs_vmcode_info_t;
+
+
+static const njs_vmcode_info_t  njs_vmcode_info[] = {
+
+    { njs_vmcode_move, sizeof(njs_vmcode_move_t),
+      NJS_VMCODE_MOVE, NJS_VMCODE_2OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_GENERIC },
+    { njs_vmcode_jump, sizeof(njs_vmcode_jump_t),
+      NJS_VMCODE_JUMP, NJS_VMCODE_NO_OPERAND, NJS_VMCODE_NO_RETVAL,
+      NJS_VMCODE_GENERIC },
+    { njs_vmcode_if_true_jump, sizeof(njs_vmcode_cond_jump_t),
+      NJS_VMCODE_IF_TRUE_JUMP, NJS_VMCODE_2OPERANDS, NJS_VMCODE_NO_RETVAL,
+      NJS_VMCODE_GENERIC },
+    { njs_vmcode_if_false_jump, sizeof(njs_vmcode_cond_jump_t),
+      NJS_VMCODE_IF_FALSE_JUMP, NJS_VMCODE_2OPERANDS, NJS_VMCODE_NO_RETVAL,
+      NJS_VMCODE_GENERIC },
+    { njs_vmcode_addition, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_ADDITION, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_GENERIC },
+    { njs_vmcode_substraction, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_SUBSTRACTION, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_GENERIC },
+    { njs_vmcode_multiplication, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_MULTIPLICATION, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_GENERIC },
+    { njs_vmcode_less, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_LESS, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_LESS_JUMP },
+    { njs_vmcode_less_or_equal, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_LESS_OR_EQUAL, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_LESS_OR_EQUAL_JUMP },
+    { njs_vmcode_greater, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GREATER, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_GREATER_JUMP },
+    { njs_vmcode_greater_or_equal, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GREATER_OR_EQUAL, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_GREATER_OR_EQUAL_JUMP },
+    { njs_vmcode_equal, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_EQUAL, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_EQUAL_JUMP },
+    { njs_vmcode_not_equal, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_NOT_EQUAL, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_NOT_EQUAL_JUMP },
+    { njs_vmcode_strict_equal, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_STRICT_EQUAL, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_STRICT_EQUAL_JUMP },
+    { njs_vmcode_strict_not_equal, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_STRICT_NOT_EQUAL, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_STRICT_NOT_EQUAL_JUMP },
+    { njs_vmcode_increment, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_INCREMENT, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_GENERIC },
+    { njs_vmcode_decrement, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_DECREMENT, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_GENERIC },
+    { njs_vmcode_post_increment, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_POST_INCREMENT, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_GENERIC },
+    { njs_vmcode_post_decrement, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_POST_DECREMENT, NJS_VMCODE_3OPERANDS, NJS_VMCODE_RETVAL,
+      NJS_VMCODE_GENERIC },
+
+    { njs_vmcode_object, sizeof(njs_vmcode_object_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_array, sizeof(njs_vmcode_array_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_function, sizeof(njs_vmcode_function_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_regexp, sizeof(njs_vmcode_regexp_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_object_copy, sizeof(njs_vmcode_object_copy_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_property_get, sizeof(njs_vmcode_prop_get_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_property_set, sizeof(njs_vmcode_prop_set_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_property_in, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_property_delete, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_property_foreach, sizeof(njs_vmcode_prop_foreach_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_property_next, sizeof(njs_vmcode_prop_next_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_instance_of, sizeof(njs_vmcode_instance_of_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_typeof, sizeof(njs_vmcode_2addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_void, sizeof(njs_vmcode_2addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_delete, sizeof(njs_vmcode_2addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_unary_plus, sizeof(njs_vmcode_2addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_unary_negation, sizeof(njs_vmcode_2addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_exponentiation, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_division, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_remainder, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_logical_not, sizeof(njs_vmcode_2addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_test_if_true, sizeof(njs_vmcode_test_jump_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_test_if_false, sizeof(njs_vmcode_test_jump_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_bitwise_not, sizeof(njs_vmcode_2addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_bitwise_and, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_bitwise_xor, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_bitwise_or, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_left_shift, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_right_shift, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_unsigned_right_shift, sizeof(njs_vmcode_3addr_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_if_equal_jump, sizeof(njs_vmcode_equal_jump_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_function_frame, sizeof(njs_vmcode_function_frame_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_method_frame, sizeof(njs_vmcode_method_frame_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_function_call, sizeof(njs_vmcode_function_call_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_return, sizeof(njs_vmcode_return_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_stop, sizeof(njs_vmcode_stop_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_try_start, sizeof(njs_vmcode_try_start_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_try_end, sizeof(njs_vmcode_try_end_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_throw, sizeof(njs_vmcode_throw_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_catch, sizeof(njs_vmcode_catch_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+    { njs_vmcode_finally, sizeof(njs_vmcode_finally_t),
+      NJS_VMCODE_GENERIC, 0, 0, 0 },
+};
+
+
+/*
+ * njs_vmcode_opcodes() sets opcodes of a generated bytecode.  An operation
+ * is handled in place by the threaded code interpreter only if it has
+ * the operands and retval layout expected by the handler.  A comparison
+ * followed by a conditional jump on its result is fused into
+ * a superinstruction.
+ */
+
+nxt_int_t
+njs_vmcode_opcodes(njs_vm_t *vm, u_char *start, u_char *end)
+{
+    u_char                   *p;
+    nxt_uint_t               n;
+    njs_vmcode_t             *code;
+    njs_vmcode_3addr_t       *test;
+    njs_vmcode_cond_jump_t   *cond_jump;
+    const njs_vmcode_info_t  *info;
+
+    p = start;
+
+    while (p < end) {
+        code = (njs_vmcode_t *) p;
+
+        info = njs_vmcode_info;
+        n = nxt_nitems(njs_vmcode_info);
+
+        while (info->operation != code->operation) {
+            info++;
+            n--;
+
+            if (nxt_slow_path(n == 0)) {
+                njs_internal_error(vm, NULL);
+                return NXT_ERROR;
+            }
+        }
+
+        code->opcode = NJS_VMCODE_GENERIC;
+
+        if (info->opcode != NJS_VMCODE_GENERIC
+            && info->operands == code->operands
+            && info->retval == code->retval)
+        {
+            code->opcode = info->opcode;
+
+            cond_jump = (njs_vmcode_cond_jump_t *) (p + info->size);
+            test = (njs_vmcode_3addr_t *) p;
+
+            if (info->jump != NJS_VMCODE_GENERIC
+                && (u_char *) cond_jump < end
+                && (cond_jump->code.operation == njs_vmcode_if_true_jump
+                    || cond_jump->code.operation == njs_vmcode_if_false_jump)
+                && cond_jump->cond == test->dst)
+            {
+                code->opcode = info->jump;
+            }
+        }
+
+        p += info->size;
+    }
+
+    return NXT_OK;
+}
+
+#endif
+
+
 nxt_noinline void
 njs_value_retain(njs_value_t *value)
 {
@@ -297,16 +1096,17 @@ njs_value_release(njs_vm_t *vm, njs_value_t *value)
 
 
 njs_ret_t
-njs_vmcode_object(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
+njs_vmcode_object(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2,
+    njs_value_t *dst)
 {
     njs_object_t  *object;
 
     object = njs_object_alloc(vm);
 
     if (nxt_fast_path(object != NULL)) {
-        vm->retval.data.u.object = object;
-        vm->retval.type = NJS_OBJECT;
-        vm->retval.data.truth = 1;
+        dst->data.u.object = object;
+        dst->type = NJS_OBJECT;
+        dst->data.truth = 1;
 
         return sizeof(njs_vmcode_object_t);
     }
@@ -316,11 +1116,12 @@ njs_vmcode_object(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
 
 
 njs_ret_t
-njs_vmcode_array(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
+njs_vmcode_array(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2,
+    njs_value_t *dst)
 {
     uint32_t            length;
     njs_array_t         *array;
-    njs_value_t         *value;
+    njs_array_item_t    *item;
     njs_vmcode_array_t  *code;
 
     code = (njs_vmcode_array_t *) vm->current;
@@ -331,12 +1132,13 @@ njs_vmcode_array(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
 
         if (code->code.ctor) {
             /* Array of the form [,,,], [1,,]. */
-            value = array->start;
+            array->kind = NJS_ARRAY_HOLEY;
+            item = array->start;
             length = array->length;
 
             do {
-                njs_set_invalid(value);
-                value++;
+                njs_array_item_set_invalid(item);
+                item++;
                 length--;
             } while (length != 0);
 
@@ -345,9 +1147,9 @@ njs_vmcode_array(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
             array->length = 0;
         }
 
-        vm->retval.data.u.array = array;
-        vm->retval.type = NJS_ARRAY;
-        vm->retval.data.truth = 1;
+        dst->data.u.array = array;
+        dst->type = NJS_ARRAY;
+        dst->data.truth = 1;
 
         return sizeof(njs_vmcode_array_t);
     }
@@ -357,7 +1159,8 @@ njs_vmcode_array(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
 
 
 njs_ret_t
-njs_vmcode_function(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
+njs_vmcode_function(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2,
+    njs_value_t *dst)
 {
     size_t                 size;
     nxt_uint_t             n, nesting;
@@ -394,16 +1197,17 @@ njs_vmcode_function(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
         } while (n < nesting);
     }
 
-    vm->retval.data.u.function = function;
-    vm->retval.type = NJS_FUNCTION;
-    vm->retval.data.truth = 1;
+    dst->data.u.function = function;
+    dst->type = NJS_FUNCTION;
+    dst->data.truth = 1;
 
     return sizeof(njs_vmcode_function_t);
 }
 
 
 njs_ret_t
-njs_vmcode_regexp(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
+njs_vmcode_regexp(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2,
+    njs_value_t *dst)
 {
     njs_regexp_t         *regexp;
     njs_vmcode_regexp_t  *code;
@@ -413,9 +1217,9 @@ njs_vmcode_regexp(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
     regexp = njs_regexp_alloc(vm, code->pattern);
 
     if (nxt_fast_path(regexp != NULL)) {
-        vm->retval.data.u.regexp = regexp;
-        vm->retval.type = NJS_REGEXP;
-        vm->retval.data.truth = 1;
+        dst->data.u.regexp = regexp;
+        dst->type = NJS_REGEXP;
+        dst->data.truth = 1;
 
         return sizeof(njs_vmcode_regexp_t);
     }
@@ -425,7 +1229,8 @@ njs_vmcode_regexp(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
 
 
 njs_ret_t
-njs_vmcode_object_copy(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
+njs_vmcode_object_copy(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld,
+    njs_value_t *dst)
 {
     njs_object_t    *object;
     njs_function_t  *function;
@@ -452,7 +1257,7 @@ njs_vmcode_object_copy(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
         break;
     }
 
-    vm->retval = *value;
+    *dst = *value;
 
     njs_retain(value);
 
@@ -462,19 +1267,89 @@ njs_vmcode_object_copy(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
 
 njs_ret_t
 njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *property)
+    njs_value_t *property, njs_value_t *dst)
 {
-    void                  *obj;
-    int32_t               index;
-    uintptr_t             data;
-    njs_ret_t             ret;
-    njs_value_t           *val, ext_val;
-    njs_slice_prop_t      slice;
-    njs_string_prop_t     string;
-    njs_object_prop_t     *prop;
-    const njs_value_t     *retval;
-    const njs_extern_t    *ext_proto;
-    njs_property_query_t  pq;
+    void                        *obj;
+    int32_t                     index;
+    uintptr_t                   data;
+    njs_ret_t                   ret;
+    njs_value_t                 value, ext_val;
+    njs_slice_prop_t            slice;
+    njs_string_prop_t           string;
+    njs_array_t                 *array;
+    njs_array_item_t            *item;
+    njs_object_prop_t           *prop;
+    njs_typed_array_t           *typed_array;
+    const njs_value_t           *retval;
+    const njs_extern_t          *ext_proto;
+    njs_property_cache_t        *cache;
+    njs_property_query_t        pq;
+    njs_vmcode_prop_get_t       *code;
+    njs_property_cache_entry_t  *entry;
+
+    if (njs_is_array(object) && njs_is_int32(property)) {
+
+        /* array[i]. */
+
+        array = object->data.u.array;
+
+        if ((uint32_t) property->data.integer < array->length) {
+            item = &array->start[property->data.integer];
+            retval = &njs_value_void;
+
+            if (njs_array_item_is_valid(item)) {
+                retval = njs_array_item_value(item, &value);
+            }
+
+            *dst = *retval;
+
+            return sizeof(njs_vmcode_prop_get_t);
+        }
+    }
+
+    if (njs_is_typed_array(object) && njs_is_int32(property)) {
+
+        /* typed_array[i]. */
+
+        typed_array = object->data.u.typed_array;
+
+        if ((uint32_t) property->data.integer
+            < njs_typed_array_length(typed_array))
+        {
+            njs_typed_array_get(typed_array, property->data.integer, dst);
+
+            return sizeof(njs_vmcode_prop_get_t);
+        }
+    }
+
+    code = (njs_vmcode_prop_get_t *) vm->current;
+    cache = NULL;
+
+    if (code->code.cache != 0) {
+        cache = njs_property_cache(vm, code->code.cache);
+
+        if (nxt_fast_path(cache != NULL)) {
+
+            if (njs_is_external(object)) {
+                entry = njs_property_cache_find(cache, object->external.proto);
+
+                if (entry != NULL) {
+                    njs_string_get(property, &pq.lhq.key);
+                    ext_proto = entry->value;
+                    goto external;
+                }
+
+            } else if (njs_is_object(object)) {
+                prop = njs_property_cache_prop(cache, object->data.u.object);
+
+                if (prop != NULL && prop->type == NJS_PROPERTY) {
+                    *dst = prop->value;
+
+                    return sizeof(njs_vmcode_prop_get_t);
+                }
+            }
+        }
+    }
 
     pq.query = NJS_PROPERTY_QUERY_GET;
 
@@ -487,17 +1362,21 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
     case NXT_OK:
         prop = pq.lhq.value;
 
+        if (cache != NULL && njs_property_cacheable(object, &pq, prop)) {
+            njs_property_cache_prop_add(cache, pq.prototype, prop);
+        }
+
         switch (prop->type) {
 
         case NJS_METHOD:
             if (pq.shared) {
-                ret = njs_method_private_copy(vm, &pq);
+                /* A shared method is copied only if it is modified. */
 
-                if (nxt_slow_path(ret != NXT_OK)) {
-                    return ret;
-                }
-
-                prop = pq.lhq.value;
+                value = prop->value;
+                value.data.u.function = njs_function_overlay(vm,
+                                               value.data.u.function, 0);
+                retval = &value;
+                break;
             }
 
             /* Fall through. */
@@ -525,40 +1404,54 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
         index = (int32_t) njs_value_to_index(property);
 
         if (nxt_fast_path(index >= 0)) {
+            ret = njs_string_flat(vm, object);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+
             slice.start = index;
             slice.length = 1;
             slice.string_length = njs_string_prop(&string, object);
 
             if (slice.start < slice.string_length) {
                 /*
-                 * A single codepoint string fits in vm->retval
+                 * A single codepoint string fits in the value
                  * so the function cannot fail.
                  */
-                (void) njs_string_slice(vm, &vm->retval, &string, &slice);
+                (void) njs_string_slice(vm, &value, object, &string,
+                                        &slice);
 
-                return sizeof(njs_vmcode_prop_get_t);
+                retval = &value;
             }
         }
 
         break;
 
     case NJS_ARRAY_VALUE:
-        val = pq.lhq.value;
-
-        if (njs_is_valid(val)) {
-            retval = val;
+        if (njs_array_item_is_valid((njs_array_item_t *) pq.lhq.value)) {
+            retval = njs_array_item_value((njs_array_item_t *) pq.lhq.value,
+                                          &value);
         }
 
         break;
 
     case NJS_EXTERNAL_VALUE:
-        ext_proto = object->external.proto;
+        ext_proto = NULL;
 
-        ret = nxt_lvlhsh_find(&ext_proto->hash, &pq.lhq);
+        ret = nxt_lvlhsh_find(&object->external.proto->hash, &pq.lhq);
 
         if (ret == NXT_OK) {
             ext_proto = pq.lhq.value;
+        }
+
+        if (cache != NULL) {
+            njs_property_cache_add(cache, object->external.proto,
+                                   (void *) ext_proto);
+        }
+
+    external:
 
+        if (ext_proto != NULL) {
             ext_val.type = NJS_EXTERNAL;
             ext_val.data.truth = 1;
             ext_val.external.proto = ext_proto;
@@ -572,23 +1465,28 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
             data = ext_proto->data;
 
         } else {
+            ext_proto = object->external.proto;
             data = (uintptr_t) &pq.lhq.key;
         }
 
-        vm->retval = njs_value_void;
+        retval = &njs_value_void;
 
         if (ext_proto->get != NULL) {
             obj = njs_extern_object(vm, object);
 
-            ret = ext_proto->get(vm, &vm->retval, obj, data);
+            value = njs_value_void;
+
+            ret = ext_proto->get(vm, &value, obj, data);
             if (nxt_slow_path(ret != NXT_OK)) {
                 return ret;
             }
 
-            /* The vm->retval is already retained by ext_proto->get(). */
+            /* The value is already retained by ext_proto->get(). */
+
+            retval = &value;
         }
 
-        return sizeof(njs_vmcode_prop_get_t);
+        break;
 
     case NJS_TRAP_PROPERTY:
     case NXT_ERROR:
@@ -597,7 +1495,7 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
         return ret;
     }
 
-    vm->retval = *retval;
+    *dst = *retval;
 
     /* GC: njs_retain(retval) */
 
@@ -607,17 +1505,21 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
 
 njs_ret_t
 njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *property)
+    njs_value_t *property, njs_value_t *unused)
 {
-    void                   *obj;
-    uintptr_t              data;
-    nxt_str_t              s;
-    njs_ret_t              ret;
-    njs_value_t            *p, *value;
-    njs_object_prop_t      *prop;
-    const njs_extern_t     *ext_proto;
-    njs_property_query_t   pq;
-    njs_vmcode_prop_set_t  *code;
+    void                        *obj;
+    uint32_t                    index;
+    uintptr_t                   data;
+    nxt_str_t                   s;
+    njs_ret_t                   ret;
+    njs_value_t                 *value;
+    njs_array_t                 *array;
+    njs_object_prop_t           *prop;
+    njs_typed_array_t           *typed_array;
+    const njs_extern_t          *ext_proto;
+    njs_property_cache_t        *cache;
+    njs_property_query_t        pq;
+    njs_vmcode_prop_set_t       *code;
 
     if (njs_is_primitive(object)) {
         njs_type_error(vm, "property set on primitive %s type",
@@ -628,6 +1530,65 @@ njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
     code = (njs_vmcode_prop_set_t *) vm->current;
     value = njs_vmcode_operand(vm, code->value);
 
+    if (njs_is_array(object) && njs_is_int32(property)) {
+
+        /* array[i] = value. */
+
+        array = object->data.u.array;
+        index = property->data.integer;
+
+        /* An append is also done in place if the array has spare space. */
+
+        if (!array->object.immutable
+            && (index < array->length
+                || (index == array->length
+                    && &array->start[index] < &array->data[array->size])))
+        {
+            ret = njs_array_value_set(vm, array, &array->start[index], value);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+
+            if (index == array->length) {
+                array->length++;
+            }
+
+            return sizeof(njs_vmcode_prop_set_t);
+        }
+    }
+
+    if (njs_is_typed_array(object) && njs_is_int32(property)) {
+
+        /* typed_array[i] = value. */
+
+        typed_array = object->data.u.typed_array;
+
+        if ((uint32_t) property->data.integer
+            < njs_typed_array_length(typed_array))
+        {
+            njs_typed_array_set(typed_array, property->data.integer, value);
+
+            return sizeof(njs_vmcode_prop_set_t);
+        }
+    }
+
+    cache = NULL;
+
+    if (code->code.cache != 0 && !njs_is_external(object)) {
+        cache = njs_property_cache(vm, code->code.cache);
+
+        if (nxt_fast_path(cache != NULL)) {
+            prop = njs_property_cache_prop(cache, object->data.u.object);
+
+            if (prop != NULL
+                && prop->type == NJS_PROPERTY
+                && !object->data.u.object->immutable)
+            {
+                goto found;
+            }
+        }
+    }
+
     pq.query = NJS_PROPERTY_QUERY_SET;
 
     ret = njs_property_query(vm, &pq, object, property);
@@ -637,6 +1598,10 @@ njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
     case NXT_OK:
         prop = pq.lhq.value;
 
+        if (cache != NULL && njs_property_cacheable(object, &pq, prop)) {
+            njs_property_cache_prop_add(cache, pq.prototype, prop);
+        }
+
         if (prop->type == NJS_PROPERTY_HANDLER) {
             ret = prop->value.data.u.prop_handler(vm, object, value,
                                                   &vm->retval);
@@ -654,21 +1619,12 @@ njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
             return sizeof(njs_vmcode_prop_set_t);
         }
 
-        prop = njs_object_prop_alloc(vm, &pq.value, &njs_value_void, 1);
+        prop = njs_object_prop_add(vm, object->data.u.object, &pq.value,
+                                   &pq.lhq);
         if (nxt_slow_path(prop == NULL)) {
             return NXT_ERROR;
         }
 
-        pq.lhq.replace = 0;
-        pq.lhq.value = prop;
-        pq.lhq.pool = vm->mem_cache_pool;
-
-        ret = nxt_lvlhsh_insert(&object->data.u.object->hash, &pq.lhq);
-        if (nxt_slow_path(ret != NXT_OK)) {
-            /* Only NXT_ERROR can be returned here. */
-            return ret;
-        }
-
         break;
 
     case NJS_PRIMITIVE_VALUE:
@@ -676,8 +1632,18 @@ njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
         return sizeof(njs_vmcode_prop_set_t);
 
     case NJS_ARRAY_VALUE:
-        p = pq.lhq.value;
-        *p = *value;
+        ret = njs_array_value_set(vm, object->data.u.array,
+                                  (njs_array_item_t *) pq.lhq.value, value);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        return sizeof(njs_vmcode_prop_set_t);
+
+    case NJS_TYPED_ARRAY_VALUE:
+        (void) njs_typed_array_key(property, &index);
+
+        njs_typed_array_set(object->data.u.typed_array, index, value);
 
         return sizeof(njs_vmcode_prop_set_t);
 
@@ -719,6 +1685,8 @@ njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
         return ret;
     }
 
+found:
+
     if (prop->writable) {
         prop->value = *value;
     }
@@ -728,12 +1696,12 @@ njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
 
 
 njs_ret_t
-njs_vmcode_property_in(njs_vm_t *vm, njs_value_t *object, njs_value_t *property)
+njs_vmcode_property_in(njs_vm_t *vm, njs_value_t *object, njs_value_t *property,
+    njs_value_t *dst)
 {
     void                  *obj;
     uintptr_t             data;
     njs_ret_t             ret;
-    njs_value_t           *value;
     const njs_value_t     *retval;
     const njs_extern_t    *ext_proto;
     njs_property_query_t  pq;
@@ -760,9 +1728,7 @@ njs_vmcode_property_in(njs_vm_t *vm, njs_value_t *object, njs_value_t *property)
         return NXT_ERROR;
 
     case NJS_ARRAY_VALUE:
-        value = pq.lhq.value;
-
-        if (njs_is_valid(value)) {
+        if (njs_array_item_is_valid((njs_array_item_t *) pq.lhq.value)) {
             retval = &njs_value_true;
         }
 
@@ -803,7 +1769,7 @@ njs_vmcode_property_in(njs_vm_t *vm, njs_value_t *object, njs_value_t *property)
         return ret;
     }
 
-    vm->retval = *retval;
+    *dst = *retval;
 
     return sizeof(njs_vmcode_3addr_t);
 }
@@ -811,12 +1777,12 @@ njs_vmcode_property_in(njs_vm_t *vm, njs_value_t *object, njs_value_t *property)
 
 njs_ret_t
 njs_vmcode_property_delete(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *property)
+    njs_value_t *property, njs_value_t *dst)
 {
     void                  *obj;
     uintptr_t             data;
     njs_ret_t             ret;
-    njs_value_t           *value, ext_val;
+    njs_value_t           ext_val;
     const njs_value_t     *retval;
     njs_object_prop_t     *prop;
     const njs_extern_t    *ext_proto;
@@ -834,9 +1800,7 @@ njs_vmcode_property_delete(njs_vm_t *vm, njs_value_t *object,
         prop = pq.lhq.value;
 
         if (prop->configurable) {
-            pq.lhq.pool = vm->mem_cache_pool;
-
-            (void) nxt_lvlhsh_delete(&object->data.u.object->hash, &pq.lhq);
+            njs_object_prop_delete(vm, object->data.u.object, &pq.lhq);
 
             njs_release(vm, property);
 
@@ -851,8 +1815,8 @@ njs_vmcode_property_delete(njs_vm_t *vm, njs_value_t *object,
         break;
 
     case NJS_ARRAY_VALUE:
-        value = pq.lhq.value;
-        njs_set_invalid(value);
+        object->data.u.array->kind = NJS_ARRAY_HOLEY;
+        njs_array_item_set_invalid((njs_array_item_t *) pq.lhq.value);
         retval = &njs_value_true;
         break;
 
@@ -905,42 +1869,131 @@ njs_vmcode_property_delete(njs_vm_t *vm, njs_value_t *object,
         return ret;
     }
 
-    vm->retval = *retval;
+    *dst = *retval;
 
     return sizeof(njs_vmcode_3addr_t);
 }
 
 
-static njs_ret_t
-njs_method_private_copy(njs_vm_t *vm, njs_property_query_t *pq)
+static njs_property_cache_t *
+njs_property_cache(njs_vm_t *vm, uint32_t slot)
 {
-    njs_function_t     *function;
-    njs_object_prop_t  *prop, *shared;
+    size_t                size;
+    njs_property_cache_t  *cache;
 
-    prop = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_object_prop_t));
-    if (nxt_slow_path(prop == NULL)) {
-        return NXT_ERROR;
+    if (nxt_slow_path(slot >= vm->property_cache_size)) {
+        size = nxt_max(slot, vm->property_cache_slots) + 1;
+
+        cache = nxt_mem_cache_zalloc(vm->mem_cache_pool,
+                                     size * sizeof(njs_property_cache_t));
+        if (nxt_slow_path(cache == NULL)) {
+            /* The operation falls back to property query. */
+            return NULL;
+        }
+
+        if (vm->property_cache != NULL) {
+            memcpy(cache, vm->property_cache,
+                   vm->property_cache_size * sizeof(njs_property_cache_t));
+
+            nxt_mem_cache_free(vm->mem_cache_pool, vm->property_cache);
+        }
+
+        vm->property_cache = cache;
+        vm->property_cache_size = size;
     }
 
-    shared = pq->lhq.value;
-    *prop = *shared;
+    return &vm->property_cache[slot];
+}
 
-    function = njs_function_value_copy(vm, &prop->value);
-    if (nxt_slow_path(function == NULL)) {
-        return NXT_ERROR;
+
+static njs_property_cache_entry_t *
+njs_property_cache_find(njs_property_cache_t *cache, const void *object)
+{
+    nxt_uint_t  n;
+
+    for (n = 0; n < NJS_PROPERTY_CACHE_WAYS; n++) {
+        if (cache->entry[n].object == object) {
+            return &cache->entry[n];
+        }
+    }
+
+    return NULL;
+}
+
+
+static void
+njs_property_cache_add(njs_property_cache_t *cache, const void *object,
+    void *value)
+{
+    njs_property_cache_entry_t  *entry;
+
+    entry = &cache->entry[cache->next++ % NJS_PROPERTY_CACHE_WAYS];
+
+    entry->object = object;
+    entry->value = value;
+}
+
+
+static njs_object_prop_t *
+njs_property_cache_prop(njs_property_cache_t *cache, njs_object_t *object)
+{
+    njs_property_cache_entry_t  *entry;
+
+    if (object->shape != NULL) {
+        entry = njs_property_cache_find(cache, object->shape);
+
+        if (entry != NULL) {
+            return &object->slots[(uintptr_t) entry->value].prop;
+        }
+
+        return NULL;
+    }
+
+    entry = njs_property_cache_find(cache, object);
+
+    if (entry != NULL) {
+        return entry->value;
+    }
+
+    return NULL;
+}
+
+
+static void
+njs_property_cache_prop_add(njs_property_cache_t *cache, njs_object_t *object,
+    njs_object_prop_t *prop)
+{
+    uintptr_t  slot;
+
+    if (object->shape != NULL) {
+        slot = (njs_object_slot_t *) prop - object->slots;
+        njs_property_cache_add(cache, object->shape, (void *) slot);
+
+    } else {
+        njs_property_cache_add(cache, object, prop);
     }
+}
+
 
-    pq->lhq.replace = 0;
-    pq->lhq.value = prop;
-    pq->lhq.pool = vm->mem_cache_pool;
+/*
+ * The property caches are flushed when a property is deleted from or
+ * replaced in a private hash, so a cached njs_object_prop_t never outlives
+ * its hash entry.  A deleted slot property is just marked as whiteout.
+ */
 
-    return nxt_lvlhsh_insert(&pq->prototype->hash, &pq->lhq);
+void
+njs_property_cache_flush(njs_vm_t *vm)
+{
+    if (vm->property_cache != NULL) {
+        memset(vm->property_cache, 0,
+               vm->property_cache_size * sizeof(njs_property_cache_t));
+    }
 }
 
 
 njs_ret_t
 njs_vmcode_property_foreach(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *invld)
+    njs_value_t *invld, njs_value_t *dst)
 {
     void                       *obj;
     njs_ret_t                  ret;
@@ -955,22 +2008,27 @@ njs_vmcode_property_foreach(njs_vm_t *vm, njs_value_t *object,
             return NXT_ERROR;
         }
 
-        vm->retval.data.u.next = next;
-
-        nxt_lvlhsh_each_init(&next->lhe, &njs_object_hash_proto);
+        njs_object_each_init(&next->each);
         next->index = -1;
 
         if (njs_is_array(object) && object->data.u.array->length != 0) {
             next->index = 0;
+
+        } else if (njs_is_typed_array(object)
+                   && njs_typed_array_length(object->data.u.typed_array) != 0)
+        {
+            next->index = 0;
         }
 
+        dst->data.u.next = next;
+
     } else if (njs_is_external(object)) {
         ext_proto = object->external.proto;
 
         if (ext_proto->foreach != NULL) {
             obj = njs_extern_object(vm, object);
 
-            ret = ext_proto->foreach(vm, obj, &vm->retval);
+            ret = ext_proto->foreach(vm, obj, dst);
             if (nxt_slow_path(ret != NXT_OK)) {
                 return ret;
             }
@@ -984,7 +2042,8 @@ njs_vmcode_property_foreach(njs_vm_t *vm, njs_value_t *object,
 
 
 njs_ret_t
-njs_vmcode_property_next(njs_vm_t *vm, njs_value_t *object, njs_value_t *value)
+njs_vmcode_property_next(njs_vm_t *vm, njs_value_t *object, njs_value_t *value,
+    njs_value_t *unused)
 {
     void                    *obj;
     njs_ret_t               ret;
@@ -1002,13 +2061,25 @@ njs_vmcode_property_next(njs_vm_t *vm, njs_value_t *object, njs_value_t *value)
     if (njs_is_object(object)) {
         next = value->data.u.next;
 
+        if (next->index >= 0 && njs_is_typed_array(object)) {
+            n = next->index++;
+
+            if (n < njs_typed_array_length(object->data.u.typed_array)) {
+                njs_value_number_set(retval, n);
+
+                return code->offset;
+            }
+
+            next->index = -1;
+        }
+
         if (next->index >= 0) {
             array = object->data.u.array;
 
             while ((uint32_t) next->index < array->length) {
                 n = next->index++;
 
-                if (njs_is_valid(&array->start[n])) {
+                if (njs_array_item_is_valid(&array->start[n])) {
                     njs_value_number_set(retval, n);
 
                     return code->offset;
@@ -1018,7 +2089,7 @@ njs_vmcode_property_next(njs_vm_t *vm, njs_value_t *object, njs_value_t *value)
             next->index = -1;
         }
 
-        prop = nxt_lvlhsh_each(&object->data.u.object->hash, &next->lhe);
+        prop = njs_object_each(object->data.u.object, &next->each);
 
         if (prop != NULL) {
             *retval = prop->name;
@@ -1054,7 +2125,7 @@ njs_vmcode_property_next(njs_vm_t *vm, njs_value_t *object, njs_value_t *value)
 
 njs_ret_t
 njs_vmcode_instance_of(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *constructor)
+    njs_value_t *constructor, njs_value_t *dst)
 {
     nxt_int_t             ret;
     njs_value_t           *value;
@@ -1087,7 +2158,7 @@ njs_vmcode_instance_of(njs_vm_t *vm, njs_value_t *object,
             proto = object->data.u.object;
 
             do {
-                proto = proto->__proto__;
+                proto = njs_object_proto(vm, proto);
 
                 if (proto == prototype) {
                     retval = &njs_value_true;
@@ -1098,7 +2169,7 @@ njs_vmcode_instance_of(njs_vm_t *vm, njs_value_t *object,
         }
     }
 
-    vm->retval = *retval;
+    *dst = *retval;
 
     return sizeof(njs_vmcode_instance_of_t);
 }
@@ -1112,7 +2183,8 @@ njs_vmcode_instance_of(njs_vm_t *vm, njs_value_t *object,
  */
 
 njs_ret_t
-njs_vmcode_increment(njs_vm_t *vm, njs_value_t *reference, njs_value_t *value)
+njs_vmcode_increment(njs_vm_t *vm, njs_value_t *reference, njs_value_t *value,
+    njs_value_t *dst)
 {
     double  num;
 
@@ -1122,7 +2194,7 @@ njs_vmcode_increment(njs_vm_t *vm, njs_value_t *reference, njs_value_t *value)
         njs_release(vm, reference);
 
         njs_value_number_set(reference, num);
-        vm->retval = *reference;
+        *dst = *reference;
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1132,7 +2204,8 @@ njs_vmcode_increment(njs_vm_t *vm, njs_value_t *reference, njs_value_t *value)
 
 
 njs_ret_t
-njs_vmcode_decrement(njs_vm_t *vm, njs_value_t *reference, njs_value_t *value)
+njs_vmcode_decrement(njs_vm_t *vm, njs_value_t *reference, njs_value_t *value,
+    njs_value_t *dst)
 {
     double  num;
 
@@ -1142,7 +2215,7 @@ njs_vmcode_decrement(njs_vm_t *vm, njs_value_t *reference, njs_value_t *value)
         njs_release(vm, reference);
 
         njs_value_number_set(reference, num);
-        vm->retval = *reference;
+        *dst = *reference;
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1153,7 +2226,7 @@ njs_vmcode_decrement(njs_vm_t *vm, njs_value_t *reference, njs_value_t *value)
 
 njs_ret_t
 njs_vmcode_post_increment(njs_vm_t *vm, njs_value_t *reference,
-    njs_value_t *value)
+    njs_value_t *value, njs_value_t *dst)
 {
     double  num;
 
@@ -1163,7 +2236,7 @@ njs_vmcode_post_increment(njs_vm_t *vm, njs_value_t *reference,
         njs_release(vm, reference);
 
         njs_value_number_set(reference, num + 1.0);
-        njs_value_number_set(&vm->retval, num);
+        njs_value_number_set(dst, num);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1174,7 +2247,7 @@ njs_vmcode_post_increment(njs_vm_t *vm, njs_value_t *reference,
 
 njs_ret_t
 njs_vmcode_post_decrement(njs_vm_t *vm, njs_value_t *reference,
-    njs_value_t *value)
+    njs_value_t *value, njs_value_t *dst)
 {
     double  num;
 
@@ -1184,7 +2257,7 @@ njs_vmcode_post_decrement(njs_vm_t *vm, njs_value_t *reference,
         njs_release(vm, reference);
 
         njs_value_number_set(reference, num - 1.0);
-        njs_value_number_set(&vm->retval, num);
+        njs_value_number_set(dst, num);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1194,7 +2267,8 @@ njs_vmcode_post_decrement(njs_vm_t *vm, njs_value_t *reference,
 
 
 njs_ret_t
-njs_vmcode_typeof(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
+njs_vmcode_typeof(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld,
+    njs_value_t *dst)
 {
     nxt_uint_t  type;
 
@@ -1234,42 +2308,49 @@ njs_vmcode_typeof(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
         &njs_string_object,
         &njs_string_object,
         &njs_string_object,
+        &njs_string_object,
+        &njs_string_object,
+        &njs_string_object,
+        &njs_string_object,
     };
 
     /* A zero index means non-declared variable. */
     type = (value != NULL) ? value->type : NJS_VOID;
 
-    vm->retval = *types[type];
+    *dst = *types[type];
 
     return sizeof(njs_vmcode_2addr_t);
 }
 
 
 njs_ret_t
-njs_vmcode_void(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
+njs_vmcode_void(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2,
+    njs_value_t *dst)
 {
-    vm->retval = njs_value_void;
+    *dst = njs_value_void;
 
     return sizeof(njs_vmcode_2addr_t);
 }
 
 
 njs_ret_t
-njs_vmcode_delete(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
+njs_vmcode_delete(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld,
+    njs_value_t *dst)
 {
     njs_release(vm, value);
 
-    vm->retval = njs_value_true;
+    *dst = njs_value_true;
 
     return sizeof(njs_vmcode_2addr_t);
 }
 
 
 njs_ret_t
-njs_vmcode_unary_plus(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
+njs_vmcode_unary_plus(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld,
+    njs_value_t *dst)
 {
     if (nxt_fast_path(njs_is_numeric(value))) {
-        njs_value_number_set(&vm->retval, value->data.u.number);
+        njs_value_number_set(dst, value->data.u.number);
         return sizeof(njs_vmcode_2addr_t);
     }
 
@@ -1278,10 +2359,11 @@ njs_vmcode_unary_plus(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
 
 
 njs_ret_t
-njs_vmcode_unary_negation(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
+njs_vmcode_unary_negation(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld,
+    njs_value_t *dst)
 {
     if (nxt_fast_path(njs_is_numeric(value))) {
-        njs_value_number_set(&vm->retval, - value->data.u.number);
+        njs_value_number_set(dst, - value->data.u.number);
         return sizeof(njs_vmcode_2addr_t);
     }
 
@@ -1290,45 +2372,31 @@ njs_vmcode_unary_negation(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
 
 
 njs_ret_t
-njs_vmcode_addition(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_addition(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
-    double             num;
-    u_char             *start;
-    size_t             size, length;
-    njs_string_prop_t  string1, string2;
+    double       num;
+    njs_ret_t    ret;
+    njs_value_t  value;
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
         num = val1->data.u.number + val2->data.u.number;
-        njs_value_number_set(&vm->retval, num);
+        njs_value_number_set(dst, num);
 
         return sizeof(njs_vmcode_3addr_t);
     }
 
     if (nxt_fast_path(njs_is_string(val1) && njs_is_string(val2))) {
 
-        (void) njs_string_prop(&string1, val1);
-        (void) njs_string_prop(&string2, val2);
-
-        if ((string1.length != 0 || string1.size == 0)
-            && (string2.length != 0 || string2.size == 0))
-        {
-            length = string1.length + string2.length;
-
-        } else {
-            length = 0;
-        }
-
-        size = string1.size + string2.size;
+        /* The destination may be one of the concatenated strings. */
 
-        start = njs_string_alloc(vm, &vm->retval, size, length);
-
-        if (nxt_slow_path(start == NULL)) {
-            return NXT_ERROR;
+        ret = njs_string_concat(vm, &value, val1, val2);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
         }
 
-        (void) memcpy(start, string1.start, string1.size);
-        (void) memcpy(start + string1.size, string2.start, string2.size);
+        *dst = value;
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1338,14 +2406,15 @@ njs_vmcode_addition(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_substraction(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_substraction(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     double  num;
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
         num = val1->data.u.number - val2->data.u.number;
-        njs_value_number_set(&vm->retval, num);
+        njs_value_number_set(dst, num);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1355,14 +2424,15 @@ njs_vmcode_substraction(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_multiplication(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_multiplication(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     double  num;
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
         num = val1->data.u.number * val2->data.u.number;
-        njs_value_number_set(&vm->retval, num);
+        njs_value_number_set(dst, num);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1372,7 +2442,8 @@ njs_vmcode_multiplication(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_exponentiation(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_exponentiation(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     double      num, base, exponent;
     nxt_bool_t  valid;
@@ -1396,7 +2467,7 @@ njs_vmcode_exponentiation(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
             num = NAN;
         }
 
-        njs_value_number_set(&vm->retval, num);
+        njs_value_number_set(dst, num);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1406,14 +2477,15 @@ njs_vmcode_exponentiation(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_division(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_division(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     double  num;
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
         num = val1->data.u.number / val2->data.u.number;
-        njs_value_number_set(&vm->retval, num);
+        njs_value_number_set(dst, num);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1423,14 +2495,15 @@ njs_vmcode_division(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_remainder(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_remainder(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     double  num;
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
         num = fmod(val1->data.u.number, val2->data.u.number);
-        njs_value_number_set(&vm->retval, num);
+        njs_value_number_set(dst, num);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1440,16 +2513,18 @@ njs_vmcode_remainder(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_left_shift(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_left_shift(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     int32_t   num1;
     uint32_t  num2;
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_number_to_integer(val1->data.u.number);
-        num2 = njs_number_to_integer(val2->data.u.number);
-        njs_value_number_set(&vm->retval, num1 << (num2 & 0x1f));
+        num1 = njs_value_to_int32(val1);
+        num2 = njs_value_to_int32(val2);
+        num1 = (uint32_t) num1 << (num2 & 0x1f);
+        njs_value_int32_set(dst, num1);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1459,16 +2534,17 @@ njs_vmcode_left_shift(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_right_shift(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_right_shift(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     int32_t   num1;
     uint32_t  num2;
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_number_to_integer(val1->data.u.number);
-        num2 = njs_number_to_integer(val2->data.u.number);
-        njs_value_number_set(&vm->retval, num1 >> (num2 & 0x1f));
+        num1 = njs_value_to_int32(val1);
+        num2 = njs_value_to_int32(val2);
+        njs_value_int32_set(dst, num1 >> (num2 & 0x1f));
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1479,16 +2555,16 @@ njs_vmcode_right_shift(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 njs_ret_t
 njs_vmcode_unsigned_right_shift(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2)
+    njs_value_t *val2, njs_value_t *dst)
 {
     int32_t   num2;
     uint32_t  num1;
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_number_to_integer(val1->data.u.number);
-        num2 = njs_number_to_integer(val2->data.u.number);
-        njs_value_number_set(&vm->retval, num1 >> (num2 & 0x1f));
+        num1 = njs_value_to_int32(val1);
+        num2 = njs_value_to_int32(val2);
+        njs_value_number_set(dst, num1 >> (num2 & 0x1f));
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1498,7 +2574,8 @@ njs_vmcode_unsigned_right_shift(njs_vm_t *vm, njs_value_t *val1,
 
 
 njs_ret_t
-njs_vmcode_logical_not(njs_vm_t *vm, njs_value_t *value, njs_value_t *inlvd)
+njs_vmcode_logical_not(njs_vm_t *vm, njs_value_t *value, njs_value_t *inlvd,
+    njs_value_t *dst)
 {
     const njs_value_t  *retval;
 
@@ -1509,18 +2586,19 @@ njs_vmcode_logical_not(njs_vm_t *vm, njs_value_t *value, njs_value_t *inlvd)
         retval = &njs_value_true;
     }
 
-    vm->retval = *retval;
+    *dst = *retval;
 
     return sizeof(njs_vmcode_2addr_t);
 }
 
 
 njs_ret_t
-njs_vmcode_test_if_true(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
+njs_vmcode_test_if_true(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld,
+    njs_value_t *dst)
 {
     njs_vmcode_test_jump_t  *test_jump;
 
-    vm->retval = *value;
+    *dst = *value;
 
     if (njs_is_true(value)) {
         test_jump = (njs_vmcode_test_jump_t *) vm->current;
@@ -1532,11 +2610,12 @@ njs_vmcode_test_if_true(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
 
 
 njs_ret_t
-njs_vmcode_test_if_false(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
+njs_vmcode_test_if_false(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld,
+    njs_value_t *dst)
 {
     njs_vmcode_test_jump_t  *test_jump;
 
-    vm->retval = *value;
+    *dst = *value;
 
     if (!njs_is_true(value)) {
         test_jump = (njs_vmcode_test_jump_t *) vm->current;
@@ -1548,13 +2627,14 @@ njs_vmcode_test_if_false(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
 
 
 njs_ret_t
-njs_vmcode_bitwise_not(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
+njs_vmcode_bitwise_not(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld,
+    njs_value_t *dst)
 {
     int32_t  num;
 
     if (nxt_fast_path(njs_is_numeric(value))) {
-        num = njs_number_to_integer(value->data.u.number);
-        njs_value_number_set(&vm->retval, ~num);
+        num = njs_value_to_int32(value);
+        njs_value_int32_set(dst, ~num);
 
         return sizeof(njs_vmcode_2addr_t);
     }
@@ -1564,15 +2644,16 @@ njs_vmcode_bitwise_not(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
 
 
 njs_ret_t
-njs_vmcode_bitwise_and(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_bitwise_and(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     int32_t  num1, num2;
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_number_to_integer(val1->data.u.number);
-        num2 = njs_number_to_integer(val2->data.u.number);
-        njs_value_number_set(&vm->retval, num1 & num2);
+        num1 = njs_value_to_int32(val1);
+        num2 = njs_value_to_int32(val2);
+        njs_value_int32_set(dst, num1 & num2);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1582,15 +2663,16 @@ njs_vmcode_bitwise_and(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_bitwise_xor(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_bitwise_xor(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     int32_t  num1, num2;
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_number_to_integer(val1->data.u.number);
-        num2 = njs_number_to_integer(val2->data.u.number);
-        njs_value_number_set(&vm->retval, num1 ^ num2);
+        num1 = njs_value_to_int32(val1);
+        num2 = njs_value_to_int32(val2);
+        njs_value_int32_set(dst, num1 ^ num2);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1600,15 +2682,16 @@ njs_vmcode_bitwise_xor(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_bitwise_or(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_bitwise_or(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     int32_t  num1, num2;
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_number_to_integer(val1->data.u.number);
-        num2 = njs_number_to_integer(val2->data.u.number);
-        njs_value_number_set(&vm->retval, num1 | num2);
+        num1 = njs_value_to_int32(val1);
+        num2 = njs_value_to_int32(val2);
+        njs_value_int32_set(dst, num1 | num2);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1618,17 +2701,18 @@ njs_vmcode_bitwise_or(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     njs_ret_t          ret;
     const njs_value_t  *retval;
 
-    ret = njs_values_equal(val1, val2);
+    ret = njs_values_equal(vm, val1, val2);
 
     if (nxt_fast_path(ret >= 0)) {
 
         retval = (ret != 0) ? &njs_value_true : &njs_value_false;
-        vm->retval = *retval;
+        *dst = *retval;
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1638,17 +2722,18 @@ njs_vmcode_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_not_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_not_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     njs_ret_t          ret;
     const njs_value_t  *retval;
 
-    ret = njs_values_equal(val1, val2);
+    ret = njs_values_equal(vm, val1, val2);
 
     if (nxt_fast_path(ret >= 0)) {
 
         retval = (ret == 0) ? &njs_value_true : &njs_value_false;
-        vm->retval = *retval;
+        *dst = *retval;
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1658,7 +2743,8 @@ njs_vmcode_not_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 static nxt_noinline njs_ret_t
-njs_values_equal(const njs_value_t *val1, const njs_value_t *val2)
+njs_values_equal(njs_vm_t *vm, const njs_value_t *val1,
+    const njs_value_t *val2)
 {
     /* Void and null are equal and not comparable with anything else. */
     if (njs_is_null_or_void(val1)) {
@@ -1673,6 +2759,15 @@ njs_values_equal(const njs_value_t *val1, const njs_value_t *val2)
     if (val1->type == val2->type) {
 
         if (njs_is_string(val1)) {
+
+            if (nxt_slow_path(njs_string_is_rope(val1)
+                              || njs_string_is_rope(val2)))
+            {
+                if (njs_values_flat(vm, val1, val2) != NXT_OK) {
+                    return NXT_ERROR;
+                }
+            }
+
             return njs_string_eq(val1, val2);
         }
 
@@ -1684,17 +2779,25 @@ njs_values_equal(const njs_value_t *val1, const njs_value_t *val2)
 
 
 nxt_noinline njs_ret_t
-njs_vmcode_less(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_less(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     njs_ret_t          ret;
     const njs_value_t  *retval;
 
+    if (njs_is_string(val1) && njs_is_string(val2)) {
+        ret = njs_values_flat(vm, val1, val2);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+    }
+
     ret = njs_values_compare(val1, val2);
 
     if (nxt_fast_path(ret >= -1)) {
 
         retval = (ret > 0) ? &njs_value_true : &njs_value_false;
-        vm->retval = *retval;
+        *dst = *retval;
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1704,31 +2807,41 @@ njs_vmcode_less(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_greater(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_greater(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
-    return njs_vmcode_less(vm, val2, val1);
+    return njs_vmcode_less(vm, val2, val1, dst);
 }
 
 
 njs_ret_t
-njs_vmcode_less_or_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_less_or_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
-    return njs_vmcode_greater_or_equal(vm, val2, val1);
+    return njs_vmcode_greater_or_equal(vm, val2, val1, dst);
 }
 
 
 nxt_noinline njs_ret_t
-njs_vmcode_greater_or_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_greater_or_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
     njs_ret_t          ret;
     const njs_value_t  *retval;
 
+    if (njs_is_string(val1) && njs_is_string(val2)) {
+        ret = njs_values_flat(vm, val1, val2);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+    }
+
     ret = njs_values_compare(val1, val2);
 
     if (nxt_fast_path(ret >= -1)) {
 
         retval = (ret == 0) ? &njs_value_true : &njs_value_false;
-        vm->retval = *retval;
+        *dst = *retval;
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1773,43 +2886,57 @@ njs_values_compare(const njs_value_t *val1, const njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_strict_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_strict_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
+    njs_ret_t          ret;
     const njs_value_t  *retval;
 
-    if (njs_values_strict_equal(val1, val2)) {
-        retval = &njs_value_true;
+    ret = njs_values_strict_equal(vm, val1, val2);
 
-    } else {
-        retval = &njs_value_false;
+    if (nxt_slow_path(ret < 0)) {
+        return ret;
     }
 
-    vm->retval = *retval;
+    retval = (ret != 0) ? &njs_value_true : &njs_value_false;
+
+    *dst = *retval;
 
     return sizeof(njs_vmcode_3addr_t);
 }
 
 
 njs_ret_t
-njs_vmcode_strict_not_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_strict_not_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst)
 {
+    njs_ret_t          ret;
     const njs_value_t  *retval;
 
-    if (njs_values_strict_equal(val1, val2)) {
-        retval = &njs_value_false;
+    ret = njs_values_strict_equal(vm, val1, val2);
 
-    } else {
-        retval = &njs_value_true;
+    if (nxt_slow_path(ret < 0)) {
+        return ret;
     }
 
-    vm->retval = *retval;
+    retval = (ret == 0) ? &njs_value_true : &njs_value_false;
+
+    *dst = *retval;
 
     return sizeof(njs_vmcode_3addr_t);
 }
 
 
-nxt_noinline nxt_bool_t
-njs_values_strict_equal(const njs_value_t *val1, const njs_value_t *val2)
+/*
+ * njs_values_strict_equal() returns
+ *   1 if the values are strictly equal,
+ *   0 if the values are not equal,
+ *   NXT_ERROR if a rope operand cannot be flattened.
+ */
+
+nxt_noinline njs_ret_t
+njs_values_strict_equal(njs_vm_t *vm, const njs_value_t *val1,
+    const njs_value_t *val2)
 {
     size_t        size;
     const u_char  *start1, *start2;
@@ -1856,6 +2983,14 @@ njs_values_strict_equal(const njs_value_t *val1, const njs_value_t *val2)
                 return 0;
             }
 
+            if (nxt_slow_path(njs_string_is_rope(val1)
+                              || njs_string_is_rope(val2)))
+            {
+                if (njs_values_flat(vm, val1, val2) != NXT_OK) {
+                    return NXT_ERROR;
+                }
+            }
+
             start1 = val1->long_string.data->start;
             start2 = val2->long_string.data->start;
         }
@@ -1863,14 +2998,41 @@ njs_values_strict_equal(const njs_value_t *val1, const njs_value_t *val2)
         return (memcmp(start1, start2, size) == 0);
     }
 
+    if (njs_is_function(val1)) {
+        return (njs_function_origin(val1->data.u.function)
+                == njs_function_origin(val2->data.u.function));
+    }
+
     return (val1->data.u.object == val2->data.u.object);
 }
 
 
+/*
+ * The string operands are flattened before comparison where the memory
+ * error can be reported, so njs_string_eq() and njs_string_cmp() never
+ * see a rope.
+ */
+
+static njs_ret_t
+njs_values_flat(njs_vm_t *vm, const njs_value_t *val1,
+    const njs_value_t *val2)
+{
+    njs_ret_t  ret;
+
+    ret = njs_string_flat(vm, val1);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    return njs_string_flat(vm, val2);
+}
+
+
 njs_ret_t
-njs_vmcode_move(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
+njs_vmcode_move(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld,
+    njs_value_t *dst)
 {
-    vm->retval = *value;
+    *dst = *value;
 
     njs_retain(value);
 
@@ -1879,16 +3041,26 @@ njs_vmcode_move(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
 
 
 njs_ret_t
-njs_vmcode_jump(njs_vm_t *vm, njs_value_t *invld, njs_value_t *offset)
+njs_vmcode_jump(njs_vm_t *vm, njs_value_t *invld, njs_value_t *offset,
+    njs_value_t *unused)
 {
+    if ((njs_ret_t) offset < 0) {
+        njs_gc_safe_point(vm);
+    }
+
     return (njs_ret_t) offset;
 }
 
 
 njs_ret_t
-njs_vmcode_if_true_jump(njs_vm_t *vm, njs_value_t *cond, njs_value_t *offset)
+njs_vmcode_if_true_jump(njs_vm_t *vm, njs_value_t *cond, njs_value_t *offset,
+    njs_value_t *unused)
 {
     if (njs_is_true(cond)) {
+        if ((njs_ret_t) offset < 0) {
+            njs_gc_safe_point(vm);
+        }
+
         return (njs_ret_t) offset;
     }
 
@@ -1897,22 +3069,36 @@ njs_vmcode_if_true_jump(njs_vm_t *vm, njs_value_t *cond, njs_value_t *offset)
 
 
 njs_ret_t
-njs_vmcode_if_false_jump(njs_vm_t *vm, njs_value_t *cond, njs_value_t *offset)
+njs_vmcode_if_false_jump(njs_vm_t *vm, njs_value_t *cond, njs_value_t *offset,
+    njs_value_t *unused)
 {
     if (njs_is_true(cond)) {
         return sizeof(njs_vmcode_cond_jump_t);
     }
 
+    if ((njs_ret_t) offset < 0) {
+        njs_gc_safe_point(vm);
+    }
+
     return (njs_ret_t) offset;
 }
 
 
 njs_ret_t
-njs_vmcode_if_equal_jump(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+njs_vmcode_if_equal_jump(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *unused)
 {
+    njs_ret_t                ret;
     njs_vmcode_equal_jump_t  *jump;
 
-    if (njs_values_strict_equal(val1, val2)) {
+    ret = njs_values_strict_equal(vm, val1, val2);
+
+    if (ret != 0) {
+
+        if (nxt_slow_path(ret < 0)) {
+            return ret;
+        }
+
         jump = (njs_vmcode_equal_jump_t *) vm->current;
         return jump->offset;
     }
@@ -1922,7 +3108,8 @@ njs_vmcode_if_equal_jump(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
 
 njs_ret_t
-njs_vmcode_function_frame(njs_vm_t *vm, njs_value_t *value, njs_value_t *nargs)
+njs_vmcode_function_frame(njs_vm_t *vm, njs_value_t *value, njs_value_t *nargs,
+    njs_value_t *unused)
 {
     njs_ret_t                    ret;
     njs_vmcode_function_frame_t  *function;
@@ -2023,11 +3210,12 @@ njs_function_new_object(njs_vm_t *vm, njs_value_t *value)
 
 
 njs_ret_t
-njs_vmcode_method_frame(njs_vm_t *vm, njs_value_t *object, njs_value_t *name)
+njs_vmcode_method_frame(njs_vm_t *vm, njs_value_t *object, njs_value_t *name,
+    njs_value_t *unused)
 {
     void                       *obj;
     njs_ret_t                  ret;
-    njs_value_t                this, *value;
+    njs_value_t                this, val, *value;
     njs_object_prop_t          *prop;
     njs_property_query_t       pq;
     const njs_extern_t         *ext_proto;
@@ -2051,7 +3239,8 @@ njs_vmcode_method_frame(njs_vm_t *vm, njs_value_t *object, njs_value_t *name)
         break;
 
     case NJS_ARRAY_VALUE:
-        value = pq.lhq.value;
+        value = njs_array_item_value((njs_array_item_t *) pq.lhq.value,
+                                     &val);
 
         ret = njs_function_frame_create(vm, value, object, method->nargs,
                                         method->code.ctor);
@@ -2106,7 +3295,8 @@ njs_vmcode_method_frame(njs_vm_t *vm, njs_value_t *object, njs_value_t *name)
 
 
 njs_ret_t
-njs_vmcode_function_call(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval)
+njs_vmcode_function_call(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval,
+    njs_value_t *unused)
 {
     njs_ret_t           ret;
     nxt_uint_t          nargs;
@@ -2123,6 +3313,7 @@ njs_vmcode_function_call(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval)
                                 sizeof(njs_vmcode_function_call_t));
 
         if (nxt_fast_path(ret != NJS_ERROR)) {
+            njs_gc_safe_point(vm);
             return 0;
         }
 
@@ -2217,6 +3408,15 @@ njs_normalize_args(njs_vm_t *vm, njs_value_t *args, uint8_t *args_types,
         case NJS_STRING_ARG:
 
             if (njs_is_string(args)) {
+                /*
+                 * A rope is flattened here where the memory error can be
+                 * reported, so the native functions get the string bytes
+                 * with njs_string_prop() or njs_string_get().
+                 */
+                if (nxt_slow_path(njs_string_flat(vm, args) != NXT_OK)) {
+                    return NXT_ERROR;
+                }
+
                 break;
             }
 
@@ -2258,6 +3458,12 @@ njs_normalize_args(njs_vm_t *vm, njs_value_t *args, uint8_t *args_types,
 
             switch (args->type) {
             case NJS_STRING:
+                if (nxt_slow_path(njs_string_flat(vm, args) != NXT_OK)) {
+                    return NXT_ERROR;
+                }
+
+                break;
+
             case NJS_FUNCTION:
                 break;
 
@@ -2271,8 +3477,14 @@ njs_normalize_args(njs_vm_t *vm, njs_value_t *args, uint8_t *args_types,
         case NJS_REGEXP_ARG:
 
             switch (args->type) {
-            case NJS_VOID:
             case NJS_STRING:
+                if (nxt_slow_path(njs_string_flat(vm, args) != NXT_OK)) {
+                    return NXT_ERROR;
+                }
+
+                break;
+
+            case NJS_VOID:
             case NJS_REGEXP:
                 break;
 
@@ -2290,6 +3502,27 @@ njs_normalize_args(njs_vm_t *vm, njs_value_t *args, uint8_t *args_types,
 
             break;
 
+        case NJS_ARRAY_BUFFER_ARG:
+            if (!njs_is_array_buffer(args)) {
+                goto type_error;
+            }
+
+            break;
+
+        case NJS_TYPED_ARRAY_ARG:
+            if (!njs_is_typed_array(args)) {
+                goto type_error;
+            }
+
+            break;
+
+        case NJS_DATA_VIEW_ARG:
+            if (!njs_is_data_view(args)) {
+                goto type_error;
+            }
+
+            break;
+
         case NJS_OBJECT_ARG:
 
             if (njs_is_null_or_void(args)) {
@@ -2400,6 +3633,15 @@ njs_type_string(njs_value_type_t type)
     case NJS_OBJECT_URI_ERROR:
         return "uri error";
 
+    case NJS_ARRAY_BUFFER:
+        return "array buffer";
+
+    case NJS_TYPED_ARRAY:
+        return "typed array";
+
+    case NJS_DATA_VIEW:
+        return "data view";
+
     default:
         return NULL;
     }
@@ -2437,6 +3679,15 @@ njs_arg_type_string(uint8_t arg)
     case NJS_DATE_ARG:
         return "regexp";
 
+    case NJS_ARRAY_BUFFER_ARG:
+        return "array buffer";
+
+    case NJS_TYPED_ARRAY_ARG:
+        return "typed array";
+
+    case NJS_DATA_VIEW_ARG:
+        return "data view";
+
     default:
         return "unknown";
     }
@@ -2444,7 +3695,8 @@ njs_arg_type_string(uint8_t arg)
 
 
 njs_ret_t
-njs_vmcode_return(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval)
+njs_vmcode_return(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval,
+    njs_value_t *unused)
 {
     njs_value_t         *value;
     njs_frame_t         *frame;
@@ -2542,7 +3794,8 @@ const njs_vmcode_1addr_t  njs_continuation_nexus[] = {
 
 
 static njs_ret_t
-njs_vmcode_continuation(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
+njs_vmcode_continuation(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2,
+    njs_value_t *unused)
 {
     njs_ret_t           ret;
     nxt_bool_t          skip;
@@ -2648,7 +3901,8 @@ njs_function_frame_free(njs_vm_t *vm, njs_native_frame_t *frame)
 
 
 njs_ret_t
-njs_vmcode_stop(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval)
+njs_vmcode_stop(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval,
+    njs_value_t *unused)
 {
     njs_value_t  *value;
 
@@ -2667,7 +3921,8 @@ njs_vmcode_stop(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval)
  */
 
 njs_ret_t
-njs_vmcode_try_start(njs_vm_t *vm, njs_value_t *value, njs_value_t *offset)
+njs_vmcode_try_start(njs_vm_t *vm, njs_value_t *value, njs_value_t *offset,
+    njs_value_t *unused)
 {
     njs_exception_t  *e;
 
@@ -2695,7 +3950,8 @@ njs_vmcode_try_start(njs_vm_t *vm, njs_value_t *value, njs_value_t *offset)
  */
 
 nxt_noinline njs_ret_t
-njs_vmcode_try_end(njs_vm_t *vm, njs_value_t *invld, njs_value_t *offset)
+njs_vmcode_try_end(njs_vm_t *vm, njs_value_t *invld, njs_value_t *offset,
+    njs_value_t *unused)
 {
     njs_exception_t  *e;
 
@@ -2714,7 +3970,8 @@ njs_vmcode_try_end(njs_vm_t *vm, njs_value_t *invld, njs_value_t *offset)
 
 
 njs_ret_t
-njs_vmcode_throw(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval)
+njs_vmcode_throw(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval,
+    njs_value_t *unused)
 {
     njs_value_t  *value;
 
@@ -2735,12 +3992,13 @@ njs_vmcode_throw(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval)
  */
 
 njs_ret_t
-njs_vmcode_catch(njs_vm_t *vm, njs_value_t *exception, njs_value_t *offset)
+njs_vmcode_catch(njs_vm_t *vm, njs_value_t *exception, njs_value_t *offset,
+    njs_value_t *unused)
 {
     *exception = vm->retval;
 
     if ((njs_ret_t) offset == sizeof(njs_vmcode_catch_t)) {
-        return njs_vmcode_try_end(vm, exception, offset);
+        return njs_vmcode_try_end(vm, exception, offset, NULL);
     }
 
     vm->top_frame->exception.catch = vm->current + (njs_ret_t) offset;
@@ -2755,7 +4013,8 @@ njs_vmcode_catch(njs_vm_t *vm, njs_value_t *exception, njs_value_t *offset)
  */
 
 njs_ret_t
-njs_vmcode_finally(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval)
+njs_vmcode_finally(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval,
+    njs_value_t *unused)
 {
     njs_value_t  *value;
 
@@ -2892,7 +4151,8 @@ njs_vm_trap_argument(njs_vm_t *vm, nxt_uint_t trap)
 
 
 static njs_ret_t
-njs_vmcode_number_primitive(njs_vm_t *vm, njs_value_t *invld, njs_value_t *narg)
+njs_vmcode_number_primitive(njs_vm_t *vm, njs_value_t *invld, njs_value_t *narg,
+    njs_value_t *unused)
 {
     double       num;
     njs_ret_t    ret;
@@ -2908,6 +4168,11 @@ njs_vmcode_number_primitive(njs_vm_t *vm, njs_value_t *invld, njs_value_t *narg)
             num = NAN;
 
             if (njs_is_string(value)) {
+                ret = njs_string_flat(vm, value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return ret;
+                }
+
                 num = njs_string_to_number(value, 0);
             }
 
@@ -2922,7 +4187,8 @@ njs_vmcode_number_primitive(njs_vm_t *vm, njs_value_t *invld, njs_value_t *narg)
 
 
 static njs_ret_t
-njs_vmcode_string_primitive(njs_vm_t *vm, njs_value_t *invld, njs_value_t *narg)
+njs_vmcode_string_primitive(njs_vm_t *vm, njs_value_t *invld, njs_value_t *narg,
+    njs_value_t *unused)
 {
     njs_ret_t    ret;
     njs_value_t  *value;
@@ -2945,7 +4211,7 @@ njs_vmcode_string_primitive(njs_vm_t *vm, njs_value_t *invld, njs_value_t *narg)
 
 static njs_ret_t
 njs_vmcode_number_argument(njs_vm_t *vm, njs_value_t *invld1,
-    njs_value_t *inlvd2)
+    njs_value_t *inlvd2, njs_value_t *unused)
 {
     double       num;
     njs_ret_t    ret;
@@ -2961,6 +4227,11 @@ njs_vmcode_number_argument(njs_vm_t *vm, njs_value_t *invld1,
             num = NAN;
 
             if (njs_is_string(value)) {
+                ret = njs_string_flat(vm, value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return ret;
+                }
+
                 num = njs_string_to_number(value, 0);
             }
 
@@ -2981,7 +4252,7 @@ njs_vmcode_number_argument(njs_vm_t *vm, njs_value_t *invld1,
 
 static njs_ret_t
 njs_vmcode_string_argument(njs_vm_t *vm, njs_value_t *invld1,
-    njs_value_t *inlvd2)
+    njs_value_t *inlvd2, njs_value_t *unused)
 {
     njs_ret_t    ret;
     njs_value_t  *value;
@@ -3103,10 +4374,10 @@ njs_primitive_value(njs_vm_t *vm, njs_value_t *value, nxt_uint_t hint)
 
 
 static njs_ret_t
-njs_vmcode_restart(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
+njs_vmcode_restart(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2,
+    njs_value_t *unused)
 {
     u_char                *restart;
-    njs_ret_t             ret;
     njs_value_t           *retval, *value1;
     njs_native_frame_t    *frame;
     njs_vmcode_generic_t  *vmcode;
@@ -3123,17 +4394,78 @@ njs_vmcode_restart(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
         value1 = value1->data.u.value;
     }
 
-    ret = vmcode->code.operation(vm, value1, &frame->trap_values[1]);
+    retval = njs_vmcode_retval(vm, vmcode);
 
-    retval = njs_vmcode_operand(vm, vmcode->operand1);
+    return vmcode->code.operation(vm, value1, &frame->trap_values[1], retval);
+}
 
-    //njs_release(vm, retval);
 
-    *retval = vm->retval;
+#if (NXT_JIT)
 
-    return ret;
+/*
+ * Completes an instruction of the JIT code whose result is not handled
+ * by the machine code as the interpreter does.  Zero continues with
+ * the interpreter at vm->current.
+ */
+
+njs_ret_t
+njs_vmcode_jit_exit(njs_vm_t *vm, njs_ret_t ret, njs_vmcode_generic_t *vmcode)
+{
+    njs_value_t  *value1, *value2;
+
+    if (ret < 0 && ret >= NJS_PREEMPT) {
+        value2 = (njs_value_t *) vmcode->operand1;
+        value1 = NULL;
+
+        switch (vmcode->code.operands) {
+
+        case NJS_VMCODE_3OPERANDS:
+            value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+            /* Fall through. */
+
+        case NJS_VMCODE_2OPERANDS:
+            value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        }
+
+        switch (ret) {
+
+        case NJS_TRAP_NUMBER:
+            value2 = value1;
+
+            /* Fall through. */
+
+        case NJS_TRAP_NUMBERS:
+        case NJS_TRAP_STRINGS:
+        case NJS_TRAP_INCDEC:
+        case NJS_TRAP_PROPERTY:
+
+            njs_vm_trap(vm, ret - NJS_TRAP_BASE, value1, value2);
+
+            return 0;
+
+        case NJS_TRAP_NUMBER_ARG:
+        case NJS_TRAP_STRING_ARG:
+
+            ret = njs_vm_trap_argument(vm, ret - NJS_TRAP_BASE);
+            if (nxt_fast_path(ret == NXT_OK)) {
+                return 0;
+            }
+
+            return ret;
+
+        default:
+            return ret;
+        }
+    }
+
+    vm->current += ret;
+
+    return 0;
 }
 
+#endif
+
 
 njs_ret_t
 njs_vm_value_to_ext_string(njs_vm_t *vm, nxt_str_t *dst, const njs_value_t *src,
@@ -3186,6 +4518,11 @@ again:
                 memcpy(start, value.short_string.start, size);
 
             } else {
+                ret = njs_string_flat(vm, &value);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return NXT_ERROR;
+                }
+
                 size = value.long_string.size;
                 start = value.long_string.data->start;
             }
@@ -3305,7 +4642,7 @@ njs_object_value_to_string(njs_vm_t *vm, njs_value_t *value)
 
 static njs_ret_t
 njs_vmcode_value_to_string(njs_vm_t *vm, njs_value_t *invld1,
-    njs_value_t *invld2)
+    njs_value_t *invld2, njs_value_t *unused)
 {
     njs_ret_t  ret;
 
@@ -3339,6 +4676,7 @@ njs_value_number_set(njs_value_t *value, double num)
     value->data.u.number = num;
     value->type = NJS_NUMBER;
     value->data.truth = njs_is_number_true(num);
+    value->data.int32 = 0;
 }
 
 
@@ -3483,6 +4821,7 @@ njs_value_string_copy(njs_vm_t *vm, nxt_str_t *retval, njs_value_t *value,
     uintptr_t *next)
 {
     uintptr_t    n;
+    njs_value_t  val;
     njs_array_t  *array;
 
     switch (value->type) {
@@ -3505,9 +4844,9 @@ njs_value_string_copy(njs_vm_t *vm, nxt_str_t *retval, njs_value_t *value,
                 return NXT_DECLINED;
             }
 
-            value = &array->start[n];
+        } while (!njs_array_item_is_valid(&array->start[n]));
 
-        } while (!njs_is_valid(value));
+        value = njs_array_item_value(&array->start[n], &val);
 
         break;
 
@@ -3524,6 +4863,7 @@ njs_vm_add_backtrace_entry(njs_vm_t *vm, njs_frame_t *frame)
 {
     nxt_int_t              ret;
     nxt_uint_t             i;
+    nxt_array_t            *backtrace;
     njs_function_t         *function;
     njs_native_frame_t     *native_frame;
     njs_function_debug_t   *debug_entry;
@@ -3538,6 +4878,17 @@ njs_vm_add_backtrace_entry(njs_vm_t *vm, njs_frame_t *frame)
     native_frame = &frame->native;
     function = native_frame->function;
 
+    if (vm->backtrace == NULL) {
+        backtrace = nxt_array_create(4, sizeof(njs_backtrace_entry_t),
+                                     &njs_array_mem_proto, vm->mem_cache_pool);
+        if (nxt_slow_path(backtrace == NULL)) {
+            return NXT_ERROR;
+        }
+
+        vm->backtrace = backtrace;
+        vm->shared->init_stats.backtrace++;
+    }
+
     be = nxt_array_add(vm->backtrace, &njs_array_mem_proto, vm->mem_cache_pool);
     if (nxt_slow_path(be == NULL)) {
         return NXT_ERROR;
@@ -3634,8 +4985,8 @@ njs_debug(njs_index_t index, njs_value_t *value)
             p = value->short_string.start;
 
         } else {
-            length = value->long_string.size;
-            p = value->long_string.data->start;
+            p = njs_string_long_start(value);
+            length = (p != NULL) ? value->long_string.size : 0;
         }
 
         nxt_thread_log_debug("%p [\"%*s\"]", index, length, p);
@@ -56,6 +56,7 @@
 #define NJS_STRING_VALUE           2
 #define NJS_ARRAY_VALUE            3
 #define NJS_EXTERNAL_VALUE         4
+#define NJS_TYPED_ARRAY_VALUE      5
 
 
 /*
@@ -133,6 +134,9 @@ typedef enum {
     NJS_OBJECT_TYPE_ERROR     = 0x1e,
     NJS_OBJECT_URI_ERROR      = 0x1f,
     NJS_OBJECT_VALUE          = 0x20,
+    NJS_ARRAY_BUFFER          = 0x21,
+    NJS_TYPED_ARRAY           = 0x22,
+    NJS_DATA_VIEW             = 0x23,
 } njs_value_type_t;
 
 
@@ -158,9 +162,14 @@ typedef struct njs_function_lambda_s  njs_function_lambda_t;
 typedef struct njs_regexp_s           njs_regexp_t;
 typedef struct njs_regexp_pattern_s   njs_regexp_pattern_t;
 typedef struct njs_date_s             njs_date_t;
+typedef struct njs_array_buffer_s     njs_array_buffer_t;
+typedef struct njs_typed_array_s      njs_typed_array_t;
 typedef struct njs_frame_s            njs_frame_t;
 typedef struct njs_native_frame_s     njs_native_frame_t;
 typedef struct njs_property_next_s    njs_property_next_t;
+typedef struct njs_object_shape_s     njs_object_shape_t;
+typedef struct njs_jit_code_s         njs_jit_code_t;
+typedef union njs_object_slot_u       njs_object_slot_t;
 typedef struct njs_parser_scope_s     njs_parser_scope_t;
 
 
@@ -190,8 +199,10 @@ union njs_value_s {
          */
         uint8_t                       truth;
 
-        uint16_t                      _spare1;
-        uint32_t                      _spare2;
+        /* The int32 flag and integer field of NJS_NUMBER, see below. */
+        uint8_t                       int32;   /* 1 bit */
+        uint8_t                       _spare1;
+        int32_t                       integer;
 
         union {
             double                    number;
@@ -202,6 +213,8 @@ union njs_value_s {
             njs_function_lambda_t     *lambda;
             njs_regexp_t              *regexp;
             njs_date_t                *date;
+            njs_array_buffer_t        *array_buffer;
+            njs_typed_array_t         *typed_array;
             njs_prop_handler_t        prop_handler;
             njs_value_t               *value;
             njs_property_next_t       *next;
@@ -225,7 +238,7 @@ union njs_value_s {
         njs_value_type_t              type:8;  /* 6 bits */
         uint8_t                       truth;
 
-        /* 0xff if data is external string. */
+        /* 0xff if data is external string, NJS_STRING_VIEW if view. */
         uint8_t                       external;
         uint8_t                       _spare;
 
@@ -254,6 +267,13 @@ struct njs_object_s {
     /* A shared hash of njs_object_prop_t. */
     nxt_lvlhsh_t                      shared_hash;
 
+    /*
+     * The shape and the slots of an object which stores its properties
+     * in the slots instead of the private hash, see njs_object_prop_add().
+     */
+    njs_object_shape_t                *shape;
+    njs_object_slot_t                 *slots;
+
     /* An object __proto__. */
     njs_object_t                      *__proto__;
 
@@ -261,6 +281,11 @@ struct njs_object_s {
     njs_value_type_t                  type:8;
     uint8_t                           shared;     /* 1 bit */
     uint8_t                           extensible; /* 1 bit */
+    /*
+     * The object belongs to a preinitialized global scope which is shared
+     * by all cloned VMs and must not be modified, see njs_vm_preinit().
+     */
+    uint8_t                           immutable;  /* 1 bit */
 };
 
 
@@ -271,12 +296,22 @@ struct njs_object_value_s {
 };
 
 
+#if (NXT_NAN_BOXING)
+/* The NaN-boxed array item, see njs_array.h. */
+typedef uint64_t                      njs_array_item_t;
+#else
+typedef njs_value_t                   njs_array_item_t;
+#endif
+
+
 struct njs_array_s {
     njs_object_t                      object;
     uint32_t                          size;
     uint32_t                          length;
-    njs_value_t                       *start;
-    njs_value_t                       *data;
+    njs_array_item_t                  *start;
+    njs_array_item_t                  *data;
+    /* The items kind, see njs_array_kind_t. */
+    uint8_t                           kind;
 };
 
 
@@ -305,6 +340,9 @@ struct njs_function_s {
     uint8_t                           native:1;
     uint8_t                           ctor:1;
 
+    /* A private copy of a shared native function, see njs_function.c. */
+    uint8_t                           overlay:1;
+
     union {
         njs_function_lambda_t         *lambda;
         njs_function_native_t         native;
@@ -337,6 +375,29 @@ struct njs_date_s {
 };
 
 
+struct njs_array_buffer_s {
+    njs_object_t                      object;
+    u_char                            *start;
+    /* The size is zero if the buffer has been detached. */
+    uint32_t                          size;
+    /* The list of buffers wrapping host memory, see njs_typed_array.c. */
+    njs_array_buffer_t                *next;
+};
+
+
+/* The typed array and the DataView view of an ArrayBuffer. */
+
+struct njs_typed_array_s {
+    njs_object_t                      object;
+    njs_array_buffer_t                *buffer;
+    uint32_t                          offset;
+    /* The number of elements, the size in bytes for DataView. */
+    uint32_t                          length;
+    /* The element type, see njs_typed_array_type_t. */
+    uint8_t                           type;
+};
+
+
 typedef union {
     njs_object_t                      object;
     njs_object_value_t                object_value;
@@ -344,6 +405,8 @@ typedef union {
     njs_function_t                    function;
     njs_regexp_t                      regexp;
     njs_date_t                        date;
+    njs_array_buffer_t                array_buffer;
+    njs_typed_array_t                 typed_array;
 } njs_object_prototype_t;
 
 
@@ -414,8 +477,13 @@ typedef struct {
 }
 
 
+/*
+ * An operation with the result writes it directly to the destination
+ * operand "dst", the other operations get NULL.
+ */
+
 typedef njs_ret_t (*njs_vmcode_operation_t)(njs_vm_t *vm, njs_value_t *value1,
-    njs_value_t *value2);
+    njs_value_t *value2, njs_value_t *dst);
 
 
 #define njs_is_null(value)                                                    \
@@ -456,6 +524,30 @@ typedef njs_ret_t (*njs_vmcode_operation_t)(njs_vm_t *vm, njs_value_t *value1,
     ((value)->type <= NJS_NUMBER)
 
 
+/*
+ * A number which is an int32 integer other than -0 can have the int32
+ * flag set, then the number is also stored in the integer field and the
+ * integer operations do not convert the double.  The flag is set by the
+ * integer operations and njs_value_int32_hint() for number literals, it
+ * is reset by njs_value_number_set(), so a number without the flag can
+ * still be an integer.  The code which stores a number directly must
+ * reset the flag.
+ */
+
+#define njs_is_int32(value)                                                   \
+    ((value)->type == NJS_NUMBER && (value)->data.int32)
+
+
+#define njs_value_int32_set(value, i)                                         \
+    do {                                                                      \
+        (value)->data.u.number = (i);                                         \
+        (value)->type = NJS_NUMBER;                                           \
+        (value)->data.truth = ((i) != 0);                                     \
+        (value)->data.int32 = 1;                                              \
+        (value)->data.integer = (i);                                          \
+    } while (0)
+
+
 #define njs_is_string(value)                                                  \
     ((value)->type == NJS_STRING)
 
@@ -478,9 +570,12 @@ typedef njs_ret_t (*njs_vmcode_operation_t)(njs_vm_t *vm, njs_value_t *value1,
             (str)->length = (value)->short_string.size;                       \
             (str)->start = (u_char *) (value)->short_string.start;            \
                                                                               \
-        } else {                                                              \
+        } else if ((value)->long_string.data->start != NULL) {                \
             (str)->length = (value)->long_string.size;                        \
             (str)->start = (u_char *) (value)->long_string.data->start;       \
+                                                                              \
+        } else {                                                              \
+            njs_string_rope_get(value, str);                                  \
         }                                                                     \
     } while (0)
 
@@ -544,6 +639,18 @@ typedef njs_ret_t (*njs_vmcode_operation_t)(njs_vm_t *vm, njs_value_t *value1,
     ((value)->type == NJS_DATE)
 
 
+#define njs_is_array_buffer(value)                                            \
+    ((value)->type == NJS_ARRAY_BUFFER)
+
+
+#define njs_is_typed_array(value)                                             \
+    ((value)->type == NJS_TYPED_ARRAY)
+
+
+#define njs_is_data_view(value)                                               \
+    ((value)->type == NJS_DATA_VIEW)
+
+
 #define njs_is_external(value)                                                \
     ((value)->type == NJS_EXTERNAL)
 
@@ -581,11 +688,58 @@ typedef njs_ret_t (*njs_vmcode_operation_t)(njs_vm_t *vm, njs_value_t *value1,
 #define NJS_VMCODE_RETVAL      1
 
 
+/*
+ * The opcodes are used by the threaded code interpreter to dispatch
+ * the most frequent operations without calling them.  All other
+ * operations are called by the NJS_VMCODE_GENERIC handler.
+ *
+ * The *_JUMP opcodes are superinstructions: a comparison followed by
+ * a conditional jump on its result, the most frequent operation pair.
+ * The comparison handler also performs the jump, the jump operation
+ * stays in place and is executed as usual if the comparison falls back
+ * to the generic handler or if the jump is a target of another jump.
+ */
+
+typedef enum {
+    NJS_VMCODE_GENERIC = 0,
+    NJS_VMCODE_MOVE,
+    NJS_VMCODE_JUMP,
+    NJS_VMCODE_IF_TRUE_JUMP,
+    NJS_VMCODE_IF_FALSE_JUMP,
+    NJS_VMCODE_ADDITION,
+    NJS_VMCODE_SUBSTRACTION,
+    NJS_VMCODE_MULTIPLICATION,
+    NJS_VMCODE_LESS,
+    NJS_VMCODE_LESS_OR_EQUAL,
+    NJS_VMCODE_GREATER,
+    NJS_VMCODE_GREATER_OR_EQUAL,
+    NJS_VMCODE_EQUAL,
+    NJS_VMCODE_NOT_EQUAL,
+    NJS_VMCODE_STRICT_EQUAL,
+    NJS_VMCODE_STRICT_NOT_EQUAL,
+    NJS_VMCODE_INCREMENT,
+    NJS_VMCODE_DECREMENT,
+    NJS_VMCODE_POST_INCREMENT,
+    NJS_VMCODE_POST_DECREMENT,
+    NJS_VMCODE_LESS_JUMP,
+    NJS_VMCODE_LESS_OR_EQUAL_JUMP,
+    NJS_VMCODE_GREATER_JUMP,
+    NJS_VMCODE_GREATER_OR_EQUAL_JUMP,
+    NJS_VMCODE_EQUAL_JUMP,
+    NJS_VMCODE_NOT_EQUAL_JUMP,
+    NJS_VMCODE_STRICT_EQUAL_JUMP,
+    NJS_VMCODE_STRICT_NOT_EQUAL_JUMP,
+} njs_vmcode_opcode_t;
+
+
 typedef struct {
     njs_vmcode_operation_t     operation;
     uint8_t                    operands;   /* 2 bits */
     uint8_t                    retval;     /* 1 bit  */
     uint8_t                    ctor;       /* 1 bit  */
+    uint8_t                    opcode;     /* 5 bits */
+    /* The inline cache slot of a property operation with constant name. */
+    uint32_t                   cache;
 } njs_vmcode_t;
 
 
@@ -704,6 +858,29 @@ typedef struct {
 } njs_vmcode_prop_set_t;
 
 
+/*
+ * The property cache entry maps an object layout to its own property
+ * found by a property operation with constant name: njs_object_shape_t
+ * to the slot number for objects with shapes, njs_object_t to
+ * njs_object_prop_t for objects with private hash, and njs_extern_t to
+ * the member njs_extern_t for external objects, NULL means that
+ * the external object has no such member.
+ */
+
+typedef struct {
+    const void                 *object;
+    void                       *value;
+} njs_property_cache_entry_t;
+
+
+#define NJS_PROPERTY_CACHE_WAYS  4
+
+typedef struct {
+    njs_property_cache_entry_t entry[NJS_PROPERTY_CACHE_WAYS];
+    uint32_t                   next;
+} njs_property_cache_t;
+
+
 typedef struct {
     njs_vmcode_t               code;
     njs_index_t                next;
@@ -850,6 +1027,13 @@ enum njs_prototypes_e {
     NJS_PROTOTYPE_DATE,
     NJS_PROTOTYPE_CRYPTO_HASH,
     NJS_PROTOTYPE_CRYPTO_HMAC,
+    NJS_PROTOTYPE_ARRAY_BUFFER,
+    NJS_PROTOTYPE_DATA_VIEW,
+    /* The typed arrays order is the njs_typed_array_type_t order. */
+    NJS_PROTOTYPE_UINT8_ARRAY,
+    NJS_PROTOTYPE_UINT16_ARRAY,
+    NJS_PROTOTYPE_UINT32_ARRAY,
+    NJS_PROTOTYPE_FLOAT64_ARRAY,
     NJS_PROTOTYPE_ERROR,
     NJS_PROTOTYPE_EVAL_ERROR,
     NJS_PROTOTYPE_INTERNAL_ERROR,
@@ -885,6 +1069,12 @@ enum njs_constructor_e {
     NJS_CONSTRUCTOR_DATE =           NJS_PROTOTYPE_DATE,
     NJS_CONSTRUCTOR_CRYPTO_HASH =    NJS_PROTOTYPE_CRYPTO_HASH,
     NJS_CONSTRUCTOR_CRYPTO_HMAC =    NJS_PROTOTYPE_CRYPTO_HMAC,
+    NJS_CONSTRUCTOR_ARRAY_BUFFER =   NJS_PROTOTYPE_ARRAY_BUFFER,
+    NJS_CONSTRUCTOR_DATA_VIEW =      NJS_PROTOTYPE_DATA_VIEW,
+    NJS_CONSTRUCTOR_UINT8_ARRAY =    NJS_PROTOTYPE_UINT8_ARRAY,
+    NJS_CONSTRUCTOR_UINT16_ARRAY =   NJS_PROTOTYPE_UINT16_ARRAY,
+    NJS_CONSTRUCTOR_UINT32_ARRAY =   NJS_PROTOTYPE_UINT32_ARRAY,
+    NJS_CONSTRUCTOR_FLOAT64_ARRAY =  NJS_PROTOTYPE_FLOAT64_ARRAY,
     NJS_CONSTRUCTOR_ERROR =          NJS_PROTOTYPE_ERROR,
     NJS_CONSTRUCTOR_EVAL_ERROR =     NJS_PROTOTYPE_EVAL_ERROR,
     NJS_CONSTRUCTOR_INTERNAL_ERROR = NJS_PROTOTYPE_INTERNAL_ERROR,
@@ -949,6 +1139,18 @@ enum njs_function_e {
     njs_global_scope_index(NJS_CONSTRUCTOR_FUNCTION)
 #define NJS_INDEX_REGEXP         njs_global_scope_index(NJS_CONSTRUCTOR_REGEXP)
 #define NJS_INDEX_DATE           njs_global_scope_index(NJS_CONSTRUCTOR_DATE)
+#define NJS_INDEX_ARRAY_BUFFER                                                \
+    njs_global_scope_index(NJS_CONSTRUCTOR_ARRAY_BUFFER)
+#define NJS_INDEX_DATA_VIEW                                                   \
+    njs_global_scope_index(NJS_CONSTRUCTOR_DATA_VIEW)
+#define NJS_INDEX_UINT8_ARRAY                                                 \
+    njs_global_scope_index(NJS_CONSTRUCTOR_UINT8_ARRAY)
+#define NJS_INDEX_UINT16_ARRAY                                                \
+    njs_global_scope_index(NJS_CONSTRUCTOR_UINT16_ARRAY)
+#define NJS_INDEX_UINT32_ARRAY                                                \
+    njs_global_scope_index(NJS_CONSTRUCTOR_UINT32_ARRAY)
+#define NJS_INDEX_FLOAT64_ARRAY                                               \
+    njs_global_scope_index(NJS_CONSTRUCTOR_FLOAT64_ARRAY)
 #define NJS_INDEX_OBJECT_ERROR   njs_global_scope_index(NJS_CONSTRUCTOR_ERROR)
 #define NJS_INDEX_OBJECT_EVAL_ERROR                                           \
     njs_global_scope_index(NJS_CONSTRUCTOR_EVAL_ERROR)
@@ -981,6 +1183,11 @@ enum njs_function_e {
       + njs_scope_offset(index)))
 
 
+#define njs_vmcode_retval(vm, vmcode)                                         \
+    ((vmcode)->code.retval ? njs_vmcode_operand(vm, (vmcode)->operand1)       \
+                           : NULL)
+
+
 typedef struct {
     const njs_vmcode_1addr_t  *code;
     nxt_bool_t                reference_value;
@@ -1022,6 +1229,9 @@ struct njs_vm_s {
     nxt_lvlhsh_t             values_hash;
     nxt_lvlhsh_t             modules_hash;
 
+    /* The private copies of shared native functions. */
+    nxt_lvlhsh_t             overlays_hash;
+
     uint32_t                 event_id;
     nxt_lvlhsh_t             events_hash;
     nxt_queue_t              posted_events;
@@ -1048,6 +1258,15 @@ struct njs_vm_s {
     nxt_regex_context_t      *regex_context;
     nxt_regex_match_data_t   *single_match_data;
 
+    /*
+     * The patterns compiled in the VM memory.  The list is allocated
+     * outside of the VM memory, so it does not retain the patterns
+     * and the regexes of unreachable patterns are freed by the collector.
+     */
+    njs_regexp_pattern_t     **patterns;
+    nxt_uint_t               npatterns;
+    nxt_uint_t               patterns_size;
+
     /*
      * MemoryError is statically allocated immutable Error object
      * with the generic type NJS_OBJECT_INTERNAL_ERROR.
@@ -1056,6 +1275,27 @@ struct njs_vm_s {
 
     nxt_array_t              *code;  /* of njs_vm_code_t */
 
+    /*
+     * The property caches are private to the VM and are indexed by
+     * the njs_vmcode_t.cache slot numbers assigned by the generator.
+     */
+    njs_property_cache_t     *property_cache;
+    uint32_t                 property_cache_size;
+    uint32_t                 property_cache_slots;
+
+    /* The root of the object shapes transition tree. */
+    njs_object_shape_t       *shape_root;
+
+    /* The garbage collector state, see njs_gc.c. */
+    size_t                   gc_threshold;
+    size_t                   gc_trigger;
+    uint32_t                 gc_ticks;
+    uint32_t                 gc_depth;
+    njs_vm_gc_stats_t        gc_stats;
+
+    /* The ArrayBuffers wrapping host memory, see njs_vm_array_buffer_wrap(). */
+    njs_array_buffer_t       *wrapped_buffers;
+
     nxt_trace_t              trace;
     nxt_random_t             random;
 
@@ -1064,6 +1304,7 @@ struct njs_vm_s {
 
     uint8_t                  trailer;  /* 1 bit */
     uint8_t                  accumulative; /* 1 bit */
+    uint8_t                  cloned;  /* 1 bit */
 };
 
 
@@ -1089,139 +1330,166 @@ struct njs_vm_shared_s {
     njs_function_t           constructors[NJS_CONSTRUCTOR_MAX];
 
     njs_regexp_pattern_t     *empty_regexp_pattern;
+
+    /*
+     * The patterns shared by the VM clones are allocated in the memory
+     * of the VM which has created the shared data.
+     */
+    njs_vm_t                 *patterns_owner;
+    nxt_lvlhsh_t             patterns_hash;
+    nxt_uint_t               npatterns;
+
+    njs_vm_init_stats_t      init_stats;
+
+#if (NXT_JIT)
+    /* The VM which has created the shared data and frees the JIT code. */
+    njs_vm_t                 *jit_owner;
+    njs_jit_code_t           *jit_code;
+    nxt_uint_t               jit_threshold;
+#endif
 };
 
 
 nxt_int_t njs_vmcode_interpreter(njs_vm_t *vm);
 
+#if (NXT_HAVE_COMPUTED_GOTO)
+nxt_int_t njs_vmcode_opcodes(njs_vm_t *vm, u_char *start, u_char *end);
+#endif
+
+
 void njs_value_retain(njs_value_t *value);
 void njs_value_release(njs_vm_t *vm, njs_value_t *value);
 
 njs_ret_t njs_vmcode_object(njs_vm_t *vm, njs_value_t *inlvd1,
-    njs_value_t *inlvd2);
+    njs_value_t *inlvd2, njs_value_t *dst);
 njs_ret_t njs_vmcode_array(njs_vm_t *vm, njs_value_t *inlvd1,
-    njs_value_t *inlvd2);
+    njs_value_t *inlvd2, njs_value_t *dst);
 njs_ret_t njs_vmcode_function(njs_vm_t *vm, njs_value_t *inlvd1,
-    njs_value_t *invld2);
+    njs_value_t *invld2, njs_value_t *dst);
 njs_ret_t njs_vmcode_regexp(njs_vm_t *vm, njs_value_t *inlvd1,
-    njs_value_t *invld2);
+    njs_value_t *invld2, njs_value_t *dst);
 njs_ret_t njs_vmcode_object_copy(njs_vm_t *vm, njs_value_t *value,
-    njs_value_t *invld);
+    njs_value_t *invld, njs_value_t *dst);
+
+void njs_property_cache_flush(njs_vm_t *vm);
 
 njs_ret_t njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *property);
+    njs_value_t *property, njs_value_t *dst);
 njs_ret_t njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *property);
+    njs_value_t *property, njs_value_t *unused);
 njs_ret_t njs_vmcode_property_in(njs_vm_t *vm, njs_value_t *property,
-    njs_value_t *object);
+    njs_value_t *object, njs_value_t *dst);
 njs_ret_t njs_vmcode_property_delete(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *property);
+    njs_value_t *property, njs_value_t *dst);
 njs_ret_t njs_vmcode_property_foreach(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *invld);
+    njs_value_t *invld, njs_value_t *dst);
 njs_ret_t njs_vmcode_property_next(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *value);
+    njs_value_t *value, njs_value_t *unused);
 njs_ret_t njs_vmcode_instance_of(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *constructor);
+    njs_value_t *constructor, njs_value_t *dst);
 
 njs_ret_t njs_vmcode_increment(njs_vm_t *vm, njs_value_t *reference,
-    njs_value_t *value);
+    njs_value_t *value, njs_value_t *dst);
 njs_ret_t njs_vmcode_decrement(njs_vm_t *vm, njs_value_t *reference,
-    njs_value_t *value);
+    njs_value_t *value, njs_value_t *dst);
 njs_ret_t njs_vmcode_post_increment(njs_vm_t *vm, njs_value_t *reference,
-    njs_value_t *value);
+    njs_value_t *value, njs_value_t *dst);
 njs_ret_t njs_vmcode_post_decrement(njs_vm_t *vm, njs_value_t *reference,
-    njs_value_t *value);
+    njs_value_t *value, njs_value_t *dst);
 njs_ret_t njs_vmcode_typeof(njs_vm_t *vm, njs_value_t *value,
-    njs_value_t *invld);
+    njs_value_t *invld, njs_value_t *dst);
 njs_ret_t njs_vmcode_void(njs_vm_t *vm, njs_value_t *invld1,
-    njs_value_t *invld2);
+    njs_value_t *invld2, njs_value_t *dst);
 njs_ret_t njs_vmcode_delete(njs_vm_t *vm, njs_value_t *value,
-    njs_value_t *invld);
+    njs_value_t *invld, njs_value_t *dst);
 njs_ret_t njs_vmcode_unary_plus(njs_vm_t *vm, njs_value_t *value,
-    njs_value_t *invld);
+    njs_value_t *invld, njs_value_t *dst);
 njs_ret_t njs_vmcode_unary_negation(njs_vm_t *vm, njs_value_t *value,
-    njs_value_t *invld);
+    njs_value_t *invld, njs_value_t *dst);
 njs_ret_t njs_vmcode_addition(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_substraction(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_multiplication(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_exponentiation(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_division(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_remainder(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_logical_not(njs_vm_t *vm, njs_value_t *value,
-    njs_value_t *inlvd);
+    njs_value_t *inlvd, njs_value_t *dst);
 njs_ret_t njs_vmcode_test_if_true(njs_vm_t *vm, njs_value_t *value,
-    njs_value_t *invld);
+    njs_value_t *invld, njs_value_t *dst);
 njs_ret_t njs_vmcode_test_if_false(njs_vm_t *vm, njs_value_t *value,
-    njs_value_t *invld);
+    njs_value_t *invld, njs_value_t *dst);
 njs_ret_t njs_vmcode_bitwise_not(njs_vm_t *vm, njs_value_t *value,
-    njs_value_t *inlvd);
+    njs_value_t *inlvd, njs_value_t *dst);
 njs_ret_t njs_vmcode_bitwise_and(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_bitwise_xor(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_bitwise_or(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_left_shift(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_right_shift(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_unsigned_right_shift(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
-njs_ret_t njs_vmcode_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
+njs_ret_t njs_vmcode_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst);
 njs_ret_t njs_vmcode_not_equal(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
-njs_ret_t njs_vmcode_less(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2);
-njs_ret_t njs_vmcode_greater(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
+njs_ret_t njs_vmcode_less(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst);
+njs_ret_t njs_vmcode_greater(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2,
+    njs_value_t *dst);
 njs_ret_t njs_vmcode_less_or_equal(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_greater_or_equal(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_strict_equal(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 njs_ret_t njs_vmcode_strict_not_equal(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *dst);
 
-njs_ret_t njs_vmcode_move(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld);
+njs_ret_t njs_vmcode_move(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld,
+    njs_value_t *dst);
 
-njs_ret_t njs_vmcode_jump(njs_vm_t *vm, njs_value_t *invld,
-    njs_value_t *offset);
+njs_ret_t njs_vmcode_jump(njs_vm_t *vm, njs_value_t *invld, njs_value_t *offset,
+    njs_value_t *unused);
 njs_ret_t njs_vmcode_if_true_jump(njs_vm_t *vm, njs_value_t *cond,
-    njs_value_t *offset);
+    njs_value_t *offset, njs_value_t *unused);
 njs_ret_t njs_vmcode_if_false_jump(njs_vm_t *vm, njs_value_t *cond,
-    njs_value_t *offset);
+    njs_value_t *offset, njs_value_t *unused);
 njs_ret_t njs_vmcode_if_equal_jump(njs_vm_t *vm, njs_value_t *val1,
-    njs_value_t *val2);
+    njs_value_t *val2, njs_value_t *unused);
 
 njs_ret_t njs_vmcode_function_frame(njs_vm_t *vm, njs_value_t *value,
-    njs_value_t *nargs);
+    njs_value_t *nargs, njs_value_t *unused);
 njs_ret_t njs_vmcode_method_frame(njs_vm_t *vm, njs_value_t *object,
-    njs_value_t *method);
+    njs_value_t *method, njs_value_t *unused);
 njs_ret_t njs_vmcode_function_call(njs_vm_t *vm, njs_value_t *invld,
-    njs_value_t *retval);
+    njs_value_t *retval, njs_value_t *unused);
 njs_ret_t njs_vmcode_return(njs_vm_t *vm, njs_value_t *invld,
-    njs_value_t *retval);
-njs_ret_t njs_vmcode_stop(njs_vm_t *vm, njs_value_t *invld,
-    njs_value_t *retval);
+    njs_value_t *retval, njs_value_t *unused);
+njs_ret_t njs_vmcode_stop(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval,
+    njs_value_t *unused);
 
 njs_ret_t njs_vmcode_try_start(njs_vm_t *vm, njs_value_t *value,
-    njs_value_t *offset);
+    njs_value_t *offset, njs_value_t *unused);
 njs_ret_t njs_vmcode_try_end(njs_vm_t *vm, njs_value_t *invld,
-    njs_value_t *offset);
+    njs_value_t *offset, njs_value_t *unused);
 njs_ret_t njs_vmcode_throw(njs_vm_t *vm, njs_value_t *invld,
-    njs_value_t *retval);
+    njs_value_t *retval, njs_value_t *unused);
 njs_ret_t njs_vmcode_catch(njs_vm_t *vm, njs_value_t *invld,
-    njs_value_t *exception);
+    njs_value_t *exception, njs_value_t *unused);
 njs_ret_t njs_vmcode_finally(njs_vm_t *vm, njs_value_t *invld,
-    njs_value_t *retval);
+    njs_value_t *retval, njs_value_t *unused);
 
-nxt_bool_t njs_values_strict_equal(const njs_value_t *val1,
+njs_ret_t njs_values_strict_equal(njs_vm_t *vm, const njs_value_t *val1,
     const njs_value_t *val2);
 
 njs_ret_t njs_normalize_args(njs_vm_t *vm, njs_value_t *args,
@@ -96,16 +96,36 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("999999999999999999999"),
       nxt_string("1e+21") },
 
-#if 0
     { nxt_string("9223372036854775808"),
-      nxt_string("9223372036854775808") },
+      nxt_string("9223372036854776000") },
 
     { nxt_string("18446744073709551616"),
       nxt_string("18446744073709552000") },
 
     { nxt_string("1.7976931348623157E+308"),
       nxt_string("1.7976931348623157e+308") },
-#endif
+
+    { nxt_string("[0.1 + 0.2, 0.5, 1/3, -1e-7, 123e-20, 0.000001, 1e21,"
+                 " 3037000500 * 3037000500, 2**53, 5e-324, 2.5e-308]"),
+      nxt_string("0.30000000000000004,0.5,0.3333333333333333,-1e-7,1.23e-18,"
+                 "0.000001,1e+21,9223372037000250000,9007199254740992,"
+                 "5e-324,2.5e-308") },
+
+    { nxt_string("[123456789012345680000, 1e20 + 1e5, 0.1e-5, 12.5e2,"
+                 " parseFloat('1.' + '0'.repeat(900) + '1')]"),
+      nxt_string("123456789012345680000,100000000000000100000,0.000001,"
+                 "1250,1") },
+
+    /* The shortest digits closest to the value. */
+
+    { nxt_string("[65294498705027984, 3644913354975.7813, 2**-1022, 1e23,"
+                 " 5e-324 * 3, 2**1023]"),
+      nxt_string("65294498705027980,3644913354975.7812,"
+                 "2.2250738585072014e-308,1e+23,1.5e-323,"
+                 "8.98846567431158e+307") },
+
+    { nxt_string("JSON.stringify([0.1, -0.5, 1e21, 1.5e-7, 42])"),
+      nxt_string("[0.1,-0.5,1e+21,1.5e-7,42]") },
 
     { nxt_string("+1"),
       nxt_string("1") },
@@ -200,16 +220,16 @@ static njs_unit_test_t  njs_test[] =
       nxt_string("57") },
 
     { nxt_string("5.7e-1"),
-      nxt_string("0.570000") },
+      nxt_string("0.57") },
 
     { nxt_string("-5.7e-1"),
-      nxt_string("-0.570000") },
+      nxt_string("-0.57") },
 
     { nxt_string("1.1e-01"),
-      nxt_string("0.110000") },
+      nxt_string("0.11") },
 
     { nxt_string("5.7e-2"),
-      nxt_string("0.057000") },
+      nxt_string("0.057") },
 
     { nxt_string("1.1e+01"),
       nxt_string("11") },
@@ -606,7 +626,7 @@ static njs_unit_test_t  njs_test[] =
       nxt_string("NaN") },
 
     { nxt_string("var a = 0.1; a **= -2"),
-      nxt_string("100") },
+      nxt_string("99.99999999999999") },
 
     { nxt_string("var a = 1; a **= NaN"),
       nxt_string("NaN") },
@@ -823,6 +843,75 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("-2147483648 >>> -1"),
       nxt_string("1") },
 
+    { nxt_string("var a = 2147483647; a + 1"),
+      nxt_string("2147483648") },
+
+    { nxt_string("var a = -2147483648; a - 1"),
+      nxt_string("-2147483649") },
+
+    { nxt_string("var a = 65536; a * a"),
+      nxt_string("4294967296") },
+
+    { nxt_string("var a = -65536; a * 65536 | 0"),
+      nxt_string("0") },
+
+    { nxt_string("var a = 46341; [a * a, -a * a, a * a | 0]"),
+      nxt_string("2147488281,-2147488281,-2147479015") },
+
+    { nxt_string("var a = 0, b = -1; 1 / (a * b)"),
+      nxt_string("-Infinity") },
+
+    { nxt_string("var a = -5, b = 0; 1 / (a * b)"),
+      nxt_string("-Infinity") },
+
+    { nxt_string("var a = 5, b = 0; 1 / (a * b)"),
+      nxt_string("Infinity") },
+
+    { nxt_string("var a = 1, b = -1; 1 / (a + b)"),
+      nxt_string("Infinity") },
+
+    { nxt_string("var a = -0; 1 / (a + 0)"),
+      nxt_string("Infinity") },
+
+    { nxt_string("var a = 2147483647; a++; a"),
+      nxt_string("2147483648") },
+
+    { nxt_string("var a = 2147483647; ++a"),
+      nxt_string("2147483648") },
+
+    { nxt_string("var a = -2147483648; a--; [a, a | 0]"),
+      nxt_string("-2147483649,2147483647") },
+
+    { nxt_string("var a = 2147483647; [a++, a]"),
+      nxt_string("2147483647,2147483648") },
+
+    { nxt_string("var a = 1; a <<= 31; a"),
+      nxt_string("-2147483648") },
+
+    { nxt_string("var a = 1 << 30; [a * 2, (a * 2) | 0, a + a, a - -a]"),
+      nxt_string("2147483648,-2147483648,2147483648,2147483648") },
+
+    { nxt_string("var a = -1; [a >>> 0, (a >>> 0) + 1, (a >>> 0) | 0]"),
+      nxt_string("4294967295,4294967296,-1") },
+
+    { nxt_string("var a = 5, b = 0.5; [a + b, a * b, a - b, (a * b) | 0]"),
+      nxt_string("5.5,2.5,4.5,2") },
+
+    { nxt_string("var h = 0; for (var i = 0; i < 1000; i++) { h = (h * 31 + i) | 0 }; h"),
+      nxt_string("562641396") },
+
+    { nxt_string("var a = [1, 2, 3], s = 0; for (var i = 0; i < a.length; i++) s += a[i]; s"),
+      nxt_string("6") },
+
+    { nxt_string("var a = [1, , 3]; [a[1], a[1 + 1], a[-1], a[3]]"),
+      nxt_string(",3,,") },
+
+    { nxt_string("var a = [1, 2]; a[-1 | 0] = 5; a[1 | 0] = 7; [a, a[-1]]"),
+      nxt_string("1,7,5") },
+
+    { nxt_string("var a = [0, 1, 2]; a[2 - 1] = 'x'; a.length = 2; a[1 | 0]"),
+      nxt_string("x") },
+
 #if 0
     { nxt_string("9223372036854775808 >>> 0"),
       nxt_string("0") },
@@ -1140,6 +1229,27 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("null != undefined"),
       nxt_string("false") },
 
+    /* Comparisons fused with conditional jumps. */
+
+    { nxt_string("var a = [1, '1', null, undefined, NaN, 'a', {}], r = '', i;"
+                 "for (i = 0; i < a.length; i++) {"
+                 "    if (a[i] == 1) { r += 'e' }"
+                 "    if (a[i] != null) { r += 'n' }"
+                 "    if (a[i] === '1') { r += 's' }"
+                 "    if (a[i] !== a[i]) { r += 'N' }"
+                 "    if (a[i] < 'b') { r += 'l' }"
+                 "    if (!(a[i] >= 1)) { r += 'g' }"
+                 "    r += '|' }"
+                 "r"),
+      nxt_string("en|ensl|g|g|nNg|nlg|nlg|") },
+
+    { nxt_string("var n = 0, o = { valueOf: function() { n++; return 2 } }, i;"
+                 "for (i = 0; i < o; i++) {} [i, n]"),
+      nxt_string("2,3") },
+
+    { nxt_string("var i = 0, j = 10; while (i <= j) { i++; j-- } i + ':' + j"),
+      nxt_string("6:4") },
+
     { nxt_string("null < undefined"),
       nxt_string("false") },
 
@@ -2479,6 +2589,63 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("var x = { a: 1 }, b = delete x.a; x.a +' '+ b"),
       nxt_string("undefined true") },
 
+    /* Object shapes. */
+
+    { nxt_string("var o = {}, i, s = '';"
+                 "for (i = 0; i < 20; i++) { o['k' + i] = i }"
+                 "for (i = 0; i < 20; i++) { s += o['k' + i] }"
+                 "s +' '+ Object.keys(o).length"),
+      nxt_string("012345678910111213141516171819 20") },
+
+    { nxt_string("var o = {a:1, b:2, c:3}, r = [], p;"
+                 "delete o.b; o.d = 4;"
+                 "for (p in o) { r.push(p + o[p]) }"
+                 "o.b = 5; r +' '+ o.b +' '+ ('b' in o)"),
+      nxt_string("a1,c3,d4 5 true") },
+
+    { nxt_string("var a = {x:1, y:2}, b = {x:3, y:4}; b.y = 5;"
+                 "JSON.stringify(a) + JSON.stringify(b)"),
+      nxt_string("{\"x\":1,\"y\":2}{\"x\":3,\"y\":5}") },
+
+    { nxt_string("var o = {a:1}; Object.defineProperty(o, 'a', {value:2});"
+                 "Object.defineProperty(o, 'b', {value:3});"
+                 "o.a = 4; o.b = 5; o.a + o.b +' '+ Object.keys(o)"),
+      nxt_string("7 a") },
+
+    /* Property caches. */
+
+    { nxt_string("var a = [{x:1}, {x:2}, {y:0, x:3}, {x:4}, {x:5}], i, s = 0;"
+                 "for (i = 0; i < 10; i++) { s += a[i % 5].x } s"),
+      nxt_string("30") },
+
+    { nxt_string("var a = [{x:1}, {x:2}, {x:3}], i;"
+                 "for (i = 0; i < 6; i++) { a[i % 3].x += i } a[0].x + a[2].x"),
+      nxt_string("14") },
+
+    { nxt_string("var o = {a:1}, r = [], i;"
+                 "for (i = 0; i < 3; i++) {"
+                 "    r.push(o.a); if (i == 0) delete o.a; else o.a = 5 }"
+                 "r"),
+      nxt_string("1,,5") },
+
+    { nxt_string("var o = {a:1}, i;"
+                 "for (i = 0; i < 3; i++) {"
+                 "    o.a = i;"
+                 "    if (i == 1) Object.freeze(o) }"
+                 "o.a"),
+      nxt_string("1") },
+
+    { nxt_string("function F() {} F.prototype.x = 1;"
+                 "var o = new F(), r = [], i;"
+                 "for (i = 0; i < 2; i++) { r.push(o.x); o.x = 2 }"
+                 "r +' '+ F.prototype.x"),
+      nxt_string("1,2 1") },
+
+    { nxt_string("var o = {x:1}, p = {x:2}, r = [], i;"
+                 "for (i = 0; i < 4; i++) { r.push(o.x); o = (o.x == 1) ? p : o }"
+                 "r"),
+      nxt_string("1,2,2,2") },
+
     { nxt_string("delete null"),
       nxt_string("true") },
 
@@ -2959,6 +3126,17 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("var a = [1,2,3,4]; a.reverse()"),
       nxt_string("4,3,2,1") },
 
+    { nxt_string("var a = [NaN, -0, 2**60, null, undefined, true, 'abcde',"
+                 "           'abcdef', 'αβ', {}];"
+                 "a.reverse().map(function(v) { return typeof v + ':' + v })"),
+      nxt_string("object:[object Object],string:αβ,string:abcdef,"
+                 "string:abcde,boolean:true,undefined:undefined,object:null,"
+                 "number:1152921504606847000,number:-0,number:NaN") },
+
+    { nxt_string("var a = [-0, 'ab']; a.push('abcdefgh');"
+                 "1/a[0] + a.slice(1).join('')"),
+      nxt_string("-Infinityababcdefgh") },
+
     { nxt_string("var a = [1,2,3,4]; a.indexOf()"),
       nxt_string("-1") },
 
@@ -3043,6 +3221,51 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("[].includes.bind(0)(0, 0)"),
       nxt_string("false") },
 
+    { nxt_string("var a = [1,2,-0,NaN];"
+                 "[a.indexOf(0), a.lastIndexOf(+0), a.indexOf(NaN),"
+                 " a.includes(NaN), a.includes(0), a.indexOf('1')]"),
+      nxt_string("2,2,-1,true,true,-1") },
+
+    { nxt_string("var a = [1,2,3]; a[1] = 'x';"
+                 "[a.indexOf('x'), a.includes('x'), a.indexOf(3)]"),
+      nxt_string("1,true,2") },
+
+    { nxt_string("var a = [1,2,3]; delete a[1];"
+                 "[a.indexOf(undefined), a.reduce(function(s, v) { return s + v })]"),
+      nxt_string("-1,4") },
+
+    { nxt_string("var a = [1,2,3]; a[5] = 6;"
+                 "[a.lastIndexOf(undefined), a.reduceRight(function(s, v)"
+                 "                                        { return s + v })]"),
+      nxt_string("-1,12") },
+
+    { nxt_string("var a = [1,,3]; a.fill(7); [a.indexOf(7), 1 in a]"),
+      nxt_string("0,true") },
+
+    { nxt_string("var a = [1,,3]; a.fill('y', 1, 2);"
+                 "[a.indexOf('y'), a.indexOf(3), a.includes(1)]"),
+      nxt_string("1,2,true") },
+
+    { nxt_string("var a = [1,2,3]; a.length = 5;"
+                 "[a.indexOf(undefined), a.includes(3), a.slice(1).indexOf(3)]"),
+      nxt_string("-1,true,1") },
+
+    { nxt_string("var a = [1,2].concat(['3'], 4);"
+                 "[a.indexOf('3'), a.indexOf(4), a.slice(2).includes(3)]"),
+      nxt_string("2,3,false") },
+
+    { nxt_string("var a = [], i;"
+                 "for (i = 0; i < 20; i++) { a[i] = i * 2 }"
+                 "a[20] = 'x'; a.shift(); a[a.length] = 'y';"
+                 "[a.length, a.indexOf(38), a.indexOf('x'), a[20]]"),
+      nxt_string("21,18,19,y") },
+
+    { nxt_string("var a = [], i;"
+                 "for (i = 0; i < 30; i++) { a.push(i); a.shift() }"
+                 "for (i = 0; i < 30; i++) { a[a.length] = i }"
+                 "[a.length, a[29], a.indexOf(17)]"),
+      nxt_string("30,29,17") },
+
     { nxt_string("var a = []; var s = { sum: 0 };"
                  "a.forEach(function(v, i, a) { this.sum += v }, s); s.sum"),
       nxt_string("0") },
@@ -3423,6 +3646,45 @@ static njs_unit_test_t  njs_test[] =
                  "a.sort(function(x, y) { return x - y })"),
       nxt_string("1,") },
 
+    { nxt_string("var a = [3,1,,undefined,2,undefined];"
+                 "a.sort(function(x, y) { return x - y });"
+                 "[a, a.length, 3 in a, 4 in a, 5 in a, a[4]]"),
+      nxt_string("1,2,3,,,,6,true,true,false,") },
+
+    { nxt_string("['b',undefined,'a','undefined','c'].sort()"),
+      nxt_string("a,b,c,undefined,") },
+
+    { nxt_string("[10,9,1,100,true,null,'2'].sort()"),
+      nxt_string("1,10,100,2,9,,true") },
+
+    { nxt_string("[1,5,2,8,3,7].sort(function(x, y) { return y - x })"),
+      nxt_string("8,7,5,3,2,1") },
+
+    { nxt_string("[1,'5',2,'8'].sort(function(x, y) { return x - y })"),
+      nxt_string("1,2,5,8") },
+
+    { nxt_string("[3,1,2,5,4].sort(function(x, y) { return x > y })"),
+      nxt_string("1,2,3,4,5") },
+
+    { nxt_string("[9,8,7,6,5,4,3,2,1,0].sort(function(x, y) { return x - y })"),
+      nxt_string("0,1,2,3,4,5,6,7,8,9") },
+
+    { nxt_string("var a = [], i;"
+                 "for (i = 0; i < 20; i++) { a.push({k: i % 3, i: i}) }"
+                 "a.sort(function(x, y) { return x.k - y.k });"
+                 "a.map(function(v) { return v.i }).join()"),
+      nxt_string("0,3,6,9,12,15,18,1,4,7,10,13,16,19,2,5,8,11,14,17") },
+
+    { nxt_string("var n = 0, a = [5,4,3,2,1];"
+                 "a.sort(function(x, y) { n++; return x - y + 0 });"
+                 "a + ' ' + (n < 10)"),
+      nxt_string("1,2,3,4,5 true") },
+
+    { nxt_string("var a = [3,2,1];"
+                 "try { a.sort(function() { throw 'e' }) } catch (e) {}"
+                 "a"),
+      nxt_string("3,2,1") },
+
     /* Strings. */
 
     { nxt_string("var a = '0123456789' + '012345';"
@@ -3501,6 +3763,18 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("'abc'.toUTF8().length"),
       nxt_string("3") },
 
+    { nxt_string("var s = 'xyz'; s = s[1]; [s, s.charCodeAt(0), s.length]"),
+      nxt_string("y,121,1") },
+
+    { nxt_string("var s = 'abcdefghijklmnopq'; s = s + s; s"),
+      nxt_string("abcdefghijklmnopqabcdefghijklmnopq") },
+
+    { nxt_string("var s = 'abcdefghijklmnopq', t = 'rs'; t = s + t; t"),
+      nxt_string("abcdefghijklmnopqrs") },
+
+    { nxt_string("var o = {n:{n:1}}; o = o.n; o.n"),
+      nxt_string("1") },
+
     { nxt_string("'абв'.length"),
       nxt_string("3") },
 
@@ -3552,6 +3826,55 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("var a = 'abc'; a.concat('абв', 123)"),
       nxt_string("abcабв123") },
 
+    { nxt_string("var s = '', i;"
+                 "for (i = 0; i < 1000; i++) { s += 'a' + i }"
+                 "[s.length, s[3], s.slice(-4), s.indexOf('a999')]"),
+      nxt_string("3890,1,a999,3886") },
+
+    { nxt_string("var s = '', i;"
+                 "for (i = 0; i < 100; i++) { s = s + 'αβγ' }"
+                 "[s.length, s[299], s.substr(150, 3), s == 'αβγ'.repeat(100)]"),
+      nxt_string("300,γ,αβγ,true") },
+
+    { nxt_string("var a = 'x'.repeat(200), b = a + a, c = b + a, o = {};"
+                 "o[c + 'y'] = 1; [c.length, o[a + b + 'y'], b + c == c + b]"),
+      nxt_string("600,1,true") },
+
+    { nxt_string("var a = 'x'.repeat(200);"
+                 "a.concat(a, 'y', a).length"),
+      nxt_string("601") },
+
+    { nxt_string("function r(c) { return c.repeat(200) + c.repeat(100) }"
+                 "[r('a') === r('a'), r('a') !== r('b'), r('a') == r('a'),"
+                 " r('a') < r('b'), r('b') >= r('a'), r('a') > r('a')]"),
+      nxt_string("true,true,true,true,true,false") },
+
+    { nxt_string("function r(c) { return c.repeat(200) + c.repeat(100) }"
+                 "[r('a').indexOf('a'.repeat(300)), r('ab').indexOf('b'),"
+                 " [r('x')].indexOf(r('x')), [r('x')].includes(r('x')),"
+                 " [r('y')].lastIndexOf(r('y'))]"),
+      nxt_string("0,1,0,true,0") },
+
+    { nxt_string("function r(c) { return c.repeat(200) + c.repeat(100) }"
+                 "var s = r('ab');"
+                 "[s[3], s.slice(-3), s.split('b').length,"
+                 " s.replace(/a/g, '').length, s.toUpperCase()[5],"
+                 " (r('a') + 'b').replace(r('a'), 'c')]"),
+      nxt_string("b,bab,301,300,B,cb") },
+
+    { nxt_string("function r(c) { return c.repeat(200) + c.repeat(100) }"
+                 "var v; switch (r('a')) { case r('b'): v = 'b'; break;"
+                 "                         case r('a'): v = 'a' } v"),
+      nxt_string("a") },
+
+    { nxt_string("function r(c) { return c.repeat(200) + c.repeat(100) }"
+                 "[[r('b'), r('a')].sort()[0] === r('a'),"
+                 " [r('a'), r('b')].join(r('-')).length,"
+                 " JSON.stringify(r('a')).length,"
+                 " String(new Error(r('m'))).length,"
+                 " +(' '.repeat(300) + '5'), r('1') in [1]]"),
+      nxt_string("true,900,302,307,5,false") },
+
     { nxt_string("''.concat.call(0, 1, 2, 3, 4, 5, 6, 7, 8, 9)"),
       nxt_string("0123456789") },
 
@@ -3884,6 +4207,13 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("var p1 = $r.props, p2 = $r2.props; '' + p1.a + p2.a"),
       nxt_string("12") },
 
+    { nxt_string("var s = '', i;"
+                 "for (i = 0; i < 3; i++) {"
+                 "    s += [$r, $r2][i % 2].props.a"
+                 "         + $r.header['User-Agent'].length }"
+                 "s"),
+      nxt_string("117217117") },
+
     { nxt_string("var a = $r.host; a +' '+ a.length +' '+ a"),
       nxt_string("АБВГДЕЁЖЗИЙ 22 АБВГДЕЁЖЗИЙ") },
 
@@ -4116,6 +4446,32 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("'абв абв абвгдежз'.includes('абвгд', 9)"),
       nxt_string("false") },
 
+    { nxt_string("var s = 'abcdefghij'.repeat(10) + 'xyz'"
+                 "        + 'abcdefghij'.repeat(10);"
+                 "[s.indexOf('xyz'), s.indexOf('jx'), s.indexOf('xy', 101),"
+                 " s.lastIndexOf('ja'), s.lastIndexOf('zab', 90),"
+                 " s.includes('zz')]"),
+      nxt_string("100,99,-1,192,-1,false") },
+
+    { nxt_string("var s = 'я'.repeat(70) + 'xyz' + 'я'.repeat(70) + 'xyz';"
+                 "[s.indexOf('xyz'), s.indexOf('xyz', 73), s.lastIndexOf('xyz'),"
+                 " s.lastIndexOf('яx', 100), s.includes('zя', 72)]"),
+      nxt_string("70,143,143,69,true") },
+
+    { nxt_string("var s = 'я'.repeat(64);"
+                 "[s.lastIndexOf('я'), s.lastIndexOf('я', 64),"
+                 " s.lastIndexOf('', 64), s.substring(64).length,"
+                 " s.substring(10, 10).length, s.slice(31, 31).length]"),
+      nxt_string("63,63,64,0,0,0") },
+
+    { nxt_string("('a,b;'.repeat(30) + 'c').split(',').length"
+                 "+ ('α,β;'.repeat(30) + 'γ').split(';').length"),
+      nxt_string("62") },
+
+    { nxt_string("[('x'.repeat(50) + 'ab').replace('ab', '!').length,"
+                 " ('я'.repeat(50) + 'ab').replace('ab', '!').length]"),
+      nxt_string("51,51") },
+
     { nxt_string("''.startsWith('')"),
       nxt_string("true") },
 
@@ -4482,6 +4838,51 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("'0123456789'.split('').reverse().join('')"),
       nxt_string("9876543210") },
 
+    /* Long substrings share the parent string bytes. */
+
+    { nxt_string("var s = 'abcdefghij'.repeat(10), v = s.slice(5, 95);"
+                 "[v.length, v.slice(10, 80).substr(20, 30).substring(5, 25)]"),
+      nxt_string("90,abcdefghijabcdefghij") },
+
+    { nxt_string("var s = 'abcdefghij'.repeat(10), v = s.substr(3, 60);"
+                 "v == s.substring(3, 63) && v.length"),
+      nxt_string("60") },
+
+    { nxt_string("var s = 'abcdefghij'.repeat(100);"
+                 "s.slice(500, 520) + s.slice(1, 999).length"),
+      nxt_string("abcdefghijabcdefghij998") },
+
+    { nxt_string("var p = ('abcdefghij'.repeat(5) + '|'"
+                 "         + '0123456789'.repeat(5)).split('|');"
+                 "p[0].length + p[1].length + p[1].charAt(33)"),
+      nxt_string("1003") },
+
+    { nxt_string("var p = ('x'.repeat(40) + '|' + 'y'.repeat(40)).split(/\\|/);"
+                 "p[1].length + ' ' + (p[0] + p[1]).indexOf('y')"),
+      nxt_string("40 40") },
+
+    { nxt_string("var m = /(b+)c/.exec('a' + 'b'.repeat(40) + 'c');"
+                 "m[1].length + ' ' + m[1].lastIndexOf('b')"),
+      nxt_string("40 39") },
+
+    { nxt_string("var s = 'ab'.repeat(40);"
+                 "s.replace(/(a)(b.+a)/,"
+                 "          function(m, p1, p2) { return p2.length + p2[0] })"),
+      nxt_string("78bb") },
+
+    { nxt_string("var s = 'α'.repeat(100) + ',' + 'β'.repeat(100),"
+                 "    p = s.split(',');"
+                 "[p[0].length, p[0].charAt(70), p[1].substr(60, 3)]"),
+      nxt_string("100,α,βββ") },
+
+    { nxt_string("var m = /(α+)/.exec('α'.repeat(100) + 'β');"
+                 "[m[1].length, m[1].charAt(80), m[1].indexOf('α', 90)]"),
+      nxt_string("100,α,90") },
+
+    { nxt_string("var s = 'α'.repeat(100);"
+                 "[s.substr(3, 50).charAt(45), s.slice(10, 42).charAt(31)]"),
+      nxt_string("α,α") },
+
     { nxt_string("'abc'.repeat(3)"),
       nxt_string("abcabcabc") },
 
@@ -5230,11 +5631,21 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("/"),
       nxt_string("SyntaxError: Unterminated RegExp \"/\" in 1") },
 
+#if (NXT_HAVE_PCRE2)
+    { nxt_string("/(/.test('')"),
+      nxt_string("SyntaxError: pcre2_compile(\"(\") failed: "
+                 "missing closing parenthesis in 1") },
+
+    { nxt_string("/+/.test('')"),
+      nxt_string("SyntaxError: pcre2_compile(\"+\") failed: "
+                 "quantifier does not follow a repeatable item at \"+\" in 1") },
+#else
     { nxt_string("/(/.test('')"),
       nxt_string("SyntaxError: pcre_compile(\"(\") failed: missing ) in 1") },
 
     { nxt_string("/+/.test('')"),
       nxt_string("SyntaxError: pcre_compile(\"+\") failed: nothing to repeat at \"+\" in 1") },
+#endif
 
     { nxt_string("/^$/.test('')"),
       nxt_string("true") },
@@ -5346,6 +5757,58 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("var r = new RegExp('abc', 'i'); r.test('00ABC11')"),
       nxt_string("true") },
 
+    { nxt_string("var a = /x/g, b = new RegExp('x', 'g'); a.exec('xx');"
+                 "[a === b, a.lastIndex, b.lastIndex]"),
+      nxt_string("false,1,0") },
+
+    { nxt_string("[new RegExp('a'), new RegExp('a', 'i'), new RegExp('a'),"
+                 " new RegExp('a', 'gm')]"),
+      nxt_string("/a/,/a/i,/a/,/a/gm") },
+
+    { nxt_string("var s = 'a\\xAAb'.toBytes(), r = /(\\w)(.)b/;"
+                 "[r.test(s), s.search(/b/), r.exec(s).length,"
+                 " s.split(/\\xAA/).length, r.test('ab'), r.test('a-b')]"),
+      nxt_string("true,2,3,2,false,true") },
+
+    { nxt_string("var r = /^\\/api\\/v[0-9]+\\//;"
+                 "[r.test('/api/v2/x'), r.test('x/api/v2/'), r.test('/api/')]"),
+      nxt_string("true,false,false") },
+
+    { nxt_string("var r = /\\.php$/;"
+                 "[r.test('a.php'), r.test('a.php\\n'), r.test('a.phpx')]"),
+      nxt_string("true,true,false") },
+
+    { nxt_string("var r = /Bearer (.+)/; r.exec('x Bearer tok')[1]"
+                 " + r.exec('bearer tok')"),
+      nxt_string("toknull") },
+
+    { nxt_string("[/a?b/.test('b'), /ab?c/.test('ac'), /a{0}z/.test('z'),"
+                 " /é?x/.test('x'), /aé+b/.test('aééb'), /^abc/m.test('x\\nabc'),"
+                 " /ab|cd/.test('cd'), /ab/i.test('AB'), /a\\nb/.test('a\\nb')]"),
+      nxt_string("true,true,true,true,true,true,true,true,true") },
+
+    { nxt_string("[/^x?|y/.test('y'), /^a\\d|y/.test('y'), /^a.|y/.test('y'),"
+                 " /^ab?|c/.test('c'), /^http\\w*:|mailto:/.test('mailto:x'),"
+                 " /^a(b|c)d/.test('acd'), /^ab/.test('xab')]"),
+      nxt_string("true,true,true,true,true,true,false") },
+
+    { nxt_string("['xyz'.search(/^a.|y/), 'xyz'.match(/^a.|y/),"
+                 " 'xyz'.replace(/^a.|y/, '-'), 'xyz'.split(/^a.|y/)]"),
+      nxt_string("1,y,x-z,x,z") },
+
+    { nxt_string("[/\\v/.test('\\n'), 'a\\n\\x0b'.search(/\\v/),"
+                 " /a\\vb/.test('a\\nb')]"),
+      nxt_string("true,1,true") },
+
+    { nxt_string("var r = /ab/g, s = 'abxab';"
+                 "[r.exec(s).index, r.exec(s).index, r.exec(s), r.lastIndex]"),
+      nxt_string("0,3,,0") },
+
+    { nxt_string("['xyz'.replace(/ab/g, '-'), 'xyz'.split(/ab/),"
+                 " 'xyz'.match(/ab/g), 'xyz'.search(/ab/),"
+                 " 'abxab'.replace(/ab/g, '-'), 'abxab'.split(/ab/).length]"),
+      nxt_string("xyz,xyz,,-1,-x-,3") },
+
     { nxt_string("[0].map(RegExp().toString)"),
       nxt_string("TypeError: 'this' argument is not a regexp") },
 
@@ -6256,6 +6719,21 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("function f() {} f.__proto__ === Function.prototype"),
       nxt_string("true") },
 
+    { nxt_string("[].push.__proto__ === Function.prototype"),
+      nxt_string("true") },
+
+    { nxt_string("[].push instanceof Function"),
+      nxt_string("true") },
+
+    { nxt_string("Array.prototype.push.x = 1; [].push.x"),
+      nxt_string("1") },
+
+    { nxt_string("var p = [].push; p.y = 2; [p === [].push, [].push.y]"),
+      nxt_string("true,2") },
+
+    { nxt_string("var p = [].push; p.y = 2; var a = [1]; a.push(2); a"),
+      nxt_string("1,2") },
+
     { nxt_string("RegExp()"),
       nxt_string("/(?:)/") },
 
@@ -6348,6 +6826,18 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("Object.prototype.toString.call(/./)"),
       nxt_string("[object RegExp]") },
 
+    { nxt_string("Object.prototype.toString.call(new TypeError())"),
+      nxt_string("[object TypeError]") },
+
+    { nxt_string("Object.prototype.toString.call(new URIError())"),
+      nxt_string("[object URIError]") },
+
+    { nxt_string("Object.prototype.toString.call(new ArrayBuffer(1))"),
+      nxt_string("[object ArrayBuffer]") },
+
+    { nxt_string("Object.prototype.toString.call(new Float64Array(1))"),
+      nxt_string("[object Float64Array]") },
+
     { nxt_string("var p = { a:5 }; var o = Object.create(p); o.a"),
       nxt_string("5") },
 
@@ -7318,10 +7808,175 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("eval()"),
       nxt_string("InternalError: Not implemented") },
 
+    /* Typed arrays. */
+
+    { nxt_string("var a = new Uint8Array(4); a[0] = 257; a[1] = -1; a[2] = 3.7;"
+                 "[a[0], a[1], a[2], a[3], a[4], a.length]"),
+      nxt_string("1,255,3,0,,4") },
+
+    { nxt_string("var a = new Uint16Array([65537, -1, '7']);"
+                 "[a[0], a[1], a[2]]"),
+      nxt_string("1,65535,7") },
+
+    { nxt_string("var a = new Uint32Array([4294967295, -2, 2147483648]);"
+                 "[a[0], a[1], a[2], a[0] + 1]"),
+      nxt_string("4294967295,4294967294,2147483648,4294967296") },
+
+    { nxt_string("var a = new Float64Array([1.5, NaN, -0.25]);"
+                 "[a[0] * 2, a[1], a[2] * 4]"),
+      nxt_string("3,NaN,-1") },
+
+    { nxt_string("var a = new Uint8Array(2); a[2] = 1; a[-1] = 1;"
+                 "[a[2], a[-1], a.length]"),
+      nxt_string(",,2") },
+
+    { nxt_string("var u = new Uint8Array(4); u[1.5] = 7; u[-1] = 3; u[-0] = 5;"
+                 "[u[1.5], u[-1], u[-0], u[0], 1.5 in u, -1 in u, -0 in u,"
+                 " Object.keys(u)]"),
+      nxt_string(",,5,5,false,false,true,0,1,2,3") },
+
+    { nxt_string("var u = new Uint8Array(2); u['-0'] = 1; u.NaN = 1;"
+                 " u['Infinity'] = 1; u['1.0'] = 2; u['01'] = 3;"
+                 "[u['-0'], u.NaN, u.Infinity, u['1.0'], u['01'],"
+                 " Object.keys(u)]"),
+      nxt_string(",,,2,3,0,1,1.0,01") },
+
+    { nxt_string("var a = new Uint8Array(2); a['1'] = 5;"
+                 "[a[1], 0 in a, 2 in a, delete a[0]]"),
+      nxt_string("5,true,false,false") },
+
+    { nxt_string("var a = new Uint8Array(3); a.x = 1;"
+                 "var s = ''; for (var k in a) { s += k }"
+                 "s + ' ' + Object.keys(a)"),
+      nxt_string("012x 0,1,2,x") },
+
+    { nxt_string("var b = new ArrayBuffer(8);"
+                 "var f = new Float64Array(b), u = new Uint8Array(b);"
+                 "f[0] = 2; [u[7] || u[0], b.byteLength]"),
+      nxt_string("64,8") },
+
+    { nxt_string("var b = new ArrayBuffer(8);"
+                 "var u16 = new Uint16Array(b, 2, 2), u8 = new Uint8Array(b);"
+                 "u16[0] = 0xffff;"
+                 "[u8[1], u8[2], u8[3], u16.byteOffset, u16.byteLength,"
+                 " u16.length]"),
+      nxt_string("0,255,255,2,4,2") },
+
+    { nxt_string("var a = new Uint8Array([1, 2, 3, 4, 5]);"
+                 "var s = a.subarray(1, -1); s[0] = 9;"
+                 "[a[1], s.length, s.byteOffset, s.buffer === a.buffer]"),
+      nxt_string("9,3,1,true") },
+
+    { nxt_string("var a = new Uint8Array([1, 2, 3, 4]);"
+                 "var s = a.slice(-2); s[0] = 0;"
+                 "[a[2], s[0], s[1], s.length, s.buffer === a.buffer]"),
+      nxt_string("3,0,4,2,false") },
+
+    { nxt_string("var a = new Uint8Array(5); a.fill(7, 1, -1); a.fill(1, 4);"
+                 "[a[0], a[1], a[3], a[4]]"),
+      nxt_string("0,7,7,1") },
+
+    { nxt_string("var a = new Uint16Array(4);"
+                 "a.set([1, 2], 2); a.set(new Uint16Array([3]));"
+                 "[a[0], a[1], a[2], a[3]]"),
+      nxt_string("3,0,1,2") },
+
+    { nxt_string("var a = new Uint8Array([1, 2, 3, 4]);"
+                 "a.set(new Uint16Array(a.buffer, 0, 1), 1);"
+                 "[a[0], a[1], a[2]]"),
+      nxt_string("1,1,3") },
+
+    { nxt_string("var a = new Float64Array(new Uint8Array([1, 255]));"
+                 "[a[0], a[1]]"),
+      nxt_string("1,255") },
+
+    { nxt_string("new Uint8Array(4).set([1], 4)"),
+      nxt_string("RangeError: offset is out of bounds") },
+
+    { nxt_string("Uint8Array(1)"),
+      nxt_string("TypeError: Constructor Uint8Array requires 'new'") },
+
+    { nxt_string("new Uint8Array(-1)"),
+      nxt_string("RangeError: Invalid index") },
+
+    { nxt_string("new Uint16Array(new ArrayBuffer(3))"),
+      nxt_string("RangeError: byte length of Uint16Array "
+                 "should be a multiple of 2") },
+
+    { nxt_string("new Uint32Array(new ArrayBuffer(8), 2)"),
+      nxt_string("RangeError: start offset of Uint32Array "
+                 "should be a multiple of 4") },
+
+    { nxt_string("new Uint8Array(new ArrayBuffer(4), 1, 4)"),
+      nxt_string("RangeError: Invalid typed array length: 4") },
+
+    { nxt_string("Uint8Array.prototype.fill.call([], 1)"),
+      nxt_string("TypeError: cannot convert array to typed array") },
+
+    { nxt_string("[Uint8Array.BYTES_PER_ELEMENT, Uint16Array.BYTES_PER_ELEMENT,"
+                 " Uint32Array.BYTES_PER_ELEMENT,"
+                 " new Float64Array(1).BYTES_PER_ELEMENT]"),
+      nxt_string("1,2,4,8") },
+
+    { nxt_string("[Uint8Array.prototype.length, Float64Array.name,"
+                 " Uint16Array.length]"),
+      nxt_string(",Float64Array,3") },
+
+    { nxt_string("new Uint32Array(2).__proto__ === Uint32Array.prototype"),
+      nxt_string("true") },
+
+    { nxt_string("new ArrayBuffer(10).slice(2, -3).byteLength"),
+      nxt_string("5") },
+
+    { nxt_string("[ArrayBuffer.isView(new DataView(new ArrayBuffer(1))),"
+                 " ArrayBuffer.isView(new ArrayBuffer(1)),"
+                 " ArrayBuffer.isView()]"),
+      nxt_string("true,false,false") },
+
+    { nxt_string("new ArrayBuffer()"),
+      nxt_string("[object ArrayBuffer]") },
+
+    { nxt_string("var d = new DataView(new ArrayBuffer(8));"
+                 "d.setUint16(0, 0x1234); d.setUint16(2, 0x1234, true);"
+                 "[d.getUint8(0), d.getUint8(1), d.getUint8(2),"
+                 " d.getUint16(2, true)]"),
+      nxt_string("18,52,52,4660") },
+
+    { nxt_string("var d = new DataView(new ArrayBuffer(8)); d.setInt32(0, -2);"
+                 "[d.getInt32(0), d.getUint32(0), d.getInt16(2),"
+                 " d.getInt8(3)]"),
+      nxt_string("-2,4294967294,-2,-2") },
+
+    { nxt_string("var d = new DataView(new ArrayBuffer(8));"
+                 "d.setFloat64(0, -2.5, true); d.setFloat32(4, 0.5);"
+                 "[d.getFloat32(4) * 2, d.getFloat64(0, true) !== -2.5]"),
+      nxt_string("1,true") },
+
+    { nxt_string("var d = new DataView(new ArrayBuffer(8), 2, 4);"
+                 "d.setUint8(0, 1);"
+                 "[d.byteOffset, d.byteLength, new Uint8Array(d.buffer)[2]]"),
+      nxt_string("2,4,1") },
+
+    { nxt_string("new DataView(new ArrayBuffer(4)).getUint32(1)"),
+      nxt_string("RangeError: Offset is outside the bounds of the DataView") },
+
+    { nxt_string("new DataView({})"),
+      nxt_string("TypeError: First argument to DataView constructor "
+                 "must be an ArrayBuffer") },
+
+    { nxt_string("new DataView(new ArrayBuffer(4), 5)"),
+      nxt_string("RangeError: Start offset 5 is outside the bounds "
+                 "of the buffer") },
+
+    { nxt_string("[typeof new Uint8Array(1), typeof new ArrayBuffer(1),"
+                 " typeof new DataView(new ArrayBuffer(1)),"
+                 " typeof Float64Array]"),
+      nxt_string("object,object,object,function") },
+
     /* Math. */
 
     { nxt_string("Math.PI"),
-      nxt_string("3.14159") },
+      nxt_string("3.141592653589793") },
 
     { nxt_string("Math.abs()"),
       nxt_string("NaN") },
@@ -7582,6 +8237,10 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("Math.cbrt('27')"),
       nxt_string("3") },
 
+    { nxt_string("[Math.cbrt(-27), Math.cbrt(64), Math.cbrt(1e-300),"
+                 " Math.cbrt(2)]"),
+      nxt_string("-3,4,1e-100,1.2599210498948732") },
+
     { nxt_string("Math.cbrt(-1)"),
       nxt_string("-1") },
 
@@ -8361,10 +9020,10 @@ static njs_unit_test_t  njs_test[] =
       nxt_string("57") },
 
     { nxt_string("parseFloat('-5.7e-1')"),
-      nxt_string("-0.570000") },
+      nxt_string("-0.57") },
 
     { nxt_string("parseFloat('-5.e-1')"),
-      nxt_string("-0.500000") },
+      nxt_string("-0.5") },
 
     { nxt_string("parseFloat('5.7e+01')"),
       nxt_string("57") },
@@ -8373,7 +9032,7 @@ static njs_unit_test_t  njs_test[] =
       nxt_string("57") },
 
     { nxt_string("parseFloat('-5.7e-1abc')"),
-      nxt_string("-0.570000") },
+      nxt_string("-0.57") },
 
     { nxt_string("parseFloat('-5.7e')"),
       nxt_string("-5.7") },
@@ -9374,6 +10033,134 @@ static njs_unit_test_t  njs_test[] =
 };
 
 
+static njs_unit_test_t  njs_preinit_test[] =
+{
+    { nxt_string("var o = {a:1}; function main() { return o.a }"),
+      nxt_string("1") },
+
+    { nxt_string("var n = 1; function main() { n++; return n }"),
+      nxt_string("2") },
+
+    { nxt_string("var s = 'abc'.repeat(10); function main() { return s.length }"),
+      nxt_string("30") },
+
+    { nxt_string("var o = {a:[1,{b:2}]};"
+                 "function main() { return JSON.stringify(o) }"),
+      nxt_string("{\"a\":[1,{\"b\":2}]}") },
+
+    { nxt_string("var a = [3,1,2];"
+                 "function main() { return a.slice().sort().join() }"),
+      nxt_string("1,2,3") },
+
+    { nxt_string("function F() { this.x = 1 }"
+                 "function main() { var f = new F(); f.x++; return f.x }"),
+      nxt_string("2") },
+
+    { nxt_string("var re = /b/; function main() { return re.test('abc') }"),
+      nxt_string("true") },
+
+    { nxt_string("var o = {a:1}; function main() { o.a = 2 }"),
+      nxt_string("TypeError: cannot modify preinitialized object") },
+
+    { nxt_string("var o = {a:1}; function main() { delete o.a }"),
+      nxt_string("TypeError: cannot modify preinitialized object") },
+
+    { nxt_string("var o = {}; function main() {"
+                 "Object.defineProperty(o, 'a', {value:1}) }"),
+      nxt_string("TypeError: cannot modify preinitialized object") },
+
+    { nxt_string("var a = [1,2]; function main() { a[0] = 3 }"),
+      nxt_string("TypeError: cannot modify preinitialized object") },
+
+    { nxt_string("var a = [1,2]; function main() { a.length = 0 }"),
+      nxt_string("TypeError: cannot modify preinitialized object") },
+
+    { nxt_string("var a = [1,2]; function main() { a.push(3) }"),
+      nxt_string("TypeError: cannot modify preinitialized object") },
+
+    { nxt_string("function F() {} F.prototype.x = 1;"
+                 "function main() { F.prototype.x = 2 }"),
+      nxt_string("TypeError: cannot modify preinitialized object") },
+
+    { nxt_string("function F() {}"
+                 "function main() { var x = F.prototype.x;"
+                 "                  F.prototype.x = 1; return x }"),
+      nxt_string("undefined") },
+
+    /* Not preinitialized values are cloned as usual. */
+
+    { nxt_string("var d = new Date(0); function main() { return d.getTime() }"),
+      nxt_string("0") },
+
+    { nxt_string("var f = (function() { var n = 0;"
+                 "                      return function() { return ++n } })();"
+                 "function main() { return f() }"),
+      nxt_string("1") },
+
+    { nxt_string("var o = {}; o.x.y; function main() {}"),
+      nxt_string("TypeError: cannot get property 'y' of undefined") },
+};
+
+
+static njs_unit_test_t  njs_gc_test[] =
+{
+    { nxt_string("var o; for (var i = 0; i < 20000; i++) { o = {a:i, b:[i]} }"
+                 "o.a + o.b[0]"),
+      nxt_string("39998") },
+
+    { nxt_string("var keep = [];"
+                 "for (var i = 0; i < 20000; i++) {"
+                 "    var o = {v: 'v' + i};"
+                 "    if (i % 1000 == 0) { keep.push(o) } }"
+                 "keep.length + ':' + keep[19].v"),
+      nxt_string("20:v19000") },
+
+    { nxt_string("var d = {};"
+                 "for (var i = 0; i < 32; i++) { d['k' + i] = 'v' + i }"
+                 "for (var j = 0; j < 20000; j++) { var t = {x: [j, j]} }"
+                 "Object.keys(d).length + d.k0 + d.k17 + d.k31"),
+      nxt_string("32v0v17v31") },
+
+    { nxt_string("function f(n) { var a = n; return function() { return a } }"
+                 "var s = 0;"
+                 "for (var i = 0; i < 20000; i++) { s += f(i)() }"
+                 "s"),
+      nxt_string("199990000") },
+
+    { nxt_string("var s = '';"
+                 "for (var i = 0; i < 20000; i++) {"
+                 "    s = (s + 'abc').substring(0, 30) }"
+                 "s.length + s.substring(0, 6)"),
+      nxt_string("30abcabc") },
+
+    { nxt_string("var m = [];"
+                 "for (var i = 0; i < 20000; i++) {"
+                 "    m[i % 100] = JSON.parse('{\"a\":' + i + '}') }"
+                 "m[99].a + m[0].a"),
+      nxt_string("39899") },
+};
+
+
+typedef struct {
+    nxt_str_t   script;
+    nxt_uint_t  regexp;
+    nxt_uint_t  backtrace;
+} njs_init_stats_test_t;
+
+
+static njs_init_stats_test_t  njs_init_stats_test[] =
+{
+    { nxt_string("1 + 1"), 0, 0 },
+    { nxt_string("/b/.test('abc')"), 1, 0 },
+    { nxt_string("'abc'.search('b')"), 1, 0 },
+    { nxt_string("'abc'.split(/b/)"), 1, 0 },
+    { nxt_string("'abc'.replace(/b/, 'x')"), 1, 0 },
+    { nxt_string("try { throw 1 } catch (e) {}"), 0, 0 },
+    { nxt_string("function f() { throw 1 } try { f() } catch (e) {}"), 0, 1 },
+    { nxt_string("function f() { throw 1 } f()"), 0, 1 },
+};
+
+
 typedef struct {
     nxt_str_t             uri;
     uint32_t              a;
@@ -9873,29 +10660,896 @@ done:
 }
 
 
-int nxt_cdecl
-main(int argc, char **argv)
+static nxt_int_t
+njs_preinit_unit_test(void)
 {
-    nxt_bool_t  disassemble, verbose;
+    u_char          *start;
+    njs_vm_t        *vm, *nvm;
+    nxt_int_t       ret, rc;
+    nxt_str_t       s;
+    nxt_uint_t      i, n;
+    njs_vm_opt_t    options;
+    njs_function_t  *function;
 
-    disassemble = 0;
-    verbose = 0;
+    static nxt_str_t  main_name = nxt_string("main");
 
-    if (argc > 1) {
-        switch (argv[1][0]) {
+    vm = NULL;
+    nvm = NULL;
 
-        case 'd':
-            disassemble = 1;
-            break;
+    rc = NXT_ERROR;
 
-        case 'v':
-            verbose = 1;
-            break;
+    for (i = 0; i < nxt_nitems(njs_preinit_test); i++) {
 
-        default:
-            break;
+        memset(&options, 0, sizeof(njs_vm_opt_t));
+
+        vm = njs_vm_create(&options);
+        if (vm == NULL) {
+            printf("njs_vm_create() failed\n");
+            goto done;
         }
-    }
 
-    return njs_unit_test(disassemble, verbose);
+        start = njs_preinit_test[i].script.start;
+
+        ret = njs_vm_compile(vm, &start,
+                             start + njs_preinit_test[i].script.length);
+        if (ret != NXT_OK) {
+            printf("njs_vm_compile() failed\n");
+            goto done;
+        }
+
+        ret = njs_vm_preinit(vm);
+
+        if (ret == NXT_ERROR) {
+            if (njs_vm_retval_to_ext_string(vm, &s) != NXT_OK) {
+                printf("njs_vm_retval_to_ext_string() failed\n");
+                goto done;
+            }
+
+            if (!nxt_strstr_eq(&njs_preinit_test[i].ret, &s)) {
+                goto failed;
+            }
+
+            njs_vm_destroy(vm);
+            vm = NULL;
+
+            continue;
+        }
+
+        /* The second clone must not see changes made in the first one. */
+
+        for (n = 0; n < 2; n++) {
+            nvm = njs_vm_clone(vm, NULL);
+            if (nvm == NULL) {
+                printf("njs_vm_clone() failed\n");
+                goto done;
+            }
+
+            ret = njs_vm_run(nvm);
+            if (ret != NXT_OK) {
+                printf("njs_vm_run() failed\n");
+                goto done;
+            }
+
+            function = njs_vm_function(nvm, &main_name);
+            if (function == NULL) {
+                printf("njs_vm_function() failed\n");
+                goto done;
+            }
+
+            (void) njs_vm_call(nvm, function, NULL, 0);
+
+            if (njs_vm_retval_to_ext_string(nvm, &s) != NXT_OK) {
+                printf("njs_vm_retval_to_ext_string() failed\n");
+                goto done;
+            }
+
+            if (!nxt_strstr_eq(&njs_preinit_test[i].ret, &s)) {
+                goto failed;
+            }
+
+            njs_vm_destroy(nvm);
+            nvm = NULL;
+        }
+
+        njs_vm_destroy(vm);
+        vm = NULL;
+    }
+
+    rc = NXT_OK;
+
+    printf("njs preinit unit tests passed\n");
+
+    goto done;
+
+failed:
+
+    printf("njs_preinit(\"%.*s\")\nexpected: \"%.*s\"\n     got: \"%.*s\"\n",
+           (int) njs_preinit_test[i].script.length,
+           njs_preinit_test[i].script.start,
+           (int) njs_preinit_test[i].ret.length, njs_preinit_test[i].ret.start,
+           (int) s.length, s.start);
+
+done:
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    if (vm != NULL) {
+        njs_vm_destroy(vm);
+    }
+
+    return rc;
+}
+
+
+/*
+ * The cache tests run the scripts loaded from the code images
+ * saved after compilation instead of the compiled scripts.
+ */
+
+static nxt_int_t
+njs_cache_unit_test(void)
+{
+    u_char        *start;
+    njs_vm_t      *vm, *nvm;
+    nxt_int_t     ret, rc;
+    nxt_str_t     s, image, source;
+    nxt_uint_t    i, declined;
+    njs_vm_opt_t  options;
+
+    vm = NULL;
+    nvm = NULL;
+    image.start = NULL;
+    declined = 0;
+
+    rc = NXT_ERROR;
+
+    for (i = 0; i < nxt_nitems(njs_test); i++) {
+
+        memset(&options, 0, sizeof(njs_vm_opt_t));
+
+        vm = njs_vm_create(&options);
+        if (vm == NULL) {
+            printf("njs_vm_create() failed\n");
+            goto done;
+        }
+
+        ret = njs_externals_init(vm);
+        if (ret != NXT_OK) {
+            goto done;
+        }
+
+        source = njs_test[i].script;
+        start = source.start;
+
+        ret = njs_vm_compile(vm, &start, start + source.length);
+
+        if (ret == NXT_OK) {
+            ret = njs_vm_cache_save(vm, &source, &s);
+        }
+
+        if (ret != NXT_OK) {
+            if (ret != NXT_DECLINED && ret != NXT_ERROR) {
+                printf("njs_vm_cache_save() failed\n");
+                goto done;
+            }
+
+            declined += (ret == NXT_DECLINED);
+
+            njs_vm_destroy(vm);
+            vm = NULL;
+
+            continue;
+        }
+
+        image.length = s.length;
+        image.start = malloc(s.length);
+        if (image.start == NULL) {
+            printf("malloc() failed\n");
+            goto done;
+        }
+
+        memcpy(image.start, s.start, s.length);
+
+        njs_vm_destroy(vm);
+
+        memset(&options, 0, sizeof(njs_vm_opt_t));
+
+        vm = njs_vm_create(&options);
+        if (vm == NULL) {
+            printf("njs_vm_create() failed\n");
+            goto done;
+        }
+
+        ret = njs_externals_init(vm);
+        if (ret != NXT_OK) {
+            goto done;
+        }
+
+        /* An image of another script is stale. */
+
+        source.length--;
+
+        ret = njs_vm_cache_load(vm, &source, &image);
+        if (ret != NXT_DECLINED) {
+            printf("njs_vm_cache_load() accepted a stale image\n");
+            goto failed;
+        }
+
+        source.length++;
+
+        ret = njs_vm_cache_load(vm, &source, &image);
+        if (ret != NXT_OK) {
+            printf("njs_vm_cache_load() failed\n");
+            goto failed;
+        }
+
+        free(image.start);
+        image.start = NULL;
+
+        nvm = njs_vm_clone(vm, NULL);
+        if (nvm == NULL) {
+            printf("njs_vm_clone() failed\n");
+            goto done;
+        }
+
+        (void) njs_vm_run(nvm);
+
+        if (njs_vm_retval_to_ext_string(nvm, &s) != NXT_OK) {
+            printf("njs_vm_retval_to_ext_string() failed\n");
+            goto done;
+        }
+
+        if (!nxt_strstr_eq(&njs_test[i].ret, &s)) {
+            printf("expected: \"%.*s\"\n     got: \"%.*s\"\n",
+                   (int) njs_test[i].ret.length, njs_test[i].ret.start,
+                   (int) s.length, s.start);
+            goto failed;
+        }
+
+        njs_vm_destroy(nvm);
+        nvm = NULL;
+
+        njs_vm_destroy(vm);
+        vm = NULL;
+    }
+
+    rc = NXT_OK;
+
+    printf("njs cache unit tests passed, %u scripts declined\n",
+           (unsigned) declined);
+
+    goto done;
+
+failed:
+
+    printf("njs_cache(\"%.*s\")\n",
+           (int) njs_test[i].script.length, njs_test[i].script.start);
+
+done:
+
+    if (image.start != NULL) {
+        free(image.start);
+    }
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    if (vm != NULL) {
+        njs_vm_destroy(vm);
+    }
+
+    return rc;
+}
+
+
+/*
+ * The reset tests run the scripts in a clone reset after the previous runs
+ * to ensure that no state of the previous runs is left.  The scripts using
+ * the external objects are skipped since the objects are changed by the
+ * previous runs.
+ */
+
+static nxt_int_t
+njs_reset_unit_test(void)
+{
+    u_char        *start;
+    njs_vm_t      *vm, *nvm;
+    nxt_int_t     ret, rc;
+    nxt_str_t     s;
+    nxt_uint_t    i, n, skipped;
+    njs_vm_opt_t  options;
+
+    vm = NULL;
+    nvm = NULL;
+    skipped = 0;
+
+    rc = NXT_ERROR;
+
+    for (i = 0; i < nxt_nitems(njs_test); i++) {
+
+        if (memchr(njs_test[i].script.start, '$', njs_test[i].script.length)
+            != NULL)
+        {
+            skipped++;
+            continue;
+        }
+
+        memset(&options, 0, sizeof(njs_vm_opt_t));
+
+        vm = njs_vm_create(&options);
+        if (vm == NULL) {
+            printf("njs_vm_create() failed\n");
+            goto done;
+        }
+
+        ret = njs_externals_init(vm);
+        if (ret != NXT_OK) {
+            goto done;
+        }
+
+        start = njs_test[i].script.start;
+
+        ret = njs_vm_compile(vm, &start, start + njs_test[i].script.length);
+
+        if (ret != NXT_OK) {
+            njs_vm_destroy(vm);
+            vm = NULL;
+
+            continue;
+        }
+
+        nvm = njs_vm_clone(vm, NULL);
+        if (nvm == NULL) {
+            printf("njs_vm_clone() failed\n");
+            goto done;
+        }
+
+        for (n = 0; n < 2; n++) {
+            (void) njs_vm_run(nvm);
+
+            nvm = njs_vm_reset(vm, nvm);
+            if (nvm == NULL) {
+                printf("njs_vm_reset() failed\n");
+                goto done;
+            }
+        }
+
+        (void) njs_vm_run(nvm);
+
+        if (njs_vm_retval_to_ext_string(nvm, &s) != NXT_OK) {
+            printf("njs_vm_retval_to_ext_string() failed\n");
+            goto done;
+        }
+
+        if (!nxt_strstr_eq(&njs_test[i].ret, &s)) {
+            printf("njs_reset(\"%.*s\")\nexpected: \"%.*s\"\n"
+                   "     got: \"%.*s\"\n",
+                   (int) njs_test[i].script.length, njs_test[i].script.start,
+                   (int) njs_test[i].ret.length, njs_test[i].ret.start,
+                   (int) s.length, s.start);
+            goto done;
+        }
+
+        njs_vm_destroy(nvm);
+        nvm = NULL;
+
+        njs_vm_destroy(vm);
+        vm = NULL;
+    }
+
+    rc = NXT_OK;
+
+    printf("njs reset unit tests passed, %u scripts skipped\n",
+           (unsigned) skipped);
+
+done:
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    if (vm != NULL) {
+        njs_vm_destroy(vm);
+    }
+
+    return rc;
+}
+
+
+static nxt_int_t
+njs_gc_unit_test(void)
+{
+    u_char             *start;
+    njs_vm_t           *vm, *nvm;
+    nxt_int_t          ret, rc;
+    nxt_str_t          s;
+    nxt_uint_t         i;
+    njs_vm_opt_t       options;
+    njs_vm_gc_stats_t  stats;
+
+    vm = NULL;
+    nvm = NULL;
+
+    rc = NXT_ERROR;
+
+    for (i = 0; i < nxt_nitems(njs_gc_test); i++) {
+
+        memset(&options, 0, sizeof(njs_vm_opt_t));
+
+        options.gc_threshold = 4096;
+
+        vm = njs_vm_create(&options);
+        if (vm == NULL) {
+            printf("njs_vm_create() failed\n");
+            goto done;
+        }
+
+        start = njs_gc_test[i].script.start;
+
+        ret = njs_vm_compile(vm, &start, start + njs_gc_test[i].script.length);
+        if (ret != NXT_OK) {
+            printf("njs_vm_compile() failed\n");
+            goto done;
+        }
+
+        nvm = njs_vm_clone(vm, NULL);
+        if (nvm == NULL) {
+            printf("njs_vm_clone() failed\n");
+            goto done;
+        }
+
+        ret = njs_vm_run(nvm);
+        if (ret != NXT_OK) {
+            printf("njs_vm_run() failed\n");
+            goto done;
+        }
+
+        if (njs_vm_gc(vm) != NXT_DECLINED) {
+            printf("njs_vm_gc() collected a cloned VM\n");
+            goto done;
+        }
+
+        if (njs_vm_gc(nvm) != NXT_OK) {
+            printf("njs_vm_gc() failed\n");
+            goto done;
+        }
+
+        njs_vm_gc_stats(nvm, &stats);
+
+        if (stats.collections < 2 || stats.freed == 0 || stats.failures != 0) {
+            printf("njs_gc(\"%.*s\")\nunexpected stats: collections %u, "
+                   "freed %zu, failures %u\n",
+                   (int) njs_gc_test[i].script.length,
+                   njs_gc_test[i].script.start,
+                   (unsigned) stats.collections, stats.freed,
+                   (unsigned) stats.failures);
+            goto done;
+        }
+
+        /* The return value must survive the collection. */
+
+        if (njs_vm_retval_to_ext_string(nvm, &s) != NXT_OK) {
+            printf("njs_vm_retval_to_ext_string() failed\n");
+            goto done;
+        }
+
+        if (!nxt_strstr_eq(&njs_gc_test[i].ret, &s)) {
+            printf("njs_gc(\"%.*s\")\nexpected: \"%.*s\"\n     got: \"%.*s\"\n",
+                   (int) njs_gc_test[i].script.length,
+                   njs_gc_test[i].script.start,
+                   (int) njs_gc_test[i].ret.length, njs_gc_test[i].ret.start,
+                   (int) s.length, s.start);
+            goto done;
+        }
+
+        njs_vm_destroy(nvm);
+        nvm = NULL;
+
+        njs_vm_destroy(vm);
+        vm = NULL;
+    }
+
+    rc = NXT_OK;
+
+    printf("njs gc unit tests passed\n");
+
+done:
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    if (vm != NULL) {
+        njs_vm_destroy(vm);
+    }
+
+    return rc;
+}
+
+
+static nxt_int_t
+njs_array_buffer_unit_test(void)
+{
+    u_char          *start, data[4];
+    njs_vm_t        *vm, *nvm;
+    nxt_int_t       ret, rc;
+    nxt_str_t       s;
+    nxt_uint_t      i;
+    njs_value_t     buffer;
+    njs_vm_opt_t    options;
+    njs_function_t  *function;
+
+    static nxt_str_t  script = nxt_string(
+        "var saved;"
+        "function f(b) { var u = new Uint8Array(b); u[0]++;"
+        "                saved = new Uint16Array(b, 2);"
+        "                return [u.length, u[1], saved.length] }"
+        "function g() { return [saved.length, saved.buffer.byteLength,"
+        "                       saved[0]] }");
+
+    static struct {
+        nxt_str_t  name;
+        nxt_str_t  ret;
+    } calls[] = {
+        { nxt_string("f"), nxt_string("4,2,1") },
+        { nxt_string("g"), nxt_string("0,0,") },
+    };
+
+    vm = NULL;
+    nvm = NULL;
+
+    rc = NXT_ERROR;
+
+    memset(&options, 0, sizeof(njs_vm_opt_t));
+
+    vm = njs_vm_create(&options);
+    if (vm == NULL) {
+        printf("njs_vm_create() failed\n");
+        goto done;
+    }
+
+    start = script.start;
+
+    ret = njs_vm_compile(vm, &start, start + script.length);
+    if (ret != NXT_OK) {
+        printf("njs_vm_compile() failed\n");
+        goto done;
+    }
+
+    nvm = njs_vm_clone(vm, NULL);
+    if (nvm == NULL) {
+        printf("njs_vm_clone() failed\n");
+        goto done;
+    }
+
+    ret = njs_vm_run(nvm);
+    if (ret != NXT_OK) {
+        printf("njs_vm_run() failed\n");
+        goto done;
+    }
+
+    data[0] = 1;
+    data[1] = 2;
+    data[2] = 3;
+    data[3] = 4;
+
+    for (i = 0; i < nxt_nitems(calls); i++) {
+
+        function = njs_vm_function(nvm, &calls[i].name);
+        if (function == NULL) {
+            printf("njs_vm_function() failed\n");
+            goto done;
+        }
+
+        /* The host memory is shared with the script without copying. */
+
+        ret = njs_vm_array_buffer_wrap(nvm, &buffer, data, sizeof(data));
+        if (ret != NXT_OK) {
+            printf("njs_vm_array_buffer_wrap() failed\n");
+            goto done;
+        }
+
+        ret = njs_vm_call(nvm, function, &buffer, 1);
+        if (ret != NXT_OK) {
+            printf("njs_vm_call() failed\n");
+            goto done;
+        }
+
+        njs_vm_array_buffers_detach(nvm);
+
+        if (njs_vm_retval_to_ext_string(nvm, &s) != NXT_OK) {
+            printf("njs_vm_retval_to_ext_string() failed\n");
+            goto done;
+        }
+
+        if (!nxt_strstr_eq(&calls[i].ret, &s)) {
+            printf("njs_array_buffer(\"%.*s\")\n"
+                   "expected: \"%.*s\"\n     got: \"%.*s\"\n",
+                   (int) calls[i].name.length, calls[i].name.start,
+                   (int) calls[i].ret.length, calls[i].ret.start,
+                   (int) s.length, s.start);
+            goto done;
+        }
+    }
+
+    if (data[0] != 2) {
+        printf("njs_array_buffer(): the host memory was not changed\n");
+        goto done;
+    }
+
+    rc = NXT_OK;
+
+    printf("njs array buffer unit tests passed\n");
+
+done:
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    if (vm != NULL) {
+        njs_vm_destroy(vm);
+    }
+
+    return rc;
+}
+
+
+static nxt_int_t
+njs_init_stats_unit_test(void)
+{
+    u_char               *start;
+    njs_vm_t             *vm, *nvm;
+    nxt_int_t            ret, rc;
+    nxt_uint_t           i, n;
+    njs_vm_opt_t         options;
+    njs_vm_init_stats_t  before, after;
+
+    static const nxt_uint_t  clones = 3;
+
+    vm = NULL;
+    nvm = NULL;
+
+    rc = NXT_ERROR;
+
+    for (i = 0; i < nxt_nitems(njs_init_stats_test); i++) {
+
+        memset(&options, 0, sizeof(njs_vm_opt_t));
+
+        options.backtrace = 1;
+
+        vm = njs_vm_create(&options);
+        if (vm == NULL) {
+            printf("njs_vm_create() failed\n");
+            goto done;
+        }
+
+        start = njs_init_stats_test[i].script.start;
+
+        ret = njs_vm_compile(vm, &start,
+                             start + njs_init_stats_test[i].script.length);
+        if (ret != NXT_OK) {
+            printf("njs_vm_compile() failed\n");
+            goto done;
+        }
+
+        njs_vm_init_stats(vm, &before);
+
+        for (n = 0; n < clones; n++) {
+            nvm = njs_vm_clone(vm, NULL);
+            if (nvm == NULL) {
+                printf("njs_vm_clone() failed\n");
+                goto done;
+            }
+
+            (void) njs_vm_run(nvm);
+
+            njs_vm_destroy(nvm);
+            nvm = NULL;
+        }
+
+        njs_vm_init_stats(vm, &after);
+
+        if (after.clones - before.clones != clones
+            || after.regexp - before.regexp
+               != clones * njs_init_stats_test[i].regexp
+            || after.backtrace - before.backtrace
+               != clones * njs_init_stats_test[i].backtrace)
+        {
+            printf("njs_init_stats(\"%.*s\")\nunexpected stats: clones %u, "
+                   "regexp %u, backtrace %u\n",
+                   (int) njs_init_stats_test[i].script.length,
+                   njs_init_stats_test[i].script.start,
+                   (unsigned) (after.clones - before.clones),
+                   (unsigned) (after.regexp - before.regexp),
+                   (unsigned) (after.backtrace - before.backtrace));
+            goto done;
+        }
+
+        njs_vm_destroy(vm);
+        vm = NULL;
+    }
+
+    rc = NXT_OK;
+
+    printf("njs init stats unit tests passed\n");
+
+done:
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    if (vm != NULL) {
+        njs_vm_destroy(vm);
+    }
+
+    return rc;
+}
+
+
+#if (NXT_JIT)
+
+/*
+ * The JIT unit test runs the scripts with all functions compiled on the
+ * first call.  The scripts without external objects are run again in
+ * the second clone which calls the machine code compiled by the first one.
+ */
+
+static nxt_int_t
+njs_jit_unit_test(void)
+{
+    u_char        *start;
+    njs_vm_t      *vm, *nvm;
+    nxt_int_t     ret, rc;
+    nxt_str_t     s;
+    nxt_uint_t    i, n, clones;
+    njs_vm_opt_t  options;
+
+    vm = NULL;
+    nvm = NULL;
+
+    rc = NXT_ERROR;
+
+    for (i = 0; i < nxt_nitems(njs_test); i++) {
+
+        memset(&options, 0, sizeof(njs_vm_opt_t));
+
+        options.jit_threshold = 1;
+
+        vm = njs_vm_create(&options);
+        if (vm == NULL) {
+            printf("njs_vm_create() failed\n");
+            goto done;
+        }
+
+        ret = njs_externals_init(vm);
+        if (ret != NXT_OK) {
+            goto done;
+        }
+
+        start = njs_test[i].script.start;
+
+        ret = njs_vm_compile(vm, &start, start + njs_test[i].script.length);
+
+        if (ret != NXT_OK) {
+            njs_vm_destroy(vm);
+            vm = NULL;
+
+            continue;
+        }
+
+        clones = (memchr(njs_test[i].script.start, '$',
+                         njs_test[i].script.length) != NULL) ? 1 : 2;
+
+        for (n = 0; n < clones; n++) {
+            nvm = njs_vm_clone(vm, NULL);
+            if (nvm == NULL) {
+                printf("njs_vm_clone() failed\n");
+                goto done;
+            }
+
+            (void) njs_vm_run(nvm);
+
+            if (njs_vm_retval_to_ext_string(nvm, &s) != NXT_OK) {
+                printf("njs_vm_retval_to_ext_string() failed\n");
+                goto done;
+            }
+
+            if (!nxt_strstr_eq(&njs_test[i].ret, &s)) {
+                printf("njs_jit(\"%.*s\")\nexpected: \"%.*s\"\n"
+                       "     got: \"%.*s\"\n",
+                       (int) njs_test[i].script.length,
+                       njs_test[i].script.start,
+                       (int) njs_test[i].ret.length, njs_test[i].ret.start,
+                       (int) s.length, s.start);
+                goto done;
+            }
+
+            njs_vm_destroy(nvm);
+            nvm = NULL;
+        }
+
+        njs_vm_destroy(vm);
+        vm = NULL;
+    }
+
+    rc = NXT_OK;
+
+    printf("njs jit unit tests passed\n");
+
+done:
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    if (vm != NULL) {
+        njs_vm_destroy(vm);
+    }
+
+    return rc;
+}
+
+#endif
+
+
+int nxt_cdecl
+main(int argc, char **argv)
+{
+    nxt_bool_t  disassemble, verbose;
+
+    disassemble = 0;
+    verbose = 0;
+
+    if (argc > 1) {
+        switch (argv[1][0]) {
+
+        case 'd':
+            disassemble = 1;
+            break;
+
+        case 'v':
+            verbose = 1;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (njs_unit_test(disassemble, verbose) != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    if (njs_preinit_unit_test() != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    if (njs_cache_unit_test() != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    if (njs_reset_unit_test() != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    if (njs_init_stats_unit_test() != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    if (njs_array_buffer_unit_test() != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+#if (NXT_JIT)
+    if (njs_jit_unit_test() != NXT_OK) {
+        return NXT_ERROR;
+    }
+#endif
+
+    return njs_gc_unit_test();
 }
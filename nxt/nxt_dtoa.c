@@ -0,0 +1,889 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+/*
+ * The Grisu3 algorithm of Florian Loitsch, "Printing Floating-Point Numbers
+ * Quickly and Accurately with Integers".  The algorithm produces the shortest
+ * digits string closest to the value, which reads back to the same double,
+ * for about 99.5% of values and detects the rest, which are printed with
+ * the slower exact bignum algorithm.
+ */
+
+
+#include <nxt_auto_config.h>
+#include <nxt_types.h>
+#include <nxt_clang.h>
+#include <nxt_dtoa.h>
+#include <string.h>
+#include <math.h>
+
+
+#define NXT_DBL_SIGNIFICAND_SIZE  52
+#define NXT_DBL_EXPONENT_BIAS     (0x3ff + NXT_DBL_SIGNIFICAND_SIZE)
+#define NXT_DBL_HIDDEN_BIT        0x0010000000000000ULL
+#define NXT_DBL_SIGNIFICAND_MASK  0x000fffffffffffffULL
+#define NXT_DBL_EXPONENT_MASK     0x7ff0000000000000ULL
+
+#define NXT_DIYFP_SIGNIFICAND_SIZE  64
+
+/* The doubles below 2^53 are integers if they have no fraction. */
+#define NXT_DTOA_INTEGER_MAX      9007199254740992.0
+
+/* 1280 bits are enough for 2^55 * 10^324 and 2^1076 * 10. */
+#define NXT_BIGNUM_SIZE           40
+
+
+typedef struct {
+    uint64_t  significand;
+    int       exp;
+} nxt_diyfp_t;
+
+
+typedef struct {
+    uint32_t    digits[NXT_BIGNUM_SIZE];
+    nxt_uint_t  size;
+} nxt_bignum_t;
+
+
+static nxt_diyfp_t nxt_diyfp_from_double(double value);
+static nxt_diyfp_t nxt_diyfp_mul(nxt_diyfp_t a, nxt_diyfp_t b);
+static nxt_diyfp_t nxt_diyfp_normalize(nxt_diyfp_t v);
+static void nxt_diyfp_boundaries(nxt_diyfp_t v, nxt_diyfp_t *minus,
+    nxt_diyfp_t *plus);
+static nxt_diyfp_t nxt_cached_power(int exp, int *dec_exp);
+static nxt_bool_t nxt_grisu3(double value, u_char *start, size_t *len,
+    int *dec_exp);
+static nxt_bool_t nxt_grisu3_digits(nxt_diyfp_t low, nxt_diyfp_t w,
+    nxt_diyfp_t high, u_char *start, size_t *len, int *dec_exp);
+static nxt_bool_t nxt_grisu3_round(u_char *start, size_t len,
+    uint64_t too_high_w, uint64_t unsafe, uint64_t rest, uint64_t ten_kappa,
+    uint64_t unit);
+static size_t nxt_dtoa_bignum(double value, u_char *start, int *dec_exp);
+static void nxt_bignum_set(nxt_bignum_t *b, uint64_t value);
+static void nxt_bignum_shift(nxt_bignum_t *b, nxt_uint_t shift);
+static void nxt_bignum_mul(nxt_bignum_t *b, uint32_t factor);
+static void nxt_bignum_pow10(nxt_bignum_t *b, nxt_uint_t exp);
+static nxt_int_t nxt_bignum_cmp(const nxt_bignum_t *a, const nxt_bignum_t *b);
+static void nxt_bignum_add(nxt_bignum_t *sum, const nxt_bignum_t *a,
+    const nxt_bignum_t *b);
+static void nxt_bignum_sub(nxt_bignum_t *a, const nxt_bignum_t *b);
+static size_t nxt_dtoa_format(u_char *start, size_t len, int point);
+static size_t nxt_dtoa_integer(uint64_t value, u_char *start);
+
+
+/*
+ * The normalized significands and binary exponents of 10^-348, 10^-340,
+ * ..., 10^340.
+ */
+
+static const nxt_diyfp_t  nxt_cached_powers[] = {
+    { 0xfa8fd5a0081c0288ULL, -1220 },  /* 1e-348 */
+    { 0xbaaee17fa23ebf76ULL, -1193 },  /* 1e-340 */
+    { 0x8b16fb203055ac76ULL, -1166 },  /* 1e-332 */
+    { 0xcf42894a5dce35eaULL, -1140 },  /* 1e-324 */
+    { 0x9a6bb0aa55653b2dULL, -1113 },  /* 1e-316 */
+    { 0xe61acf033d1a45dfULL, -1087 },  /* 1e-308 */
+    { 0xab70fe17c79ac6caULL, -1060 },  /* 1e-300 */
+    { 0xff77b1fcbebcdc4fULL, -1034 },  /* 1e-292 */
+    { 0xbe5691ef416bd60cULL, -1007 },  /* 1e-284 */
+    { 0x8dd01fad907ffc3cULL,  -980 },  /* 1e-276 */
+    { 0xd3515c2831559a83ULL,  -954 },  /* 1e-268 */
+    { 0x9d71ac8fada6c9b5ULL,  -927 },  /* 1e-260 */
+    { 0xea9c227723ee8bcbULL,  -901 },  /* 1e-252 */
+    { 0xaecc49914078536dULL,  -874 },  /* 1e-244 */
+    { 0x823c12795db6ce57ULL,  -847 },  /* 1e-236 */
+    { 0xc21094364dfb5637ULL,  -821 },  /* 1e-228 */
+    { 0x9096ea6f3848984fULL,  -794 },  /* 1e-220 */
+    { 0xd77485cb25823ac7ULL,  -768 },  /* 1e-212 */
+    { 0xa086cfcd97bf97f4ULL,  -741 },  /* 1e-204 */
+    { 0xef340a98172aace5ULL,  -715 },  /* 1e-196 */
+    { 0xb23867fb2a35b28eULL,  -688 },  /* 1e-188 */
+    { 0x84c8d4dfd2c63f3bULL,  -661 },  /* 1e-180 */
+    { 0xc5dd44271ad3cdbaULL,  -635 },  /* 1e-172 */
+    { 0x936b9fcebb25c996ULL,  -608 },  /* 1e-164 */
+    { 0xdbac6c247d62a584ULL,  -582 },  /* 1e-156 */
+    { 0xa3ab66580d5fdaf6ULL,  -555 },  /* 1e-148 */
+    { 0xf3e2f893dec3f126ULL,  -529 },  /* 1e-140 */
+    { 0xb5b5ada8aaff80b8ULL,  -502 },  /* 1e-132 */
+    { 0x87625f056c7c4a8bULL,  -475 },  /* 1e-124 */
+    { 0xc9bcff6034c13053ULL,  -449 },  /* 1e-116 */
+    { 0x964e858c91ba2655ULL,  -422 },  /* 1e-108 */
+    { 0xdff9772470297ebdULL,  -396 },  /* 1e-100 */
+    { 0xa6dfbd9fb8e5b88fULL,  -369 },  /* 1e-92 */
+    { 0xf8a95fcf88747d94ULL,  -343 },  /* 1e-84 */
+    { 0xb94470938fa89bcfULL,  -316 },  /* 1e-76 */
+    { 0x8a08f0f8bf0f156bULL,  -289 },  /* 1e-68 */
+    { 0xcdb02555653131b6ULL,  -263 },  /* 1e-60 */
+    { 0x993fe2c6d07b7facULL,  -236 },  /* 1e-52 */
+    { 0xe45c10c42a2b3b06ULL,  -210 },  /* 1e-44 */
+    { 0xaa242499697392d3ULL,  -183 },  /* 1e-36 */
+    { 0xfd87b5f28300ca0eULL,  -157 },  /* 1e-28 */
+    { 0xbce5086492111aebULL,  -130 },  /* 1e-20 */
+    { 0x8cbccc096f5088ccULL,  -103 },  /* 1e-12 */
+    { 0xd1b71758e219652cULL,   -77 },  /* 1e-4 */
+    { 0x9c40000000000000ULL,   -50 },  /* 1e4 */
+    { 0xe8d4a51000000000ULL,   -24 },  /* 1e12 */
+    { 0xad78ebc5ac620000ULL,     3 },  /* 1e20 */
+    { 0x813f3978f8940984ULL,    30 },  /* 1e28 */
+    { 0xc097ce7bc90715b3ULL,    56 },  /* 1e36 */
+    { 0x8f7e32ce7bea5c70ULL,    83 },  /* 1e44 */
+    { 0xd5d238a4abe98068ULL,   109 },  /* 1e52 */
+    { 0x9f4f2726179a2245ULL,   136 },  /* 1e60 */
+    { 0xed63a231d4c4fb27ULL,   162 },  /* 1e68 */
+    { 0xb0de65388cc8ada8ULL,   189 },  /* 1e76 */
+    { 0x83c7088e1aab65dbULL,   216 },  /* 1e84 */
+    { 0xc45d1df942711d9aULL,   242 },  /* 1e92 */
+    { 0x924d692ca61be758ULL,   269 },  /* 1e100 */
+    { 0xda01ee641a708deaULL,   295 },  /* 1e108 */
+    { 0xa26da3999aef774aULL,   322 },  /* 1e116 */
+    { 0xf209787bb47d6b85ULL,   348 },  /* 1e124 */
+    { 0xb454e4a179dd1877ULL,   375 },  /* 1e132 */
+    { 0x865b86925b9bc5c2ULL,   402 },  /* 1e140 */
+    { 0xc83553c5c8965d3dULL,   428 },  /* 1e148 */
+    { 0x952ab45cfa97a0b3ULL,   455 },  /* 1e156 */
+    { 0xde469fbd99a05fe3ULL,   481 },  /* 1e164 */
+    { 0xa59bc234db398c25ULL,   508 },  /* 1e172 */
+    { 0xf6c69a72a3989f5cULL,   534 },  /* 1e180 */
+    { 0xb7dcbf5354e9beceULL,   561 },  /* 1e188 */
+    { 0x88fcf317f22241e2ULL,   588 },  /* 1e196 */
+    { 0xcc20ce9bd35c78a5ULL,   614 },  /* 1e204 */
+    { 0x98165af37b2153dfULL,   641 },  /* 1e212 */
+    { 0xe2a0b5dc971f303aULL,   667 },  /* 1e220 */
+    { 0xa8d9d1535ce3b396ULL,   694 },  /* 1e228 */
+    { 0xfb9b7cd9a4a7443cULL,   720 },  /* 1e236 */
+    { 0xbb764c4ca7a44410ULL,   747 },  /* 1e244 */
+    { 0x8bab8eefb6409c1aULL,   774 },  /* 1e252 */
+    { 0xd01fef10a657842cULL,   800 },  /* 1e260 */
+    { 0x9b10a4e5e9913129ULL,   827 },  /* 1e268 */
+    { 0xe7109bfba19c0c9dULL,   853 },  /* 1e276 */
+    { 0xac2820d9623bf429ULL,   880 },  /* 1e284 */
+    { 0x80444b5e7aa7cf85ULL,   907 },  /* 1e292 */
+    { 0xbf21e44003acdd2dULL,   933 },  /* 1e300 */
+    { 0x8e679c2f5e44ff8fULL,   960 },  /* 1e308 */
+    { 0xd433179d9c8cb841ULL,   986 },  /* 1e316 */
+    { 0x9e19db92b4e31ba9ULL,  1013 },  /* 1e324 */
+    { 0xeb96bf6ebadf77d9ULL,  1039 },  /* 1e332 */
+    { 0xaf87023b9bf0ee6bULL,  1066 },  /* 1e340 */
+};
+
+
+static const uint64_t  nxt_pow10[] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+
+/*
+ * nxt_dtoa() writes a finite double as ECMAScript Number.prototype.toString()
+ * does, at most NXT_DTOA_MAX_LEN bytes, and returns the length.
+ */
+
+size_t
+nxt_dtoa(double value, u_char *start)
+{
+    int     dec_exp;
+    size_t  len;
+    u_char  *p;
+
+    p = start;
+
+    /* The negative zero is "-0" as well. */
+
+    if (signbit(value)) {
+        *p++ = '-';
+        value = -value;
+    }
+
+    if (value == 0) {
+        *p++ = '0';
+        return p - start;
+    }
+
+    if (value < NXT_DTOA_INTEGER_MAX && value == (double) (uint64_t) value) {
+        len = nxt_dtoa_integer((uint64_t) value, p);
+
+    } else {
+        if (!nxt_grisu3(value, p, &len, &dec_exp)) {
+            len = nxt_dtoa_bignum(value, p, &dec_exp);
+        }
+
+        len = nxt_dtoa_format(p, len, (int) len + dec_exp);
+    }
+
+    return (p - start) + len;
+}
+
+
+static size_t
+nxt_dtoa_integer(uint64_t value, u_char *start)
+{
+    size_t  len;
+    u_char  *p, buf[NXT_DTOA_MAX_LEN];
+
+    p = buf + NXT_DTOA_MAX_LEN;
+
+    do {
+        *(--p) = (u_char) (value % 10 + '0');
+        value /= 10;
+    } while (value != 0);
+
+    len = buf + NXT_DTOA_MAX_LEN - p;
+
+    memcpy(start, p, len);
+
+    return len;
+}
+
+
+/*
+ * nxt_dtoa_format() places the decimal point into the "len" digits
+ * at the "start" to represent the value 0.digits * 10^point.
+ */
+
+static size_t
+nxt_dtoa_format(u_char *start, size_t len, int point)
+{
+    int     exp;
+    size_t  offset;
+    u_char  *p;
+
+    if ((int) len <= point && point <= 21) {
+        /* 1234e7 -> 12340000000 */
+        memset(start + len, '0', point - len);
+        return point;
+    }
+
+    if (0 < point && point <= 21) {
+        /* 1234e-2 -> 12.34 */
+        memmove(start + point + 1, start + point, len - point);
+        start[point] = '.';
+        return len + 1;
+    }
+
+    if (-6 < point && point <= 0) {
+        /* 1234e-6 -> 0.001234 */
+        offset = 2 - point;
+        memmove(start + offset, start, len);
+        start[0] = '0';
+        start[1] = '.';
+        memset(start + 2, '0', offset - 2);
+        return len + offset;
+    }
+
+    /* 1234e30 -> 1.234e+33 */
+
+    if (len == 1) {
+        p = start + 1;
+
+    } else {
+        memmove(start + 2, start + 1, len - 1);
+        start[1] = '.';
+        p = start + len + 1;
+    }
+
+    *p++ = 'e';
+
+    exp = point - 1;
+
+    if (exp < 0) {
+        *p++ = '-';
+        exp = -exp;
+
+    } else {
+        *p++ = '+';
+    }
+
+    return (p - start) + nxt_dtoa_integer(exp, p);
+}
+
+
+/*
+ * nxt_grisu3() generates the shortest digits closest to the value,
+ * the value is digits * 10^dec_exp.  The scaled boundaries are imprecise,
+ * so the function fails if it cannot guarantee the result.
+ */
+
+static nxt_bool_t
+nxt_grisu3(double value, u_char *start, size_t *len, int *dec_exp)
+{
+    nxt_diyfp_t  v, w, w_minus, w_plus, c_mk;
+
+    v = nxt_diyfp_from_double(value);
+
+    nxt_diyfp_boundaries(v, &w_minus, &w_plus);
+
+    c_mk = nxt_cached_power(w_plus.exp, dec_exp);
+
+    w = nxt_diyfp_mul(nxt_diyfp_normalize(v), c_mk);
+    w_plus = nxt_diyfp_mul(w_plus, c_mk);
+    w_minus = nxt_diyfp_mul(w_minus, c_mk);
+
+    return nxt_grisu3_digits(w_minus, w, w_plus, start, len, dec_exp);
+}
+
+
+/*
+ * nxt_grisu3_digits() generates the digits of the upper boundary until
+ * the rest is inside the interval widened by the "unit" imprecision
+ * of the scaled values.
+ */
+
+static nxt_bool_t
+nxt_grisu3_digits(nxt_diyfp_t low, nxt_diyfp_t w, nxt_diyfp_t high,
+    u_char *start, size_t *len, int *dec_exp)
+{
+    int          kappa;
+    size_t       n;
+    uint32_t     p1, d;
+    uint64_t     p2, unit, too_high, unsafe, rest;
+    nxt_diyfp_t  one;
+
+    unit = 1;
+    too_high = high.significand + unit;
+    unsafe = too_high - (low.significand - unit);
+
+    one.significand = 1ULL << -w.exp;
+    one.exp = w.exp;
+
+    p1 = (uint32_t) (too_high >> -one.exp);
+    p2 = too_high & (one.significand - 1);
+
+    kappa = 1;
+
+    while (kappa < 10 && p1 >= nxt_pow10[kappa]) {
+        kappa++;
+    }
+
+    n = 0;
+
+    while (kappa > 0) {
+        d = p1 / (uint32_t) nxt_pow10[kappa - 1];
+        p1 %= (uint32_t) nxt_pow10[kappa - 1];
+
+        start[n++] = (u_char) ('0' + d);
+        kappa--;
+
+        rest = ((uint64_t) p1 << -one.exp) + p2;
+
+        if (rest < unsafe) {
+            *len = n;
+            *dec_exp += kappa;
+
+            return nxt_grisu3_round(start, n, too_high - w.significand,
+                                    unsafe, rest,
+                                    nxt_pow10[kappa] << -one.exp, unit);
+        }
+    }
+
+    for ( ;; ) {
+        p2 *= 10;
+        unit *= 10;
+        unsafe *= 10;
+
+        d = (uint32_t) (p2 >> -one.exp);
+
+        start[n++] = (u_char) ('0' + d);
+        kappa--;
+
+        p2 &= one.significand - 1;
+
+        if (p2 < unsafe) {
+            *len = n;
+            *dec_exp += kappa;
+
+            return nxt_grisu3_round(start, n,
+                                    (too_high - w.significand) * unit,
+                                    unsafe, p2, one.significand, unit);
+        }
+    }
+}
+
+
+/*
+ * nxt_grisu3_round() moves the last digit closer to the value while
+ * the result stays inside the unsafe interval, and fails if the closest
+ * digit or the result inside the boundaries cannot be guaranteed.
+ */
+
+static nxt_bool_t
+nxt_grisu3_round(u_char *start, size_t len, uint64_t too_high_w,
+    uint64_t unsafe, uint64_t rest, uint64_t ten_kappa, uint64_t unit)
+{
+    uint64_t  small, big;
+
+    small = too_high_w - unit;
+    big = too_high_w + unit;
+
+    while (rest < small && unsafe - rest >= ten_kappa
+           && (rest + ten_kappa < small
+               || small - rest >= rest + ten_kappa - small))
+    {
+        start[len - 1]--;
+        rest += ten_kappa;
+    }
+
+    if (rest < big && unsafe - rest >= ten_kappa
+        && (rest + ten_kappa < big
+            || big - rest > rest + ten_kappa - big))
+    {
+        return 0;
+    }
+
+    return (2 * unit <= rest && rest <= unsafe - 4 * unit);
+}
+
+
+/*
+ * nxt_dtoa_bignum() is the exact algorithm of Steele & White and
+ * Burger & Dybvig for the values rejected by Grisu3.  The value is r / s,
+ * and m_minus / s and m_plus / s are the distances to the middles between
+ * the value and its neighbours.  The middles read back to the value if
+ * its significand is even.
+ */
+
+static size_t
+nxt_dtoa_bignum(double value, u_char *start, int *dec_exp)
+{
+    int           k, cmp, e2;
+    size_t        len;
+    uint32_t      d;
+    nxt_bool_t    even, low, high;
+    nxt_uint_t    shift;
+    nxt_diyfp_t   v;
+    nxt_bignum_t  r, s, m_minus, m_plus, t;
+
+    v = nxt_diyfp_from_double(value);
+
+    even = ((v.significand & 1) == 0);
+
+    /* The lower neighbour of a power of 2 is closer. */
+
+    shift = (v.significand == NXT_DBL_HIDDEN_BIT
+             && v.exp != 1 - NXT_DBL_EXPONENT_BIAS);
+
+    e2 = (v.exp > 0) ? v.exp : 0;
+
+    nxt_bignum_set(&r, v.significand);
+    nxt_bignum_shift(&r, 1 + shift + e2);
+
+    nxt_bignum_set(&s, 1);
+    nxt_bignum_shift(&s, 1 + shift + ((v.exp < 0) ? -v.exp : 0));
+
+    nxt_bignum_set(&m_plus, 1);
+    nxt_bignum_shift(&m_plus, shift + e2);
+
+    nxt_bignum_set(&m_minus, 1);
+    nxt_bignum_shift(&m_minus, e2);
+
+    /* The estimation is fixed below. */
+
+    k = (int) ceil(log10(value));
+
+    if (k >= 0) {
+        nxt_bignum_pow10(&s, k);
+
+    } else {
+        nxt_bignum_pow10(&r, -k);
+        nxt_bignum_pow10(&m_plus, -k);
+        nxt_bignum_pow10(&m_minus, -k);
+    }
+
+    /* The upper middle must be below 10^k. */
+
+    for ( ;; ) {
+        nxt_bignum_add(&t, &r, &m_plus);
+        cmp = nxt_bignum_cmp(&t, &s);
+
+        if (cmp < 0 || (cmp == 0 && !even)) {
+            break;
+        }
+
+        nxt_bignum_pow10(&s, 1);
+        k++;
+    }
+
+    for ( ;; ) {
+        nxt_bignum_add(&t, &r, &m_plus);
+        nxt_bignum_pow10(&t, 1);
+        cmp = nxt_bignum_cmp(&t, &s);
+
+        if (cmp > 0 || (cmp == 0 && even)) {
+            break;
+        }
+
+        nxt_bignum_pow10(&r, 1);
+        nxt_bignum_pow10(&m_plus, 1);
+        nxt_bignum_pow10(&m_minus, 1);
+        k--;
+    }
+
+    len = 0;
+
+    for ( ;; ) {
+        nxt_bignum_pow10(&r, 1);
+        nxt_bignum_pow10(&m_plus, 1);
+        nxt_bignum_pow10(&m_minus, 1);
+
+        d = 0;
+
+        while (nxt_bignum_cmp(&r, &s) >= 0) {
+            nxt_bignum_sub(&r, &s);
+            d++;
+        }
+
+        cmp = nxt_bignum_cmp(&r, &m_minus);
+        low = even ? (cmp <= 0) : (cmp < 0);
+
+        nxt_bignum_add(&t, &r, &m_plus);
+        cmp = nxt_bignum_cmp(&t, &s);
+        high = even ? (cmp >= 0) : (cmp > 0);
+
+        if (!low && !high) {
+            start[len++] = (u_char) ('0' + d);
+            continue;
+        }
+
+        if (low && high) {
+            /* The closest digit, the even one in the middle. */
+
+            nxt_bignum_add(&t, &r, &r);
+            cmp = nxt_bignum_cmp(&t, &s);
+
+            if (cmp > 0 || (cmp == 0 && (d & 1))) {
+                d++;
+            }
+
+        } else if (high) {
+            d++;
+        }
+
+        start[len++] = (u_char) ('0' + d);
+
+        break;
+    }
+
+    *dec_exp = k - (int) len;
+
+    return len;
+}
+
+
+static void
+nxt_bignum_set(nxt_bignum_t *b, uint64_t value)
+{
+    b->digits[0] = (uint32_t) value;
+    b->digits[1] = (uint32_t) (value >> 32);
+
+    b->size = (b->digits[1] != 0) ? 2 : (b->digits[0] != 0);
+}
+
+
+static void
+nxt_bignum_shift(nxt_bignum_t *b, nxt_uint_t shift)
+{
+    nxt_uint_t  i, n, bits;
+
+    if (b->size == 0) {
+        return;
+    }
+
+    n = shift / 32;
+    bits = shift % 32;
+
+    if (bits != 0) {
+        b->digits[b->size] = 0;
+
+        for (i = b->size; i > 0; i--) {
+            b->digits[i] = (b->digits[i] << bits)
+                           | (b->digits[i - 1] >> (32 - bits));
+        }
+
+        b->digits[0] <<= bits;
+
+        if (b->digits[b->size] != 0) {
+            b->size++;
+        }
+    }
+
+    if (n != 0) {
+        memmove(&b->digits[n], &b->digits[0], b->size * sizeof(uint32_t));
+        memset(&b->digits[0], 0, n * sizeof(uint32_t));
+        b->size += n;
+    }
+}
+
+
+static void
+nxt_bignum_mul(nxt_bignum_t *b, uint32_t factor)
+{
+    uint64_t    carry;
+    nxt_uint_t  i;
+
+    carry = 0;
+
+    for (i = 0; i < b->size; i++) {
+        carry += (uint64_t) b->digits[i] * factor;
+        b->digits[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+
+    if (carry != 0) {
+        b->digits[b->size++] = (uint32_t) carry;
+    }
+}
+
+
+static void
+nxt_bignum_pow10(nxt_bignum_t *b, nxt_uint_t exp)
+{
+    while (exp >= 9) {
+        nxt_bignum_mul(b, (uint32_t) nxt_pow10[9]);
+        exp -= 9;
+    }
+
+    if (exp != 0) {
+        nxt_bignum_mul(b, (uint32_t) nxt_pow10[exp]);
+    }
+}
+
+
+static nxt_int_t
+nxt_bignum_cmp(const nxt_bignum_t *a, const nxt_bignum_t *b)
+{
+    nxt_uint_t  i;
+
+    if (a->size != b->size) {
+        return (a->size < b->size) ? -1 : 1;
+    }
+
+    for (i = a->size; i > 0; i--) {
+        if (a->digits[i - 1] != b->digits[i - 1]) {
+            return (a->digits[i - 1] < b->digits[i - 1]) ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+
+static void
+nxt_bignum_add(nxt_bignum_t *sum, const nxt_bignum_t *a,
+    const nxt_bignum_t *b)
+{
+    uint64_t    carry;
+    nxt_uint_t  i, size;
+
+    if (a->size < b->size) {
+        nxt_bignum_add(sum, b, a);
+        return;
+    }
+
+    size = a->size;
+    carry = 0;
+
+    for (i = 0; i < size; i++) {
+        carry += a->digits[i];
+
+        if (i < b->size) {
+            carry += b->digits[i];
+        }
+
+        sum->digits[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+
+    if (carry != 0) {
+        sum->digits[size++] = (uint32_t) carry;
+    }
+
+    sum->size = size;
+}
+
+
+/* a -= b, a is not less than b. */
+
+static void
+nxt_bignum_sub(nxt_bignum_t *a, const nxt_bignum_t *b)
+{
+    int64_t     diff;
+    uint32_t    borrow;
+    nxt_uint_t  i;
+
+    borrow = 0;
+
+    for (i = 0; i < a->size; i++) {
+        diff = (int64_t) a->digits[i] - borrow;
+
+        if (i < b->size) {
+            diff -= b->digits[i];
+        }
+
+        borrow = (diff < 0);
+        a->digits[i] = (uint32_t) diff;
+    }
+
+    while (a->size != 0 && a->digits[a->size - 1] == 0) {
+        a->size--;
+    }
+}
+
+
+static nxt_diyfp_t
+nxt_diyfp_from_double(double value)
+{
+    int          biased_exp;
+    uint64_t     u, significand;
+    nxt_diyfp_t  v;
+
+    memcpy(&u, &value, sizeof(uint64_t));
+
+    biased_exp = (int) ((u & NXT_DBL_EXPONENT_MASK)
+                        >> NXT_DBL_SIGNIFICAND_SIZE);
+    significand = u & NXT_DBL_SIGNIFICAND_MASK;
+
+    if (biased_exp != 0) {
+        v.significand = significand + NXT_DBL_HIDDEN_BIT;
+        v.exp = biased_exp - NXT_DBL_EXPONENT_BIAS;
+
+    } else {
+        /* A subnormal number. */
+        v.significand = significand;
+        v.exp = 1 - NXT_DBL_EXPONENT_BIAS;
+    }
+
+    return v;
+}
+
+
+/* The upper 64 bits of the 128-bit product rounded to nearest. */
+
+static nxt_diyfp_t
+nxt_diyfp_mul(nxt_diyfp_t a, nxt_diyfp_t b)
+{
+    uint64_t     a_hi, a_lo, b_hi, b_lo, ac, bc, ad, bd, tmp;
+    nxt_diyfp_t  v;
+
+    a_hi = a.significand >> 32;
+    a_lo = a.significand & 0xffffffff;
+    b_hi = b.significand >> 32;
+    b_lo = b.significand & 0xffffffff;
+
+    ac = a_hi * b_hi;
+    bc = a_lo * b_hi;
+    ad = a_hi * b_lo;
+    bd = a_lo * b_lo;
+
+    tmp = (bd >> 32) + (ad & 0xffffffff) + (bc & 0xffffffff);
+    tmp += 1U << 31;
+
+    v.significand = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+    v.exp = a.exp + b.exp + NXT_DIYFP_SIGNIFICAND_SIZE;
+
+    return v;
+}
+
+
+static nxt_diyfp_t
+nxt_diyfp_normalize(nxt_diyfp_t v)
+{
+    while ((v.significand & (1ULL << 63)) == 0) {
+        v.significand <<= 1;
+        v.exp--;
+    }
+
+    return v;
+}
+
+
+/*
+ * nxt_diyfp_boundaries() returns the middles between the value and its
+ * neighbours with the same normalized exponent.
+ */
+
+static void
+nxt_diyfp_boundaries(nxt_diyfp_t v, nxt_diyfp_t *minus, nxt_diyfp_t *plus)
+{
+    nxt_diyfp_t  pl, mi;
+
+    pl.significand = (v.significand << 1) + 1;
+    pl.exp = v.exp - 1;
+
+    while ((pl.significand & (NXT_DBL_HIDDEN_BIT << 1)) == 0) {
+        pl.significand <<= 1;
+        pl.exp--;
+    }
+
+    pl.significand <<= NXT_DIYFP_SIGNIFICAND_SIZE
+                       - NXT_DBL_SIGNIFICAND_SIZE - 2;
+    pl.exp -= NXT_DIYFP_SIGNIFICAND_SIZE - NXT_DBL_SIGNIFICAND_SIZE - 2;
+
+    /* The lower neighbour of a power of 2 is closer. */
+
+    if (v.significand == NXT_DBL_HIDDEN_BIT
+        && v.exp != 1 - NXT_DBL_EXPONENT_BIAS)
+    {
+        mi.significand = (v.significand << 2) - 1;
+        mi.exp = v.exp - 2;
+
+    } else {
+        mi.significand = (v.significand << 1) - 1;
+        mi.exp = v.exp - 1;
+    }
+
+    mi.significand <<= mi.exp - pl.exp;
+    mi.exp = pl.exp;
+
+    *minus = mi;
+    *plus = pl;
+}
+
+
+/*
+ * nxt_cached_power() returns a power of 10 which scales a number with
+ * the binary exponent "exp" into the [-60, -32] binary exponent range
+ * and sets the negated decimal exponent of the power.
+ */
+
+static nxt_diyfp_t
+nxt_cached_power(int exp, int *dec_exp)
+{
+    int     k;
+    double  dk;
+    size_t  index;
+
+    /* 0.30102999566398114 is 1 / log2(10). */
+
+    dk = (-61 - exp) * 0.30102999566398114 + 347;
+
+    k = (int) dk;
+
+    if (dk - k > 0.0) {
+        k++;
+    }
+
+    index = (size_t) ((k >> 3) + 1);
+
+    *dec_exp = -(-348 + (int) index * 8);
+
+    return nxt_cached_powers[index];
+}
@@ -0,0 +1,17 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NXT_DTOA_H_INCLUDED_
+#define _NXT_DTOA_H_INCLUDED_
+
+
+/* "-1.2345678901234567e-308" */
+#define NXT_DTOA_MAX_LEN  32
+
+
+NXT_EXPORT size_t nxt_dtoa(double value, u_char *start);
+
+
+#endif /* _NXT_DTOA_H_INCLUDED_ */
@@ -55,6 +55,9 @@ typedef struct {
 
     /* Chunk bitmap.  There can be no more than 32 chunks in a page. */
     uint8_t                     map[4];
+
+    /* Bitmap of chunks marked by nxt_mem_cache_mark(). */
+    uint8_t                     marks[4];
 } nxt_mem_cache_page_t;
 
 
@@ -78,6 +81,9 @@ typedef struct {
     NXT_RBTREE_NODE             (node);
     nxt_mem_cache_block_type_t  type:8;
 
+    /* A large allocation is marked by nxt_mem_cache_mark(). */
+    uint8_t                     mark;
+
     /* Block size must be less than 4G. */
     uint32_t                    size;
 
@@ -101,6 +107,12 @@ typedef struct {
 } nxt_mem_cache_slot_t;
 
 
+typedef struct {
+    u_char                      *start;
+    u_char                      *end;
+} nxt_mem_cache_range_t;
+
+
 struct nxt_mem_cache_pool_s {
     /* rbtree of nxt_mem_cache_block_t. */
     nxt_rbtree_t                blocks;
@@ -113,6 +125,12 @@ struct nxt_mem_cache_pool_s {
     uint32_t                    page_alignment;
     uint32_t                    cluster_size;
 
+    /* Size of allocated chunks, pages, and large allocations. */
+    size_t                      size;
+
+    /* nxt_mem_cache_mark() has failed to mark all reachable allocations. */
+    uint8_t                     mark_failed;
+
     const nxt_mem_proto_t       *proto;
     void                        *mem;
     void                        *trace;
@@ -129,6 +147,14 @@ struct nxt_mem_cache_pool_s {
     map[chunk / 8] &= ~(0x80 >> (chunk & 7))
 
 
+#define nxt_mem_cache_chunk_is_marked(marks, chunk)                          \
+    ((marks[chunk / 8] & (0x80 >> (chunk & 7))) != 0)
+
+
+#define nxt_mem_cache_chunk_set_marked(marks, chunk)                          \
+    marks[chunk / 8] |= (0x80 >> (chunk & 7))
+
+
 #define nxt_mem_cache_free_junk(p, size)                                      \
     memset((p), 0x5A, size)
 
@@ -154,6 +180,10 @@ static nxt_mem_cache_block_t *nxt_mem_cache_find_block(nxt_rbtree_t *tree,
     u_char *p);
 static const char *nxt_mem_cache_chunk_free(nxt_mem_cache_pool_t *pool,
     nxt_mem_cache_block_t *cluster, u_char *p);
+static u_char *nxt_mem_cache_mark_chunk(nxt_mem_cache_pool_t *pool, u_char *p,
+    size_t *size);
+static size_t nxt_mem_cache_sweep_cluster(nxt_mem_cache_pool_t *pool,
+    nxt_mem_cache_block_t *cluster, nxt_bool_t keep);
 
 
 nxt_mem_cache_pool_t *
@@ -268,6 +298,13 @@ nxt_mem_cache_pool_is_empty(nxt_mem_cache_pool_t *pool)
 }
 
 
+size_t
+nxt_mem_cache_pool_size(nxt_mem_cache_pool_t *pool)
+{
+    return pool->size;
+}
+
+
 void
 nxt_mem_cache_pool_destroy(nxt_mem_cache_pool_t *pool)
 {
@@ -295,6 +332,81 @@ nxt_mem_cache_pool_destroy(nxt_mem_cache_pool_t *pool)
 }
 
 
+/*
+ * nxt_mem_cache_pool_reset() frees all allocations at once.  Clusters
+ * up to the keep size are retained as free pages to serve the following
+ * allocations without calling the memory prototype, the other clusters
+ * and all large allocations are returned.
+ */
+
+void
+nxt_mem_cache_pool_reset(nxt_mem_cache_pool_t *pool, size_t keep)
+{
+    u_char                 *p;
+    size_t                 kept;
+    nxt_uint_t             n, pages;
+    nxt_rbtree_node_t      *node, *next;
+    nxt_mem_cache_slot_t   *slot;
+    nxt_mem_cache_page_t   *page;
+    nxt_mem_cache_block_t  *block;
+
+    nxt_queue_init(&pool->free_pages);
+
+    slot = pool->slots;
+
+    do {
+        nxt_queue_init(&slot->pages);
+        slot++;
+    } while (slot[-1].size * 2 < pool->page_size);
+
+    pages = pool->cluster_size >> pool->page_size_shift;
+    kept = 0;
+
+    node = nxt_rbtree_min(&pool->blocks);
+
+    while (nxt_rbtree_is_there_successor(&pool->blocks, node)) {
+
+        next = nxt_rbtree_node_successor(&pool->blocks, node);
+        block = (nxt_mem_cache_block_t *) node;
+
+        p = block->start;
+
+        if (block->type == NXT_MEM_CACHE_CLUSTER_BLOCK
+            && kept + pool->cluster_size <= keep)
+        {
+            kept += pool->cluster_size;
+
+            for (n = 0; n < pages; n++) {
+                page = &block->pages[n];
+
+                page->size = 0;
+                page->chunks = 0;
+                memset(page->map, 0, sizeof(page->map));
+                memset(page->marks, 0, sizeof(page->marks));
+
+                nxt_queue_insert_tail(&pool->free_pages, &page->link);
+            }
+
+            nxt_mem_cache_free_junk(p, pool->cluster_size);
+
+        } else {
+            nxt_rbtree_delete(&pool->blocks, &block->node);
+
+            if (block->type != NXT_MEM_CACHE_EMBEDDED_BLOCK) {
+                pool->proto->free(pool->mem, block);
+            }
+
+            pool->proto->free(pool->mem, p);
+        }
+
+        node = next;
+    }
+
+    pool->size = 0;
+    pool->mark_failed = 0;
+}
+
+
 void *
 nxt_mem_cache_alloc(nxt_mem_cache_pool_t *pool, size_t size)
 {
@@ -455,9 +567,11 @@ nxt_mem_cache_alloc_small(nxt_mem_cache_pool_t *pool, size_t size)
             p = nxt_mem_cache_page_addr(pool, page);
         }
 
-#if (NXT_DEBUG)
         size = pool->page_size;
-#endif
+    }
+
+    if (nxt_fast_path(p != NULL)) {
+        pool->size += size;
     }
 
     if (pool->proto->trace != NULL) {
@@ -618,11 +732,14 @@ nxt_mem_cache_alloc_large(nxt_mem_cache_pool_t *pool, size_t alignment,
     }
 
     block->type = type;
+    block->mark = 0;
     block->size = size;
     block->start = p;
 
     nxt_rbtree_insert(&pool->blocks, &block->node);
 
+    pool->size += size;
+
     return p;
 }
 
@@ -663,6 +780,8 @@ nxt_mem_cache_free(nxt_mem_cache_pool_t *pool, void *p)
         } else if (nxt_fast_path(p == block->start)) {
             nxt_rbtree_delete(&pool->blocks, &block->node);
 
+            pool->size -= block->size;
+
             if (block->type == NXT_MEM_CACHE_DISCRETE_BLOCK) {
                 pool->proto->free(pool->mem, block);
             }
@@ -749,6 +868,8 @@ nxt_mem_cache_chunk_free(nxt_mem_cache_pool_t *pool,
 
         nxt_mem_cache_chunk_set_free(page->map, chunk);
 
+        pool->size -= size;
+
         /* Find a slot with appropriate chunk size. */
         for (slot = pool->slots; slot->size < size; slot++) { /* void */ }
 
@@ -777,6 +898,9 @@ nxt_mem_cache_chunk_free(nxt_mem_cache_pool_t *pool,
 
     } else if (nxt_slow_path(p != start)) {
         return "invalid pointer to chunk: %p";
+
+    } else {
+        pool->size -= size;
     }
 
     /* Add the free page to the pool's free pages tree. */
@@ -820,3 +944,386 @@ nxt_mem_cache_chunk_free(nxt_mem_cache_pool_t *pool,
 
     return NULL;
 }
+
+
+/*
+ * nxt_mem_cache_mark() conservatively marks allocations reachable from
+ * the memory range: a word of the range or of an already marked allocation
+ * which points inside an allocation marks the allocation too.  On 64-bit
+ * platforms the words are read at 32-bit steps, because nxt_lvlhsh entries
+ * store pointers as two 32-bit halves.  nxt_mem_cache_sweep() frees all
+ * allocations which have not been marked and clears the marks.  Between
+ * these calls nxt_mem_cache_is_marked() tests allocations and unmarked
+ * allocations may be freed, but nothing may be allocated from the pool.
+ * If marking fails, nxt_mem_cache_sweep() only clears the marks.
+ */
+
+#if (NXT_64BIT)
+typedef uint32_t  nxt_mem_cache_word_t;
+#else
+typedef uintptr_t  nxt_mem_cache_word_t;
+#endif
+
+
+nxt_int_t
+nxt_mem_cache_mark(nxt_mem_cache_pool_t *pool, const void *start, size_t size)
+{
+    u_char                 *p, *end, *chunk, *low, *high;
+    size_t                 chunk_size;
+    uintptr_t              value[2];
+    nxt_uint_t             i, n, items, nalloc;
+    nxt_rbtree_node_t      *node;
+    nxt_mem_cache_word_t   *word;
+    nxt_mem_cache_range_t  *stack, *prev;
+
+    if (nxt_rbtree_is_empty(&pool->blocks)) {
+        return NXT_OK;
+    }
+
+    node = nxt_rbtree_min(&pool->blocks);
+    low = ((nxt_mem_cache_block_t *) node)->start;
+
+    node = nxt_rbtree_root(&pool->blocks);
+
+    while (node->right != nxt_rbtree_sentinel(&pool->blocks)) {
+        node = node->right;
+    }
+
+    high = ((nxt_mem_cache_block_t *) node)->start
+           + ((nxt_mem_cache_block_t *) node)->size;
+
+    nalloc = 64;
+
+    stack = pool->proto->alloc(pool->mem,
+                               nalloc * sizeof(nxt_mem_cache_range_t));
+    if (nxt_slow_path(stack == NULL)) {
+        goto failed;
+    }
+
+    stack[0].start = (u_char *) start;
+    stack[0].end = (u_char *) start + size;
+    items = 1;
+
+    while (items != 0) {
+        items--;
+
+        word = (nxt_mem_cache_word_t *)
+                   nxt_align_ptr(stack[items].start,
+                                 sizeof(nxt_mem_cache_word_t));
+        end = stack[items].end;
+
+        while ((u_char *) word + sizeof(uintptr_t) <= end) {
+
+            memcpy(&value[0], word, sizeof(uintptr_t));
+            n = 1;
+
+#if (NXT_64BIT)
+            value[1] = ((uintptr_t) word[1] << 32) + word[0];
+
+            if (value[1] != value[0]) {
+                n = 2;
+            }
+#endif
+
+            word++;
+
+            for (i = 0; i < n; i++) {
+                p = (u_char *) value[i];
+
+                if (p < low || p >= high) {
+                    continue;
+                }
+
+                chunk = nxt_mem_cache_mark_chunk(pool, p, &chunk_size);
+                if (chunk == NULL) {
+                    continue;
+                }
+
+                if (items == nalloc) {
+                    prev = stack;
+                    nalloc *= 2;
+
+                    stack = pool->proto->alloc(pool->mem,
+                                         nalloc * sizeof(nxt_mem_cache_range_t));
+                    if (nxt_slow_path(stack == NULL)) {
+                        pool->proto->free(pool->mem, prev);
+                        goto failed;
+                    }
+
+                    memcpy(stack, prev, items * sizeof(nxt_mem_cache_range_t));
+                    pool->proto->free(pool->mem, prev);
+                }
+
+                stack[items].start = chunk;
+                stack[items].end = chunk + chunk_size;
+                items++;
+            }
+        }
+    }
+
+    pool->proto->free(pool->mem, stack);
+
+    return NXT_OK;
+
+failed:
+
+    pool->mark_failed = 1;
+
+    return NXT_ERROR;
+}
+
+
+static u_char *
+nxt_mem_cache_mark_chunk(nxt_mem_cache_pool_t *pool, u_char *p, size_t *size)
+{
+    u_char                 *start;
+    nxt_uint_t             n, chunk, chunk_size;
+    nxt_mem_cache_page_t   *page;
+    nxt_mem_cache_block_t  *block;
+
+    block = nxt_mem_cache_find_block(&pool->blocks, p);
+
+    if (block == NULL) {
+        return NULL;
+    }
+
+    if (block->type != NXT_MEM_CACHE_CLUSTER_BLOCK) {
+        if (block->mark) {
+            return NULL;
+        }
+
+        block->mark = 1;
+        *size = block->size;
+
+        return block->start;
+    }
+
+    n = (p - block->start) >> pool->page_size_shift;
+    page = &block->pages[n];
+
+    if (page->size == 0) {
+        return NULL;
+    }
+
+    start = block->start + (n << pool->page_size_shift);
+    chunk_size = page->size << pool->chunk_size_shift;
+    chunk = 0;
+
+    if (chunk_size != pool->page_size) {
+        chunk = (p - start) / chunk_size;
+
+        if (nxt_mem_cache_chunk_is_free(page->map, chunk)) {
+            return NULL;
+        }
+
+        start += chunk * chunk_size;
+    }
+
+    if (nxt_mem_cache_chunk_is_marked(page->marks, chunk)) {
+        return NULL;
+    }
+
+    nxt_mem_cache_chunk_set_marked(page->marks, chunk);
+    *size = chunk_size;
+
+    return start;
+}
+
+
+/* All allocations are treated as marked if marking has failed. */
+
+nxt_bool_t
+nxt_mem_cache_is_marked(nxt_mem_cache_pool_t *pool, const void *p)
+{
+    nxt_uint_t             n, chunk, chunk_size;
+    nxt_mem_cache_page_t   *page;
+    nxt_mem_cache_block_t  *block;
+
+    if (pool->mark_failed) {
+        return 1;
+    }
+
+    block = nxt_mem_cache_find_block(&pool->blocks, (u_char *) p);
+
+    if (block == NULL) {
+        return 0;
+    }
+
+    if (block->type != NXT_MEM_CACHE_CLUSTER_BLOCK) {
+        return block->mark;
+    }
+
+    n = ((u_char *) p - block->start) >> pool->page_size_shift;
+    page = &block->pages[n];
+
+    if (page->size == 0) {
+        return 0;
+    }
+
+    chunk_size = page->size << pool->chunk_size_shift;
+    chunk = 0;
+
+    if (chunk_size != pool->page_size) {
+        chunk = ((u_char *) p - block->start - (n << pool->page_size_shift))
+                / chunk_size;
+    }
+
+    return nxt_mem_cache_chunk_is_marked(page->marks, chunk);
+}
+
+
+size_t
+nxt_mem_cache_sweep(nxt_mem_cache_pool_t *pool)
+{
+    size_t                 freed;
+    nxt_bool_t             keep;
+    nxt_rbtree_node_t      *node, *next;
+    nxt_mem_cache_block_t  *block;
+
+    keep = pool->mark_failed;
+    pool->mark_failed = 0;
+
+    freed = 0;
+
+    node = nxt_rbtree_min(&pool->blocks);
+
+    while (nxt_rbtree_is_there_successor(&pool->blocks, node)) {
+
+        next = nxt_rbtree_node_successor(&pool->blocks, node);
+        block = (nxt_mem_cache_block_t *) node;
+
+        if (block->type == NXT_MEM_CACHE_CLUSTER_BLOCK) {
+            freed += nxt_mem_cache_sweep_cluster(pool, block, keep);
+
+        } else if (block->mark || keep) {
+            block->mark = 0;
+
+        } else {
+            freed += block->size;
+            nxt_mem_cache_free(pool, block->start);
+        }
+
+        node = next;
+    }
+
+    return freed;
+}
+
+
+static size_t
+nxt_mem_cache_sweep_cluster(nxt_mem_cache_pool_t *pool,
+    nxt_mem_cache_block_t *cluster, nxt_bool_t keep)
+{
+    u_char                *p;
+    size_t                freed;
+    nxt_uint_t            n, pages, chunk, chunks, size, live, dead;
+    nxt_mem_cache_page_t  *page;
+
+    pages = pool->cluster_size >> pool->page_size_shift;
+
+    live = 0;
+    dead = 0;
+
+    for (n = 0; n < pages; n++) {
+        page = &cluster->pages[n];
+
+        if (page->size == 0) {
+            continue;
+        }
+
+        size = page->size << pool->chunk_size_shift;
+        chunks = pool->page_size / size;
+
+        for (chunk = 0; chunk < chunks; chunk++) {
+
+            if (size != pool->page_size
+                && nxt_mem_cache_chunk_is_free(page->map, chunk))
+            {
+                continue;
+            }
+
+            if (nxt_mem_cache_chunk_is_marked(page->marks, chunk)) {
+                live++;
+
+            } else {
+                dead++;
+            }
+        }
+    }
+
+    freed = 0;
+
+    if (live == 0 && dead != 0 && !keep) {
+
+        /* Free the whole cluster at once. */
+
+        for (n = 0; n < pages; n++) {
+            page = &cluster->pages[n];
+
+            if (page->size == 0) {
+                /* The page is in the pool's free pages list. */
+                nxt_queue_remove(&page->link);
+                continue;
+            }
+
+            size = page->size << pool->chunk_size_shift;
+
+            if (size == pool->page_size) {
+                freed += size;
+                continue;
+            }
+
+            chunks = pool->page_size / size;
+
+            if (page->chunks != 0) {
+                /* The page is in the pool chunk slot list. */
+                nxt_queue_remove(&page->link);
+            }
+
+            freed += (chunks - page->chunks) * size;
+        }
+
+        pool->size -= freed;
+
+        nxt_rbtree_delete(&pool->blocks, &cluster->node);
+
+        p = cluster->start;
+
+        /* Stale pointers in the freed memory may retain allocations later. */
+        nxt_mem_cache_free_junk(p, pool->cluster_size);
+
+        pool->proto->free(pool->mem, cluster);
+        pool->proto->free(pool->mem, p);
+
+        return freed;
+    }
+
+    for (n = 0; n < pages; n++) {
+        page = &cluster->pages[n];
+
+        if (page->size != 0 && dead != 0 && !keep) {
+            size = page->size << pool->chunk_size_shift;
+            chunks = pool->page_size / size;
+            p = cluster->start + (n << pool->page_size_shift);
+
+            for (chunk = 0; chunk < chunks; chunk++, p += size) {
+
+                if ((size != pool->page_size
+                     && nxt_mem_cache_chunk_is_free(page->map, chunk))
+                    || nxt_mem_cache_chunk_is_marked(page->marks, chunk))
+                {
+                    continue;
+                }
+
+                (void) nxt_mem_cache_chunk_free(pool, cluster, p);
+                freed += size;
+                dead--;
+
+            }
+        }
+
+        memset(page->marks, 0, sizeof(page->marks));
+    }
+
+    return freed;
+}
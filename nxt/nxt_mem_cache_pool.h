@@ -22,6 +22,9 @@ NXT_EXPORT nxt_mem_cache_pool_t *
     size_t min_chunk_size)
     NXT_MALLOC_LIKE;
 NXT_EXPORT nxt_bool_t nxt_mem_cache_pool_is_empty(nxt_mem_cache_pool_t *pool);
+NXT_EXPORT size_t nxt_mem_cache_pool_size(nxt_mem_cache_pool_t *pool);
+NXT_EXPORT void nxt_mem_cache_pool_reset(nxt_mem_cache_pool_t *pool,
+    size_t keep);
 NXT_EXPORT void nxt_mem_cache_pool_destroy(nxt_mem_cache_pool_t *pool);
 
 NXT_EXPORT void *nxt_mem_cache_alloc(nxt_mem_cache_pool_t *pool, size_t size)
@@ -36,5 +39,11 @@ NXT_EXPORT void *nxt_mem_cache_zalign(nxt_mem_cache_pool_t *pool,
     NXT_MALLOC_LIKE;
 NXT_EXPORT void nxt_mem_cache_free(nxt_mem_cache_pool_t *pool, void *p);
 
+NXT_EXPORT nxt_int_t nxt_mem_cache_mark(nxt_mem_cache_pool_t *pool,
+    const void *start, size_t size);
+NXT_EXPORT nxt_bool_t nxt_mem_cache_is_marked(nxt_mem_cache_pool_t *pool,
+    const void *p);
+NXT_EXPORT size_t nxt_mem_cache_sweep(nxt_mem_cache_pool_t *pool);
+
 
 #endif /* _NXT_MEM_CACHE_POOL_H_INCLUDED_ */
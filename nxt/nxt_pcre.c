@@ -5,6 +5,9 @@
  */
 
 #include <nxt_auto_config.h>
+
+#if !(NXT_HAVE_PCRE2)
+
 #include <nxt_types.h>
 #include <nxt_clang.h>
 #include <nxt_stub.h>
@@ -14,6 +17,19 @@
 #include <string.h>
 
 
+/*
+ * The JIT compiled code runs on its own stack.  The default 32K stack
+ * allocated on the machine stack is not enough for complex regexes,
+ * so a larger stack is allocated on demand and is shared by all regexes.
+ * A VM is not used by several threads at once and the stack is not used
+ * by several matches at once, so the stack is per process, that is, per
+ * worker.
+ */
+
+#define NXT_PCRE_JIT_STACK_MIN  (32 * 1024)
+#define NXT_PCRE_JIT_STACK_MAX  (1024 * 1024)
+
+
 static void *nxt_pcre_malloc(size_t size);
 static void nxt_pcre_free(void *p);
 static void *nxt_pcre_default_malloc(size_t size, void *memory_data);
@@ -22,6 +38,10 @@ static void nxt_pcre_default_free(void *p, void *memory_data);
 
 static nxt_regex_context_t  *regex_context;
 
+#if (NXT_HAVE_PCRE_JIT)
+static pcre_jit_stack       *regex_jit_stack;
+#endif
+
 
 nxt_regex_context_t *
 nxt_regex_context_create(nxt_pcre_malloc_t private_malloc,
@@ -46,18 +66,64 @@ nxt_regex_context_create(nxt_pcre_malloc_t private_malloc,
 }
 
 
+void
+nxt_regex_free(nxt_regex_t *regex, nxt_regex_context_t *ctx)
+{
+#if (NXT_HAVE_PCRE_JIT)
+    void  *(*saved_malloc)(size_t size);
+    void  (*saved_free)(void *p);
+
+    /*
+     * The code and the study data are allocated by the allocator of
+     * the context, only the JIT code is allocated outside of it.
+     */
+
+    if (regex->extra == NULL) {
+        return;
+    }
+
+    saved_malloc = pcre_malloc;
+    pcre_malloc = nxt_pcre_malloc;
+    saved_free = pcre_free;
+    pcre_free = nxt_pcre_free;
+    regex_context = ctx;
+
+    pcre_free_study(regex->extra);
+    regex->extra = NULL;
+
+    pcre_malloc = saved_malloc;
+    pcre_free = saved_free;
+    regex_context = NULL;
+#endif
+}
+
+
 nxt_int_t
 nxt_regex_compile(nxt_regex_t *regex, u_char *source, size_t len,
     nxt_uint_t options, nxt_regex_context_t *ctx)
 {
-    int         ret, err, erroff;
-    char        *pattern, *error;
-    void        *(*saved_malloc)(size_t size);
-    void        (*saved_free)(void *p);
-    const char  *errstr;
+    int             ret, err, erroff;
+    char            *pattern, *error;
+    void            *(*saved_malloc)(size_t size);
+    void            (*saved_free)(void *p);
+    const char      *errstr;
+#if (NXT_HAVE_PCRE_JIT)
+    int             jit;
+#endif
 
     ret = NXT_ERROR;
 
+#if (NXT_HAVE_PCRE_JIT)
+
+    /* The stack is allocated by the system allocator. */
+
+    if (regex_jit_stack == NULL) {
+        regex_jit_stack = pcre_jit_stack_alloc(NXT_PCRE_JIT_STACK_MIN,
+                                               NXT_PCRE_JIT_STACK_MAX);
+    }
+
+#endif
+
     saved_malloc = pcre_malloc;
     pcre_malloc = nxt_pcre_malloc;
     saved_free = pcre_free;
@@ -95,7 +161,11 @@ nxt_regex_compile(nxt_regex_t *regex, u_char *source, size_t len,
         goto done;
     }
 
+#if (NXT_HAVE_PCRE_JIT)
+    regex->extra = pcre_study(regex->code, PCRE_STUDY_JIT_COMPILE, &errstr);
+#else
     regex->extra = pcre_study(regex->code, 0, &errstr);
+#endif
 
     if (nxt_slow_path(errstr != NULL)) {
         nxt_alert(ctx->trace, NXT_LEVEL_ERROR,
@@ -104,6 +174,24 @@ nxt_regex_compile(nxt_regex_t *regex, u_char *source, size_t len,
         goto done;
     }
 
+#if (NXT_HAVE_PCRE_JIT)
+
+    jit = 0;
+
+    if (regex->extra != NULL) {
+        err = pcre_fullinfo(regex->code, regex->extra, PCRE_INFO_JIT, &jit);
+
+        if (err < 0) {
+            jit = 0;
+        }
+    }
+
+    if (jit && regex_jit_stack != NULL) {
+        pcre_assign_jit_stack(regex->extra, NULL, regex_jit_stack);
+    }
+
+#endif
+
     err = pcre_fullinfo(regex->code, NULL, PCRE_INFO_CAPTURECOUNT,
                         &regex->ncaptures);
 
@@ -112,6 +200,12 @@ nxt_regex_compile(nxt_regex_t *regex, u_char *source, size_t len,
                   "pcre_fullinfo(\"%s\", PCRE_INFO_CAPTURECOUNT) failed: %d",
                   pattern, err);
 
+#if (NXT_HAVE_PCRE_JIT)
+        if (regex->extra != NULL) {
+            pcre_free_study(regex->extra);
+        }
+#endif
+
         goto done;
     }
 
@@ -212,11 +306,31 @@ nxt_int_t
 nxt_regex_match(nxt_regex_t *regex, u_char *subject, size_t len,
     nxt_regex_match_data_t *match_data, nxt_regex_context_t *ctx)
 {
-    int  ret;
+    int         ret;
+#if (NXT_HAVE_PCRE_JIT)
+    pcre_extra  extra;
+#endif
 
     ret = pcre_exec(regex->code, regex->extra, (char *) subject, len, 0, 0,
                     match_data->captures, match_data->ncaptures);
 
+#if (NXT_HAVE_PCRE_JIT)
+
+    /*
+     * The interpreter is not limited by the JIT stack size and
+     * is used if the stack is exhausted by a deep backtracking.
+     */
+
+    if (ret == PCRE_ERROR_JIT_STACKLIMIT) {
+        extra = *regex->extra;
+        extra.flags &= ~PCRE_EXTRA_EXECUTABLE_JIT;
+
+        ret = pcre_exec(regex->code, &extra, (char *) subject, len, 0, 0,
+                        match_data->captures, match_data->ncaptures);
+    }
+
+#endif
+
     /* PCRE_ERROR_NOMATCH is -1. */
 
     if (nxt_slow_path(ret < PCRE_ERROR_NOMATCH)) {
@@ -232,3 +346,5 @@ nxt_regex_captures(nxt_regex_match_data_t *match_data)
 {
     return match_data->captures;
 }
+
+#endif /* !(NXT_HAVE_PCRE2) */
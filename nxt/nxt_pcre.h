@@ -11,7 +11,18 @@
 #include <pcre.h>
 
 
-#define NXT_REGEX_NOMATCH  PCRE_ERROR_NOMATCH
+#define NXT_REGEX_NOMATCH    PCRE_ERROR_NOMATCH
+
+#define NXT_REGEX_CASELESS   PCRE_CASELESS
+#define NXT_REGEX_MULTILINE  PCRE_MULTILINE
+#define NXT_REGEX_UTF8       PCRE_UTF8
+
+#ifdef PCRE_JAVASCRIPT_COMPAT
+/* JavaScript compatibility has been introduced in PCRE-7.7. */
+#define NXT_REGEX_JAVASCRIPT_COMPAT  PCRE_JAVASCRIPT_COMPAT
+#else
+#define NXT_REGEX_JAVASCRIPT_COMPAT  0
+#endif
 
 
 struct nxt_regex_s {
@@ -33,4 +44,12 @@ struct nxt_regex_match_data_s {
 };
 
 
+struct nxt_regex_context_s {
+    nxt_pcre_malloc_t  private_malloc;
+    nxt_pcre_free_t    private_free;
+    void               *memory_data;
+    nxt_trace_t        *trace;
+};
+
+
 #endif /* _NXT_PCRE_H_INCLUDED_ */
@@ -0,0 +1,322 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_auto_config.h>
+
+#if (NXT_HAVE_PCRE2)
+
+#include <nxt_types.h>
+#include <nxt_clang.h>
+#include <nxt_stub.h>
+#include <nxt_trace.h>
+#include <nxt_regex.h>
+#include <nxt_pcre2.h>
+#include <string.h>
+
+
+/*
+ * The JIT compiled code runs on its own stack.  The default 32K stack
+ * allocated on the machine stack is not enough for complex regexes,
+ * so a larger stack is allocated on demand and is shared by all regexes.
+ * A VM is not used by several threads at once and the stack is not used
+ * by several matches at once, so the stack is per process, that is, per
+ * worker.
+ */
+
+#define NXT_PCRE2_JIT_STACK_MIN  (32 * 1024)
+#define NXT_PCRE2_JIT_STACK_MAX  (1024 * 1024)
+
+
+static void nxt_pcre2_jit_stack_init(void);
+static void *nxt_pcre2_default_malloc(size_t size, void *memory_data);
+static void nxt_pcre2_default_free(void *p, void *memory_data);
+
+
+static pcre2_jit_stack      *regex_jit_stack;
+static pcre2_match_context  *regex_match_context;
+
+
+nxt_regex_context_t *
+nxt_regex_context_create(nxt_pcre_malloc_t private_malloc,
+    nxt_pcre_free_t private_free, void *memory_data)
+{
+    nxt_regex_context_t  *ctx;
+
+    if (private_malloc == NULL) {
+        private_malloc = nxt_pcre2_default_malloc;
+        private_free = nxt_pcre2_default_free;
+    }
+
+    ctx = private_malloc(sizeof(nxt_regex_context_t), memory_data);
+    if (nxt_slow_path(ctx == NULL)) {
+        return NULL;
+    }
+
+    ctx->private_malloc = private_malloc;
+    ctx->private_free = private_free;
+    ctx->memory_data = memory_data;
+
+    ctx->general = pcre2_general_context_create(private_malloc, private_free,
+                                                memory_data);
+    if (nxt_slow_path(ctx->general == NULL)) {
+        goto fail;
+    }
+
+    ctx->compile = pcre2_compile_context_create(ctx->general);
+    if (nxt_slow_path(ctx->compile == NULL)) {
+        pcre2_general_context_free(ctx->general);
+        goto fail;
+    }
+
+    return ctx;
+
+fail:
+
+    private_free(ctx, memory_data);
+
+    return NULL;
+}
+
+
+void
+nxt_regex_free(nxt_regex_t *regex, nxt_regex_context_t *ctx)
+{
+    /* The code is freed by the allocator of the context. */
+
+    pcre2_code_free(regex->code);
+    regex->code = NULL;
+}
+
+
+nxt_int_t
+nxt_regex_compile(nxt_regex_t *regex, u_char *source, size_t len,
+    nxt_uint_t options, nxt_regex_context_t *ctx)
+{
+    int         err;
+    u_char      *error;
+    uint32_t    ncaptures;
+    PCRE2_SIZE  erroff;
+    u_char      errstr[128];
+
+    /* Zero length means a zero-terminated string. */
+
+    if (len == 0) {
+        len = strlen((char *) source);
+    }
+
+    regex->code = pcre2_compile(source, len, options, &err, &erroff,
+                                ctx->compile);
+
+    if (nxt_slow_path(regex->code == NULL)) {
+        pcre2_get_error_message(err, errstr, sizeof(errstr));
+
+        error = source + erroff;
+
+        if (erroff < len) {
+            nxt_alert(ctx->trace, NXT_LEVEL_ERROR,
+                      "pcre2_compile(\"%.*s\") failed: %s at \"%.*s\"",
+                      (int) len, source, errstr, (int) (len - erroff), error);
+
+        } else {
+            nxt_alert(ctx->trace, NXT_LEVEL_ERROR,
+                      "pcre2_compile(\"%.*s\") failed: %s",
+                      (int) len, source, errstr);
+        }
+
+        return NXT_ERROR;
+    }
+
+    err = pcre2_pattern_info(regex->code, PCRE2_INFO_CAPTURECOUNT, &ncaptures);
+
+    if (nxt_slow_path(err < 0)) {
+        nxt_alert(ctx->trace, NXT_LEVEL_ERROR,
+                  "pcre2_pattern_info(\"%.*s\", PCRE2_INFO_CAPTURECOUNT) "
+                  "failed: %d", (int) len, source, err);
+
+        return NXT_ERROR;
+    }
+
+    /* Reserve additional elements for the first "$0" capture. */
+    regex->ncaptures = ncaptures + 1;
+
+    /*
+     * The regex is matched by the interpreter if the library
+     * is built without JIT support or JIT compilation fails.
+     */
+
+    regex->jit = 0;
+
+    err = pcre2_jit_compile(regex->code, PCRE2_JIT_COMPLETE);
+
+    if (err == 0) {
+        regex->jit = 1;
+
+        nxt_pcre2_jit_stack_init();
+    }
+
+    return NXT_OK;
+}
+
+
+static void
+nxt_pcre2_jit_stack_init(void)
+{
+    /* The stack and the match context use the system allocator. */
+
+    if (regex_match_context != NULL) {
+        return;
+    }
+
+    regex_match_context = pcre2_match_context_create(NULL);
+    if (nxt_slow_path(regex_match_context == NULL)) {
+        return;
+    }
+
+    regex_jit_stack = pcre2_jit_stack_create(NXT_PCRE2_JIT_STACK_MIN,
+                                             NXT_PCRE2_JIT_STACK_MAX, NULL);
+
+    /* The default machine stack is used if the stack allocation fails. */
+
+    pcre2_jit_stack_assign(regex_match_context, NULL, regex_jit_stack);
+}
+
+
+nxt_bool_t
+nxt_regex_is_valid(nxt_regex_t *regex)
+{
+    return (regex->code != NULL);
+}
+
+
+nxt_uint_t
+nxt_regex_ncaptures(nxt_regex_t *regex)
+{
+    return regex->ncaptures;
+}
+
+
+nxt_regex_match_data_t *
+nxt_regex_match_data(nxt_regex_t *regex, nxt_regex_context_t *ctx)
+{
+    size_t                  size;
+    nxt_uint_t              ncaptures;
+    nxt_regex_match_data_t  *match_data;
+
+    if (regex != NULL) {
+        ncaptures = regex->ncaptures;
+
+    } else {
+        ncaptures = 1;
+    }
+
+    size = sizeof(nxt_regex_match_data_t) + (ncaptures - 1) * 2 * sizeof(int);
+
+    match_data = ctx->private_malloc(size, ctx->memory_data);
+    if (nxt_slow_path(match_data == NULL)) {
+        return NULL;
+    }
+
+    match_data->data = pcre2_match_data_create(ncaptures, ctx->general);
+    if (nxt_slow_path(match_data->data == NULL)) {
+        ctx->private_free(match_data, ctx->memory_data);
+        return NULL;
+    }
+
+    match_data->ncaptures = ncaptures;
+
+    return match_data;
+}
+
+
+void
+nxt_regex_match_data_free(nxt_regex_match_data_t *match_data,
+    nxt_regex_context_t *ctx)
+{
+    pcre2_match_data_free(match_data->data);
+    ctx->private_free(match_data, ctx->memory_data);
+}
+
+
+static void *
+nxt_pcre2_default_malloc(size_t size, void *memory_data)
+{
+    return malloc(size);
+}
+
+
+static void
+nxt_pcre2_default_free(void *p, void *memory_data)
+{
+    free(p);
+}
+
+
+nxt_int_t
+nxt_regex_match(nxt_regex_t *regex, u_char *subject, size_t len,
+    nxt_regex_match_data_t *match_data, nxt_regex_context_t *ctx)
+{
+    int         ret, *captures;
+    uint32_t    i, n;
+    PCRE2_SIZE  *ovector;
+
+    ret = PCRE2_ERROR_JIT_STACKLIMIT;
+
+    if (regex->jit) {
+        ret = pcre2_jit_match(regex->code, subject, len, 0, 0,
+                              match_data->data, regex_match_context);
+    }
+
+    /*
+     * The interpreter is not limited by the JIT stack size and
+     * is used if the stack is exhausted by a deep backtracking.
+     */
+
+    if (ret == PCRE2_ERROR_JIT_STACKLIMIT) {
+        ret = pcre2_match(regex->code, subject, len, 0, PCRE2_NO_JIT,
+                          match_data->data, NULL);
+    }
+
+    /* PCRE2_ERROR_NOMATCH is -1. */
+
+    if (ret < PCRE2_ERROR_NOMATCH) {
+        nxt_alert(ctx->trace, NXT_LEVEL_ERROR, "pcre2_match() failed: %d",
+                  ret);
+        return ret;
+    }
+
+    if (ret == PCRE2_ERROR_NOMATCH) {
+        return ret;
+    }
+
+    /*
+     * The offsets are converted to the PCRE layout, the unset captures
+     * and the captures after the last set one are -1.  Zero return value
+     * means that all captures did not fit in the match data.
+     */
+
+    ovector = pcre2_get_ovector_pointer(match_data->data);
+    captures = match_data->captures;
+
+    n = (ret != 0) ? (uint32_t) ret : (uint32_t) match_data->ncaptures;
+
+    for (i = 0; i < n * 2; i++) {
+        captures[i] = (ovector[i] != PCRE2_UNSET) ? (int) ovector[i] : -1;
+    }
+
+    for ( /* void */ ; i < (uint32_t) match_data->ncaptures * 2; i++) {
+        captures[i] = -1;
+    }
+
+    return ret;
+}
+
+
+int *
+nxt_regex_captures(nxt_regex_match_data_t *match_data)
+{
+    return match_data->captures;
+}
+
+#endif /* NXT_HAVE_PCRE2 */
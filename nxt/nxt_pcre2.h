@@ -0,0 +1,54 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NXT_PCRE2_H_INCLUDED_
+#define _NXT_PCRE2_H_INCLUDED_
+
+
+#define PCRE2_CODE_UNIT_WIDTH  8
+#include <pcre2.h>
+
+
+#define NXT_REGEX_NOMATCH    PCRE2_ERROR_NOMATCH
+
+#define NXT_REGEX_CASELESS   PCRE2_CASELESS
+#define NXT_REGEX_MULTILINE  PCRE2_MULTILINE
+#define NXT_REGEX_UTF8       PCRE2_UTF
+
+/* The PCRE2 replacement of PCRE_JAVASCRIPT_COMPAT. */
+#define NXT_REGEX_JAVASCRIPT_COMPAT                                           \
+    (PCRE2_ALT_BSUX | PCRE2_MATCH_UNSET_BACKREF | PCRE2_ALLOW_EMPTY_CLASS)
+
+
+struct nxt_regex_s {
+    pcre2_code          *code;
+    nxt_bool_t          jit;
+    int                 ncaptures;
+};
+
+
+struct nxt_regex_match_data_s {
+    pcre2_match_data    *data;
+    int                 ncaptures;
+    /*
+     * The N capture positions are converted from the PCRE2 offsets and
+     * are stored in [n * 2] and [n * 2 + 1] elements as with PCRE.
+     * The first pair is for the "$0" capture and it is always allocated.
+     */
+    int                 captures[2];
+};
+
+
+struct nxt_regex_context_s {
+    nxt_pcre_malloc_t      private_malloc;
+    nxt_pcre_free_t        private_free;
+    void                   *memory_data;
+    nxt_trace_t            *trace;
+    pcre2_general_context  *general;
+    pcre2_compile_context  *compile;
+};
+
+
+#endif /* _NXT_PCRE2_H_INCLUDED_ */
@@ -12,16 +12,16 @@ typedef void *(*nxt_pcre_malloc_t)(size_t size, void *memory_data);
 typedef void (*nxt_pcre_free_t)(void *p, void *memory_data);
 
 
+/*
+ * The structures are defined by the regex library backend:
+ * nxt_pcre.h for PCRE or nxt_pcre2.h for PCRE2.  Both backends compile
+ * regexes to machine code if the library supports JIT, the code is not
+ * allocated by the context allocator and is freed by nxt_regex_free().
+ */
+
 typedef struct nxt_regex_s             nxt_regex_t;
 typedef struct nxt_regex_match_data_s  nxt_regex_match_data_t;
-
-
-typedef struct {
-    nxt_pcre_malloc_t  private_malloc;
-    nxt_pcre_free_t    private_free;
-    void               *memory_data;
-    nxt_trace_t        *trace;
-} nxt_regex_context_t;
+typedef struct nxt_regex_context_s     nxt_regex_context_t;
 
 
 NXT_EXPORT nxt_regex_context_t *
@@ -29,6 +29,7 @@ NXT_EXPORT nxt_regex_context_t *
     nxt_pcre_free_t private_free, void *memory_data);
 NXT_EXPORT nxt_int_t nxt_regex_compile(nxt_regex_t *regex, u_char *source,
     size_t len, nxt_uint_t options, nxt_regex_context_t *ctx);
+NXT_EXPORT void nxt_regex_free(nxt_regex_t *regex, nxt_regex_context_t *ctx);
 NXT_EXPORT nxt_bool_t nxt_regex_is_valid(nxt_regex_t *regex);
 NXT_EXPORT nxt_uint_t nxt_regex_ncaptures(nxt_regex_t *regex);
 NXT_EXPORT nxt_regex_match_data_t *nxt_regex_match_data(nxt_regex_t *regex,
@@ -38,6 +38,24 @@ typedef struct {
 #define nxt_log_error(...)
 #define nxt_thread_log_debug(...)
 
+
+#if (NXT_DEBUG)
+
+#include <stdlib.h>
+
+#define nxt_assert(condition)                                                 \
+    do {                                                                      \
+        if (nxt_slow_path(!(condition))) {                                    \
+            abort();                                                          \
+        }                                                                     \
+    } while (0)
+
+#else
+
+#define nxt_assert(condition)
+
+#endif
+
 #define NXT_DOUBLE_LEN   1024
 
 #include <unistd.h>
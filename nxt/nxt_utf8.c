@@ -24,6 +24,85 @@
 #include <nxt_unicode_lower_case.h>
 #include <nxt_unicode_upper_case.h>
 
+#if (NXT_HAVE_SSE2)
+#include <emmintrin.h>
+#endif
+#include <string.h>
+
+
+/*
+ * The length functions process a string by chunks of 16 bytes with SSE2
+ * or by chunks of 8 bytes otherwise.  An ASCII chunk or a chunk of valid
+ * UTF-8 string is handled at once, only a non-ASCII chunk of unknown
+ * string is decoded character by character.
+ */
+
+#if (NXT_HAVE_SSE2)
+
+#define NXT_UTF8_CHUNK  16
+
+
+nxt_inline nxt_bool_t
+nxt_utf8_chunk_is_ascii(const u_char *p)
+{
+    return (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *) p)) == 0);
+}
+
+
+/* Returns the number of the chunk bytes which start UTF-8 characters. */
+
+nxt_inline size_t
+nxt_utf8_chunk_count(const u_char *p)
+{
+    __m128i  v;
+
+    v = _mm_loadu_si128((const __m128i *) p);
+
+    /* The continuation bytes 10xxxxxx are -128 ... -65 signed bytes. */
+
+    v = _mm_cmpgt_epi8(v, _mm_set1_epi8(-65));
+    v = _mm_and_si128(v, _mm_set1_epi8(1));
+    v = _mm_sad_epu8(v, _mm_setzero_si128());
+
+    return _mm_cvtsi128_si32(v) + _mm_extract_epi16(v, 4);
+}
+
+#else
+
+#define NXT_UTF8_CHUNK  8
+
+#define NXT_UTF8_HIGH_BITS  0x8080808080808080ULL
+
+
+nxt_inline nxt_bool_t
+nxt_utf8_chunk_is_ascii(const u_char *p)
+{
+    uint64_t  w;
+
+    memcpy(&w, p, sizeof(uint64_t));
+
+    return ((w & NXT_UTF8_HIGH_BITS) == 0);
+}
+
+
+nxt_inline size_t
+nxt_utf8_chunk_count(const u_char *p)
+{
+    uint64_t  w;
+
+    memcpy(&w, p, sizeof(uint64_t));
+
+    /* The high bits of the continuation bytes 10xxxxxx. */
+
+    w = w & ~(w << 1) & NXT_UTF8_HIGH_BITS;
+
+    /* The sum of the bytes is in the high byte. */
+
+    return 8 - (size_t) (((w >> 7) * 0x0101010101010101ULL) >> 56);
+}
+
+#endif
+
 
 u_char *
 nxt_utf8_encode(u_char *p, uint32_t u)
@@ -261,12 +340,34 @@ ssize_t
 nxt_utf8_length(const u_char *p, size_t len)
 {
     ssize_t       length;
-    const u_char  *end;
+    const u_char  *end, *chunk;
 
     length = 0;
 
     end = p + len;
 
+    while ((size_t) (end - p) >= NXT_UTF8_CHUNK) {
+
+        if (nxt_utf8_chunk_is_ascii(p)) {
+            p += NXT_UTF8_CHUNK;
+            length += NXT_UTF8_CHUNK;
+            continue;
+        }
+
+        /* The last character may end beyond the chunk. */
+
+        chunk = p + NXT_UTF8_CHUNK;
+
+        do {
+            if (nxt_slow_path(nxt_utf8_decode(&p, end) == 0xffffffff)) {
+                return -1;
+            }
+
+            length++;
+
+        } while (p < chunk);
+    }
+
     while (p < end) {
         if (nxt_slow_path(nxt_utf8_decode(&p, end) == 0xffffffff)) {
             return -1;
@@ -282,15 +383,75 @@ nxt_utf8_length(const u_char *p, size_t len)
 nxt_bool_t
 nxt_utf8_is_valid(const u_char *p, size_t len)
 {
+    return (nxt_utf8_length(p, len) >= 0);
+}
+
+
+/*
+ * nxt_utf8_count() and nxt_utf8_skip() expect a valid UTF-8 string,
+ * they count the bytes which are not the continuation bytes 10xxxxxx.
+ */
+
+size_t
+nxt_utf8_count(const u_char *p, size_t len)
+{
+    size_t        length;
     const u_char  *end;
 
+    length = 0;
+
     end = p + len;
 
+    while ((size_t) (end - p) >= NXT_UTF8_CHUNK) {
+        length += nxt_utf8_chunk_count(p);
+        p += NXT_UTF8_CHUNK;
+    }
+
     while (p < end) {
-        if (nxt_slow_path(nxt_utf8_decode(&p, end) == 0xffffffff)) {
-            return 0;
+        length += ((*p++ & 0xC0) != 0x80);
+    }
+
+    return length;
+}
+
+
+/*
+ * nxt_utf8_skip() returns the start of the n-th character after
+ * the character at p, or the end if the string is shorter.
+ */
+
+const u_char *
+nxt_utf8_skip(const u_char *p, const u_char *end, size_t n)
+{
+    size_t  count;
+
+    /* The character at p is counted too. */
+
+    n++;
+
+    while ((size_t) (end - p) >= NXT_UTF8_CHUNK) {
+        count = nxt_utf8_chunk_count(p);
+
+        if (count >= n) {
+            break;
         }
+
+        n -= count;
+        p += NXT_UTF8_CHUNK;
+    }
+
+    while (p < end) {
+
+        if ((*p & 0xC0) != 0x80) {
+            n--;
+
+            if (n == 0) {
+                return p;
+            }
+        }
+
+        p++;
     }
 
-    return 1;
+    return end;
 }
@@ -27,6 +27,9 @@ NXT_EXPORT uint32_t nxt_utf8_upper_case(const u_char **start,
     const u_char *end);
 NXT_EXPORT ssize_t nxt_utf8_length(const u_char *p, size_t len);
 NXT_EXPORT nxt_bool_t nxt_utf8_is_valid(const u_char *p, size_t len);
+NXT_EXPORT size_t nxt_utf8_count(const u_char *p, size_t len);
+NXT_EXPORT const u_char *nxt_utf8_skip(const u_char *p, const u_char *end,
+    size_t n);
 
 
 /*
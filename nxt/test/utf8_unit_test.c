@@ -17,6 +17,9 @@
 //#define NXT_UTF8_START_TEST  0
 
 
+static uint32_t  multibyte[] = { 0x00B6, 0x20AC, 0x1F600, 0x0061 };
+
+
 static u_char  invalid[] = {
 
     /* Invalid first byte less than 0xC2. */
@@ -82,6 +85,95 @@ utf8_overlong(u_char *overlong, size_t len)
 }
 
 
+static nxt_int_t
+utf8_length_unit_test(void)
+{
+    u_char        *p, c, buf[256];
+    size_t        size;
+    ssize_t       length;
+    uint32_t      u;
+    nxt_uint_t    i, k, n, a, b, offsets[256];
+    const u_char  *pp, *expect;
+
+    /*
+     * The string has runs of ASCII characters and runs of
+     * 2, 3, and 4 bytes characters to cross the chunk boundaries.
+     */
+
+    p = buf;
+    n = 0;
+
+    while (p < buf + sizeof(buf) - 4) {
+        offsets[n] = p - buf;
+        u = ((n / 20) % 2 == 0) ? (u_char) ('a' + n % 26) : multibyte[n % 4];
+        p = nxt_utf8_encode(p, u);
+        n++;
+    }
+
+    offsets[n] = p - buf;
+    size = p - buf;
+
+    for (a = 0; a <= n; a++) {
+        for (b = a; b <= n; b++) {
+            p = buf + offsets[a];
+            size = offsets[b] - offsets[a];
+
+            length = nxt_utf8_length(p, size);
+
+            if (length != (ssize_t) (b - a)) {
+                printf("nxt_utf8_length(%u, %u) failed: %zd\n",
+                       (unsigned) a, (unsigned) b, length);
+                return NXT_ERROR;
+            }
+
+            if (nxt_utf8_count(p, size) != b - a) {
+                printf("nxt_utf8_count(%u, %u) failed\n",
+                       (unsigned) a, (unsigned) b);
+                return NXT_ERROR;
+            }
+
+            for (k = 0; k <= b - a; k++) {
+                pp = nxt_utf8_skip(p, p + size, k);
+                expect = buf + offsets[a + k];
+
+                if (pp != expect) {
+                    printf("nxt_utf8_skip(%u, %u, %u) failed\n",
+                           (unsigned) a, (unsigned) b, (unsigned) k);
+                    return NXT_ERROR;
+                }
+            }
+        }
+    }
+
+    size = offsets[n];
+
+    for (i = 0; i < size; i++) {
+        c = buf[i];
+        buf[i] = 0xFF;
+
+        if (nxt_utf8_length(buf, size) != -1 || nxt_utf8_is_valid(buf, size)) {
+            printf("nxt_utf8_length() failed on invalid byte at %u\n",
+                   (unsigned) i);
+            return NXT_ERROR;
+        }
+
+        buf[i] = c;
+    }
+
+    for (i = 0; i < n; i++) {
+        if (offsets[i + 1] - offsets[i] > 1
+            && nxt_utf8_length(buf, offsets[i] + 1) != -1)
+        {
+            printf("nxt_utf8_length() failed on incomplete character %u\n",
+                   (unsigned) i);
+            return NXT_ERROR;
+        }
+    }
+
+    return NXT_OK;
+}
+
+
 static nxt_int_t
 utf8_unit_test(nxt_uint_t start)
 {
@@ -185,6 +277,10 @@ utf8_unit_test(nxt_uint_t start)
         return NXT_ERROR;
     }
 
+    if (utf8_length_unit_test() != NXT_OK) {
+        return NXT_ERROR;
+    }
+
     printf("utf8 unit test passed\n");
     return NXT_OK;
 }